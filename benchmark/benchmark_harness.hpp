@@ -0,0 +1,378 @@
+#pragma once
+
+#include <juno/common/communicator.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm> // std::sort, std::max
+#include <chrono>
+#include <cmath> // std::abs
+#include <cstdint>
+#include <cstdio>  // fprintf, fopen
+#include <cstdlib> // strtol, strtod
+#include <cstring> // strcmp, strstr
+#include <string>
+#include <utility> // std::move
+#include <vector>
+
+#include <unistd.h> // dup, close
+
+//========================================================================================
+// Benchmark Harness
+//========================================================================================
+// We want a benchmark harness that:
+// - Gives stable numbers that can be compared between releases on the same hardware.
+//   - Each benchmark is run a few times to warm up caches, page in memory, and let the
+//     clocks settle, then timed for a number of samples.
+//   - Each sample repeats the benchmark enough times to last at least min_time, so that
+//     short kernels are not dominated by the resolution of the clock.
+//   - We report the median and the median absolute deviation (MAD) of the samples,
+//     which are insensitive to the occasional sample disturbed by the OS.
+// - Reports in the units that matter for the kernel: seconds, GB/s and GFLOP/s, from
+//   the number of bytes moved and flops performed per call, as declared by the caller.
+//   - Given the peak bandwidth and flop rate of the machine, the fraction of the
+//     roofline bound achieved, min(peak GFLOP/s, intensity * peak GB/s), is reported.
+// - Writes machine-readable JSON, so results can be tracked by scripts.
+// - Works for host and device code. Kokkos::fence() is called after each call, so that
+//   asynchronous kernels are timed to completion.
+// - Works for distributed benchmarks, when MPI is initialized before the harness: the
+//   ranks start each sample together, the time of a sample is that of the slowest rank,
+//   and rank 0 prints and writes the results. The bytes and flops are per rank.
+//
+// Usage:
+// 1. BENCHMARK_CASE(name)
+//      - to define a benchmark case, which calls harness.run(...) one or more times.
+//      - harness.run(name, bytes, flops, f) times f(), which moves "bytes" bytes and
+//        performs "flops" floating point operations per call. Either may be 0.
+//      - pass results that are otherwise unused to doNotOptimize(value), so that the
+//        compiler cannot remove their computation.
+// 2. BENCHMARK_SUITE(name)
+//      - to define a benchmark suite containing one or more BENCHMARK(case).
+// 3. RUN_BENCHMARK_SUITE(suite, argc, argv)
+//      - to initialize Kokkos and run a benchmark suite in the main function.
+//
+// Command line options (after the Kokkos options, which Kokkos removes):
+//   --warmup N       calls before timing (default 3)
+//   --samples N      timed samples (default 10)
+//   --min-time S     minimum duration of a sample in seconds (default 0.001)
+//   --filter STR     only run benchmarks whose name contains STR
+//   --json FILE      write the results to FILE
+//   --peak-gbs X     peak bandwidth of the machine in GB/s, for the roofline
+//   --peak-gflops X  peak flop rate of the machine in GFLOP/s, for the roofline
+
+namespace juno::benchmark
+{
+
+struct Options {
+  int32_t warmup = 3;
+  int32_t samples = 10;
+  double min_time = 1e-3;
+  char const * filter = nullptr;
+  char const * json = nullptr;
+  double peak_gbs = 0.0;
+  double peak_gflops = 0.0;
+};
+
+struct Result {
+  std::string name;
+  int64_t bytes;      // per call
+  int64_t flops;      // per call
+  int64_t iterations; // calls per sample
+  int32_t samples;
+  double median; // seconds per call
+  double mad;    // seconds per call
+  double min;    // seconds per call
+  double max;    // seconds per call
+
+  [[nodiscard]] auto
+  gbs() const noexcept -> double
+  {
+    return 1e-9 * static_cast<double>(bytes) / median;
+  }
+
+  [[nodiscard]] auto
+  gflops() const noexcept -> double
+  {
+    return 1e-9 * static_cast<double>(flops) / median;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Median of the values. Reorders the values.
+inline auto
+median(std::vector<double> & values) -> double
+{
+  std::sort(values.begin(), values.end());
+  size_t const n = values.size();
+  return n % 2 == 1 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+//----------------------------------------------------------------------------------------
+// Median absolute deviation from the median. Reorders the values.
+inline auto
+medianAbsoluteDeviation(std::vector<double> & values, double const med) -> double
+{
+  for (double & v : values) {
+    v = std::abs(v - med);
+  }
+  return median(values);
+}
+
+//----------------------------------------------------------------------------------------
+// Prevent the compiler from removing the computation of a value that is otherwise
+// unused, e.g. the result of a reduction.
+template <class T>
+inline void
+doNotOptimize(T const & value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class Harness
+{
+  using Clock = std::chrono::steady_clock;
+
+  std::string _suite;
+  Options _options;
+  std::vector<Result> _results;
+  Communicator _comm;
+  FILE * _out = stdout; // A copy of stdout, which a benchmark may redirect
+
+  [[nodiscard]] auto
+  isRoot() const noexcept -> bool
+  {
+    return _comm.rank() == 0;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Time "iterations" calls of f, in seconds, on the slowest rank.
+  template <class F>
+  auto
+  timeCalls(F & f, int64_t const iterations) const -> double
+  {
+    _comm.barrier();
+    auto const start = Clock::now();
+    for (int64_t i = 0; i < iterations; ++i) {
+      f();
+      Kokkos::fence();
+    }
+    std::chrono::duration<double> const elapsed = Clock::now() - start;
+    return _comm.maxAll(elapsed.count());
+  }
+
+  //--------------------------------------------------------------------------------------
+  [[nodiscard]] auto
+  rooflineFraction(Result const & r) const noexcept -> double
+  {
+    if (_options.peak_gbs <= 0.0 || _options.peak_gflops <= 0.0 || r.bytes == 0 ||
+        r.flops == 0) {
+      return 0.0;
+    }
+    double const intensity = static_cast<double>(r.flops) / static_cast<double>(r.bytes);
+    double const bound = std::min(_options.peak_gflops, intensity * _options.peak_gbs);
+    return r.gflops() / bound;
+  }
+
+  //--------------------------------------------------------------------------------------
+  static void
+  writeJSONString(FILE * file, std::string const & s)
+  {
+    fputc('"', file);
+    for (char const c : s) {
+      if (c == '"' || c == '\\') {
+        fputc('\\', file);
+      }
+      fputc(c, file);
+    }
+    fputc('"', file);
+  }
+
+public:
+  //--------------------------------------------------------------------------------------
+  // Parse the harness options from the command line. Unknown arguments are ignored.
+  Harness(char const * suite, int argc, char ** argv)
+      : _suite(suite)
+  {
+    for (int i = 1; i + 1 < argc; ++i) {
+      char const * const arg = argv[i];
+      char * const value = argv[i + 1];
+      if (std::strcmp(arg, "--warmup") == 0) {
+        _options.warmup = static_cast<int32_t>(std::strtol(value, nullptr, 10));
+      } else if (std::strcmp(arg, "--samples") == 0) {
+        _options.samples = static_cast<int32_t>(std::strtol(value, nullptr, 10));
+      } else if (std::strcmp(arg, "--min-time") == 0) {
+        _options.min_time = std::strtod(value, nullptr);
+      } else if (std::strcmp(arg, "--filter") == 0) {
+        _options.filter = value;
+      } else if (std::strcmp(arg, "--json") == 0) {
+        _options.json = value;
+      } else if (std::strcmp(arg, "--peak-gbs") == 0) {
+        _options.peak_gbs = std::strtod(value, nullptr);
+      } else if (std::strcmp(arg, "--peak-gflops") == 0) {
+        _options.peak_gflops = std::strtod(value, nullptr);
+      } else {
+        continue;
+      }
+      ++i;
+    }
+    _options.samples = std::max(_options.samples, 1);
+
+    // Print through a copy of file descriptor 1, so that a benchmark may discard the
+    // output of the code it times by redirecting stdout
+    fflush(stdout);
+    int const fd = dup(fileno(stdout));
+    if (fd >= 0) {
+      FILE * const out = fdopen(fd, "w");
+      if (out != nullptr) {
+        setvbuf(out, nullptr, _IOLBF, 0);
+        _out = out;
+      } else {
+        close(fd);
+      }
+    }
+
+    if (isRoot()) {
+      fprintf(_out, "Running benchmark suite '%s' on %s, %d ranks\n", suite,
+              Kokkos::DefaultExecutionSpace::name(), _comm.size());
+      fprintf(_out, "%-40s %12s %12s %10s %10s %10s\n", "benchmark", "median (s)",
+              "MAD (s)", "GB/s", "GFLOP/s", "roofline");
+    }
+  }
+
+  Harness(Harness const &) = delete;
+  Harness(Harness &&) = delete;
+  auto
+  operator=(Harness const &) -> Harness & = delete;
+  auto
+  operator=(Harness &&) -> Harness & = delete;
+
+  ~Harness()
+  {
+    if (_out != stdout) {
+      fclose(_out);
+    }
+  }
+
+  [[nodiscard]] auto
+  options() const noexcept -> Options const &
+  {
+    return _options;
+  }
+
+  [[nodiscard]] auto
+  results() const noexcept -> std::vector<Result> const &
+  {
+    return _results;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Time f(), which moves "bytes" bytes and performs "flops" flops per call.
+  template <class F>
+  void
+  run(char const * name, int64_t const bytes, int64_t const flops, F && f)
+  {
+    if (_options.filter != nullptr && std::strstr(name, _options.filter) == nullptr) {
+      return;
+    }
+
+    // Warm up, using the last call to estimate the number of calls per sample
+    double once = 0.0;
+    for (int32_t i = 0; i < std::max(_options.warmup, 1); ++i) {
+      once = timeCalls(f, 1);
+    }
+    int64_t iterations = 1;
+    if (once < _options.min_time) {
+      iterations = static_cast<int64_t>(_options.min_time / std::max(once, 1e-9)) + 1;
+    }
+
+    std::vector<double> times(static_cast<size_t>(_options.samples));
+    for (double & t : times) {
+      t = timeCalls(f, iterations) / static_cast<double>(iterations);
+    }
+    auto const [min, max] = std::minmax_element(times.begin(), times.end());
+    Result r{name, bytes, flops, iterations, _options.samples, 0.0, 0.0, *min, *max};
+    r.median = median(times);
+    r.mad = medianAbsoluteDeviation(times, r.median);
+    if (isRoot()) {
+      fprintf(_out, "%-40s %12.4e %12.4e %10.3f %10.3f %9.1f%%\n", name, r.median,
+              r.mad, r.gbs(), r.gflops(), 100.0 * rooflineFraction(r));
+    }
+    _results.push_back(std::move(r));
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Write the results to the JSON file, if requested. Returns false on failure.
+  auto
+  finish() -> bool
+  {
+    if (!isRoot()) {
+      return true;
+    }
+    fprintf(_out, "Benchmark suite '%s' finished\n", _suite.c_str());
+    if (_options.json == nullptr) {
+      return true;
+    }
+    FILE * const file = fopen(_options.json, "w");
+    if (file == nullptr) {
+      fprintf(_out, "Could not open '%s' for writing\n", _options.json);
+      return false;
+    }
+    fprintf(file, "{\n  \"suite\": ");
+    writeJSONString(file, _suite);
+    fprintf(file, ",\n  \"context\": {\n");
+    fprintf(file, "    \"execution_space\": \"%s\",\n",
+            Kokkos::DefaultExecutionSpace::name());
+    fprintf(file, "    \"host_concurrency\": %d,\n",
+            Kokkos::DefaultHostExecutionSpace().concurrency());
+    fprintf(file, "    \"ranks\": %d,\n", _comm.size());
+    fprintf(file, "    \"float64\": %s,\n", JUNO_ENABLE_FLOAT64 ? "true" : "false");
+#ifdef __FAST_MATH__
+    fprintf(file, "    \"fastmath\": true,\n");
+#else
+    fprintf(file, "    \"fastmath\": false,\n");
+#endif
+    fprintf(file, "    \"asserts\": %s,\n", JUNO_ENABLE_ASSERTS ? "true" : "false");
+    fprintf(file, "    \"warmup\": %d,\n", _options.warmup);
+    fprintf(file, "    \"min_time\": %.9g,\n", _options.min_time);
+    fprintf(file, "    \"peak_gbs\": %.9g,\n", _options.peak_gbs);
+    fprintf(file, "    \"peak_gflops\": %.9g\n", _options.peak_gflops);
+    fprintf(file, "  },\n  \"benchmarks\": [");
+    for (size_t i = 0; i < _results.size(); ++i) {
+      Result const & r = _results[i];
+      fprintf(file, "%s\n    {\"name\": ", i == 0 ? "" : ",");
+      writeJSONString(file, r.name);
+      fprintf(file,
+              ", \"bytes\": %ld, \"flops\": %ld, \"iterations\": %ld, \"samples\": %d, "
+              "\"median_s\": %.9g, \"mad_s\": %.9g, \"min_s\": %.9g, \"max_s\": %.9g, "
+              "\"gb_per_s\": %.9g, \"gflop_per_s\": %.9g, \"roofline_fraction\": %.9g}",
+              r.bytes, r.flops, r.iterations, r.samples, r.median, r.mad, r.min, r.max,
+              r.gbs(), r.gflops(), rooflineFraction(r));
+    }
+    fprintf(file, "\n  ]\n}\n");
+    bool const ok = fclose(file) == 0;
+    fprintf(_out, "Wrote results to '%s'\n", _options.json);
+    return ok;
+  }
+};
+
+} // namespace juno::benchmark
+
+// We don't want to put the entire benchmark file in an anonymous namespace
+// NOLINTBEGIN(misc-use-anonymous-namespace)
+#define BENCHMARK_CASE(name) static void name(juno::benchmark::Harness & harness)
+
+#define BENCHMARK_SUITE(name) static void name(juno::benchmark::Harness & harness)
+// NOLINTEND(misc-use-anonymous-namespace)
+
+#define BENCHMARK(name) name(harness)
+
+#define RUN_BENCHMARK_SUITE(suite, argc, argv)                                           \
+  {                                                                                      \
+    Kokkos::ScopeGuard const kokkos_guard(argc, argv);                                   \
+    juno::benchmark::Harness harness(#suite, argc, argv);                                \
+    suite(harness);                                                                      \
+    if (!harness.finish()) {                                                             \
+      return 1;                                                                          \
+    }                                                                                    \
+  }
@@ -0,0 +1,63 @@
+#include <juno/common/arena.hpp>
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include "../benchmark_harness.hpp"
+
+// The temporaries of an outer iteration: a few vectors, allocated as Views each
+// iteration, or carved from an arena that is reset each iteration. The kernel is
+// small, so that the cost of the allocations shows.
+
+Int constexpr num_values = 1 << 16;
+Int constexpr num_temporaries = 8;
+
+int64_t constexpr iteration_bytes =
+    int64_t{num_temporaries} * num_values * int64_t{sizeof(Float)};
+
+BENCHMARK_CASE(temporaries)
+{
+  using MemSpace = juno::DeviceMemSpace;
+  using ExecSpace = typename MemSpace::execution_space;
+  using Vector = Kokkos::View<Float *, MemSpace>;
+  auto const size = static_cast<size_t>(num_values);
+
+  auto const fill = [](Vector const & v) {
+    Kokkos::parallel_for(
+        "fill", juno::rangePolicy<ExecSpace>(0, num_values),
+        KOKKOS_LAMBDA(Int const i) { v(i) = static_cast<Float>(i); });
+  };
+  harness.run("Views", iteration_bytes, 0, [&]() {
+    for (Int k = 0; k < num_temporaries; ++k) {
+      fill(Vector(Kokkos::view_alloc(Kokkos::WithoutInitializing, std::string("v")),
+                  size));
+    }
+    Kokkos::fence();
+  });
+
+  juno::Arena<MemSpace> arena("temporaries");
+  harness.run("arena", iteration_bytes, 0, [&]() {
+    for (Int k = 0; k < num_temporaries; ++k) {
+      fill(arena.allocate<Float>(size));
+    }
+    Kokkos::fence();
+    arena.reset();
+  });
+  arena.logUsage();
+}
+
+BENCHMARK_SUITE(arena)
+{
+  BENCHMARK(temporaries);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(arena, argc, argv);
+  return 0;
+}
@@ -0,0 +1,253 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/mirrored_view.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm> // std::min
+#include <concepts>
+#include <cstdint>
+#include <cstdio> // printf
+
+#include "../benchmark_harness.hpp"
+
+// Bandwidth of a simple reduction over Kokkos views in host and device memory, with
+// the default Kokkos policies, the tuned juno policies with Int and Size indices, and a
+// native HIP kernel
+
+using HostSpace = Kokkos::HostSpace;
+using HostExecSpace = HostSpace::execution_space;
+using HostRangePolicy = Kokkos::RangePolicy<HostExecSpace>;
+using DeviceExecSpace = Kokkos::DefaultExecutionSpace;
+using DeviceSpace = DeviceExecSpace::memory_space;
+using DeviceRangePolicy = Kokkos::RangePolicy<DeviceExecSpace>;
+
+template <typename T, typename MemSpace>
+struct Grid {
+  using Vector = Kokkos::View<T *, Kokkos::LayoutLeft, MemSpace>;
+  Vector _x;
+
+  explicit Grid(size_t n) noexcept
+      : _x("x", n) {};
+
+  template <typename OtherMemSpace>
+  auto
+  operator=(Grid<T, OtherMemSpace> const & g) noexcept -> Grid<T, MemSpace> &
+  {
+    if constexpr (std::same_as<MemSpace, OtherMemSpace>) {
+      _x = g._x;
+    } else {
+      Kokkos::deep_copy(_x, g._x);
+    }
+    return *this;
+  }
+};
+
+int32_t constexpr size = 1 << 24;
+int64_t constexpr bytes = int64_t{size} * int64_t{sizeof(float)};
+
+#if JUNO_USE_HIP
+//----------------------------------------------------------------------------------------
+// Native HIP reference: a grid-stride loop, a block reduction in shared memory, and one
+// atomic per block.
+int32_t constexpr hip_block_size = 256;
+
+__global__ void __launch_bounds__(hip_block_size)
+    sinReduceKernel(float const * RESTRICT x, int32_t const n, float * RESTRICT result)
+{
+  __shared__ float partial[hip_block_size];
+  float sum = 0;
+  auto const stride = static_cast<int32_t>(gridDim.x * blockDim.x);
+  for (auto i = static_cast<int32_t>(blockIdx.x * blockDim.x + threadIdx.x); i < n;
+       i += stride) {
+    sum += sinf(x[i]);
+  }
+  partial[threadIdx.x] = sum;
+  __syncthreads();
+  for (uint32_t s = hip_block_size / 2; s > 0; s >>= 1) {
+    if (threadIdx.x < s) {
+      partial[threadIdx.x] += partial[threadIdx.x + s];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    atomicAdd(result, partial[0]);
+  }
+}
+#endif
+
+BENCHMARK_CASE(sinReduce)
+{
+  Grid<float, HostSpace> h_a(size);
+  for (int32_t i = 0; i < size; ++i) {
+    h_a._x(i) = 1;
+  }
+  Grid<float, DeviceSpace> d_a(size);
+  d_a = h_a;
+
+  // Host: default and tuned policies
+  float h_result = 0;
+  harness.run("SinReduce default (host)", bytes, size, [&]() {
+    Kokkos::parallel_reduce(
+        "SinReduce", HostRangePolicy(0, size),
+        KOKKOS_LAMBDA(int64_t const i, float & update) {
+          update += Kokkos::sin(h_a._x(i));
+        },
+        h_result);
+    juno::benchmark::doNotOptimize(h_result);
+  });
+  harness.run("SinReduce tuned range (host)", bytes, size, [&]() {
+    Kokkos::parallel_reduce(
+        "SinReduce", juno::rangePolicy<HostExecSpace>(0, size),
+        KOKKOS_LAMBDA(Int const i, float & update) { update += Kokkos::sin(h_a._x(i)); },
+        h_result);
+    juno::benchmark::doNotOptimize(h_result);
+  });
+  harness.run("SinReduce tuned range, Size index (host)", bytes, size, [&]() {
+    Kokkos::parallel_reduce(
+        "SinReduce", juno::rangePolicy<HostExecSpace, Size>(0, size),
+        KOKKOS_LAMBDA(Size const i, float & update) { update += Kokkos::sin(h_a._x(i)); },
+        h_result);
+    juno::benchmark::doNotOptimize(h_result);
+  });
+
+  // Device: default and tuned policies, and the native reference
+  float d_result = 0;
+  harness.run("SinReduce default (device)", bytes, size, [&]() {
+    Kokkos::parallel_reduce(
+        "SinReduce", DeviceRangePolicy(0, size),
+        KOKKOS_LAMBDA(int64_t const i, float & update) {
+          update += Kokkos::sin(d_a._x(i));
+        },
+        d_result);
+    juno::benchmark::doNotOptimize(d_result);
+  });
+  harness.run("SinReduce tuned range (device)", bytes, size, [&]() {
+    Kokkos::parallel_reduce(
+        "SinReduce", juno::rangePolicy<DeviceExecSpace>(0, size),
+        KOKKOS_LAMBDA(Int const i, float & update) { update += Kokkos::sin(d_a._x(i)); },
+        d_result);
+    juno::benchmark::doNotOptimize(d_result);
+  });
+  harness.run("SinReduce tuned range, Size index (device)", bytes, size, [&]() {
+    Kokkos::parallel_reduce(
+        "SinReduce", juno::rangePolicy<DeviceExecSpace, Size>(0, size),
+        KOKKOS_LAMBDA(Size const i, float & update) { update += Kokkos::sin(d_a._x(i)); },
+        d_result);
+    juno::benchmark::doNotOptimize(d_result);
+  });
+  using Member = juno::TunedTeamPolicy<DeviceExecSpace>::member_type;
+  harness.run("SinReduce grid-stride (device)", bytes, size, [&]() {
+    Kokkos::parallel_reduce(
+        "SinReduce", juno::gridStridePolicy<DeviceExecSpace>(size),
+        KOKKOS_LAMBDA(Member const & member, float & update) {
+          for (Int i = juno::gridStrideBegin(member); i < size;
+               i += juno::gridStrideStep(member)) {
+            update += Kokkos::sin(d_a._x(i));
+          }
+        },
+        d_result);
+    juno::benchmark::doNotOptimize(d_result);
+  });
+
+#if JUNO_USE_HIP
+  int32_t device = 0;
+  hipDeviceProp_t prop;
+  if (hipGetDevice(&device) != hipSuccess ||
+      hipGetDeviceProperties(&prop, device) != hipSuccess) {
+    printf("Could not query the HIP device\n");
+    return;
+  }
+  int32_t const resident_blocks =
+      prop.multiProcessorCount * (prop.maxThreadsPerMultiProcessor / hip_block_size);
+  int32_t const blocks =
+      std::min((size + hip_block_size - 1) / hip_block_size, resident_blocks);
+  Kokkos::View<float, DeviceSpace> const result("result");
+  harness.run("SinReduce native HIP (device)", bytes, size, [&]() {
+    // Kokkos::fence() in the harness synchronizes the device after the launch
+    if (hipMemsetAsync(result.data(), 0, sizeof(float)) != hipSuccess) {
+      return;
+    }
+    sinReduceKernel<<<blocks, hip_block_size>>>(d_a._x.data(), size, result.data());
+  });
+  gpuError_t const error = gpuGetLastError();
+  if (error != gpuSuccess) {
+    printf("HIP error: %s\n", gpuGetErrorString(error));
+  }
+#endif
+}
+
+BENCHMARK_CASE(deepCopy)
+{
+  Grid<float, HostSpace> h_a(size);
+  Grid<float, DeviceSpace> d_a(size);
+  // Read and write
+  harness.run("deep_copy (host to device)", 2 * bytes, 0, [&]() { d_a = h_a; });
+  harness.run("deep_copy (device to host)", 2 * bytes, 0, [&]() { h_a = d_a; });
+}
+
+BENCHMARK_CASE(batchedUpload)
+{
+  // Upload and reduce the data in batches, with a blocking copy before each kernel, and
+  // with the upload of the next batch overlapping the kernel on the current one.
+  Int constexpr num_batches = 8;
+  Int constexpr batch_size = size / num_batches;
+  // Uploaded, then read
+  int64_t constexpr batch_bytes = 2 * int64_t{batch_size} * int64_t{sizeof(float)};
+
+  juno::MirroredView<float, DeviceExecSpace> const blocking("blocking", batch_size);
+  harness.run("upload + SinReduce blocking", num_batches * batch_bytes, size, [&]() {
+    DeviceExecSpace const space;
+    auto const d_x = blocking.device();
+    for (Int b = 0; b < num_batches; ++b) {
+      blocking.toDevice(space);
+      space.fence();
+      float result = 0;
+      Kokkos::parallel_reduce(
+          "SinReduce", juno::rangePolicy(0, batch_size, space),
+          KOKKOS_LAMBDA(Int const i, float & update) { update += Kokkos::sin(d_x(i)); },
+          result);
+      juno::benchmark::doNotOptimize(result);
+    }
+  });
+
+  // Reduce into device views, so that the reductions do not block the host
+  juno::DoubleBufferedView<float, DeviceExecSpace> buf("double_buffered", batch_size);
+  Kokkos::View<float, DeviceSpace> const results[2] = {
+      Kokkos::View<float, DeviceSpace>("result_0"),
+      Kokkos::View<float, DeviceSpace>("result_1")};
+  auto const double_buffered = [&]() {
+    buf.acquireBack();
+    buf.beginUpload();
+    buf.swap();
+    for (Int b = 0; b < num_batches; ++b) {
+      auto const d_x = buf.front().device();
+      Kokkos::parallel_reduce(
+          "SinReduce", juno::rangePolicy(0, batch_size, buf.computeSpace()),
+          KOKKOS_LAMBDA(Int const i, float & update) { update += Kokkos::sin(d_x(i)); },
+          results[b % 2]);
+      if (b + 1 < num_batches) {
+        buf.acquireBack();
+        buf.beginUpload();
+      }
+      buf.swap();
+    }
+    buf.fence();
+  };
+  harness.run("upload + SinReduce double-buffered", num_batches * batch_bytes, size,
+              double_buffered);
+}
+
+BENCHMARK_SUITE(device_view)
+{
+  BENCHMARK(sinReduce);
+  BENCHMARK(deepCopy);
+  BENCHMARK(batchedUpload);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(device_view, argc, argv);
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include <juno/common/logger.hpp>
+
+#include <cstdint>
+#include <cstdio>      // snprintf
+#include <type_traits> // std::is_integral_v
+
+#include <fcntl.h>  // open
+#include <unistd.h> // dup, dup2, close
+
+#include "../benchmark_harness.hpp"
+
+// The formatting of the logger: numbers with std::to_chars, as toBuffer does, and
+// with snprintf, as it did before. Then the cost of a message at the call site: a
+// synchronous debug, and deferredDebug, which renders later or on the flusher thread.
+
+int32_t constexpr num_values = 1 << 10;
+int32_t constexpr num_messages = 1000;
+
+// Format an integer and a double num_values times, and return the total length
+template <class Format>
+auto
+formatValues(Format const & format) -> uint64_t
+{
+  uint64_t length = 0;
+  for (int32_t i = 0; i < num_values; ++i) {
+    length += format(i * 1021);
+    length += format(static_cast<double>(i) * 0.37);
+  }
+  return length;
+}
+
+BENCHMARK_CASE(numbers)
+{
+  juno::logger::reset();
+  char * const buffer = juno::logger::buffer;
+
+  // snprintf once for the length, then again to write
+  auto const with_snprintf = [buffer](auto const value) -> uint64_t {
+    int length = 0;
+    if constexpr (std::is_integral_v<decltype(value)>) {
+      length = snprintf(nullptr, 0, "%d", value);
+      snprintf(buffer, juno::logger::buffer_size, "%d", value);
+    } else {
+      length = snprintf(nullptr, 0, "%f", value);
+      snprintf(buffer, juno::logger::buffer_size, "%f", value);
+    }
+    return static_cast<uint64_t>(length);
+  };
+  auto const with_to_chars = [buffer](auto const value) -> uint64_t {
+    return static_cast<uint64_t>(juno::logger::impl::toBuffer(buffer, value) - buffer);
+  };
+  harness.run("snprintf", 0, 0,
+              [&]() { juno::benchmark::doNotOptimize(formatValues(with_snprintf)); });
+  harness.run("to_chars", 0, 0,
+              [&]() { juno::benchmark::doNotOptimize(formatValues(with_to_chars)); });
+}
+
+BENCHMARK_CASE(messages)
+{
+  // Discard the log lines. The harness prints through its own copy of stdout.
+  fflush(stdout);
+  int const null = open("/dev/null", O_WRONLY);
+  if (null < 0) {
+    return;
+  }
+  int const saved_stdout = dup(STDOUT_FILENO);
+  dup2(null, STDOUT_FILENO);
+  close(null);
+
+  juno::logger::reset();
+  juno::logger::level = juno::logger::levels::debug;
+  harness.run("debug", 0, 0, [&]() {
+    for (int32_t i = 0; i < num_messages; ++i) {
+      juno::logger::debug("message ", i, " value ", 0.5 * i);
+    }
+  });
+  harness.run("deferredDebug", 0, 0, [&]() {
+    for (int32_t i = 0; i < num_messages; ++i) {
+      juno::logger::deferredDebug("message ", i, " value ", 0.5 * i);
+    }
+  });
+  juno::logger::flush();
+  juno::logger::asynchronous = true;
+  harness.run("deferredDebug (asynchronous)", 0, 0, [&]() {
+    for (int32_t i = 0; i < num_messages; ++i) {
+      juno::logger::deferredDebug("message ", i, " value ", 0.5 * i);
+    }
+  });
+  juno::logger::reset();
+
+  fflush(stdout);
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdout);
+}
+
+BENCHMARK_SUITE(logger)
+{
+  BENCHMARK(numbers);
+  BENCHMARK(messages);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(logger, argc, argv);
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/task_scheduler.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath> // std::sqrt
+#include <cstdint>
+#include <vector>
+
+#include "../benchmark_harness.hpp"
+
+// A host loop over cells whose cost varies by two orders of magnitude, in blocks, like
+// a model that mixes coarse and finely meshed pin cells: static scheduling, dynamic
+// scheduling, and cost-weighted partitions with work stealing.
+
+Int constexpr num_cells = 1 << 16;
+Int constexpr block_size = 1024; // cells of the same kind of pin
+
+// The work of a cell, in iterations
+auto
+cellWork(Int const i) -> Int
+{
+  return (i / block_size) % 8 == 0 ? 200 : 2;
+}
+
+BENCHMARK_CASE(heterogeneous)
+{
+  std::vector<double> costs(num_cells);
+  int64_t total = 0;
+  for (Int i = 0; i < num_cells; ++i) {
+    costs[static_cast<size_t>(i)] = static_cast<double>(cellWork(i));
+    total += cellWork(i);
+  }
+  Kokkos::View<double *, juno::HostMemSpace> const result("result", num_cells);
+  auto const cell = [=](Int const i) {
+    auto x = static_cast<double>(i);
+    for (Int k = 0; k < cellWork(i); ++k) {
+      x = std::sqrt(x + static_cast<double>(k));
+    }
+    result(i) = x;
+  };
+  int64_t const bytes = int64_t{num_cells} * int64_t{sizeof(double)};
+  int64_t const flops = 2 * total;
+
+  harness.run("static", bytes, flops, [&]() {
+    Kokkos::parallel_for("static", juno::rangePolicy<juno::HostExecSpace>(0, num_cells),
+                         cell);
+  });
+  harness.run("dynamic", bytes, flops, [&]() {
+    Kokkos::parallel_for(
+        "dynamic", juno::dynamicRangePolicy<juno::HostExecSpace>(0, num_cells), cell);
+  });
+  harness.run("weighted, work stealing", bytes, flops,
+              [&]() { juno::parallelForWeighted("weighted", costs, cell); });
+}
+
+BENCHMARK_SUITE(task_scheduler)
+{
+  BENCHMARK(heterogeneous);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(task_scheduler, argc, argv);
+  return 0;
+}
@@ -0,0 +1,69 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+#include <juno/math/exponential.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+#include "../benchmark_harness.hpp"
+
+// The attenuation 1 - exp(-tau) of an array of optical lengths, as in the inner loop of
+// a sweep: the library exp, rational approximations, and tables.
+
+Int constexpr num_values = 1 << 22;
+
+int64_t constexpr attenuation_bytes = int64_t{2} * num_values * int64_t{sizeof(Float)};
+int64_t constexpr attenuation_flops = int64_t{2} * num_values; // not counting the exp
+
+BENCHMARK_CASE(attenuation)
+{
+  using MemSpace = juno::DeviceMemSpace;
+  using ExecSpace = typename MemSpace::execution_space;
+  Kokkos::View<Float *, MemSpace> const tau("tau", num_values);
+  Kokkos::View<Float *, MemSpace> const result("result", num_values);
+  Kokkos::parallel_for(
+      "tau", juno::rangePolicy<ExecSpace>(0, num_values), KOKKOS_LAMBDA(Int const i) {
+        // Optical lengths of segments, in [0, 4)
+        tau(i) = static_cast<Float>((i * 7) % 4096) / 1024;
+      });
+
+  auto const run = [&](auto const & exp) {
+    Kokkos::parallel_for(
+        "attenuation", juno::rangePolicy<ExecSpace>(0, num_values),
+        KOKKOS_LAMBDA(Int const i) { result(i) = 1 - exp(-tau(i)); });
+    Kokkos::fence();
+  };
+  struct LibraryExp {
+    HOSTDEV auto
+    operator()(Float const x) const noexcept -> Float
+    {
+      return Kokkos::exp(x);
+    }
+  };
+  harness.run("library exp", attenuation_bytes, attenuation_flops,
+              [&]() { run(LibraryExp{}); });
+  harness.run("rational, order 2", attenuation_bytes, attenuation_flops,
+              [&]() { run(juno::RationalExp<2>{}); });
+  harness.run("rational, order 3", attenuation_bytes, attenuation_flops,
+              [&]() { run(juno::RationalExp<3>{}); });
+  harness.run("rational, order 5", attenuation_bytes, attenuation_flops,
+              [&]() { run(juno::RationalExp<5>{}); });
+  auto const coarse = juno::makeExpTable<MemSpace>(1e-4);
+  auto const fine = juno::makeExpTable<MemSpace>(1e-6);
+  harness.run("table, 1e-4", attenuation_bytes, attenuation_flops,
+              [&]() { run(coarse); });
+  harness.run("table, 1e-6", attenuation_bytes, attenuation_flops, [&]() { run(fine); });
+}
+
+BENCHMARK_SUITE(exponential)
+{
+  BENCHMARK(attenuation);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(exponential, argc, argv);
+  return 0;
+}
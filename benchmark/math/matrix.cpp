@@ -0,0 +1,125 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+#include <juno/math/matrix.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include "../benchmark_harness.hpp"
+
+// Batched LU solves of many small systems, against a loop over individual solves.
+// Each call restores the matrices from a copy first, since they are factored in place,
+// and the copy is included in the bytes moved.
+
+Int constexpr num_entries = 1 << 22; // matrix entries per batch
+
+// Copy the matrices, then read and write them and the right-hand sides
+template <Int N>
+int64_t constexpr solve_bytes =
+    int64_t{num_entries / (N * N)} * int64_t{sizeof(Float)} * (4 * N * N + 2 * N);
+
+template <Int N>
+int64_t constexpr solve_flops =
+    int64_t{num_entries / (N * N)} * (2 * N * N * N / 3 + 2 * N * N);
+
+template <Int N, class MemSpace>
+auto
+makeSystems(Int const size, Int const layout) -> juno::MatrixBatch<N, MemSpace>
+{
+  auto const h_a = juno::makeBatch<Float, N, N, juno::HostMemSpace>("a", size, layout);
+  uint32_t state = 1;
+  for (Int b = 0; b < size; ++b) {
+    for (Int i = 0; i < N; ++i) {
+      for (Int j = 0; j < N; ++j) {
+        state = state * 1664525U + 1013904223U;
+        h_a(b, i, j) = static_cast<Float>(state >> 8) / static_cast<Float>(1U << 24);
+      }
+      h_a(b, i, i) += static_cast<Float>(N);
+    }
+  }
+  auto a = juno::makeBatch<Float, N, N, MemSpace>("a", size, layout);
+  Kokkos::deep_copy(a.values, h_a.values);
+  return a;
+}
+
+template <Int N, class MemSpace>
+void
+benchmarkSolves(juno::benchmark::Harness & harness, Int const layout,
+                std::string const & name)
+{
+  Int constexpr size = num_entries / (N * N);
+  auto const a0 = makeSystems<N, MemSpace>(size, layout);
+  auto const a = makeSystems<N, MemSpace>(size, layout);
+  auto const x = juno::makeBatch<Float, N, 1, MemSpace>("x", size, layout);
+  auto const pivots = juno::makeBatch<Int, N, 1, MemSpace>("pivots", size, layout);
+  std::string const label = name + " " + std::to_string(N) + "x" + std::to_string(N);
+  harness.run(label.c_str(), solve_bytes<N>, solve_flops<N>, [&]() {
+    Kokkos::deep_copy(a.values, a0.values);
+    Int const num_singular = juno::luFactor(a, pivots);
+    juno::luSolve(a, pivots, x);
+    juno::benchmark::doNotOptimize(num_singular);
+  });
+}
+
+template <Int N>
+void
+benchmarkIndividualSolves(juno::benchmark::Harness & harness)
+{
+  // The way a per-system library call would be used: one matrix at a time, each
+  // contiguous in memory
+  Int constexpr size = num_entries / (N * N);
+  auto const a0 =
+      makeSystems<N, juno::HostMemSpace>(size, juno::batch_layouts::contiguous);
+  auto const a =
+      makeSystems<N, juno::HostMemSpace>(size, juno::batch_layouts::contiguous);
+  auto const x =
+      juno::makeBatch<Float, N, 1>("x", size, juno::batch_layouts::contiguous);
+  auto const pivots =
+      juno::makeBatch<Int, N, 1>("pivots", size, juno::batch_layouts::contiguous);
+  std::string const label =
+      "individual solves " + std::to_string(N) + "x" + std::to_string(N);
+  harness.run(label.c_str(), solve_bytes<N>, solve_flops<N>, [&]() {
+    Kokkos::deep_copy(a.values, a0.values);
+    Int num_singular = 0;
+    for (Int b = 0; b < size; ++b) {
+      num_singular += juno::luFactor(a, pivots, b) ? 0 : 1;
+      juno::luSolve(a, pivots, x, b);
+    }
+    juno::benchmark::doNotOptimize(num_singular);
+  });
+}
+
+template <Int N>
+void
+benchmarkSize(juno::benchmark::Harness & harness)
+{
+  benchmarkIndividualSolves<N>(harness);
+  benchmarkSolves<N, juno::HostMemSpace>(harness, juno::batch_layouts::contiguous,
+                                         "batched contiguous (host)");
+  benchmarkSolves<N, juno::HostMemSpace>(harness, juno::batch_layouts::interleaved,
+                                         "batched interleaved (host)");
+  benchmarkSolves<N, juno::DeviceMemSpace>(harness, juno::batch_layouts::interleaved,
+                                           "batched interleaved (device)");
+}
+
+BENCHMARK_CASE(luSolve)
+{
+  benchmarkSize<2>(harness);
+  benchmarkSize<4>(harness);
+  benchmarkSize<8>(harness);
+  benchmarkSize<16>(harness);
+}
+
+BENCHMARK_SUITE(matrix)
+{
+  BENCHMARK(luSolve);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(matrix, argc, argv);
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+#include <juno/math/krylov.hpp>
+#include <juno/math/sparse_matrix.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include "../benchmark_harness.hpp"
+
+// Sparse products and solves with the 5-point Laplacian on a square grid, the pattern
+// of a CMFD operator on a quad mesh.
+
+Int constexpr grid_size = 1024; // cells per side
+Int constexpr num_cells = grid_size * grid_size;
+
+// Read the matrix entries, their columns, and x for each entry, and write y
+int64_t constexpr spmv_entries = int64_t{5} * num_cells;
+int64_t constexpr spmv_bytes =
+    spmv_entries * int64_t{2 * sizeof(Float) + sizeof(Int)} + int64_t{num_cells} * 4;
+int64_t constexpr spmv_flops = 2 * spmv_entries;
+
+template <class MemSpace>
+auto
+makeLaplacian() -> juno::CSRMatrix<MemSpace>
+{
+  juno::CSRMatrix<juno::HostMemSpace> a;
+  a.num_rows = num_cells;
+  a.num_cols = num_cells;
+  a.row_offsets = Kokkos::View<Int *, juno::HostMemSpace>("row_offsets", num_cells + 1);
+  a.columns = Kokkos::View<Int *, juno::HostMemSpace>("columns", 5 * num_cells);
+  a.values = Kokkos::View<Float *, juno::HostMemSpace>("values", 5 * num_cells);
+  Int k = 0;
+  for (Int row = 0; row < num_cells; ++row) {
+    for (Int const col : {row - grid_size, row - 1, row, row + 1, row + grid_size}) {
+      if (0 <= col && col < num_cells) {
+        a.columns(k) = col;
+        a.values(k) = col == row ? 4 : -1;
+        ++k;
+      }
+    }
+    a.row_offsets(row + 1) = k;
+  }
+  return a.mirror<MemSpace>();
+}
+
+template <class MemSpace>
+void
+benchmarkSpmv(juno::benchmark::Harness & harness, std::string const & space)
+{
+  auto const csr = makeLaplacian<MemSpace>();
+  auto const ell = juno::makeSlicedELLMatrix(csr);
+  Kokkos::View<Float *, MemSpace> const x("x", num_cells);
+  Kokkos::View<Float *, MemSpace> const y("y", num_cells);
+  Kokkos::deep_copy(x, 1);
+  harness.run(("CSR (" + space + ")").c_str(), spmv_bytes, spmv_flops, [&]() {
+    juno::spmv(csr, x, y);
+  });
+  harness.run(("sliced ELL (" + space + ")").c_str(), spmv_bytes, spmv_flops, [&]() {
+    juno::spmv(ell, x, y);
+  });
+}
+
+BENCHMARK_CASE(spmv)
+{
+  benchmarkSpmv<juno::HostMemSpace>(harness, "host");
+  benchmarkSpmv<juno::DeviceMemSpace>(harness, "device");
+}
+
+BENCHMARK_CASE(solve)
+{
+  // A fixed number of iterations, so that the preconditioners and the solvers are
+  // compared per iteration
+  Int constexpr iterations = 20;
+  auto const a = makeLaplacian<juno::DeviceMemSpace>();
+  auto const ilu = juno::makeILU0Preconditioner(a);
+  auto const jacobi = juno::makeJacobiPreconditioner(a);
+  Kokkos::View<Float *, juno::DeviceMemSpace> const b("b", num_cells);
+  Kokkos::View<Float *, juno::DeviceMemSpace> const x("x", num_cells);
+  Kokkos::deep_copy(b, 1);
+  juno::KrylovOptions options;
+  options.tolerance = 0;
+  options.max_iterations = iterations;
+  options.check_interval = iterations;
+  auto const run = [&](char const * name, auto const & m, bool const use_gmres) {
+    harness.run(name, iterations * spmv_bytes, iterations * spmv_flops, [&]() {
+      Kokkos::deep_copy(x, 0);
+      auto const result = use_gmres ? juno::gmres(a, m, b, x, options)
+                                    : juno::bicgstab(a, m, b, x, options);
+      juno::benchmark::doNotOptimize(result.residual);
+    });
+  };
+  run("GMRES + Jacobi (device)", jacobi, true);
+  run("GMRES + ILU(0) (device)", ilu, true);
+  run("BiCGStab + Jacobi (device)", jacobi, false);
+  run("BiCGStab + ILU(0) (device)", ilu, false);
+}
+
+BENCHMARK_SUITE(sparse_matrix)
+{
+  BENCHMARK(spmv);
+  BENCHMARK(solve);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(sparse_matrix, argc, argv);
+  return 0;
+}
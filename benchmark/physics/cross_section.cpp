@@ -0,0 +1,120 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+#include <juno/physics/material.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "../benchmark_harness.hpp"
+
+// The inner loop of a sweep: the scattering source and the total cross section of each
+// cell, from the cross sections of its material. Compares the aligned rows of
+// CrossSections with an unpadded matrix by destination group.
+
+Int constexpr group_count = 51;
+Int constexpr material_count = 64;
+Int constexpr cell_count = 1 << 16;
+
+int64_t constexpr source_flops = int64_t{2} * cell_count * group_count * group_count;
+int64_t constexpr source_bytes =
+    int64_t{sizeof(Float)} * cell_count * group_count * (group_count + 3);
+
+auto
+makeNuclides() -> juno::CrossSections<juno::HostMemSpace>
+{
+  juno::CrossSections<juno::HostMemSpace> xs("nuclides", 1, group_count);
+  for (Int g = 0; g < group_count; ++g) {
+    xs(0, juno::reactions::total, g) = 1;
+    for (Int from = 0; from < group_count; ++from) {
+      xs.scatter(0, from, g) = from <= g ? static_cast<Float>(0.01) : 0;
+    }
+  }
+  return xs;
+}
+
+BENCHMARK_CASE(scattering_source)
+{
+  using MemSpace = juno::DeviceMemSpace;
+  using ExecSpace = typename MemSpace::execution_space;
+  std::vector<juno::Material> materials;
+  for (Int m = 0; m < material_count; ++m) {
+    materials.push_back({"m", {0}, {static_cast<Float>(m + 1)}});
+  }
+  juno::MaterialCrossSections const materials_xs(makeNuclides(), materials);
+  auto const xs = materials_xs.device();
+  Int const stride = xs.groupStride();
+
+  Kokkos::View<Int *, MemSpace> const cell_materials("cell_materials", cell_count);
+  Kokkos::View<Float *, MemSpace> const flux("flux", cell_count * stride);
+  Kokkos::View<Float *, MemSpace> const source("source", cell_count * stride);
+  Kokkos::parallel_for(
+      "cell_materials", juno::rangePolicy<ExecSpace>(0, cell_count),
+      KOKKOS_LAMBDA(Int const c) { cell_materials(c) = (c * 7) % material_count; });
+  Kokkos::deep_copy(flux, 1);
+
+  // The unpadded scattering matrix of each material by destination group, where the
+  // source of each group is a dot product
+  Int constexpr matrix_size = group_count * group_count;
+  Kokkos::View<Float *, MemSpace> const by_destination("by_destination",
+                                                       material_count * matrix_size);
+  Kokkos::parallel_for(
+      "by_destination", juno::rangePolicy<ExecSpace>(0, material_count * matrix_size),
+      KOKKOS_LAMBDA(Int const i) {
+        Int const m = i / matrix_size;
+        Int const to = (i / group_count) % group_count;
+        Int const from = i % group_count;
+        by_destination(i) = xs.scatter(m, from, to);
+      });
+
+  harness.run("group-contiguous", source_bytes, source_flops, [&]() {
+    Kokkos::parallel_for(
+        "group-contiguous", juno::rangePolicy<ExecSpace>(0, cell_count),
+        KOKKOS_LAMBDA(Int const c) {
+          Int const m = cell_materials(c);
+          Float const * RESTRICT const phi = flux.data() + c * stride;
+          Float * RESTRICT const q = source.data() + c * stride;
+          for (Int g = 0; g < stride; ++g) {
+            q[g] = 0;
+          }
+          for (Int from = 0; from < group_count; ++from) {
+            Float const * RESTRICT const row = xs.scatterRow(m, from);
+            for (Int g = 0; g < stride; ++g) {
+              q[g] += row[g] * phi[from];
+            }
+          }
+          Float const * RESTRICT const total = xs.row(m, juno::reactions::total);
+          for (Int g = 0; g < group_count; ++g) {
+            q[g] /= total[g];
+          }
+        });
+  });
+  harness.run("by destination group", source_bytes, source_flops, [&]() {
+    Kokkos::parallel_for(
+        "by destination group", juno::rangePolicy<ExecSpace>(0, cell_count),
+        KOKKOS_LAMBDA(Int const c) {
+          Int const m = cell_materials(c);
+          Float const * const matrix = by_destination.data() + m * matrix_size;
+          for (Int g = 0; g < group_count; ++g) {
+            Float sum = 0;
+            for (Int from = 0; from < group_count; ++from) {
+              sum += matrix[g * group_count + from] * flux(c * stride + from);
+            }
+            source(c * stride + g) = sum / xs(m, juno::reactions::total, g);
+          }
+        });
+  });
+}
+
+BENCHMARK_SUITE(cross_section)
+{
+  BENCHMARK(scattering_source);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(cross_section, argc, argv);
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <juno/config.hpp>
+#include <juno/physics/moc.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+#include "../benchmark_harness.hpp"
+
+// One transport sweep over a mesh of quads, with the segments cached or traced again in
+// each sweep.
+
+Int constexpr mesh_size = 64; // quads on each side of the unit square
+Int constexpr group_count = 8;
+
+using Sweeper = juno::MOCSweeper<juno::DeviceMemSpace>;
+
+auto
+makeQuadMesh() -> juno::FaceVertexMesh<juno::HostMemSpace>
+{
+  Int constexpr m = mesh_size;
+  juno::PolytopeSoup<juno::HostMemSpace> soup((m + 1) * (m + 1), m * m, 4 * m * m);
+  for (Int j = 0; j <= m; ++j) {
+    for (Int i = 0; i <= m; ++i) {
+      Int const v = j * (m + 1) + i;
+      soup.x()(v) = static_cast<Float>(i) / static_cast<Float>(m);
+      soup.y()(v) = static_cast<Float>(j) / static_cast<Float>(m);
+      soup.z()(v) = 0;
+    }
+  }
+  soup.elementOffsets()(0) = 0;
+  for (Int j = 0; j < m; ++j) {
+    for (Int i = 0; i < m; ++i) {
+      Int const f = j * m + i;
+      Int const v = j * (m + 1) + i;
+      soup.elementTypes()(f) = juno::vtk_types::quad;
+      soup.elementOffsets()(f + 1) = 4 * (f + 1);
+      soup.elementVertices()(4 * f + 0) = v;
+      soup.elementVertices()(4 * f + 1) = v + 1;
+      soup.elementVertices()(4 * f + 2) = v + m + 2;
+      soup.elementVertices()(4 * f + 3) = v + m + 1;
+    }
+  }
+  return juno::makeFaceVertexMesh(soup);
+}
+
+BENCHMARK_CASE(sweep)
+{
+  using MemSpace = juno::DeviceMemSpace;
+  auto const grid = juno::buildFaceGrid(makeQuadMesh().mirror<MemSpace>());
+  juno::TrackParameters parameters;
+  parameters.num_azimuthal = 32;
+  parameters.spacing = static_cast<Float>(0.005);
+  parameters.num_polar = 3;
+  auto const layout = juno::makeTrackLayout(grid.box, parameters);
+
+  juno::CrossSections<juno::HostMemSpace> host_xs("xs", 1, group_count);
+  for (Int g = 0; g < group_count; ++g) {
+    host_xs(0, juno::reactions::total, g) =
+        static_cast<Float>(0.5 + static_cast<double>(g));
+  }
+  auto const xs = host_xs.mirror<MemSpace>();
+  Int const stride = xs.groupStride();
+  Int constexpr face_count = mesh_size * mesh_size;
+  Kokkos::View<Int *, MemSpace> const materials("materials", face_count);
+  Kokkos::View<Float *, MemSpace> const source("source", face_count * stride);
+  Kokkos::View<Float *, MemSpace> const flux("flux", face_count * stride);
+  Kokkos::deep_copy(source, 1);
+
+  Sweeper cached(grid, layout);
+  juno::SweepOptions options;
+  options.memory_budget = 0;
+  Sweeper traced(grid, layout, options);
+
+  // Per segment, direction, polar angle, and group: the attenuation, the update of the
+  // flux, and the tally. The bytes are those of the segments and the boundary fluxes.
+  int64_t const work = 2 * cached.numSegments() * layout.polar.num_angles * group_count;
+  int64_t const flops = 6 * work;
+  int64_t const boundary_bytes = int64_t{4} * layout.numTracks() *
+                                 layout.polar.num_angles * stride *
+                                 static_cast<int64_t>(sizeof(Float));
+  int64_t const bytes = 2 * cached.segmentBytes() + boundary_bytes;
+  harness.run("cached segments", bytes, flops,
+              [&]() { cached.sweep(xs, materials, source, flux); });
+  harness.run("segments traced in each sweep", bytes, flops,
+              [&]() { traced.sweep(xs, materials, source, flux); });
+}
+
+BENCHMARK_SUITE(moc)
+{
+  BENCHMARK(sweep);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  RUN_BENCHMARK_SUITE(moc, argc, argv);
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include <juno/common/communicator.hpp>
+#include <juno/config.hpp>
+#include <juno/mesh/partition.hpp>
+#include <juno/physics/boundary_exchange.hpp>
+#include <juno/physics/moc.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+#include "../benchmark_harness.hpp"
+
+// Strong scaling of the decomposed transport sweep: the same mesh of quads, split into
+// one block per rank, each swept with the exchange of its boundary fluxes. Run it on
+// 1, 2, 4, ... ranks (the run_benchmark_moc_scaling_mpi target) and compare the times:
+// the bytes and flops are those of one rank.
+
+Int constexpr mesh_size = 64; // quads on each side of the unit square
+Int constexpr group_count = 8;
+
+using MemSpace = juno::DeviceMemSpace;
+
+auto
+makeQuadMesh() -> juno::FaceVertexMesh<juno::HostMemSpace>
+{
+  Int constexpr m = mesh_size;
+  juno::PolytopeSoup<juno::HostMemSpace> soup((m + 1) * (m + 1), m * m, 4 * m * m);
+  for (Int j = 0; j <= m; ++j) {
+    for (Int i = 0; i <= m; ++i) {
+      Int const v = j * (m + 1) + i;
+      soup.x()(v) = static_cast<Float>(i) / static_cast<Float>(m);
+      soup.y()(v) = static_cast<Float>(j) / static_cast<Float>(m);
+      soup.z()(v) = 0;
+    }
+  }
+  soup.elementOffsets()(0) = 0;
+  for (Int j = 0; j < m; ++j) {
+    for (Int i = 0; i < m; ++i) {
+      Int const f = j * m + i;
+      Int const v = j * (m + 1) + i;
+      soup.elementTypes()(f) = juno::vtk_types::quad;
+      soup.elementOffsets()(f + 1) = 4 * (f + 1);
+      soup.elementVertices()(4 * f + 0) = v;
+      soup.elementVertices()(4 * f + 1) = v + 1;
+      soup.elementVertices()(4 * f + 2) = v + m + 2;
+      soup.elementVertices()(4 * f + 3) = v + m + 1;
+    }
+  }
+  return juno::makeFaceVertexMesh(soup);
+}
+
+BENCHMARK_CASE(decomposed_sweep)
+{
+  juno::Communicator const comm;
+  auto const mesh = makeQuadMesh();
+  juno::AABB2 box;
+  box.min = {0, 0};
+  box.max = {1, 1};
+  auto const blocks = juno::makeBlockDecomposition(box, comm.size());
+  auto const face_blocks = juno::partitionFaces(mesh, blocks);
+  if (face_blocks.empty()) {
+    return;
+  }
+  auto const submesh = juno::extractSubmesh(mesh, face_blocks, comm.rank());
+  juno::TrackParameters parameters;
+  parameters.num_azimuthal = 32;
+  parameters.spacing = static_cast<Float>(0.005);
+  parameters.num_polar = 3;
+  auto const layout = juno::makeBlockTrackLayout(blocks, comm.rank(), parameters);
+  juno::BoundaryExchange<MemSpace> exchange(layout, blocks, comm.rank(), comm);
+  juno::MOCSweeper<MemSpace> sweeper(
+      juno::buildFaceGrid(submesh.mesh.mirror<MemSpace>()), layout);
+
+  juno::CrossSections<juno::HostMemSpace> host_xs("xs", 1, group_count);
+  for (Int g = 0; g < group_count; ++g) {
+    host_xs(0, juno::reactions::total, g) =
+        static_cast<Float>(0.5 + static_cast<double>(g));
+  }
+  auto const xs = host_xs.mirror<MemSpace>();
+  Int const stride = xs.groupStride();
+  Int const face_count = submesh.mesh.numFaces();
+  Kokkos::View<Int *, MemSpace> const materials("materials", face_count);
+  Kokkos::View<Float *, MemSpace> const source("source", face_count * stride);
+  Kokkos::View<Float *, MemSpace> const flux("flux", face_count * stride);
+  Kokkos::deep_copy(source, 1);
+
+  // As in the sweep benchmark, per rank
+  int64_t const work = 2 * sweeper.numSegments() * layout.polar.num_angles * group_count;
+  int64_t const flops = 6 * work;
+  int64_t const boundary_bytes = int64_t{4} * layout.numTracks() *
+                                 layout.polar.num_angles * stride *
+                                 static_cast<int64_t>(sizeof(Float));
+  int64_t const bytes = 2 * sweeper.segmentBytes() + boundary_bytes;
+  harness.run("sweep", bytes, flops,
+              [&]() { sweeper.sweep(xs, materials, source, flux, exchange); });
+
+  // The exchange alone, without a sweep to overlap
+  Int const angular_size = layout.polar.num_angles * stride;
+  Kokkos::View<Float *, MemSpace> const psi("psi", 2 * layout.numTracks() * angular_size);
+  int64_t const message_bytes = int64_t{2} * exchange.numSent() * angular_size *
+                                static_cast<int64_t>(sizeof(Float));
+  exchange.finish(psi);
+  harness.run("exchange", message_bytes, 0, [&]() {
+    exchange.begin(psi, angular_size);
+    exchange.finish(psi);
+  });
+}
+
+BENCHMARK_SUITE(moc_scaling)
+{
+  BENCHMARK(decomposed_sweep);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  juno::MPIGuard const mpi(argc, argv);
+  RUN_BENCHMARK_SUITE(moc_scaling, argc, argv);
+  return 0;
+}
@@ -0,0 +1,79 @@
+set(BENCHMARK_HARNESS_HEADER "${PROJECT_SOURCE_DIR}/benchmark/benchmark_harness.hpp")
+
+# Directory for the JSON results written by the "run-benchmarks" target
+set(JUNO_BENCHMARK_RESULTS_DIR "${PROJECT_BINARY_DIR}/benchmark_results")
+
+# Run the benchmarks one at a time, since timings taken while another benchmark runs
+# are meaningless. USES_TERMINAL serializes them under Ninja only, so each run target
+# also depends on the one added before it.
+macro(juno_serialize_benchmark_run TARGET)
+  get_property(JUNO_LAST_BENCHMARK_RUN GLOBAL PROPERTY JUNO_LAST_BENCHMARK_RUN)
+  if (JUNO_LAST_BENCHMARK_RUN)
+    add_dependencies(${TARGET} ${JUNO_LAST_BENCHMARK_RUN})
+  endif()
+  set_property(GLOBAL PROPERTY JUNO_LAST_BENCHMARK_RUN ${TARGET})
+endmacro()
+
+macro(juno_add_benchmark FILENAME)
+
+  # Strip the path and extension from the filename to get the benchmark name
+  set(BENCHNAME ${FILENAME})
+  get_filename_component(BENCHNAME ${BENCHNAME} NAME_WE)
+  get_filename_component(BENCHNAME ${BENCHNAME} NAME_WLE)
+
+  # Prepend "benchmark_" to the benchmark name
+  set(BENCHNAME "benchmark_${BENCHNAME}")
+
+  # Always include the benchmark harness header with the benchmark
+  add_executable(${BENCHNAME} ${FILENAME} ${BENCHMARK_HARNESS_HEADER})
+  target_link_libraries(${BENCHNAME} PRIVATE juno)
+  set_target_properties(${BENCHNAME} PROPERTIES CXX_STANDARD ${CMAKE_CXX_STANDARD})
+
+  # Run the benchmark as part of "run-benchmarks", writing its results as JSON.
+  # Benchmarks are not tests, since their timings are not pass/fail.
+  add_custom_target(run_${BENCHNAME}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${JUNO_BENCHMARK_RESULTS_DIR}
+    COMMAND ${BENCHNAME} --json ${JUNO_BENCHMARK_RESULTS_DIR}/${BENCHNAME}.json
+    DEPENDS ${BENCHNAME}
+    COMMENT "Running ${BENCHNAME}"
+    USES_TERMINAL
+    VERBATIM)
+  add_dependencies(run-benchmarks run_${BENCHNAME})
+  juno_serialize_benchmark_run(run_${BENCHNAME})
+
+  if (JUNO_USE_CLANG_TIDY)
+    set_clang_tidy_properties(${BENCHNAME})
+  endif()
+
+  if (JUNO_USE_HIP)
+    set_hip_properties(${BENCHNAME} ${FILENAME})
+  endif()
+
+endmacro()
+
+# A benchmark that also runs on each of the given numbers of MPI ranks, for strong
+# scaling, when MPI is enabled
+macro(juno_add_mpi_benchmark FILENAME)
+
+  juno_add_benchmark(${FILENAME})
+
+  if (JUNO_USE_MPI)
+    set(JUNO_MPI_BENCHMARK_COMMANDS)
+    foreach(NUM_RANKS ${ARGN})
+      list(APPEND JUNO_MPI_BENCHMARK_COMMANDS
+        COMMAND ${MPIEXEC_EXECUTABLE} ${MPIEXEC_NUMPROC_FLAG} ${NUM_RANKS}
+                ${MPIEXEC_PREFLAGS} $<TARGET_FILE:${BENCHNAME}> ${MPIEXEC_POSTFLAGS}
+                --json ${JUNO_BENCHMARK_RESULTS_DIR}/${BENCHNAME}_${NUM_RANKS}.json)
+    endforeach()
+    add_custom_target(run_${BENCHNAME}_mpi
+      COMMAND ${CMAKE_COMMAND} -E make_directory ${JUNO_BENCHMARK_RESULTS_DIR}
+      ${JUNO_MPI_BENCHMARK_COMMANDS}
+      DEPENDS ${BENCHNAME}
+      COMMENT "Running ${BENCHNAME} on ${ARGN} ranks"
+      USES_TERMINAL
+      VERBATIM)
+    add_dependencies(run-benchmarks run_${BENCHNAME}_mpi)
+    juno_serialize_benchmark_run(run_${BENCHNAME}_mpi)
+  endif()
+
+endmacro()
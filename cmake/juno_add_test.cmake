@@ -26,3 +26,16 @@ macro(juno_add_test FILENAME)
   endif()
 
 endmacro()
+
+# A test that also runs on NUM_RANKS MPI ranks, when MPI is enabled
+macro(juno_add_mpi_test FILENAME NUM_RANKS)
+
+  juno_add_test(${FILENAME})
+
+  if (JUNO_USE_MPI)
+    add_test(NAME ${TESTNAME}_mpi
+             COMMAND ${MPIEXEC_EXECUTABLE} ${MPIEXEC_NUMPROC_FLAG} ${NUM_RANKS}
+                     ${MPIEXEC_PREFLAGS} $<TARGET_FILE:${TESTNAME}> ${MPIEXEC_POSTFLAGS})
+  endif()
+
+endmacro()
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstddef>     // std::byte, size_t
+#include <cstdint>     // uintptr_t, uint64_t
+#include <string>      // std::string
+#include <type_traits> // std::is_trivially_destructible_v
+#include <utility>     // std::move, std::exchange
+#include <vector>      // std::vector
+
+//========================================================================================
+// ARENA
+//========================================================================================
+// An Arena is one allocation in MemSpace, from which unmanaged Views are carved. Each
+// Kokkos::View construction is its own allocation, and device allocations and frees
+// are slow and synchronize the device. An iterative method that needs temporaries each
+// outer iteration can instead take them from an arena, and reset the arena at the end
+// of the iteration, so that the loop makes no allocations after the first iteration:
+//  - allocate<T>(n) returns an uninitialized, unmanaged View of n T's, aligned to
+//    Arena::alignment bytes. It is only a bump of an offset, and does not touch the
+//    device.
+//  - reset() makes the whole arena free again. Every View carved from it must be dead
+//    by then, or at least never used again; the arena does not track them.
+//  - If an allocation does not fit, it is made separately and kept until the reset,
+//    and the reset grows the arena to the high-water mark, so that the next iteration
+//    fits. An arena may start empty and size itself in the first iteration.
+//  - The high-water mark, the most memory in use between two resets, is reported by
+//    logUsage(), to size the arena up front, or to find the step that needs the most.
+//
+// An arena is not thread safe, and is used from the host, like Kokkos::View
+// construction. Copies are not allowed, since two arenas would carve the same memory.
+//
+// Usage:
+//   juno::Arena<MemSpace> arena("cmfd", bytes);
+//   for (Int iteration = 0; iteration < num_iterations; ++iteration) {
+//     auto const r = arena.allocate<Float>(n);
+//     ...
+//     arena.reset();
+//   }
+//   arena.logUsage();
+
+namespace juno
+{
+
+template <class MemSpace = DeviceMemSpace>
+class Arena
+{
+public:
+  template <class T>
+  using View = Kokkos::View<T *, MemSpace, Kokkos::MemoryUnmanaged>;
+
+  // The alignment of each allocation: that of device allocations, so that carved Views
+  // coalesce as well as their own allocations would
+  static constexpr size_t alignment = 256;
+
+private:
+  using ByteView = Kokkos::View<std::byte *, MemSpace>;
+
+  std::string _label;
+  ByteView _buffer;
+  std::byte * _base = nullptr; // the first aligned byte of _buffer
+  size_t _capacity = 0;
+  size_t _used = 0;       // including the overflow allocations
+  size_t _high_water = 0; // of _used, since construction
+  std::vector<ByteView> _overflow;
+  Int _num_overflows = 0; // since construction
+
+  // An allocation of at least size bytes from the alignment
+  auto
+  allocateBytes(char const * label, size_t const size) -> ByteView
+  {
+    return ByteView(Kokkos::view_alloc(Kokkos::WithoutInitializing, _label + label),
+                    size + alignment - 1);
+  }
+
+  static auto
+  alignUp(std::byte * const p) noexcept -> std::byte *
+  {
+    auto const address = reinterpret_cast<uintptr_t>(p);
+    return p + (alignment - address % alignment) % alignment;
+  }
+
+public:
+  Arena() = default;
+
+  explicit Arena(std::string label, size_t const capacity = 0)
+      : _label(std::move(label))
+  {
+    grow(capacity);
+  }
+
+  Arena(Arena const &) = delete;
+  auto
+  operator=(Arena const &) -> Arena & = delete;
+  ~Arena() = default;
+
+  // The moved-from arena is empty
+  Arena(Arena && other) noexcept
+  {
+    *this = std::move(other);
+  }
+
+  auto
+  operator=(Arena && other) noexcept -> Arena &
+  {
+    if (this != &other) {
+      _label = std::move(other._label);
+      _buffer = std::exchange(other._buffer, ByteView());
+      _base = std::exchange(other._base, nullptr);
+      _capacity = std::exchange(other._capacity, 0);
+      _used = std::exchange(other._used, 0);
+      _high_water = std::exchange(other._high_water, 0);
+      _overflow = std::exchange(other._overflow, {});
+      _num_overflows = std::exchange(other._num_overflows, 0);
+    }
+    return *this;
+  }
+
+  // The bytes that allocate<T>(n) takes from the arena
+  template <class T>
+  static constexpr auto
+  bytes(size_t const n) noexcept -> size_t
+  {
+    return (n * sizeof(T) + alignment - 1) / alignment * alignment;
+  }
+
+  [[nodiscard]] auto
+  label() const noexcept -> std::string const &
+  {
+    return _label;
+  }
+
+  [[nodiscard]] auto
+  capacity() const noexcept -> size_t
+  {
+    return _capacity;
+  }
+
+  [[nodiscard]] auto
+  used() const noexcept -> size_t
+  {
+    return _used;
+  }
+
+  [[nodiscard]] auto
+  highWater() const noexcept -> size_t
+  {
+    return _high_water;
+  }
+
+  // The number of allocations that did not fit
+  [[nodiscard]] auto
+  numOverflows() const noexcept -> Int
+  {
+    return _num_overflows;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // n uninitialized T's, valid until the next reset
+  template <class T>
+  auto
+  allocate(size_t const n) -> View<T>
+  {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Arena: nothing is destroyed, so T must be trivially destructible");
+    static_assert(alignof(T) <= alignment);
+    size_t const size = bytes<T>(n);
+    std::byte * p = nullptr;
+    if (_used + size <= _capacity) {
+      p = _base + _used;
+    } else if (size != 0) {
+      _overflow.push_back(allocateBytes("::overflow", size));
+      p = alignUp(_overflow.back().data());
+      ++_num_overflows;
+    }
+    _used += size;
+    _high_water = _used > _high_water ? _used : _high_water;
+    return View<T>(reinterpret_cast<T *>(p), n);
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Free everything that was allocated, and grow to the high-water mark if the
+  // allocations did not fit
+  void
+  reset()
+  {
+    _overflow.clear();
+    if (_high_water > _capacity) {
+      LOG_DEBUG("Arena ", _label.c_str(), ": growing from ",
+                static_cast<uint64_t>(_capacity), " to ",
+                static_cast<uint64_t>(_high_water), " bytes");
+      grow(_high_water);
+    }
+    _used = 0;
+  }
+
+  // Reallocate the arena with at least capacity bytes. This frees the memory of every
+  // View carved from it, so it too must follow a reset, or precede any allocation.
+  void
+  grow(size_t const capacity)
+  {
+    if (capacity <= _capacity) {
+      return;
+    }
+    _buffer = ByteView(); // free the old buffer first, to not need both at once
+    _buffer = allocateBytes("", capacity);
+    _base = alignUp(_buffer.data());
+    _capacity = capacity;
+  }
+
+  // Log the high-water mark, the capacity, and the allocations that did not fit
+  void
+  logUsage() const
+  {
+    LOG_INFO("Arena ", _label.c_str(), ": high water ",
+             static_cast<uint64_t>(_high_water), " of ", static_cast<uint64_t>(_capacity),
+             " bytes, ", _num_overflows, " overflows");
+  }
+};
+
+} // namespace juno
@@ -5,6 +5,13 @@
 #include <cstdio>  // printf
 #include <cstdlib> // abort
 
+#if JUNO_ENABLE_DEFERRED_ASSERTS
+#  include <Kokkos_Core.hpp>
+
+#  include <cstdint> // int64_t
+#  include <omp.h>   // omp_get_thread_num
+#endif
+
 //========================================================================================
 // Assertions
 //========================================================================================
@@ -22,6 +29,15 @@
 //    - Use ASSERT_ASSUME(expr) to assert that the expression is true when assertions
 //      are enabled, and to assume that the expression is true when assertions are
 //      disabled.
+//  - We want to be able to keep the checks enabled in production, on the GPU.
+//    - An abort() in a kernel kills the device context, and says nothing about how
+//      many threads failed.
+//    - With JUNO_ENABLE_DEFERRED_ASSERTS, a failed assertion instead records the first
+//      failed_asserts::capacity failures (file, line, condition, thread index), counts
+//      the rest, and returns. checkAsserts() reports them after the kernel.
+//    - The records are a global in host memory, and one in device memory, so a check
+//      that passes costs a compare and a branch, as before: nothing is allocated,
+//      launched or synchronized until something fails.
 //
 // Usage:
 //  ASSERT(expr) - Asserts that expr is true.
@@ -35,10 +51,22 @@
 //    If JUNO_ENABLE_ASSERTS is 1, this is equivalent to ASSERT(expr).
 //    If JUNO_ENABLE_ASSERTS is 0, this is equivalent to ASSUME(expr).
 //
+//  checkAsserts(label) - With JUNO_ENABLE_DEFERRED_ASSERTS, fences, then logs a warning
+//    for each recorded failure, and an error, handled by the error policy, if any
+//    assertion failed since the last check. Returns the number of failures, and
+//    resets the records. Call it after the kernels whose contracts should be checked,
+//    e.g. once per iteration of a solver. Without deferred assertions, it returns 0.
+//
 //  NOTE:
 //    1. ASSUME(expr) must be able to be evaluated at compile time. If the
 //        assumption does not hold, the program will be ill-formed.
 //    2. printf is used so that ASSERT and ASSERT_NEAR can be used in device code.
+//    3. A deferred assertion does not stop the thread that failed it, so the code
+//       after it runs with the condition false. The first failure is the one to fix.
+//    4. In a GPU build, the device records are one variable shared by every
+//       translation unit, which needs relocatable device code (-fgpu-rdc).
+//       The thread index is the global index in x, which is the index of a
+//       RangePolicy; in host code it is the OpenMP thread.
 
 #if !JUNO_ENABLE_ASSERTS
 #  define ASSERT(expr)
@@ -46,7 +74,7 @@
 #  define ASSERT_ASSUME(expr) ASSUME(expr)
 #else
 #  define ASSERT(cond)                                                                   \
-    if (!(cond)) {                                                                       \
+    if (!(cond)) [[unlikely]] {                                                          \
       juno::failedAssert(__FILE__, __LINE__, #cond);                                     \
     }
 
@@ -55,19 +83,23 @@
       auto const a_eval = (a);                                                           \
       auto const b_eval = (b);                                                           \
       auto const diff_eval = a_eval < b_eval ? b_eval - a_eval : a_eval - b_eval;        \
-      if (diff_eval > (eps)) {                                                           \
+      if (diff_eval > (eps)) [[unlikely]] {                                              \
         juno::failedAssertNear(__FILE__, __LINE__, #a, #b, #eps);                        \
       }                                                                                  \
     }
 
 #  define ASSERT_ASSUME(expr) ASSERT(expr)
 
+#endif // JUNO_ENABLE_ASSERTS
+
 //========================================================================================
 // Implementation
 //========================================================================================
 namespace juno
 {
 
+#if JUNO_ENABLE_ASSERTS && !JUNO_ENABLE_DEFERRED_ASSERTS
+
 //------------------------------------------------------------------------------
 [[noreturn]] HOSTDEV inline void
 failedAssert(char const * const file, int const line, char const * const msg) noexcept
@@ -85,6 +117,113 @@ failedAssertNear(char const * const file, int const line, char const * const a,
   abort();
 }
 
-} // namespace juno
+#elif JUNO_ENABLE_DEFERRED_ASSERTS
 
-#endif // JUNO_ENABLE_ASSERTS
+#  if !JUNO_ENABLE_ASSERTS
+#    error "JUNO_ENABLE_DEFERRED_ASSERTS requires JUNO_ENABLE_ASSERTS"
+#  endif
+
+namespace failed_asserts
+{
+inline constexpr int capacity = 16;     // failures recorded; the rest are only counted
+inline constexpr int file_size = 64;    // the end of the path is kept
+inline constexpr int message_size = 96; // the start of the condition is kept
+} // namespace failed_asserts
+
+struct FailedAssert {
+  char file[failed_asserts::file_size];
+  char message[failed_asserts::message_size];
+  int line;
+  int64_t thread;
+};
+
+struct FailedAsserts {
+  unsigned count; // every failure, including those past capacity
+  FailedAssert records[failed_asserts::capacity];
+};
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables) OK, global records
+extern FailedAsserts host_failed_asserts;
+#  if JUNO_USE_GPU
+extern __device__ FailedAsserts device_failed_asserts;
+#  endif
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+namespace impl
+{
+
+//------------------------------------------------------------------------------
+// Copy s into dst[at, size - 1), keeping the end of s if it is a path. Returns the new
+// end of dst, which is always null-terminated.
+HOSTDEV inline auto
+appendString(char * const dst, int const size, int at, char const * const s,
+             bool const keep_end = false) noexcept -> int
+{
+  int n = 0;
+  while (s[n] != '\0') {
+    ++n;
+  }
+  int const first = keep_end && n > size - 1 - at ? n - (size - 1 - at) : 0;
+  for (int i = first; i < n && at < size - 1; ++i) {
+    dst[at++] = s[i];
+  }
+  dst[at] = '\0';
+  return at;
+}
+
+//------------------------------------------------------------------------------
+// Claim a record, and fill it. Only failures reach here, so the cost of the atomic
+// and the copies is never paid by a check that passes.
+HOSTDEV inline void
+recordFailedAssert(char const * const file, int const line, char const * const a,
+                   char const * const b, char const * const eps) noexcept
+{
+#  if COMPILING_DEVICE
+  FailedAsserts & failed = device_failed_asserts;
+  auto const thread = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+#  else
+  FailedAsserts & failed = host_failed_asserts;
+  auto const thread = static_cast<int64_t>(omp_get_thread_num());
+#  endif
+  unsigned const i = Kokkos::atomic_fetch_add(&failed.count, 1U);
+  if (i >= static_cast<unsigned>(failed_asserts::capacity)) {
+    return;
+  }
+  FailedAssert & record = failed.records[i];
+  appendString(record.file, failed_asserts::file_size, 0, file, true);
+  int at = appendString(record.message, failed_asserts::message_size, 0, a);
+  if (b != nullptr) {
+    at = appendString(record.message, failed_asserts::message_size, at, " == ");
+    at = appendString(record.message, failed_asserts::message_size, at, b);
+    at = appendString(record.message, failed_asserts::message_size, at, " +/- ");
+    appendString(record.message, failed_asserts::message_size, at, eps);
+  }
+  record.line = line;
+  record.thread = thread;
+}
+
+} // namespace impl
+
+//------------------------------------------------------------------------------
+HOSTDEV inline void
+failedAssert(char const * const file, int const line, char const * const msg) noexcept
+{
+  impl::recordFailedAssert(file, line, msg, nullptr, nullptr);
+}
+
+//------------------------------------------------------------------------------
+HOSTDEV inline void
+failedAssertNear(char const * const file, int const line, char const * const a,
+                 char const * const b, char const * const eps) noexcept
+{
+  impl::recordFailedAssert(file, line, a, b, eps);
+}
+
+#endif // JUNO_ENABLE_DEFERRED_ASSERTS
+
+//------------------------------------------------------------------------------
+// The number of assertions that failed since the last check. See above.
+auto
+checkAsserts(char const * label = "") -> int64_t;
+
+} // namespace juno
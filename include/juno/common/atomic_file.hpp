@@ -0,0 +1,71 @@
+#pragma once
+
+#include <juno/common/logger.hpp>
+
+#include <fstream> // std::ofstream
+#include <string>
+
+//========================================================================================
+// ATOMIC FILE
+//========================================================================================
+// Write a file so that readers never see it partially written: the contents go to a
+// temporary file next to it, which then replaces it by a rename. The temporary has a
+// name unique to the write (the process and a counter), so that concurrent writers of
+// the same file, such as ranks or threads sharing a cache directory, never write into
+// the same temporary. The last rename wins. A failed write removes its temporary, and
+// leaves the destination as it was.
+//
+// Usage:
+//   bool const ok = juno::writeFileAtomically(
+//       "cache/mix.bin", "stage cache",
+//       [&](std::ofstream & file) { file.write(data, size); });
+
+namespace juno
+{
+
+namespace impl
+{
+
+// A name for a temporary file next to filename, unique to the call
+auto
+temporaryFilename(std::string const & filename) -> std::string;
+
+// Replace filename with temporary. Logs an error, removes temporary, and returns false
+// if it cannot.
+auto
+replaceFile(std::string const & temporary, std::string const & filename) -> bool;
+
+// Remove a temporary file, ignoring errors
+void
+removeFile(std::string const & temporary);
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+// Write filename with write(file), for a binary std::ofstream. "what" names the file in
+// the error messages. Logs an error and returns false if the file cannot be written.
+template <class Write>
+auto
+writeFileAtomically(std::string const & filename, char const * what, Write const & write)
+    -> bool
+{
+  std::string const temporary = impl::temporaryFilename(filename);
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      LOG_ERROR("Cannot open ", what, " '", temporary, "' for writing");
+      return false;
+    }
+    write(file);
+    // Closing flushes, so that a full disk is seen here
+    file.close();
+    if (!file) {
+      LOG_ERROR("Cannot write ", what, " '", temporary, "'");
+      impl::removeFile(temporary);
+      return false;
+    }
+  }
+  return impl::replaceFile(temporary, filename);
+}
+
+} // namespace juno
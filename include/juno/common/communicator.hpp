@@ -0,0 +1,171 @@
+#pragma once
+
+#include <juno/common/settings.hpp>
+#include <juno/config.hpp>
+
+#include <cstddef> // size_t
+#include <cstdint> // int32_t
+#include <vector>
+
+#if JUNO_USE_MPI
+#  include <mpi.h>
+#endif
+
+//========================================================================================
+// COMMUNICATOR
+//========================================================================================
+// The ranks of a distributed run, and the messages between them. A Communicator wraps
+// an MPI communicator, MPI_COMM_WORLD by default, with the few operations that the
+// domain decomposition needs:
+//  - send and receive: non-blocking messages of bytes, which are added to a Requests,
+//    and complete when it is tested or waited on. A Requests may be tested between
+//    kernels, so that the messages progress while the device computes.
+//  - maxAll and sumAll: reductions over the ranks, e.g. of timings and residuals, and
+//    allGather, e.g. of the sizes of each rank's part of the output.
+//  - gpuAware(): whether device pointers may be passed to the messages, so that device
+//    buffers are sent without a copy to the host. It is detected from the MPI library
+//    (Open MPI's CUDA and ROCm extensions), and settings::mpi::gpu_aware overrides it.
+//
+// Without JUNO_USE_MPI, or before MPI_Init, a Communicator is a single rank, and has
+// no one to send to: a rank that is its own neighbor must copy its messages itself.
+//
+// MPIGuard initializes MPI for the lifetime of the guard, like Kokkos::ScopeGuard, if
+// it is not initialized already.
+//
+// Usage:
+//   juno::MPIGuard const mpi(argc, argv);
+//   juno::Communicator const comm;
+//   juno::Requests requests;
+//   comm.receive(in.data(), bytes, neighbor, tag, requests);
+//   comm.send(out.data(), bytes, neighbor, tag, requests);
+//   ... work that does not need the messages ...
+//   requests.waitAll();
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+// Messages in flight. Not copyable, since each must be completed once.
+class Requests
+{
+#if JUNO_USE_MPI
+  std::vector<MPI_Request> _requests;
+#endif
+
+public:
+  Requests() = default;
+  Requests(Requests const &) = delete;
+  Requests(Requests &&) noexcept = default;
+  auto
+  operator=(Requests const &) -> Requests & = delete;
+  auto
+  operator=(Requests &&) noexcept -> Requests & = default;
+
+  // Waits for the messages in flight
+  ~Requests();
+
+#if JUNO_USE_MPI
+  void
+  add(MPI_Request const request)
+  {
+    _requests.push_back(request);
+  }
+#endif
+
+  [[nodiscard]] auto
+  empty() const noexcept -> bool;
+
+  // Progress the messages. True if they are all complete, which clears them.
+  auto
+  testAll() -> bool;
+
+  // Wait for all the messages to complete
+  void
+  waitAll();
+};
+
+//----------------------------------------------------------------------------------------
+class Communicator
+{
+#if JUNO_USE_MPI
+  MPI_Comm _comm = MPI_COMM_NULL;
+#endif
+  int32_t _rank = 0;
+  int32_t _size = 1;
+  bool _gpu_aware = false;
+
+public:
+  // MPI_COMM_WORLD, or a single rank without MPI
+  Communicator();
+
+#if JUNO_USE_MPI
+  explicit Communicator(MPI_Comm comm);
+
+  [[nodiscard]] auto
+  comm() const noexcept -> MPI_Comm
+  {
+    return _comm;
+  }
+#endif
+
+  [[nodiscard]] auto
+  rank() const noexcept -> int32_t
+  {
+    return _rank;
+  }
+
+  [[nodiscard]] auto
+  size() const noexcept -> int32_t
+  {
+    return _size;
+  }
+
+  [[nodiscard]] auto
+  gpuAware() const noexcept -> bool
+  {
+    return _gpu_aware;
+  }
+
+  // Start sending or receiving bytes from data. The data must not be touched, or read
+  // for a receive, until the requests complete. Logs an error without MPI.
+  void
+  send(void const * data, size_t bytes, int32_t dest, int32_t tag,
+       Requests & requests) const;
+
+  void
+  receive(void * data, size_t bytes, int32_t source, int32_t tag,
+          Requests & requests) const;
+
+  // Reductions over the ranks. Every rank must call them, in the same order.
+  [[nodiscard]] auto
+  maxAll(double value) const -> double;
+
+  [[nodiscard]] auto
+  sumAll(double value) const -> double;
+
+  // The value of each rank, in order of rank
+  [[nodiscard]] auto
+  allGather(int64_t value) const -> std::vector<int64_t>;
+
+  void
+  barrier() const;
+};
+
+//----------------------------------------------------------------------------------------
+// MPI_Init and MPI_Finalize, unless MPI was initialized by someone else
+class MPIGuard
+{
+  bool _owner = false;
+
+public:
+  MPIGuard(int & argc, char **& argv);
+  MPIGuard(MPIGuard const &) = delete;
+  MPIGuard(MPIGuard &&) = delete;
+  auto
+  operator=(MPIGuard const &) -> MPIGuard & = delete;
+  auto
+  operator=(MPIGuard &&) -> MPIGuard & = delete;
+  ~MPIGuard();
+};
+
+} // namespace juno
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm>   // std::min, std::max
+#include <cstdint>
+#include <type_traits> // std::type_identity_t, std::is_same_v
+
+//========================================================================================
+// EXECUTION POLICIES
+//========================================================================================
+// Kokkos' default policies are portable, but they are not tuned for any backend. For
+// bandwidth-bound kernels on GPUs they fall well short of native HIP, because:
+//  - The default index type is 64-bit. This doubles the register pressure and the cost
+//    of index arithmetic on the GPU.
+//  - Without launch bounds, the compiler must assume the largest possible block size.
+//    That limits the registers each thread may use.
+//  - With one element per thread, there are more blocks to schedule, and reductions
+//    have more partial results to combine.
+//
+// We select tuned policies per backend through LaunchTuning<ExecSpace>:
+//  - rangePolicy<ExecSpace>(begin, end): a RangePolicy with Int indices, static
+//    scheduling, and launch bounds. A chunk size and a desired occupancy can also be
+//    set. Chunk sizes apply to host backends only; the GPU backends ignore them.
+//    rangePolicy<ExecSpace, Size>(begin, end) is the same with 64-bit indices, for the
+//    few loops whose extent may exceed intMax(), such as over all the segments of a
+//    track layout. The kernel then takes a Size index.
+//  - dynamicRangePolicy<ExecSpace>(begin, end, chunk_size): the same with dynamic
+//    scheduling, for host loops whose iterations vary in cost: idle threads take the
+//    next chunk. The GPU backends schedule blocks dynamically anyway, and ignore it.
+//    When the costs can be estimated, parallelForWeighted (task_scheduler.hpp) also
+//    keeps each thread on contiguous memory.
+//  - gridStridePolicy<ExecSpace>(n): a TeamPolicy with just enough teams to fill the
+//    device once. Loop over the elements with the grid-stride pattern of native GPU
+//    kernels, where each thread processes several elements:
+//      for (Int i = gridStrideBegin(member); i < n; i += gridStrideStep(member))
+//    This is meant for GPU backends. On host backends, where each thread should work on
+//    contiguous memory, use rangePolicy.
+//
+// The tuning values are starting points, taken from benchmark/common/device_view.cpp.
+// Specialize LaunchTuning to change them.
+
+namespace juno
+{
+
+using DeviceExecSpace = Kokkos::DefaultExecutionSpace;
+using DeviceMemSpace = DeviceExecSpace::memory_space;
+using HostExecSpace = Kokkos::DefaultHostExecutionSpace;
+using HostMemSpace = HostExecSpace::memory_space;
+
+//----------------------------------------------------------------------------------------
+// The default tuning, for host backends
+template <class ExecSpace>
+struct LaunchTuning {
+  // Launch bounds: threads per block (0 for no bound) and blocks per multiprocessor
+  static constexpr uint32_t max_threads = 0;
+  static constexpr uint32_t min_blocks = 0;
+
+  // Iterations per chunk of static scheduling (0 for the Kokkos default). Large chunks
+  // amortize the scheduling overhead, and keep each thread on contiguous memory.
+  static constexpr Int chunk_size = 4096;
+
+  // Desired occupancy in percent (0 for the Kokkos default)
+  static constexpr int32_t occupancy = 0;
+
+  // Threads per team for gridStridePolicy
+  static constexpr Int team_size = 1;
+};
+
+#ifdef KOKKOS_ENABLE_HIP
+// Blocks of 256 threads, 4 wavefronts on AMD GPUs. With launch bounds, the compiler
+// allocates registers for this block size instead of the 1024-thread maximum.
+template <>
+struct LaunchTuning<Kokkos::HIP> {
+  static constexpr uint32_t max_threads = 256;
+  static constexpr uint32_t min_blocks = 1;
+  static constexpr Int chunk_size = 0;
+  static constexpr int32_t occupancy = 0;
+  static constexpr Int team_size = 256;
+};
+#endif
+
+#ifdef KOKKOS_ENABLE_CUDA
+template <>
+struct LaunchTuning<Kokkos::Cuda> {
+  static constexpr uint32_t max_threads = 256;
+  static constexpr uint32_t min_blocks = 2;
+  static constexpr Int chunk_size = 0;
+  static constexpr int32_t occupancy = 0;
+  static constexpr Int team_size = 256;
+};
+#endif
+
+template <class ExecSpace>
+using TunedLaunchBounds = Kokkos::LaunchBounds<LaunchTuning<ExecSpace>::max_threads,
+                                               LaunchTuning<ExecSpace>::min_blocks>;
+
+template <class ExecSpace = DeviceExecSpace, class Index = Int>
+using TunedRangePolicy =
+    Kokkos::RangePolicy<ExecSpace, Kokkos::IndexType<Index>,
+                        Kokkos::Schedule<Kokkos::Static>, TunedLaunchBounds<ExecSpace>>;
+
+template <class ExecSpace = DeviceExecSpace, class Index = Int>
+using TunedDynamicRangePolicy =
+    Kokkos::RangePolicy<ExecSpace, Kokkos::IndexType<Index>,
+                        Kokkos::Schedule<Kokkos::Dynamic>, TunedLaunchBounds<ExecSpace>>;
+
+template <class ExecSpace = DeviceExecSpace>
+using TunedTeamPolicy =
+    Kokkos::TeamPolicy<ExecSpace, Kokkos::IndexType<Int>,
+                       Kokkos::Schedule<Kokkos::Static>, TunedLaunchBounds<ExecSpace>>;
+
+//----------------------------------------------------------------------------------------
+// Apply the occupancy hint of the tuning, if any. This changes the type of the policy.
+template <class ExecSpace, class Policy>
+auto
+withOccupancyHint(Policy const & policy)
+{
+  if constexpr (LaunchTuning<ExecSpace>::occupancy > 0) {
+    return Kokkos::Experimental::prefer(
+        policy,
+        Kokkos::Experimental::DesiredOccupancy{LaunchTuning<ExecSpace>::occupancy});
+  } else {
+    return policy;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// A tuned policy over [begin, end), with Int or Size indices. The bounds are not
+// deduced, so that rangePolicy<ExecSpace>(0, n) is over Int for any integer n.
+template <class ExecSpace = DeviceExecSpace, class Index = Int>
+auto
+rangePolicy(std::type_identity_t<Index> const begin,
+            std::type_identity_t<Index> const end, ExecSpace const & space = ExecSpace())
+{
+  static_assert(std::is_same_v<Index, Int> || std::is_same_v<Index, Size>);
+  TunedRangePolicy<ExecSpace, Index> policy(space, begin, end);
+  if constexpr (LaunchTuning<ExecSpace>::chunk_size > 0) {
+    policy.set_chunk_size(static_cast<int>(LaunchTuning<ExecSpace>::chunk_size));
+  }
+  return withOccupancyHint<ExecSpace>(policy);
+}
+
+//----------------------------------------------------------------------------------------
+// A tuned policy over [begin, end) with dynamic scheduling, in chunks of chunk_size.
+// Smaller chunks balance better, at the cost of more scheduling.
+template <class ExecSpace = DeviceExecSpace>
+auto
+dynamicRangePolicy(Int const begin, Int const end, Int const chunk_size = 64,
+                   ExecSpace const & space = ExecSpace())
+{
+  TunedDynamicRangePolicy<ExecSpace> policy(space, begin, end);
+  policy.set_chunk_size(static_cast<int>(chunk_size));
+  return withOccupancyHint<ExecSpace>(policy);
+}
+
+//----------------------------------------------------------------------------------------
+// A tuned team policy for a grid-stride loop over n elements. The number of teams is
+// limited to the number that the device can run at once.
+template <class ExecSpace = DeviceExecSpace>
+auto
+gridStridePolicy(Int const n, ExecSpace const & space = ExecSpace())
+{
+  Int const team_size = LaunchTuning<ExecSpace>::team_size;
+  Int const resident_teams =
+      std::max(static_cast<Int>(space.concurrency()) / team_size, Int{1});
+  Int const needed_teams = std::max((n + team_size - 1) / team_size, Int{1});
+  // Kokkos takes the league and team sizes as int, and the league fits the device
+  TunedTeamPolicy<ExecSpace> policy(
+      space, static_cast<int>(std::min(needed_teams, resident_teams)),
+      static_cast<int>(team_size));
+  return withOccupancyHint<ExecSpace>(policy);
+}
+
+//----------------------------------------------------------------------------------------
+// The first index of the calling thread in a grid-stride loop
+template <class Member>
+HOSTDEV constexpr auto
+gridStrideBegin(Member const & member) noexcept -> Int
+{
+  return static_cast<Int>((member.league_rank() * member.team_size()) +
+                          member.team_rank());
+}
+
+//----------------------------------------------------------------------------------------
+// The distance between the indices of the calling thread in a grid-stride loop
+template <class Member>
+HOSTDEV constexpr auto
+gridStrideStep(Member const & member) noexcept -> Int
+{
+  return static_cast<Int>(member.league_size() * member.team_size());
+}
+
+} // namespace juno
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <juno/config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//========================================================================================
+// HASH
+//========================================================================================
+// Fast 64-bit content hashes, to detect that data has changed (e.g. that a cache is
+// stale). They are not cryptographic.
+// The hashes:
+//  - are computed in parallel with OpenMP over fixed 1 MiB chunks, then combined in
+//    order, so the hash of some data does not depend on the number of threads.
+//  - read 8 bytes at a time, so hashing runs at about the speed of memory.
+//
+// Usage:
+// - hashBytes(data, size): the hash of size bytes at data
+// - hashFile(path): the hash of the contents of a file, by mapping it
+// - hashCombine(seed, value): fold a hash into another, in order
+
+namespace juno
+{
+
+[[nodiscard]] constexpr auto
+hashCombine(uint64_t const seed, uint64_t const value) noexcept -> uint64_t
+{
+  // The finalizer of splitmix64, applied to the seed with the value
+  uint64_t h = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
+[[nodiscard]] auto
+hashBytes(void const * data, size_t size) -> uint64_t;
+
+// Logs an error and returns 0 if the file cannot be read
+[[nodiscard]] auto
+hashFile(std::string const & path) -> uint64_t;
+
+} // namespace juno
@@ -4,7 +4,13 @@
 #include <juno/common/settings.hpp>
 
 #include <chrono>
+#include <cstring> // memcpy
+#include <memory>    // std::addressof
+#include <stdexcept> // std::runtime_error
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <vector>
 
 //========================================================================================
 // LOG
@@ -16,14 +22,51 @@
 //      messages using the MAX_LOG_LEVEL macro.
 //    - prefix messages with a timestamp
 //    - colorize messages based on their verbosity level
-//  - is not thread-safe.
+//    - write floating point numbers with a fixed precision, or with the shortest
+//      representation that round-trips (float_precision < 0)
+//  - is thread-safe. Each thread formats messages into its own thread-local buffer.
+//    Finished lines are pushed onto a lock-free queue, and whichever thread finds the
+//    queue unclaimed writes the pending lines to the output. No thread ever waits on
+//    another to log, unless the queue is full.
+//  - can be made asynchronous, in which case a background thread writes the queued
+//    lines in large batches and logging never waits on the output. If the queue is
+//    full, the message is dropped and counted (see droppedMessages()). Errors are never
+//    dropped. The queue is drained on reset(), on error, and at exit.
+//  - can defer formatting. A deferred message stores the arguments in binary form in a
+//    per-thread ring, tagged with a compile-time ID of the argument types. The text is
+//    rendered later: continuously by the background thread in asynchronous mode,
+//    otherwise on flush(), reset(), exit, error, or when the thread's ring is full.
+//    If the ring is full in asynchronous mode, the message is dropped and counted.
+//  - is aware of MPI ranks. The ranks that log can be filtered (rank_filter): all ranks,
+//    only the root rank, or every rank_stride-th rank. Errors are logged on every rank.
+//    The rank is taken from MPI if JUNO_USE_MPI and MPI is initialized, otherwise from
+//    the environment variables set by common launchers (mpirun, srun, etc.).
+//  - can aggregate messages across ranks. With "aggregated" set, messages are counted
+//    locally instead of being written. aggregate(), which is collective over
+//    MPI_COMM_WORLD, writes each distinct message once on the root rank, with the
+//    number of times and the number of ranks it was logged on. Call it where the ranks
+//    synchronize anyway (e.g. once per outer iteration) and before MPI_Finalize.
+//    Errors and deferred messages are never aggregated.
+//  - handles errors according to error_policy, after writing the message:
+//    - fatal (default): write the queued messages and exit(1)
+//    - exception: throw juno::logger::Error. Within an OpenMP parallel region, the
+//      exception must be caught by the thread that threw it.
+//    - callback: call error_callback (if set) with the message, then return
+//    In every case, the message is added to a bounded record of the most recent
+//    errors, which can be queried with getErrors(). Failures to write to the output
+//    are recorded in the same way, but never end the process.
 //  - can be extended to log info to classes by specializing the "toBuffer" function.
+//    Deferred logging of trivially copyable classes works without further changes.
+//    Other classes must also specialize "toBinary" and "fromBinary".
 //
 // Usage:
 // - LOG_DEBUG(args...): print a debug message that a developer would want to know
 // - LOG_INFO(args...):  print info that a user would want to know
 // - LOG_WARN(args...):  print a warning that something may go wrong
-// - LOG_ERROR(args...): print an error message that something has gone wrong
+// - LOG_ERROR(args...): print an error message that something has gone wrong, then
+//                       handle the error according to error_policy
+// - LOG_DEBUG_DEFERRED(args...), LOG_INFO_DEFERRED(args...), LOG_WARN_DEFERRED(args...):
+//   the same as above, but with deferred formatting. Errors are never deferred.
 
 #if MAX_LOG_LEVEL > 0
 #  define LOG_ERROR(...) juno::logger::error(__VA_ARGS__)
@@ -32,21 +75,27 @@
 #endif
 
 #if MAX_LOG_LEVEL > 1
-#  define LOG_WARN(...) juno::logger::warn(__VA_ARGS__)
+#  define LOG_WARN(...)          juno::logger::warn(__VA_ARGS__)
+#  define LOG_WARN_DEFERRED(...) juno::logger::deferredWarn(__VA_ARGS__)
 #else
 #  define LOG_WARN(...)
+#  define LOG_WARN_DEFERRED(...)
 #endif
 
 #if MAX_LOG_LEVEL > 2
-#  define LOG_INFO(...) juno::logger::info(__VA_ARGS__)
+#  define LOG_INFO(...)          juno::logger::info(__VA_ARGS__)
+#  define LOG_INFO_DEFERRED(...) juno::logger::deferredInfo(__VA_ARGS__)
 #else
 #  define LOG_INFO(...)
+#  define LOG_INFO_DEFERRED(...)
 #endif
 
 #if MAX_LOG_LEVEL > 3
-#  define LOG_DEBUG(...) juno::logger::debug(__VA_ARGS__)
+#  define LOG_DEBUG(...)          juno::logger::debug(__VA_ARGS__)
+#  define LOG_DEBUG_DEFERRED(...) juno::logger::deferredDebug(__VA_ARGS__)
 #else
 #  define LOG_DEBUG(...)
+#  define LOG_DEBUG_DEFERRED(...)
 #endif
 
 namespace juno::logger
@@ -69,6 +118,41 @@ inline constexpr int32_t info = 3;  // errors, warnings and info
 inline constexpr int32_t debug = 4; // errors, warnings, info and debug
 } // namespace levels
 
+namespace rank_filters
+{
+inline constexpr int32_t all = 0;     // every rank logs
+inline constexpr int32_t root = 1;    // only rank 0 logs
+inline constexpr int32_t strided = 2; // every rank_stride-th rank logs
+} // namespace rank_filters
+
+namespace error_policies
+{
+inline constexpr int32_t fatal = 0;     // exit(1)
+inline constexpr int32_t exception = 1; // throw juno::logger::Error
+inline constexpr int32_t callback = 2;  // call error_callback and return
+} // namespace error_policies
+
+// The exception thrown by error() under error_policies::exception
+class Error : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// The number of most recent errors that are kept
+inline constexpr size_t error_record_capacity = 16;
+
+// The size of the message of an error record, including the null character. Longer
+// messages are truncated.
+inline constexpr size_t error_message_size = 256;
+
+// An entry of the error record. It is fixed-size, so that an error is recorded without
+// allocating.
+struct ErrorRecord {
+  TimePoint time;
+  char message[error_message_size]; // without the preamble (color, timestamp, level)
+};
+
 //========================================================================================
 // Global variables
 //========================================================================================
@@ -80,11 +164,29 @@ inline constexpr int32_t debug = 4; // errors, warnings, info and debug
 extern int32_t & level;
 extern bool & timestamped;
 extern bool & colorized;
+extern bool & asynchronous;
+extern int32_t & float_precision;
+extern int32_t & rank_filter;
+extern int32_t & rank_stride;
+extern bool & aggregated;
+extern int32_t & error_policy;
+extern juno::settings::logger::ErrorCallback & error_callback;
 extern TimePoint start_time;
 
+// Each thread has its own buffer, so messages may be formatted concurrently
 inline constexpr int32_t buffer_size = 256;
-extern char buffer[buffer_size];
-extern char const * const buffer_end; // 1 past the last valid character in the buffer
+extern thread_local char buffer[buffer_size];
+extern thread_local char const * const buffer_end; // 1 past the last valid character
+
+// The number of finished lines that may be waiting to be written to the output
+inline constexpr uint64_t queue_capacity = 256;
+static_assert((queue_capacity & (queue_capacity - 1)) == 0,
+              "queue_capacity must be a power of 2");
+
+// Deferred messages are serialized into a thread-local buffer, then copied to the
+// thread's ring of ring_capacity bytes
+extern thread_local char binary_buffer[buffer_size];
+inline constexpr uint64_t ring_capacity = 1 << 16;
 
 // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
 
@@ -93,15 +195,52 @@ extern char const * const buffer_end; // 1 past the last valid character in the
 //========================================================================================
 
 //----------------------------------------------------------------------------------------
-// Return a view of the last message written to the log buffer
-constexpr auto
+// Return a view of the last message written to the log buffer by the calling thread
+inline auto
 getLastMessage() noexcept -> std::string_view
 {
   return {buffer};
 }
 
 //----------------------------------------------------------------------------------------
-// Reset the logger to its default state
+// Write all queued messages to the output and flush stdout and stderr
+void
+flush() noexcept;
+
+//----------------------------------------------------------------------------------------
+// Return the MPI rank of this process in MPI_COMM_WORLD, or 0 if it is unknown
+auto
+rank() noexcept -> int32_t;
+
+//----------------------------------------------------------------------------------------
+// Write the aggregated messages of every rank on the root rank.
+// This is collective over MPI_COMM_WORLD when JUNO_USE_MPI.
+void
+aggregate() noexcept;
+
+//----------------------------------------------------------------------------------------
+// Return the number of errors since the last reset() or clearErrors(), including
+// those no longer in the record
+auto
+errorCount() noexcept -> uint64_t;
+
+//----------------------------------------------------------------------------------------
+// Return the most recent errors, oldest first
+auto
+getErrors() -> std::vector<ErrorRecord>;
+
+//----------------------------------------------------------------------------------------
+// Clear the error record and the error count
+void
+clearErrors() noexcept;
+
+//----------------------------------------------------------------------------------------
+// Return the number of messages dropped because the queue was full in asynchronous mode
+auto
+droppedMessages() noexcept -> uint64_t;
+
+//----------------------------------------------------------------------------------------
+// Reset the logger to its default state, writing all queued messages first
 void
 reset() noexcept;
 
@@ -134,6 +273,10 @@ toBuffer(char * buffer_pos, char const (&value)[N]) noexcept -> char *
 auto
 addTimestamp(char * buffer_pos) noexcept -> char *;
 
+// Add the timestamp for the given time
+auto
+addTimestamp(char * buffer_pos, TimePoint time) noexcept -> char *;
+
 //----------------------------------------------------------------------------------------
 // Add color to the buffer if the log is colorized
 auto
@@ -149,19 +292,52 @@ addLevel(int32_t msg_level, char * buffer_pos) noexcept -> char *;
 auto
 setPreamble(int32_t msg_level) noexcept -> char *;
 
+// Set the preamble of a message that was logged at the given time
+auto
+setPreamble(int32_t msg_level, TimePoint time) noexcept -> char *;
+
 //----------------------------------------------------------------------------------------
 // Set the postamble of the message (reset color and null char)
+// Returns a pointer to the null char.
+auto
+setPostamble(char * buffer_pos) noexcept -> char *;
+
+//----------------------------------------------------------------------------------------
+// Push the message in the thread-local buffer onto the output queue, then write the
+// queued messages if no other thread is currently doing so.
+void
+writeMessage(int32_t msg_level, char const * message_end) noexcept;
+
+//----------------------------------------------------------------------------------------
+// Does this rank log messages of the given level under the current rank filter?
+auto
+isRankLogged(int32_t msg_level) noexcept -> bool;
+
+//----------------------------------------------------------------------------------------
+// Count the message in the thread-local buffer (which has no preamble), to be written
+// by aggregate()
+void
+aggregateMessage(int32_t msg_level, char const * message_end) noexcept;
+
+//----------------------------------------------------------------------------------------
+// Record the error, then exit, throw, or call the callback according to error_policy
 void
-setPostamble(char * buffer_pos) noexcept;
+handleError(std::string_view message);
 
 //----------------------------------------------------------------------------------------
 // Print the message
+// Only throws for errors under error_policies::exception.
 template <class... Args>
 void
-printMessage(int32_t const msg_level, Args const &... args) noexcept
+printMessage(int32_t const msg_level, Args const &... args)
 {
-  if (msg_level <= level) {
-    char * buffer_pos = setPreamble(msg_level);
+  if (msg_level <= level && isRankLogged(msg_level)) {
+    // Aggregated messages have no preamble, so that the same message logged at
+    // different times compares equal
+    bool const aggregating = aggregated && msg_level != levels::error;
+    char * buffer_pos =
+        aggregating ? std::addressof(buffer[0]) : setPreamble(msg_level);
+    char const * const body = buffer_pos;
 
     // Use fold expression to send each argument to the buffer.
     // We need a lambda function to capture the buffer_pos variable, since it is
@@ -169,30 +345,143 @@ printMessage(int32_t const msg_level, Args const &... args) noexcept
     ([&buffer_pos](auto const & arg) { buffer_pos = toBuffer(buffer_pos, arg); }(args),
      ...);
 
-    setPostamble(buffer_pos);
+    if (aggregating) {
+      buffer_pos[0] = '\0';
+      aggregateMessage(msg_level, buffer_pos);
+      return;
+    }
+
+    std::string_view const body_view(body, static_cast<size_t>(buffer_pos - body));
+    buffer_pos = setPostamble(buffer_pos);
 
     // Print the message
-    int fprintf_result = 0;
+    writeMessage(msg_level, buffer_pos);
+
     if (msg_level == levels::error) {
-      fprintf_result = fprintf(stderr, "%s\n", buffer);
-      exit(1);
-    } else {
-      fprintf_result = fprintf(stdout, "%s\n", buffer);
-    }
-    ASSERT(fprintf_result > 0);
-    if (fprintf_result == 0) {
-      exit(1);
+      handleError(body_view);
     }
   } // msg_level <= level
 } // printMessage
 
+//----------------------------------------------------------------------------------------
+// Deferred messages
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Write types to the binary buffer
+// This is the serialization counterpart of toBuffer. By default, the bytes of the value
+// are copied, which is correct for any trivially copyable type that does not point to
+// other data. Specializations for strings are in logger.cpp.
+template <class T>
+auto
+toBinary(char * binary_pos, T const & value) noexcept -> char *
+{
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Specialize toBinary and fromBinary to defer logging of this type");
+  std::memcpy(binary_pos, std::addressof(value), sizeof(T));
+  return binary_pos + sizeof(T);
+}
+
+//----------------------------------------------------------------------------------------
+// Handle fixed-size character arrays by treating them as pointer
+template <uint64_t N>
+auto
+toBinary(char * binary_pos, char const (&value)[N]) noexcept -> char *
+{
+  char const * const p = value;
+  return toBinary(binary_pos, p);
+}
+
+//----------------------------------------------------------------------------------------
+// Read a value written by toBinary<T> and write it to the text buffer with toBuffer.
+// binary_pos is advanced past the value.
+template <class T>
+auto
+fromBinary(char const *& binary_pos, char * buffer_pos) noexcept -> char *
+{
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Specialize toBinary and fromBinary to defer logging of this type");
+  T value;
+  std::memcpy(std::addressof(value), binary_pos, sizeof(T));
+  binary_pos += sizeof(T);
+  return toBuffer(buffer_pos, value);
+}
+
+// Strings are stored as their length followed by their characters
+template <>
+auto
+toBinary(char * binary_pos, char const * const & value) noexcept -> char *;
+
+template <>
+auto
+toBinary(char * binary_pos, std::string_view const & value) noexcept -> char *;
+
+template <>
+auto
+toBinary(char * binary_pos, std::string const & value) noexcept -> char *;
+
+template <>
+auto
+fromBinary<char const *>(char const *& binary_pos, char * buffer_pos) noexcept -> char *;
+
+template <>
+auto
+fromBinary<std::string_view>(char const *& binary_pos, char * buffer_pos) noexcept
+    -> char *;
+
+template <>
+auto
+fromBinary<std::string>(char const *& binary_pos, char * buffer_pos) noexcept -> char *;
+
+//----------------------------------------------------------------------------------------
+// Render the arguments of a deferred message, in order.
+// The address of each instantiation is the compile-time ID of a deferred message: it
+// identifies the argument types and how to decode them.
+template <class... Args>
+auto
+decodeArgs(char const * binary_pos, char * buffer_pos) noexcept -> char *
+{
+  ((buffer_pos = fromBinary<Args>(binary_pos, buffer_pos)), ...);
+  return buffer_pos;
+}
+
+using Decoder = auto (*)(char const * binary_pos, char * buffer_pos) noexcept -> char *;
+
+// The header of each record in a ring. The arguments follow the header.
+struct DeferredHeader {
+  Decoder decode;    // nullptr marks padding at the end of the ring
+  Clock::rep time;   // when the message was logged
+  int32_t level;     // the level of the message
+  uint32_t size;     // the size of the record in bytes, including the header
+};
+
+//----------------------------------------------------------------------------------------
+// Time-stamp the record in binary_buffer and copy it to the calling thread's ring
+void
+commitDeferred(int32_t msg_level, Decoder decode, char const * record_end) noexcept;
+
+//----------------------------------------------------------------------------------------
+// Store the message for formatting later
+template <class... Args>
+void
+deferMessage(int32_t const msg_level, Args const &... args) noexcept
+{
+  if (msg_level <= level && isRankLogged(msg_level)) {
+    char * binary_pos = std::addressof(binary_buffer[0]) + sizeof(DeferredHeader);
+    ([&binary_pos](auto const & arg) { binary_pos = toBinary(binary_pos, arg); }(args),
+     ...);
+    ASSERT(binary_pos < binary_buffer + buffer_size);
+    commitDeferred(msg_level, &decodeArgs<std::decay_t<Args const>...>, binary_pos);
+  }
+} // deferMessage
+
 } // namespace impl
 
 //----------------------------------------------------------------------------------------
-// Log an error message
+// Log an error message and handle the error according to error_policy
 template <class... Args>
 void
-error(Args const &... args) noexcept
+error(Args const &... args)
 {
   impl::printMessage(levels::error, args...);
 }
@@ -224,4 +513,31 @@ debug(Args const &... args) noexcept
   impl::printMessage(levels::debug, args...);
 }
 
+//----------------------------------------------------------------------------------------
+// Log a warning with deferred formatting
+template <class... Args>
+void
+deferredWarn(Args const &... args) noexcept
+{
+  impl::deferMessage(levels::warn, args...);
+}
+
+//----------------------------------------------------------------------------------------
+// Log info with deferred formatting
+template <class... Args>
+void
+deferredInfo(Args const &... args) noexcept
+{
+  impl::deferMessage(levels::info, args...);
+}
+
+//----------------------------------------------------------------------------------------
+// Log a debug message with deferred formatting
+template <class... Args>
+void
+deferredDebug(Args const &... args) noexcept
+{
+  impl::deferMessage(levels::debug, args...);
+}
+
 } // namespace juno::logger
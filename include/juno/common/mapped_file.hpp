@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+//========================================================================================
+// MAPPED FILE
+//========================================================================================
+// A memory mapping of a whole file.
+// The mapping:
+//  - lets large files be parsed in parallel without reading them into a buffer first.
+//    Pages are read from disk (or the page cache) on first access, by whichever thread
+//    touches them.
+//  - is released when the MappedFile is destroyed. MappedFiles can be moved, but not
+//    copied.
+//  - is read-only by default. A copy-on-write mapping can also be written to; the
+//    written pages become private to the process, and the file is not modified.
+//  - logs an error if the file cannot be opened or mapped, and is then not open.
+//    An empty file is open, with size 0 and a null data pointer.
+//
+// Usage:
+//   juno::MappedFile const file("mesh.msh");
+//   if (file.isOpen()) {
+//     std::string_view const text = file.view();
+//     ...
+//   }
+
+namespace juno
+{
+
+class MappedFile
+{
+  char const * _data = nullptr;
+  size_t _size = 0;
+  bool _open = false;
+  bool _copy_on_write = false;
+
+public:
+  MappedFile() = default;
+
+  explicit MappedFile(std::string const & path, bool copy_on_write = false);
+
+  MappedFile(MappedFile const &) = delete;
+  auto
+  operator=(MappedFile const &) -> MappedFile & = delete;
+
+  MappedFile(MappedFile && other) noexcept;
+  auto
+  operator=(MappedFile && other) noexcept -> MappedFile &;
+
+  ~MappedFile();
+
+  [[nodiscard]] auto
+  isOpen() const noexcept -> bool
+  {
+    return _open;
+  }
+
+  [[nodiscard]] auto
+  data() const noexcept -> char const *
+  {
+    return _data;
+  }
+
+  // The data of a copy-on-write mapping, or nullptr for a read-only mapping
+  [[nodiscard]] auto
+  writableData() const noexcept -> char *
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    return _copy_on_write ? const_cast<char *>(_data) : nullptr;
+  }
+
+  [[nodiscard]] auto
+  size() const noexcept -> size_t
+  {
+    return _size;
+  }
+
+  [[nodiscard]] auto
+  view() const noexcept -> std::string_view
+  {
+    return {_data, _size};
+  }
+
+  // Unmap the file
+  void
+  close() noexcept;
+};
+
+} // namespace juno
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//========================================================================================
+// MIRRORED VIEWS
+//========================================================================================
+// A MirroredView is a 1D array with a copy in device memory and a copy in host memory.
+// The copies are synchronized explicitly and asynchronously:
+//  - toDevice(space) and toHost(space) enqueue the copy on an execution space instance
+//    (a stream on GPUs) and return immediately. Fence the instance before using the
+//    destination on the host, or launch the kernels that use it on the same instance.
+//  - The host copy is allocated in pinned memory (HostPinnedSpace), so that the copies
+//    are asynchronous DMA transfers rather than staged synchronous copies.
+//  - If the host can access the device memory (e.g. host backends), the two copies are
+//    the same view, and the transfers do nothing.
+// Copies of a MirroredView are shallow, like Kokkos::View.
+//
+// For data that is built on the host once and then only read on the device, such as
+// the setup of a solver, toView<MemSpace>(label, v) copies a std::vector to a View in
+// MemSpace. It is a synchronous copy, and does not keep a host copy.
+//
+// A DoubleBufferedView overlaps the upload of the next batch with the kernels of the
+// current batch. It holds two MirroredViews: the front buffer, which kernels read on
+// the device, and the back buffer, which the host fills and uploads. Transfers run on
+// their own execution space instance, and the kernels of each buffer on another (on
+// host backends, these are all the default instance, which has every thread). A loop
+// over batches looks like:
+//
+//   DoubleBufferedView<Float> buf("x", batch_size);
+//   fill(buf.acquireBack(), 0);
+//   buf.beginUpload();
+//   buf.swap();
+//   for (Int b = 0; b < num_batches; ++b) {
+//     // Kernels on the front buffer
+//     Kokkos::parallel_for(rangePolicy(0, batch_size, buf.computeSpace()), ...
+//         buf.front().device() ...);
+//     // Meanwhile, fill and upload the back buffer
+//     if (b + 1 < num_batches) {
+//       fill(buf.acquireBack(), b + 1);
+//       buf.beginUpload();
+//     }
+//     buf.swap();
+//   }
+//   buf.fence();
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+// Host memory that the device can transfer to and from asynchronously
+#if defined(KOKKOS_ENABLE_HIP)
+using HostPinnedSpace = Kokkos::HIPHostPinnedSpace;
+#elif defined(KOKKOS_ENABLE_CUDA)
+using HostPinnedSpace = Kokkos::CudaHostPinnedSpace;
+#else
+using HostPinnedSpace = Kokkos::HostSpace;
+#endif
+
+//----------------------------------------------------------------------------------------
+// Copy a vector on the host to a View in MemSpace
+template <class MemSpace, class T>
+auto
+toView(std::string const & label, std::vector<T> const & v) -> Kokkos::View<T *, MemSpace>
+{
+  Kokkos::View<T *, HostMemSpace> const h(label, v.size());
+  for (size_t i = 0; i < v.size(); ++i) {
+    h(i) = v[i];
+  }
+  return Kokkos::create_mirror_view_and_copy(MemSpace(), h);
+}
+
+//----------------------------------------------------------------------------------------
+template <class T, class ExecSpace = DeviceExecSpace>
+class MirroredView
+{
+public:
+  using MemSpace = typename ExecSpace::memory_space;
+
+  // True if the host copy and the device copy are the same view
+  static constexpr bool aliased =
+      Kokkos::SpaceAccessibility<Kokkos::HostSpace, MemSpace>::accessible;
+
+  using DeviceView = Kokkos::View<T *, MemSpace>;
+  using HostView =
+      std::conditional_t<aliased, DeviceView, Kokkos::View<T *, HostPinnedSpace>>;
+
+private:
+  DeviceView _device;
+  HostView _host;
+
+public:
+  MirroredView() = default;
+
+  MirroredView(std::string const & label, Int const n)
+      : _device(label, static_cast<size_t>(n))
+  {
+    if constexpr (aliased) {
+      _host = _device;
+    } else {
+      _host = HostView(label + "_host", static_cast<size_t>(n));
+    }
+  }
+
+  [[nodiscard]] auto
+  device() const noexcept -> DeviceView const &
+  {
+    return _device;
+  }
+
+  [[nodiscard]] auto
+  host() const noexcept -> HostView const &
+  {
+    return _host;
+  }
+
+  [[nodiscard]] auto
+  size() const noexcept -> Int
+  {
+    return static_cast<Int>(_device.size());
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Enqueue a copy of the host data to the device on "space"
+  void
+  toDevice(ExecSpace const & space) const
+  {
+    if constexpr (!aliased) {
+      Kokkos::deep_copy(space, _device, _host);
+    }
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Enqueue a copy of the device data to the host on "space"
+  void
+  toHost(ExecSpace const & space) const
+  {
+    if constexpr (!aliased) {
+      Kokkos::deep_copy(space, _host, _device);
+    }
+  }
+};
+
+template <class T, class ExecSpace = DeviceExecSpace>
+class DoubleBufferedView
+{
+public:
+  using Buffer = MirroredView<T, ExecSpace>;
+  using HostView = typename Buffer::HostView;
+
+private:
+  Buffer _buffers[2];
+  ExecSpace _copy_space;        // transfers
+  ExecSpace _compute_spaces[2]; // kernels on each buffer
+  int32_t _front = 0;
+
+public:
+  DoubleBufferedView(std::string const & label, Int const n)
+      : _buffers{Buffer(label + "_0", n), Buffer(label + "_1", n)}
+  {
+    // On a GPU, each instance is a stream. On a host backend, partitioning would split
+    // the thread pool, so the kernels would run on a third of the threads; there is
+    // nothing to copy anyway, so every instance is the whole space.
+    if constexpr (!Buffer::aliased) {
+      auto const instances = Kokkos::Experimental::partition_space(ExecSpace(), 1, 1, 1);
+      _copy_space = instances[0];
+      _compute_spaces[0] = instances[1];
+      _compute_spaces[1] = instances[2];
+    }
+  }
+
+  //--------------------------------------------------------------------------------------
+  // The buffer that kernels read from
+  [[nodiscard]] auto
+  front() const noexcept -> Buffer const &
+  {
+    return _buffers[_front];
+  }
+
+  //--------------------------------------------------------------------------------------
+  // The execution space instance for kernels on the front buffer
+  [[nodiscard]] auto
+  computeSpace() const noexcept -> ExecSpace const &
+  {
+    return _compute_spaces[_front];
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Wait until the kernels on the back buffer are done, then return its host data for
+  // the next batch to be written to.
+  auto
+  acquireBack() -> HostView const &
+  {
+    int32_t const back = 1 - _front;
+    _compute_spaces[back].fence("juno::DoubleBufferedView::acquireBack");
+    return _buffers[back].host();
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Enqueue the upload of the back buffer. Does not wait.
+  void
+  beginUpload() const
+  {
+    _buffers[1 - _front].toDevice(_copy_space);
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Wait for the upload of the back buffer to finish, then exchange the buffers.
+  void
+  swap()
+  {
+    _copy_space.fence("juno::DoubleBufferedView::swap");
+    _front = 1 - _front;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Wait for all transfers and kernels on both buffers
+  void
+  fence() const
+  {
+    _copy_space.fence("juno::DoubleBufferedView::fence");
+    _compute_spaces[0].fence("juno::DoubleBufferedView::fence");
+    _compute_spaces[1].fence("juno::DoubleBufferedView::fence");
+  }
+};
+
+} // namespace juno
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <juno/common/logger.hpp>
+#include <juno/common/settings.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//========================================================================================
+// PROFILER
+//========================================================================================
+// A hierarchical profiler for host code.
+// The profiler:
+//  - times scopes with RAII timers. A timer that starts while another is running on
+//    the same thread is nested under it, so each thread builds a call tree.
+//  - is thread-aware. Each thread records into its own tree without synchronization.
+//    The trees are merged by call path when the profile is queried, and each node
+//    reports the number of threads that entered it.
+//  - can time Kokkos kernels and profiling regions (enableKokkosHooks()). Kernels
+//    appear under their label, e.g. "SinReduce". A kernel is timed from launch until
+//    the launch returns, which does not include asynchronous device execution unless
+//    the kernel is followed by a fence.
+//  - reports through the logger (report()).
+//  - is cheap: a timer costs two clock reads and a search of the children of the
+//    enclosing node, which is short after the first call. With "enabled" false, a
+//    timer costs a branch. With MAX_LOG_LEVEL < 3 the report is compiled out.
+//  - uses std::chrono::steady_clock, since the logger's clock may jump.
+//
+// Usage:
+// - PROFILE_SCOPE(name): time the rest of the enclosing scope under name
+// - juno::profiler::report(): log the merged call tree at the info level
+// report(), getProfile() and reset() must be called outside of parallel regions, and
+// reset() must not be called while a timer is running.
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b)      PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name)                                                              \
+  juno::profiler::ScopedTimer const PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+
+namespace juno::profiler
+{
+
+using Clock = std::chrono::steady_clock;
+using Duration = logger::Duration;
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+extern bool & enabled;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+// A node of the merged call tree. Nodes are stored in pre-order, so the children of a
+// node follow it, and the parent of a node precedes it.
+struct ProfileNode {
+  std::string name;
+  int32_t parent;  // index of the parent node, -1 for top-level nodes
+  int32_t depth;   // 0 for top-level nodes
+  uint64_t calls;  // summed over threads
+  Duration time;   // summed over threads
+  int32_t threads; // number of threads that entered the node
+};
+
+//----------------------------------------------------------------------------------------
+// Start a timer on the calling thread, nested under the running timer, if any.
+// Does not check "enabled". Every start must be matched by a stop on the same thread.
+void
+start(char const * name);
+
+//----------------------------------------------------------------------------------------
+// Stop the most recently started timer on the calling thread.
+void
+stop() noexcept;
+
+//----------------------------------------------------------------------------------------
+// RAII timer. If the profiler is disabled on construction, the timer does nothing.
+class ScopedTimer
+{
+  bool _started;
+
+public:
+  explicit ScopedTimer(char const * name)
+      : _started(enabled)
+  {
+    if (_started) {
+      start(name);
+    }
+  }
+
+  ~ScopedTimer()
+  {
+    if (_started) {
+      stop();
+    }
+  }
+
+  ScopedTimer(ScopedTimer const &) = delete;
+  ScopedTimer(ScopedTimer &&) = delete;
+  auto
+  operator=(ScopedTimer const &) -> ScopedTimer & = delete;
+  auto
+  operator=(ScopedTimer &&) -> ScopedTimer & = delete;
+};
+
+//----------------------------------------------------------------------------------------
+// Merge the call trees of all threads.
+auto
+getProfile() -> std::vector<ProfileNode>;
+
+//----------------------------------------------------------------------------------------
+// Log the merged call tree: for each node, the total time, the number of calls, the
+// mean time per call, and the percentage of the time of the parent. The time of a
+// top-level node is compared to the wall time since the last reset().
+void
+report();
+
+//----------------------------------------------------------------------------------------
+// Clear the recorded timings and reset the settings to their defaults.
+void
+reset();
+
+//----------------------------------------------------------------------------------------
+// Register callbacks with the Kokkos Tools interface, so that Kokkos kernels and
+// profiling regions are timed as nested scopes while the profiler is enabled.
+// Call after Kokkos::initialize. Replaces any callbacks set by a loaded Kokkos tool.
+void
+enableKokkosHooks();
+
+} // namespace juno::profiler
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+//========================================================================================
+// REDUCERS
+//========================================================================================
+// Accurate sums of Float data. The bulk data is stored in FloatStorage, which may be
+// float to halve the memory traffic, and summed in FloatAccum, which is double with
+// JUNO_ENABLE_MIXED_PRECISION. Where even that is not enough, or FloatAccum is float:
+//
+//  - CompensatedSum<T>: Kahan summation. The rounding error of each addition is kept in
+//    a compensation term and subtracted from the next addend, so the error of the sum
+//    is about 2 epsilon, independent of the number of terms. KahanSum<T, Space> is the
+//    Kokkos reducer of it, for parallel_reduce.
+//
+//  - pairwiseSum(label, x): the sum of a view in FloatAccum, in blocks that are summed
+//    as a tree, with the blocks combined by KahanSum. The error of the tree grows with
+//    the log of the block size instead of its size, and there is no per element
+//    compensation, so it is nearly as fast as a plain reduction.
+//
+// Fast math may reassociate (t - s) - y to (t - y) - s, and so fold the compensation of
+// Kahan summation away. The terms that must be rounded in order are hidden from the host
+// optimizer when __FAST_MATH__ is defined, as JUNO_ENABLE_FASTMATH does. Device
+// compilers do not reassociate additions, even with their fast math options.
+//
+// Usage:
+//   juno::CompensatedSum<FloatAccum> sum;
+//   Kokkos::parallel_reduce(
+//       "label", policy,
+//       KOKKOS_LAMBDA(Int const i, juno::CompensatedSum<FloatAccum> & s) { s += x(i); },
+//       juno::KahanSum<FloatAccum, HostMemSpace>(sum));
+//   FloatAccum const total = juno::pairwiseSum("label", x);
+
+namespace juno
+{
+
+namespace impl
+{
+
+// x, but opaque to the optimizer under fast math, so that it is rounded as written
+template <class T>
+HOSTDEV inline auto
+opaque(T x) noexcept -> T
+{
+#if defined(__FAST_MATH__) && !defined(__CUDA_ARCH__) && !defined(__HIP_DEVICE_COMPILE__)
+  __asm__("" : "+m"(x));
+#endif
+  return x;
+}
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+// A sum with the rounding error of its additions
+template <class T>
+struct CompensatedSum {
+  T sum = 0;
+  T compensation = 0; // the error of sum, which value() subtracts
+
+  HOSTDEV void
+  add(T const x) noexcept
+  {
+    T const y = x - compensation;
+    T const t = impl::opaque(sum + y);
+    compensation = impl::opaque(t - sum) - y;
+    sum = t;
+  }
+
+  HOSTDEV auto
+  operator+=(T const x) noexcept -> CompensatedSum &
+  {
+    add(x);
+    return *this;
+  }
+
+  HOSTDEV void
+  join(CompensatedSum const & other) noexcept
+  {
+    add(other.sum);
+    add(-other.compensation);
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  value() const noexcept -> T
+  {
+    return sum - compensation;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// The Kokkos reducer of CompensatedSum<T>, into a value on the host or a View in Space
+template <class T, class Space>
+class KahanSum
+{
+public:
+  using reducer = KahanSum;
+  using value_type = CompensatedSum<T>;
+  using result_view_type = Kokkos::View<value_type, Space, Kokkos::MemoryUnmanaged>;
+
+private:
+  result_view_type _value;
+  bool _references_scalar = false;
+
+public:
+  HOSTDEV explicit KahanSum(value_type & value)
+      : _value(&value),
+        _references_scalar(true)
+  {
+  }
+
+  HOSTDEV explicit KahanSum(result_view_type const & value)
+      : _value(value)
+  {
+  }
+
+  HOSTDEV void
+  join(value_type & dest, value_type const & src) const noexcept
+  {
+    dest.join(src);
+  }
+
+  HOSTDEV void
+  init(value_type & value) const noexcept
+  {
+    value = value_type();
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  reference() const noexcept -> value_type &
+  {
+    return *_value.data();
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  view() const noexcept -> result_view_type
+  {
+    return _value;
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  references_scalar() const noexcept -> bool
+  {
+    return _references_scalar;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// The sum of x, in FloatAccum, pairwise within blocks of 64 and compensated between
+// them. This waits for the device.
+template <class T, class MemSpace>
+auto
+pairwiseSum(char const * label, Kokkos::View<T *, MemSpace> const & x) -> FloatAccum
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Int constexpr leaf_size = 8;
+  Int constexpr num_leaves = 8; // a power of 2
+  Int constexpr block_size = leaf_size * num_leaves;
+  auto const n = static_cast<Int>(x.size());
+  Int const num_blocks = (n + block_size - 1) / block_size;
+  CompensatedSum<FloatAccum> sum;
+  Kokkos::parallel_reduce(
+      label, rangePolicy<ExecSpace>(0, num_blocks),
+      KOKKOS_LAMBDA(Int const b, CompensatedSum<FloatAccum> & s) {
+        // Short runs in order, then the tree of the runs
+        FloatAccum leaves[num_leaves] = {};
+        Int const begin = b * block_size;
+        Int const end = begin + block_size < n ? begin + block_size : n;
+        for (Int leaf = 0; leaf < num_leaves; ++leaf) {
+          Int const leaf_begin = begin + leaf * leaf_size;
+          Int const leaf_end = leaf_begin + leaf_size;
+          for (Int i = leaf_begin; i < (leaf_end < end ? leaf_end : end); ++i) {
+            leaves[leaf] += static_cast<FloatAccum>(x(i));
+          }
+        }
+        for (Int width = num_leaves / 2; width > 0; width /= 2) {
+          for (Int leaf = 0; leaf < width; ++leaf) {
+            leaves[leaf] = leaves[2 * leaf] + leaves[2 * leaf + 1];
+          }
+        }
+        s += leaves[0];
+      },
+      KahanSum<FloatAccum, Kokkos::HostSpace>(sum));
+  return sum.value();
+}
+
+} // namespace juno
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+//========================================================================================
+// SCAN
+//========================================================================================
+// Prefix sums for building CSR structures in parallel: each row counts its entries,
+// the scan of the counts gives the row offsets, and each row then fills its entries.
+//
+// The offsets are Int, for the cache density of the CSR structures, but the scan runs in
+// Size. So the total is exact even when the offsets overflow, and the caller can detect
+// that and split the work, e.g. into smaller batches of rays, instead of writing past
+// the end of its arrays.
+
+namespace juno
+{
+
+namespace impl
+{
+
+//----------------------------------------------------------------------------------------
+// An exclusive scan of counts into offsets, which has one more entry. Returns the total,
+// which is only valid as offsets if it is at most intMax().
+template <class MemSpace>
+auto
+exclusiveScan(Kokkos::View<Int *, MemSpace> const & counts,
+              Kokkos::View<Int *, MemSpace> const & offsets) -> Size
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  auto const n = static_cast<Int>(counts.size());
+  Size total = 0;
+  Kokkos::parallel_scan(
+      "juno::exclusiveScan", rangePolicy<ExecSpace>(0, n),
+      KOKKOS_LAMBDA(Int const i, Size & partial, bool const is_final) {
+        if (is_final) {
+          offsets(i) = static_cast<Int>(partial);
+        }
+        partial += counts(i);
+        if (is_final && i + 1 == n) {
+          offsets(n) = static_cast<Int>(partial);
+        }
+      },
+      total);
+  return total;
+}
+
+} // namespace impl
+
+} // namespace juno
@@ -2,6 +2,8 @@
 
 #include <juno/config.hpp>
 
+#include <string_view>
+
 //========================================================================================
 // SETTINGS
 //========================================================================================
@@ -19,18 +21,70 @@
 namespace juno::settings::logger
 {
 
+// Called with the message (without the preamble) when an error is logged under
+// error_policies::callback
+using ErrorCallback = void (*)(std::string_view message);
+
 namespace defaults
 {
 inline constexpr int32_t level = 3; // 3 == info
 inline constexpr bool timestamped = true;
 inline constexpr bool colorized = true;
+inline constexpr bool asynchronous = false;
+inline constexpr int32_t float_precision = 6; // < 0 == shortest round-trip
+inline constexpr int32_t rank_filter = 0;     // 0 == all ranks
+inline constexpr int32_t rank_stride = 1;
+inline constexpr bool aggregated = false;
+inline constexpr int32_t error_policy = 0; // 0 == fatal
+inline constexpr ErrorCallback error_callback = nullptr;
 } // namespace defaults
 
 // Global settings
 extern int32_t level;
 extern bool timestamped;
 extern bool colorized;
+extern bool asynchronous;
+extern int32_t float_precision;
+extern int32_t rank_filter;
+extern int32_t rank_stride;
+extern bool aggregated;
+extern int32_t error_policy;
+extern ErrorCallback error_callback;
 
 } // namespace juno::settings::logger
 
+//========================================================================================
+// PROFILER
+//========================================================================================
+
+namespace juno::settings::profiler
+{
+
+namespace defaults
+{
+inline constexpr bool enabled = false;
+} // namespace defaults
+
+// Global settings
+extern bool enabled;
+
+} // namespace juno::settings::profiler
+
+//========================================================================================
+// MPI
+//========================================================================================
+
+namespace juno::settings::mpi
+{
+
+namespace defaults
+{
+inline constexpr int32_t gpu_aware = -1; // -1 == detect, 0 == no, 1 == yes
+} // namespace defaults
+
+// Global settings
+extern int32_t gpu_aware;
+
+} // namespace juno::settings::mpi
+
 // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
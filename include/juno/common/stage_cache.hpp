@@ -0,0 +1,282 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/hash.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <cstring> // std::memcpy
+#include <string>
+#include <type_traits>
+#include <utility> // std::move
+#include <vector>
+
+//========================================================================================
+// STAGE CACHE
+//========================================================================================
+// A directory of the results of the stages of a pipeline (e.g. importing a mesh,
+// reordering it, indexing it, mixing the cross sections of the materials, and laying
+// out the tracks), addressed by the hashes of their inputs, so that a run whose inputs
+// only partly changed re-runs only the stages whose inputs did.
+//
+// The key of a stage hashes everything its result depends on: the name of the stage,
+// its parameters, and the keys of the stages it reads (or the hashes of the files it
+// reads). So a change of any input changes the keys of the stages downstream of it,
+// and only those miss. E.g. changing the composition of a material changes the key of
+// the mixing, but not of the mesh or the tracks. Since nothing is overwritten, going
+// back to earlier inputs hits again.
+//
+// Each result is a file, <directory>/<stage>-<key in hex>.stage:
+//  - a header with a version, the sizes of Float and Int, the key, and a hash of the
+//    contents, so that a file from another build or a damaged file is a miss.
+//  - the contents: the values written by a StageWriter, read back in the same order
+//    by a StageReader.
+//  - written to a temporary file which then replaces the destination, so a reader never
+//    sees a partly written result, even from a concurrent run.
+// Results that have their own file format, such as a MeshCache, can be stored at
+// filename(stage, key) instead.
+//
+// A StageCache with no directory is disabled: every stage misses, and nothing is
+// written.
+//
+// Usage:
+//   juno::StageCache const cache("cache");
+//   uint64_t const key = juno::stageKey("mix", {library_hash, composition_hash});
+//   auto reader = cache.read("mix", key);
+//   if (reader.ok()) {
+//     xs = readXS(reader);
+//   } else {
+//     xs = mix(...);
+//     juno::StageWriter writer;
+//     writeXS(writer, xs);
+//     cache.write("mix", key, writer);
+//   }
+
+namespace juno
+{
+
+namespace stage_cache
+{
+inline constexpr uint32_t version = 1;
+} // namespace stage_cache
+
+//----------------------------------------------------------------------------------------
+// The key of a stage: the hash of its name and of its inputs, in order
+auto
+stageKey(std::string const & stage, std::vector<uint64_t> const & inputs) -> uint64_t;
+
+// The hash of a value, such as a parameter, by its bytes
+template <class T>
+[[nodiscard]] auto
+hashValue(T const & value) -> uint64_t
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  return hashBytes(&value, sizeof(T));
+}
+
+[[nodiscard]] inline auto
+hashString(std::string const & s) -> uint64_t
+{
+  return hashCombine(hashBytes(s.data(), s.size()), s.size());
+}
+
+//----------------------------------------------------------------------------------------
+// The contents of a stage result, as values and arrays of trivially copyable types
+class StageWriter
+{
+  std::vector<char> _bytes;
+
+  void
+  append(void const * data, size_t bytes);
+
+public:
+  [[nodiscard]] auto
+  bytes() const noexcept -> std::vector<char> const &
+  {
+    return _bytes;
+  }
+
+  template <class T>
+  void
+  write(T const & value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    append(&value, sizeof(T));
+  }
+
+  // A size, then the values
+  template <class T>
+  void
+  writeArray(T const * const data, size_t const n)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    write(static_cast<uint64_t>(n));
+    append(data, n * sizeof(T));
+  }
+
+  template <class T>
+  void
+  writeVector(std::vector<T> const & values)
+  {
+    writeArray(values.data(), values.size());
+  }
+
+  template <class T, class... Properties>
+  void
+  writeView(Kokkos::View<T *, Properties...> const & view)
+  {
+    writeArray(view.data(), view.size());
+  }
+
+  void
+  writeString(std::string const & s)
+  {
+    writeArray(s.data(), s.size());
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Reads the values of a StageWriter back, in order. Reading past the end, or an array
+// of the wrong size, makes the reader not ok() and returns zeros; check ok() once all
+// the values are read.
+class StageReader
+{
+  std::vector<char> _bytes;
+  size_t _position = 0;
+  bool _ok = false;
+
+  // The position of the next n bytes, or -1 if there are not that many
+  auto
+  take(size_t bytes) -> int64_t;
+
+public:
+  StageReader() = default;
+
+  explicit StageReader(std::vector<char> bytes)
+      : _bytes(std::move(bytes)),
+        _ok(true)
+  {
+  }
+
+  // Whether the result was found, and every value read so far was there
+  [[nodiscard]] auto
+  ok() const noexcept -> bool
+  {
+    return _ok;
+  }
+
+  // Whether every value was read
+  [[nodiscard]] auto
+  atEnd() const noexcept -> bool
+  {
+    return _position == _bytes.size();
+  }
+
+  template <class T>
+  auto
+  read() -> T
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    auto const at = take(sizeof(T));
+    if (at >= 0) {
+      std::memcpy(&value, _bytes.data() + at, sizeof(T));
+    }
+    return value;
+  }
+
+  template <class T>
+  auto
+  readVector() -> std::vector<T>
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto const n = read<uint64_t>();
+    if (!_ok || n > (_bytes.size() - _position) / sizeof(T)) {
+      _ok = false;
+      return {};
+    }
+    std::vector<T> values(static_cast<size_t>(n));
+    std::memcpy(values.data(), _bytes.data() + take(n * sizeof(T)), n * sizeof(T));
+    return values;
+  }
+
+  template <class T>
+  auto
+  readView(std::string const & label) -> Kokkos::View<T *, HostMemSpace>
+  {
+    auto const values = readVector<T>();
+    Kokkos::View<T *, HostMemSpace> view(
+        Kokkos::view_alloc(Kokkos::WithoutInitializing, label), values.size());
+    if (!values.empty()) {
+      std::memcpy(view.data(), values.data(), values.size() * sizeof(T));
+    }
+    return view;
+  }
+
+  // Read an array into an existing host View, which must have the size that was written
+  template <class T, class... Properties>
+  void
+  readInto(Kokkos::View<T *, Properties...> const & view)
+  {
+    auto const values = readVector<T>();
+    if (values.size() != view.size()) {
+      _ok = false;
+      return;
+    }
+    if (!values.empty()) {
+      std::memcpy(view.data(), values.data(), values.size() * sizeof(T));
+    }
+  }
+
+  auto
+  readString() -> std::string
+  {
+    auto const chars = readVector<char>();
+    return {chars.begin(), chars.end()};
+  }
+};
+
+//----------------------------------------------------------------------------------------
+class StageCache
+{
+  std::string _directory;
+
+public:
+  StageCache() = default;
+
+  // Creates the directory if it does not exist. Logs an error, and is disabled, if it
+  // cannot be created.
+  explicit StageCache(std::string directory);
+
+  [[nodiscard]] auto
+  enabled() const noexcept -> bool
+  {
+    return !_directory.empty();
+  }
+
+  [[nodiscard]] auto
+  directory() const noexcept -> std::string const &
+  {
+    return _directory;
+  }
+
+  // The file of the result of a stage
+  [[nodiscard]] auto
+  filename(std::string const & stage, uint64_t key) const -> std::string;
+
+  // The result of a stage, or a reader that is not ok() if it is not cached, or the
+  // file is from another build or damaged. The reason is logged at the info level,
+  // since a miss is expected.
+  [[nodiscard]] auto
+  read(std::string const & stage, uint64_t key) const -> StageReader;
+
+  // Store the result of a stage. Logs an error and returns false if it cannot be
+  // written; the pipeline still has the result, so a failed write only costs a miss.
+  auto
+  write(std::string const & stage, uint64_t key, StageWriter const & writer) const
+      -> bool;
+};
+
+} // namespace juno
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <juno/config.hpp>
+
+#include <string>
+#include <vector>
+
+//========================================================================================
+// TASK SCHEDULER
+//========================================================================================
+// Host-side scheduling of work whose cost varies from element to element, e.g. the
+// cells of a model that mixes pin cells of very different face counts. A flat
+// rangePolicy with static scheduling gives each thread the same number of elements, so
+// the threads that get the expensive ones finish last while the others wait.
+//
+// The scheduler:
+//  - splits the elements into contiguous partitions of about equal estimated cost
+//    (partitionByCost). Partitions are contiguous so that each thread keeps working on
+//    nearby memory, e.g. after the mesh has been reordered along a space-filling curve.
+//  - gives each thread a contiguous run of partitions of about equal cost, then lets
+//    threads that run out steal partitions from the other end of the others' runs.
+//    Each run is a range of task indices in a single atomic word, so the owner and the
+//    thieves claim tasks with one compare-and-swap and never lock. Stealing corrects
+//    for costs that were estimated wrongly.
+//  - measures the time each thread spends in tasks, and logs the load imbalance (the
+//    busiest thread's time over the mean) at the debug level. The LoadBalance of a run
+//    is also returned, for logLoadBalance or for tuning the costs.
+//
+// The threads are OpenMP threads, like those of the Kokkos host backend. For uniform
+// work, or on the device, use rangePolicy, or dynamicRangePolicy when the cost varies
+// but does not need to be estimated.
+//
+// Usage:
+//   std::vector<double> costs(num_faces);  // e.g. the number of edges of each face
+//   auto const balance = juno::parallelForWeighted("sweep", costs, [&](Int const i) {
+//     ...
+//   });
+//   juno::logLoadBalance("sweep", balance);
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+// How the work of a run was spread over the threads
+struct LoadBalance {
+  std::vector<double> busy_seconds; // per thread, the time spent in tasks
+  std::vector<Int> num_tasks;       // per thread
+  Int num_steals = 0;
+
+  // The busy time of the busiest thread over the mean busy time: 1 when perfectly
+  // balanced, and at most the number of threads
+  [[nodiscard]] auto
+  imbalance() const noexcept -> double;
+};
+
+// Log the imbalance, the steals, and the busy time of each thread, at the info level
+void
+logLoadBalance(std::string const & label, LoadBalance const & balance);
+
+//----------------------------------------------------------------------------------------
+// Split the elements into num_parts contiguous ranges of about equal total cost, and
+// return the num_parts + 1 offsets of the ranges. Costs must be nonnegative. Ranges
+// may be empty when there are fewer elements than parts, or a few costly ones.
+auto
+partitionByCost(std::vector<double> const & costs, Int num_parts) -> std::vector<Int>;
+
+namespace impl
+{
+
+using TaskFunction = void (*)(void const * context, Int task);
+
+auto
+runTasks(std::string const & label, std::vector<double> const & costs,
+         TaskFunction f, void const * context) -> LoadBalance;
+
+// The number of host threads that runTasks uses
+auto
+numTaskThreads() noexcept -> Int;
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+// Run f(t) for each task t in [0, costs.size()) on the host threads, with work
+// stealing. costs[t] is the estimated cost of task t, in any unit.
+template <class F>
+auto
+runTasks(std::string const & label, std::vector<double> const & costs, F const & f)
+    -> LoadBalance
+{
+  return impl::runTasks(
+      label, costs,
+      [](void const * context, Int const t) { (*static_cast<F const *>(context))(t); },
+      &f);
+}
+
+//----------------------------------------------------------------------------------------
+// Run f(i) for each element i in [0, costs.size()) on the host threads, in partitions
+// of about equal cost, tasks_per_thread per thread, with work stealing. More tasks per
+// thread balance better, at the cost of more scheduling.
+template <class F>
+auto
+parallelForWeighted(std::string const & label, std::vector<double> const & costs,
+                    F const & f, Int const tasks_per_thread = 8) -> LoadBalance
+{
+  auto const offsets = partitionByCost(costs, impl::numTaskThreads() * tasks_per_thread);
+  std::vector<double> task_costs(offsets.size() - 1, 0);
+  for (size_t t = 0; t < task_costs.size(); ++t) {
+    for (Int i = offsets[t]; i < offsets[t + 1]; ++i) {
+      task_costs[t] += costs[static_cast<size_t>(i)];
+    }
+  }
+  return runTasks(label, task_costs, [&](Int const t) {
+    auto const task = static_cast<size_t>(t);
+    for (Int i = offsets[task]; i < offsets[task + 1]; ++i) {
+      f(i);
+    }
+  });
+}
+
+} // namespace juno
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <string>
+
+//========================================================================================
+// GMSH IO
+//========================================================================================
+// Read meshes in the Gmsh MSH 4.1 ASCII format into a PolytopeSoup.
+//
+// The reader is built for multi-GB files:
+//  - The file is memory-mapped, not read into a buffer.
+//  - The $Nodes and $Elements sections are split into chunks of whole lines. The lines
+//    of each chunk are counted in parallel; then the block headers are found from the
+//    counts, so the position of every node and element is known before any is parsed.
+//  - The chunks are then parsed in parallel with OpenMP and std::from_chars, writing
+//    the coordinates and connectivity directly into the Views of the soup.
+//
+// Conversions:
+//  - Only the elements of the highest dimension in the file are read (e.g. the faces of
+//    a 2D mesh), in the order of the file. Lower-dimensional elements, such as the
+//    lines of a boundary, are skipped.
+//  - Gmsh element types are converted to VTK types (see vtk_types). The node orderings
+//    of the supported types are the same in Gmsh and VTK.
+//  - Nodes are numbered in the order of the file, whatever their Gmsh tags.
+//  - Each physical group of the highest dimension becomes an element set, named after
+//    the group, or after its tag if it is unnamed.
+//
+// Errors (an unsupported format or element type, a malformed line, a node tag that
+// does not exist) are logged with the line number, and an empty soup is returned, if
+// the error policy returns.
+
+namespace juno
+{
+
+auto
+readGmshFile(std::string const & filename) -> PolytopeSoup<HostMemSpace>;
+
+} // namespace juno
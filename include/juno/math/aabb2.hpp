@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/vec2.hpp>
+
+#include <cstdint>
+
+//========================================================================================
+// AABB2
+//========================================================================================
+// A 2D axis-aligned bounding box, usable in host and device code. The default box is
+// empty (min > max), so that growing it by any point gives the box of that point.
+// The sides of a box are numbered counterclockwise from the bottom (box_sides).
+
+namespace juno
+{
+
+// Larger than any coordinate, but finite, so that it is well-behaved under fast math
+inline constexpr Float infinite_distance = static_cast<Float>(1e30);
+
+struct AABB2 {
+  Vec2 min = {infinite_distance, infinite_distance};
+  Vec2 max = {-infinite_distance, -infinite_distance};
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  isEmpty() const noexcept -> bool
+  {
+    return min.x > max.x || min.y > max.y;
+  }
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  width() const noexcept -> Float
+  {
+    return max.x - min.x;
+  }
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  height() const noexcept -> Float
+  {
+    return max.y - min.y;
+  }
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  centroid() const noexcept -> Vec2
+  {
+    return {(min.x + max.x) / 2, (min.y + max.y) / 2};
+  }
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  contains(Vec2 const p) const noexcept -> bool
+  {
+    return min.x <= p.x && p.x <= max.x && min.y <= p.y && p.y <= max.y;
+  }
+
+  HOSTDEV constexpr void
+  grow(Vec2 const p) noexcept
+  {
+    min.x = p.x < min.x ? p.x : min.x;
+    min.y = p.y < min.y ? p.y : min.y;
+    max.x = p.x > max.x ? p.x : max.x;
+    max.y = p.y > max.y ? p.y : max.y;
+  }
+
+  HOSTDEV constexpr void
+  grow(AABB2 const & box) noexcept
+  {
+    if (box.isEmpty()) {
+      return;
+    }
+    grow(box.min);
+    grow(box.max);
+  }
+};
+
+// The sides of a box, counterclockwise
+namespace box_sides
+{
+inline constexpr int32_t bottom = 0;
+inline constexpr int32_t right = 1;
+inline constexpr int32_t top = 2;
+inline constexpr int32_t left = 3;
+inline constexpr int32_t count = 4;
+} // namespace box_sides
+
+// The side across the box from a side
+HOSTDEV constexpr auto
+oppositeSide(int32_t const side) noexcept -> int32_t
+{
+  return (side + 2) % box_sides::count;
+}
+
+} // namespace juno
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <juno/config.hpp>
+
+//========================================================================================
+// EXACT FLOATING POINT COMPARISONS
+//========================================================================================
+// The build enables -Wfloat-equal, since comparing computed values exactly is almost
+// always a bug: they should be compared with a tolerance. An exact comparison is only
+// right where a value is tested against one it may have been set to, rather than
+// computed, such as a zero denominator before a division, or an axis-aligned direction.
+// These helpers are the one place that compares floats exactly, so every such test in
+// the code is explicit.
+//
+// Usage:
+//   if (juno::isZero(denom)) { return -1; }
+//   juno::exactlyEqual(a, b)
+//
+// In tests, compare with ASSERT_NEAR and an explicit tolerance instead.
+
+namespace juno
+{
+
+#if defined(__GNUC__) || defined(__clang__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wfloat-equal"
+#endif
+
+HOSTDEV constexpr auto
+exactlyEqual(float const a, float const b) noexcept -> bool
+{
+  return a == b;
+}
+
+HOSTDEV constexpr auto
+exactlyEqual(double const a, double const b) noexcept -> bool
+{
+  return a == b;
+}
+
+HOSTDEV constexpr auto
+isZero(float const a) noexcept -> bool
+{
+  return a == 0;
+}
+
+HOSTDEV constexpr auto
+isZero(double const a) noexcept -> bool
+{
+  return a == 0;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#  pragma GCC diagnostic pop
+#endif
+
+} // namespace juno
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/reducers.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm>   // std::max
+#include <cmath>       // std::exp, std::log, std::sqrt, std::ceil
+#include <cstdint>     // uint32_t, uint64_t
+#include <cstring>     // std::memcpy
+#include <limits>      // std::numeric_limits
+#include <type_traits> // std::conditional_t
+#include <utility>     // std::move
+
+//========================================================================================
+// EXPONENTIAL
+//========================================================================================
+// Fast exponentials for kernels, in Float precision, for the attenuation 1 - exp(-tau)
+// of the transport sweeps. The library exp is accurate to an ulp and handles every
+// input, which makes it slow, and hard for the compiler to vectorize. There are two
+// alternatives, each a function object that computes exp(x), usable in host and device
+// code:
+//
+//  - RationalExp<Order>: range reduction x = k ln(2) + r, with |r| <= ln(2) / 2, then
+//    the [Order / Order] Pade approximant of exp(r), and the exponent of 2^k set in the
+//    bits of the result. No memory accesses and one division, so it vectorizes. The
+//    relative error is at most rationalExpError(Order), for finite x. Results below
+//    the smallest normal number are zero, and above the largest finite number saturate.
+//    rationalExpOrder(tolerance) is the lowest order for a relative error bound.
+//
+//  - ExpTable<MemSpace>: exp(x) for x <= 0 by linear interpolation in a table of
+//    slopes and intercepts, in MemSpace. For an absolute error bound e, the spacing is
+//    sqrt(8 e), since the error of linear interpolation is at most h^2 / 8 times the
+//    largest second derivative, 1, and the table ends at -ln(e), beyond which exp(x)
+//    is taken to be 0. That is a few thousand entries for e = 1e-6. One multiply and
+//    add, but a gather from the table, which suits GPUs better than SIMD units.
+//
+// For x <= 0, both errors are absolute errors of 1 - exp(x) too.
+//
+// Usage:
+//   juno::RationalExp<juno::rationalExpOrder(1e-7)> const exp;
+//   auto const table = juno::makeExpTable<MemSpace>(1e-6);
+//   ... = 1 - exp(-tau);  // or table(-tau)
+
+namespace juno
+{
+
+namespace impl
+{
+
+// The coefficients of the [n / n] Pade approximant of exp(r), whose numerator is
+//   P(r) = sum_j c_j r^j, c_j = (2n - j)! n! / ((2n)! j! (n - j)!)
+// and denominator P(-r). Computed rather than tabulated, so that device code can fold
+// them without reading a host array.
+HOSTDEV constexpr auto
+padeExpCoefficient(Int const n, Int const j) noexcept -> double
+{
+  double c = 1;
+  for (Int i = 1; i <= j; ++i) {
+    c = c * static_cast<double>(n - i + 1) / static_cast<double>(i * (2 * n - i + 1));
+  }
+  return c;
+}
+
+// The largest relative error of the approximants on |r| <= ln(2) / 2, in exact
+// arithmetic
+inline constexpr double pade_exp_error[4] = {7.0e-6, 6.0e-9, 2.9e-12, 1.4e-15};
+
+using FloatBits = std::conditional_t<sizeof(Float) == 4, uint32_t, uint64_t>;
+
+} // namespace impl
+
+inline constexpr Int min_rational_exp_order = 2;
+inline constexpr Int max_rational_exp_order = 5;
+
+//----------------------------------------------------------------------------------------
+// The bound on the relative error of RationalExp<order>, with the rounding of Float
+constexpr auto
+rationalExpError(Int const order) noexcept -> double
+{
+  return impl::pade_exp_error[order - min_rational_exp_order] +
+         4 * static_cast<double>(std::numeric_limits<Float>::epsilon());
+}
+
+// The lowest order whose relative error is within the tolerance, or the highest order
+constexpr auto
+rationalExpOrder(double const tolerance) noexcept -> Int
+{
+  Int order = min_rational_exp_order;
+  while (order < max_rational_exp_order && rationalExpError(order) > tolerance) {
+    ++order;
+  }
+  return order;
+}
+
+//----------------------------------------------------------------------------------------
+template <Int Order>
+struct RationalExp {
+  static_assert(min_rational_exp_order <= Order && Order <= max_rational_exp_order);
+
+  [[nodiscard]] HOSTDEV auto
+  operator()(Float const x) const noexcept -> Float
+  {
+    using Bits = impl::FloatBits;
+    Int constexpr mantissa_bits = std::numeric_limits<Float>::digits - 1;
+    Int constexpr bias = std::numeric_limits<Float>::max_exponent - 1;
+    Int constexpr min_k = std::numeric_limits<Float>::min_exponent - 1;
+    Int constexpr max_k = std::numeric_limits<Float>::max_exponent - 1;
+    // ln(2) in two parts, so that k * ln2_hi is exact (Cody and Waite). Fast math would
+    // fold the two subtractions into one by ln(2), so the first is kept opaque.
+    bool constexpr single = sizeof(Float) == 4;
+    auto constexpr ln2_hi =
+        static_cast<Float>(single ? 0.693145751953125 : 6.93147180369123816490e-01);
+    auto constexpr ln2_lo =
+        static_cast<Float>(single ? 1.428606765330187045e-06 : 1.9082149292705877e-10);
+    auto constexpr log2e = static_cast<Float>(1.44269504088896340736);
+    auto constexpr lo = static_cast<Float>(min_k * 0.69314718055994530942);
+    auto constexpr hi = static_cast<Float>(max_k * 0.69314718055994530942);
+
+    Float const y = x < lo ? lo : (x > hi ? hi : x);
+    Float const t = y * log2e;
+    auto const k = static_cast<Int>(t < 0 ? t - static_cast<Float>(0.5)
+                                          : t + static_cast<Float>(0.5));
+    Float const kf = static_cast<Float>(k);
+    Float const r = impl::opaque(y - kf * ln2_hi) - kf * ln2_lo;
+
+    // P(r) = even(r^2) + r odd(r^2), and exp(r) = P(r) / P(-r)
+    auto constexpr c = [](Int const j) {
+      return static_cast<Float>(impl::padeExpCoefficient(Order, j));
+    };
+    Float const r2 = r * r;
+    Float even = c(Order - (Order % 2));
+    for (Int j = Order - (Order % 2) - 2; j >= 0; j -= 2) {
+      even = even * r2 + c(j);
+    }
+    Float odd = c(Order - 1 + (Order % 2));
+    for (Int j = Order - 1 + (Order % 2) - 2; j >= 1; j -= 2) {
+      odd = odd * r2 + c(j);
+    }
+    odd *= r;
+    Float const er = (even + odd) / (even - odd);
+
+    // 2^k, from its bits
+    Bits const bits = static_cast<Bits>(k + bias) << mantissa_bits;
+    Float scale;
+    std::memcpy(&scale, &bits, sizeof(Float));
+    return x < lo ? 0 : er * scale;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace = HostMemSpace>
+class ExpTable
+{
+  // For each interval i: intercept and slope, so that exp(x) = a_i + b_i x
+  Kokkos::View<Float *, MemSpace> _coefficients;
+  Float _inv_spacing = 0;
+  Int _num_intervals = 0;
+  Float _tolerance = 0;
+
+public:
+  ExpTable() = default;
+
+  ExpTable(Kokkos::View<Float *, MemSpace> coefficients, Float const inv_spacing,
+           Float const tolerance)
+      : _coefficients(std::move(coefficients)),
+        _inv_spacing(inv_spacing),
+        _num_intervals(static_cast<Int>(_coefficients.size() / 2)),
+        _tolerance(tolerance)
+  {
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  numIntervals() const noexcept -> Int
+  {
+    return _num_intervals;
+  }
+
+  // The bound on the absolute error
+  [[nodiscard]] HOSTDEV auto
+  tolerance() const noexcept -> Float
+  {
+    return _tolerance;
+  }
+
+  // exp(x), for x <= 0. A positive x is clamped to the first interval, so it reads
+  // inside the table, but the result is only the extrapolation of that interval.
+  [[nodiscard]] HOSTDEV auto
+  operator()(Float const x) const noexcept -> Float
+  {
+    Float const u = x < 0 ? -x * _inv_spacing : 0;
+    if (!(u < static_cast<Float>(_num_intervals))) {
+      return 0;
+    }
+    auto const i = static_cast<Int>(u);
+    return _coefficients(2 * i) + _coefficients(2 * i + 1) * x;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// A table of exp(x) for x <= 0, with an absolute error of at most tolerance. Logs an
+// error and returns an empty table if the tolerance is 1 or more, or so small that the
+// table would be too large or the rounding of Float would exceed it.
+template <class MemSpace>
+auto
+makeExpTable(double const tolerance) -> ExpTable<MemSpace>
+{
+  double const min_tolerance =
+      std::max(1e-10, 8 * static_cast<double>(std::numeric_limits<Float>::epsilon()));
+  if (!(min_tolerance <= tolerance && tolerance < 1)) {
+    LOG_ERROR("makeExpTable: the tolerance must be less than 1, and at least 1e-10 and 8 "
+              "times the machine epsilon");
+    return {};
+  }
+  // Leave room for the rounding of the evaluation
+  double const interpolation_tolerance =
+      tolerance - 4 * static_cast<double>(std::numeric_limits<Float>::epsilon());
+  double const spacing = std::sqrt(8 * interpolation_tolerance);
+  double const end = -std::log(tolerance);
+  auto const num_intervals = static_cast<Int>(std::ceil(end / spacing));
+
+  Kokkos::View<Float *, HostMemSpace> const host("juno::ExpTable",
+                                                 2 * static_cast<size_t>(num_intervals));
+  for (Int i = 0; i < num_intervals; ++i) {
+    // The chord of exp over [x1, x0], with x0 = -i spacing
+    double const x0 = -spacing * static_cast<double>(i);
+    double const x1 = -spacing * static_cast<double>(i + 1);
+    double const slope = (std::exp(x0) - std::exp(x1)) / spacing;
+    host(2 * i) = static_cast<Float>(std::exp(x0) - slope * x0);
+    host(2 * i + 1) = static_cast<Float>(slope);
+  }
+  auto const coefficients = Kokkos::create_mirror_view_and_copy(MemSpace(), host);
+  return {coefficients, static_cast<Float>(1 / spacing), static_cast<Float>(tolerance)};
+}
+
+} // namespace juno
@@ -0,0 +1,450 @@
+#pragma once
+
+#include <juno/common/arena.hpp>
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/config.hpp>
+#include <juno/math/compare.hpp>
+#include <juno/math/preconditioners.hpp>
+#include <juno/math/sparse_matrix.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath>   // std::sqrt, std::abs
+#include <utility> // std::make_pair
+
+//========================================================================================
+// KRYLOV SOLVERS
+//========================================================================================
+// Preconditioned iterative solvers for sparse, nonsymmetric systems A x = b:
+//  - bicgstab: BiCGStab, with right preconditioning. Two products with A, and two
+//    applications of M^-1, per iteration, and a fixed amount of memory.
+//  - gmres: restarted GMRES(m), with right preconditioning and modified Gram-Schmidt.
+//    Minimizes the residual over the Krylov space of each cycle, so it converges more
+//    smoothly, at the cost of m + 1 basis vectors.
+//
+// The matrix may be a CSRMatrix or a SlicedELLMatrix, and the preconditioner any of
+// preconditioners.hpp. Everything runs on MemSpace, and stays there:
+//  - The scalars of the iteration, e.g. the dot products and the Hessenberg matrix of
+//    GMRES, are Views in MemSpace. Dot products reduce into them, and the kernels that
+//    use them read them on the device. The small dense work of each iteration, such as
+//    the Givens rotations, is a kernel with a single thread.
+//  - The scalars, and the dot products and matrix-vector products, accumulate in
+//    FloatAccum, while the vectors are stored in Float. With mixed precision, that is
+//    a double residual and Hessenberg matrix at the memory traffic of float vectors.
+//  - So there is no transfer to the host, nor a wait for the device, per iteration.
+//    The residual norm is copied to the host only to test for convergence: every
+//    check_interval iterations, and at each restart of GMRES.
+//  - The vectors and scalars are carved from an Arena, so that a solve is at most one
+//    allocation. An outer iteration that solves each iteration, as CMFD does, can pass
+//    its own arena and reset it after the solve, so that the solves allocate nothing
+//    once the arena has grown to fit them.
+//
+// Convergence is on the relative residual |b - A x| / |b| <= tolerance. The result
+// reports the true residual of x for GMRES, and the recurrence residual for BiCGStab.
+//
+// Usage:
+//   auto const m = juno::makeILU0Preconditioner(a);
+//   auto const result = juno::gmres(a, m, b, x, {.tolerance = 1e-8});
+//   auto const result = juno::gmres(a, m, b, x, arena, {.tolerance = 1e-8});
+// where x holds the initial guess.
+
+namespace juno
+{
+
+struct KrylovOptions {
+  Float tolerance = static_cast<Float>(1e-6);
+  Int max_iterations = 1000;
+  Int restart = 30;       // the basis size of GMRES
+  Int check_interval = 5; // iterations between convergence checks
+};
+
+struct KrylovResult {
+  Int iterations = 0;
+  Float residual = 0; // relative to |b|
+  bool converged = false;
+};
+
+namespace impl
+{
+
+template <class MemSpace>
+using Scalar = Kokkos::View<FloatAccum, MemSpace>;
+
+//----------------------------------------------------------------------------------------
+// result = (x, y), in MemSpace
+template <class MemSpace>
+void
+dot(Kokkos::View<Float *, MemSpace> const & x, Kokkos::View<Float *, MemSpace> const & y,
+    Scalar<MemSpace> const & result)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Kokkos::parallel_reduce(
+      "juno::dot", rangePolicy<ExecSpace>(0, static_cast<Int>(x.size())),
+      KOKKOS_LAMBDA(Int const i, FloatAccum & sum) {
+        sum += static_cast<FloatAccum>(x(i)) * static_cast<FloatAccum>(y(i));
+      },
+      result);
+}
+
+// Call f(), once, on MemSpace
+template <class MemSpace, class F>
+void
+single(char const * label, F const & f)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Kokkos::parallel_for(label, rangePolicy<ExecSpace>(0, 1), KOKKOS_LAMBDA(Int) { f(); });
+}
+
+// a / b, or 0 if b is 0, so that a breakdown stalls the iteration instead of filling
+// the vectors with NaN
+HOSTDEV constexpr auto
+safeDivide(FloatAccum const a, FloatAccum const b) noexcept -> FloatAccum
+{
+  return isZero(b) ? 0 : a / b;
+}
+
+//----------------------------------------------------------------------------------------
+// r = b - A x
+template <class Matrix, class MemSpace>
+void
+residual(Matrix const & a, Kokkos::View<Float *, MemSpace> const & b,
+         Kokkos::View<Float *, MemSpace> const & x,
+         Kokkos::View<Float *, MemSpace> const & r)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Kokkos::parallel_for(
+      "juno::residual", rangePolicy<ExecSpace>(0, a.num_rows),
+      KOKKOS_LAMBDA(Int const i) {
+        r(i) = static_cast<Float>(static_cast<FloatAccum>(b(i)) - a.rowDot(i, x));
+      });
+}
+
+// The norm of x, on the host. This waits for the device.
+template <class MemSpace>
+auto
+norm(Kokkos::View<Float *, MemSpace> const & x, Scalar<MemSpace> const & work) -> Float
+{
+  dot(x, x, work);
+  FloatAccum sum = 0;
+  Kokkos::deep_copy(sum, work);
+  return static_cast<Float>(std::sqrt(sum));
+}
+
+// The arena bytes of bicgstab and gmres
+template <class MemSpace>
+constexpr auto
+bicgstabBytes(Int const n) noexcept -> size_t
+{
+  using A = Arena<MemSpace>;
+  return 7 * A::template bytes<Float>(static_cast<size_t>(n)) +
+         A::template bytes<FloatAccum>(9);
+}
+
+template <class MemSpace>
+constexpr auto
+gmresBytes(Int const n, Int const restart) noexcept -> size_t
+{
+  using A = Arena<MemSpace>;
+  auto const m = static_cast<size_t>(restart);
+  auto const size = static_cast<size_t>(n);
+  return A::template bytes<Float>((m + 1) * size) + 2 * A::template bytes<Float>(size) +
+         A::template bytes<FloatAccum>((m + 1) * m) +
+         3 * A::template bytes<FloatAccum>(m) + A::template bytes<FloatAccum>(m + 1) +
+         A::template bytes<FloatAccum>(2);
+}
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+// Solve A x = b with BiCGStab, from the initial guess in x, with the workspace from the
+// arena. The arena is not reset.
+template <class Matrix, class Preconditioner, class MemSpace>
+auto
+bicgstab(Matrix const & a, Preconditioner const & m,
+         Kokkos::View<Float *, MemSpace> const & b,
+         Kokkos::View<Float *, MemSpace> const & x, Arena<MemSpace> & arena,
+         KrylovOptions const & options = {}) -> KrylovResult
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  using Vector = Kokkos::View<Float *, MemSpace>;
+  using Scalar = impl::Scalar<MemSpace>;
+  PROFILE_SCOPE("juno::bicgstab");
+  Int const n = a.num_rows;
+  auto const size = static_cast<size_t>(n);
+  KrylovResult result;
+
+  auto const scalars = arena.template allocate<FloatAccum>(9);
+  Scalar const rr = Kokkos::subview(scalars, 0);
+  Float const b_norm = impl::norm(b, rr);
+  if (isZero(b_norm)) {
+    Kokkos::deep_copy(x, 0);
+    result.converged = true;
+    return result;
+  }
+
+  Vector const r = arena.template allocate<Float>(size);
+  Vector const r_hat = arena.template allocate<Float>(size);
+  Vector const p = arena.template allocate<Float>(size);
+  Vector const v = arena.template allocate<Float>(size);
+  Vector const p_hat = arena.template allocate<Float>(size);
+  Vector const s_hat = arena.template allocate<Float>(size);
+  Vector const t = arena.template allocate<Float>(size);
+  Kokkos::deep_copy(ExecSpace(), p, 0);
+  Kokkos::deep_copy(ExecSpace(), v, 0);
+  impl::residual(a, b, x, r);
+  Kokkos::deep_copy(r_hat, r);
+  result.residual = impl::norm(r, rr) / b_norm;
+  if (result.residual <= options.tolerance) {
+    result.converged = true;
+    return result;
+  }
+
+  Scalar const rho = Kokkos::subview(scalars, 1);
+  Scalar const rho_old = Kokkos::subview(scalars, 2);
+  Scalar const alpha = Kokkos::subview(scalars, 3);
+  Scalar const omega = Kokkos::subview(scalars, 4);
+  Scalar const beta = Kokkos::subview(scalars, 5);
+  Scalar const rv = Kokkos::subview(scalars, 6);
+  Scalar const ts = Kokkos::subview(scalars, 7);
+  Scalar const tt = Kokkos::subview(scalars, 8);
+  Kokkos::deep_copy(rho_old, 1);
+  Kokkos::deep_copy(alpha, 1);
+  Kokkos::deep_copy(omega, 1);
+
+  auto const policy = rangePolicy<ExecSpace>(0, n);
+  while (result.iterations < options.max_iterations) {
+    ++result.iterations;
+
+    // p = r + beta (p - omega v)
+    impl::dot(r_hat, r, rho);
+    impl::single<MemSpace>("juno::bicgstab", KOKKOS_LAMBDA() {
+      beta() = impl::safeDivide(rho(), rho_old()) * impl::safeDivide(alpha(), omega());
+      rho_old() = rho();
+    });
+    Kokkos::parallel_for(
+        "juno::bicgstab", policy,
+        KOKKOS_LAMBDA(Int const i) {
+          auto const beta_f = static_cast<Float>(beta());
+          auto const omega_f = static_cast<Float>(omega());
+          p(i) = r(i) + beta_f * (p(i) - omega_f * v(i));
+        });
+
+    // v = A M^-1 p, alpha = rho / (r_hat, v), and s = r - alpha v, in r
+    m.apply(p, p_hat);
+    spmv(a, p_hat, v);
+    impl::dot(r_hat, v, rv);
+    impl::single<MemSpace>("juno::bicgstab",
+                           KOKKOS_LAMBDA() { alpha() = impl::safeDivide(rho(), rv()); });
+    Kokkos::parallel_for(
+        "juno::bicgstab", policy,
+        KOKKOS_LAMBDA(Int const i) { r(i) -= static_cast<Float>(alpha()) * v(i); });
+
+    // t = A M^-1 s, omega = (t, s) / (t, t)
+    m.apply(r, s_hat);
+    spmv(a, s_hat, t);
+    impl::dot(t, r, ts);
+    impl::dot(t, t, tt);
+    impl::single<MemSpace>("juno::bicgstab",
+                           KOKKOS_LAMBDA() { omega() = impl::safeDivide(ts(), tt()); });
+
+    // x += alpha M^-1 p + omega M^-1 s, r = s - omega t
+    Kokkos::parallel_for(
+        "juno::bicgstab", policy, KOKKOS_LAMBDA(Int const i) {
+          auto const alpha_f = static_cast<Float>(alpha());
+          auto const omega_f = static_cast<Float>(omega());
+          x(i) += alpha_f * p_hat(i) + omega_f * s_hat(i);
+          r(i) -= omega_f * t(i);
+        });
+
+    if (result.iterations % options.check_interval == 0 ||
+        result.iterations == options.max_iterations) {
+      result.residual = impl::norm(r, rr) / b_norm;
+      if (result.residual <= options.tolerance) {
+        result.converged = true;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+// Solve A x = b with BiCGStab, from the initial guess in x, with a workspace of its own
+template <class Matrix, class Preconditioner, class MemSpace>
+auto
+bicgstab(Matrix const & a, Preconditioner const & m,
+         Kokkos::View<Float *, MemSpace> const & b,
+         Kokkos::View<Float *, MemSpace> const & x, KrylovOptions const & options = {})
+    -> KrylovResult
+{
+  Arena<MemSpace> arena("juno::bicgstab", impl::bicgstabBytes<MemSpace>(a.num_rows));
+  return bicgstab(a, m, b, x, arena, options);
+}
+
+//----------------------------------------------------------------------------------------
+// Solve A x = b with restarted GMRES, from the initial guess in x, with the workspace
+// from the arena. The arena is not reset.
+template <class Matrix, class Preconditioner, class MemSpace>
+auto
+gmres(Matrix const & a, Preconditioner const & m,
+      Kokkos::View<Float *, MemSpace> const & b,
+      Kokkos::View<Float *, MemSpace> const & x, Arena<MemSpace> & arena,
+      KrylovOptions const & options = {}) -> KrylovResult
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  using Vector = Kokkos::View<Float *, MemSpace>;
+  using AccumVector = Kokkos::View<FloatAccum *, MemSpace>;
+  using Scalar = impl::Scalar<MemSpace>;
+  PROFILE_SCOPE("juno::gmres");
+  Int const n = a.num_rows;
+  Int const restart = options.restart;
+  auto const size = static_cast<size_t>(n);
+  KrylovResult result;
+
+  auto const scalars = arena.template allocate<FloatAccum>(2);
+  Scalar const work = Kokkos::subview(scalars, 0);
+  Float const b_norm = impl::norm(b, work);
+  if (isZero(b_norm)) {
+    Kokkos::deep_copy(x, 0);
+    result.converged = true;
+    return result;
+  }
+
+  // The basis: vector k is basis[k * n ... (k + 1) * n)
+  Vector const basis =
+      arena.template allocate<Float>(static_cast<size_t>(restart + 1) * size);
+  Vector const w = arena.template allocate<Float>(size);
+  Vector const z = arena.template allocate<Float>(size);
+  // The Hessenberg matrix, column-major with restart + 1 rows, and its QR factorization
+  // by Givens rotations. g is the rotated right-hand side |r| e_1, and its last entry
+  // the residual norm. They are small, so they are in FloatAccum.
+  auto const accumVector = [&](Int const n_accum) -> AccumVector {
+    return arena.template allocate<FloatAccum>(static_cast<size_t>(n_accum));
+  };
+  AccumVector const h = accumVector((restart + 1) * restart);
+  AccumVector const cs = accumVector(restart);
+  AccumVector const sn = accumVector(restart);
+  AccumVector const g = accumVector(restart + 1);
+  AccumVector const y = accumVector(restart);
+  Scalar const scale = Kokkos::subview(scalars, 1);
+  auto const policy = rangePolicy<ExecSpace>(0, n);
+  auto const hij = KOKKOS_LAMBDA(Int const i, Int const j)->FloatAccum &
+  {
+    return h(i + (restart + 1) * j);
+  };
+  auto const basisVector = [&](Int const k) -> Vector {
+    return Kokkos::subview(basis, std::make_pair(k * n, (k + 1) * n));
+  };
+
+  while (true) {
+    // r = b - A x in the first basis vector. The true residual is checked at each
+    // restart.
+    Vector const v0 = basisVector(0);
+    impl::residual(a, b, x, v0);
+    Float const beta = impl::norm(v0, work);
+    result.residual = beta / b_norm;
+    if (result.residual <= options.tolerance) {
+      result.converged = true;
+      break;
+    }
+    if (result.iterations >= options.max_iterations) {
+      break;
+    }
+    Kokkos::deep_copy(g, 0);
+    Kokkos::deep_copy(Kokkos::subview(g, 0), beta);
+    Float const inv_beta = 1 / beta;
+    Kokkos::parallel_for(
+        "juno::gmres", policy, KOKKOS_LAMBDA(Int const i) { basis(i) *= inv_beta; });
+
+    // Arnoldi, with the QR factorization of H updated at each step
+    Int k = 0;
+    while (k < restart && result.iterations < options.max_iterations) {
+      ++result.iterations;
+      Vector const vk = basisVector(k);
+      m.apply(vk, z);
+      spmv(a, z, w);
+      for (Int i = 0; i <= k; ++i) {
+        Vector const vi = basisVector(i);
+        Scalar const h_ik = Kokkos::subview(h, i + (restart + 1) * k);
+        impl::dot(w, vi, h_ik);
+        Kokkos::parallel_for(
+            "juno::gmres", policy,
+            KOKKOS_LAMBDA(Int const l) { w(l) -= static_cast<Float>(h_ik()) * vi(l); });
+      }
+      Scalar const h_next_sq = Kokkos::subview(h, k + 1 + (restart + 1) * k);
+      impl::dot(w, w, h_next_sq);
+
+      impl::single<MemSpace>("juno::gmres", KOKKOS_LAMBDA() {
+        FloatAccum const h_next = Kokkos::sqrt(hij(k + 1, k));
+        hij(k + 1, k) = h_next;
+        scale() = impl::safeDivide(1, h_next);
+        // Apply the previous rotations to the new column, then eliminate h(k + 1, k)
+        for (Int i = 0; i < k; ++i) {
+          FloatAccum const upper = cs(i) * hij(i, k) + sn(i) * hij(i + 1, k);
+          hij(i + 1, k) = -sn(i) * hij(i, k) + cs(i) * hij(i + 1, k);
+          hij(i, k) = upper;
+        }
+        FloatAccum const d = Kokkos::sqrt(hij(k, k) * hij(k, k) + h_next * h_next);
+        cs(k) = isZero(d) ? 1 : hij(k, k) / d;
+        sn(k) = impl::safeDivide(h_next, d);
+        hij(k, k) = d;
+        hij(k + 1, k) = 0;
+        g(k + 1) = -sn(k) * g(k);
+        g(k) = cs(k) * g(k);
+      });
+      Vector const vk1 = basisVector(k + 1);
+      Kokkos::parallel_for(
+          "juno::gmres", policy,
+          KOKKOS_LAMBDA(Int const i) { vk1(i) = w(i) * static_cast<Float>(scale()); });
+      ++k;
+
+      // The residual of the least-squares problem is that of the iterate
+      if (k % options.check_interval == 0 && k < restart) {
+        FloatAccum g_last = 0;
+        Kokkos::deep_copy(g_last, Kokkos::subview(g, k));
+        if (std::abs(g_last) <= static_cast<FloatAccum>(options.tolerance * b_norm)) {
+          break;
+        }
+      }
+    }
+
+    // Solve H y = g, and update x += M^-1 V y
+    impl::single<MemSpace>("juno::gmres", KOKKOS_LAMBDA() {
+      for (Int i = k - 1; i >= 0; --i) {
+        FloatAccum yi = g(i);
+        for (Int j = i + 1; j < k; ++j) {
+          yi -= hij(i, j) * y(j);
+        }
+        y(i) = impl::safeDivide(yi, hij(i, i));
+      }
+    });
+    Kokkos::parallel_for(
+        "juno::gmres", policy, KOKKOS_LAMBDA(Int const i) {
+          FloatAccum wi = 0;
+          for (Int j = 0; j < k; ++j) {
+            wi += y(j) * static_cast<FloatAccum>(basis(j * n + i));
+          }
+          w(i) = static_cast<Float>(wi);
+        });
+    m.apply(w, z);
+    Kokkos::parallel_for(
+        "juno::gmres", policy, KOKKOS_LAMBDA(Int const i) { x(i) += z(i); });
+  }
+  return result;
+}
+
+// Solve A x = b with restarted GMRES, from the initial guess in x, with a workspace of
+// its own
+template <class Matrix, class Preconditioner, class MemSpace>
+auto
+gmres(Matrix const & a, Preconditioner const & m,
+      Kokkos::View<Float *, MemSpace> const & b,
+      Kokkos::View<Float *, MemSpace> const & x, KrylovOptions const & options = {})
+    -> KrylovResult
+{
+  Arena<MemSpace> arena("juno::gmres",
+                        impl::gmresBytes<MemSpace>(a.num_rows, options.restart));
+  return gmres(a, m, b, x, arena, options);
+}
+
+} // namespace juno
@@ -0,0 +1,511 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm> // std::min
+#include <string>
+
+//========================================================================================
+// BATCHED SMALL MATRICES
+//========================================================================================
+// Our dense systems are many tiny ones, e.g. a 2x2 to 16x16 system per cell, not a few
+// large ones. A library call per system would cost more than the system itself, so we
+// operate on a whole batch of same-sized matrices at once:
+//  - The size is a template parameter, so every loop has a compile-time trip count and
+//    is fully unrolled.
+//  - The batch is stored in tiles of T matrices. Within a tile, entry (i, j) of matrix
+//    b is at (i + M * j) * T + b % T, i.e. each matrix is column-major, and the same
+//    entry of the matrices of a tile is contiguous. The tiles follow each other.
+//    - interleaved: T = 8. A SIMD lane on the host, or a thread on the device, per
+//      matrix gives unit-stride, coalesced accesses, and each tile is read as a single
+//      stream. This is the default, and the fast layout.
+//    - contiguous: T = 1. Each matrix is contiguous, with a stride of M * N between
+//      matrices, as in the strided-batched BLAS interfaces.
+//  - On the host, each thread takes whole tiles of matrices of an interleaved batch,
+//    and applies each step of a kernel to all the matrices of the tile in the innermost
+//    loop, which vectorizes. The rows are swapped by selection rather than by indexing,
+//    so pivoting does not need gathers or scatters.
+//  - On the device, teams of threads take the matrices in a grid-stride loop, one
+//    matrix per thread.
+//
+// Usage:
+//   auto const a = juno::makeBatch<Float, 4, 4>("a", num_cells); // MatrixBatch<4>
+//   auto const x = juno::makeBatch<Float, 4, 1>("x", num_cells); // VectorBatch<4>
+//   ... fill a(b, i, j) and the right-hand sides x(b, i) ...
+//   Int const num_singular = juno::solve(a, x); // x = a^-1 x, a is overwritten by LU
+// or factor once and solve for several right-hand sides with luFactor and luSolve.
+
+namespace juno
+{
+
+// The number of matrices per tile
+namespace batch_layouts
+{
+inline constexpr Int interleaved = 8;
+inline constexpr Int contiguous = 1;
+} // namespace batch_layouts
+
+//----------------------------------------------------------------------------------------
+// A batch of M by N matrices of T. The batch only holds a View, so it may be captured by
+// value in kernels on MemSpace.
+template <class T, Int M, Int N, class MemSpace = HostMemSpace>
+struct StridedBatch {
+  static constexpr Int rows = M;
+  static constexpr Int cols = N;
+
+  Kokkos::View<T *, MemSpace> values;
+  Int size = 0; // the number of matrices
+  Int tile = 1; // the number of matrices per tile
+
+  // The offset of entry (i, j) of matrix b
+  [[nodiscard]] HOSTDEV auto
+  offset(Int const b, Int const i, Int const j) const noexcept -> Int
+  {
+    ASSUME(0 <= i && i < M && 0 <= j && j < N);
+    return (b / tile) * (tile * M * N) + (i + M * j) * tile + b % tile;
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  operator()(Int const b, Int const i, Int const j) const noexcept -> T &
+  {
+    return values(offset(b, i, j));
+  }
+
+  // Entry i of vector b, for batches of column vectors
+  [[nodiscard]] HOSTDEV auto
+  operator()(Int const b, Int const i) const noexcept -> T &
+  {
+    static_assert(N == 1);
+    return values(offset(b, i, 0));
+  }
+};
+
+template <Int N, class MemSpace = HostMemSpace>
+using MatrixBatch = StridedBatch<Float, N, N, MemSpace>;
+
+template <Int N, class MemSpace = HostMemSpace>
+using VectorBatch = StridedBatch<Float, N, 1, MemSpace>;
+
+// The row interchanges of an LU factorization: row k was swapped with row pivots(b, k)
+template <Int N, class MemSpace = HostMemSpace>
+using PivotBatch = StridedBatch<Int, N, 1, MemSpace>;
+
+//----------------------------------------------------------------------------------------
+// A zero-initialized batch of size M by N matrices, with tiles of the given size. The
+// last tile is padded.
+template <class T, Int M, Int N, class MemSpace = HostMemSpace>
+auto
+makeBatch(std::string const & label, Int const size,
+          Int const layout = batch_layouts::interleaved)
+    -> StridedBatch<T, M, N, MemSpace>
+{
+  StridedBatch<T, M, N, MemSpace> batch;
+  Int const num_tiles = (size + layout - 1) / layout;
+  batch.values =
+      Kokkos::View<T *, MemSpace>(label, static_cast<size_t>(num_tiles * layout * M * N));
+  batch.size = size;
+  batch.tile = layout;
+  return batch;
+}
+
+//----------------------------------------------------------------------------------------
+// Kernels on W consecutive matrices of a tile at once
+//----------------------------------------------------------------------------------------
+// Each operation is applied to all lanes, in the innermost loop, which is unit-stride
+// and vectorizes. With W = 1, these are kernels on a single matrix of any layout.
+
+namespace impl
+{
+
+// Matrices per call on the host: a vector register of Float, or two. More lanes spill
+// the per-lane state out of the registers.
+inline constexpr Int simd_lanes = batch_layouts::interleaved;
+
+// W matrices of a tile, starting at matrix b: entry (i, j) of lane l is at
+// base[l + (i + M * j) * entry_stride]
+template <class T, Int M, Int N>
+struct Lanes {
+  T * RESTRICT base;
+  Int entry_stride;
+
+  [[nodiscard]] HOSTDEV auto
+  operator()(Int const l, Int const i, Int const j = 0) const noexcept -> T &
+  {
+    ASSUME(0 <= i && i < M && 0 <= j && j < N);
+    return base[l + (i + M * j) * entry_stride];
+  }
+};
+
+template <class T, Int M, Int N, class MemSpace>
+HOSTDEV auto
+lanes(StridedBatch<T, M, N, MemSpace> const & batch, Int const b) noexcept
+    -> Lanes<T, M, N>
+{
+  return {batch.values.data() + batch.offset(b, 0, 0), batch.tile};
+}
+
+// LU factorization with partial pivoting, in place, as in LAPACK getrf: P A = L U, with
+// L unit lower triangular. Returns the number of singular matrices. Their factorization
+// is not usable, but finishes, so that the lanes stay in step.
+template <Int W, Int N>
+HOSTDEV auto
+luFactor(Lanes<Float, N, N> const a, Lanes<Int, N, 1> const pivots) noexcept -> Int
+{
+  Int singular[W] = {};
+  for (Int k = 0; k < N; ++k) {
+    // The entry of largest magnitude in column k, on or below the diagonal
+    Int p[W];
+    Float max[W];
+    for (Int l = 0; l < W; ++l) {
+      p[l] = k;
+      max[l] = Kokkos::abs(a(l, k, k));
+    }
+    for (Int i = k + 1; i < N; ++i) {
+      for (Int l = 0; l < W; ++l) {
+        Float const v = Kokkos::abs(a(l, i, k));
+        p[l] = v > max[l] ? i : p[l];
+        max[l] = v > max[l] ? v : max[l];
+      }
+    }
+    for (Int l = 0; l < W; ++l) {
+      pivots(l, k) = p[l];
+    }
+
+    // Swap rows k and p. The rows are selected rather than indexed, so that each lane
+    // may swap a different row without gathers or scatters.
+    // Each loop over the lanes stores to one row only, so that the compiler need not
+    // check whether the rows overlap.
+    for (Int i = k + 1; i < N; ++i) {
+      for (Int j = 0; j < N; ++j) {
+        Float aij[W];
+        Float akj[W];
+        for (Int l = 0; l < W; ++l) {
+          aij[l] = a(l, i, j);
+          akj[l] = a(l, k, j);
+        }
+        for (Int l = 0; l < W; ++l) {
+          a(l, i, j) = i == p[l] ? akj[l] : aij[l];
+        }
+        for (Int l = 0; l < W; ++l) {
+          a(l, k, j) = i == p[l] ? aij[l] : akj[l];
+        }
+      }
+    }
+
+    // Eliminate below the pivot
+    Float inv_pivot[W];
+    for (Int l = 0; l < W; ++l) {
+      singular[l] |= max[l] > 0 ? 0 : 1;
+      inv_pivot[l] = max[l] > 0 ? 1 / a(l, k, k) : 0;
+    }
+    for (Int i = k + 1; i < N; ++i) {
+      Float factor[W];
+      for (Int l = 0; l < W; ++l) {
+        factor[l] = a(l, i, k) * inv_pivot[l];
+        a(l, i, k) = factor[l];
+      }
+      for (Int j = k + 1; j < N; ++j) {
+        Float akj[W];
+        for (Int l = 0; l < W; ++l) {
+          akj[l] = a(l, k, j);
+        }
+        for (Int l = 0; l < W; ++l) {
+          a(l, i, j) -= factor[l] * akj[l];
+        }
+      }
+    }
+  }
+  Int count = 0;
+  for (Int l = 0; l < W; ++l) {
+    count += singular[l];
+  }
+  return count;
+}
+
+// Solve A x = rhs in place, given the factorization of luFactor
+template <Int W, Int N>
+HOSTDEV void
+luSolve(Lanes<Float, N, N> const lu, Lanes<Int, N, 1> const pivots,
+        Lanes<Float, N, 1> const x) noexcept
+{
+  // Work on a local copy, which the compiler knows is not aliased
+  Float v[N][W];
+  for (Int i = 0; i < N; ++i) {
+    for (Int l = 0; l < W; ++l) {
+      v[i][l] = x(l, i);
+    }
+  }
+  // Apply the row interchanges
+  for (Int k = 0; k < N; ++k) {
+    for (Int i = k + 1; i < N; ++i) {
+      for (Int l = 0; l < W; ++l) {
+        bool const swap = i == pivots(l, k);
+        Float const vi = v[i][l];
+        Float const vk = v[k][l];
+        v[i][l] = swap ? vk : vi;
+        v[k][l] = swap ? vi : vk;
+      }
+    }
+  }
+  // L y = P rhs
+  for (Int i = 1; i < N; ++i) {
+    for (Int j = 0; j < i; ++j) {
+      for (Int l = 0; l < W; ++l) {
+        v[i][l] -= lu(l, i, j) * v[j][l];
+      }
+    }
+  }
+  // U x = y
+  for (Int i = N - 1; i >= 0; --i) {
+    for (Int j = i + 1; j < N; ++j) {
+      for (Int l = 0; l < W; ++l) {
+        v[i][l] -= lu(l, i, j) * v[j][l];
+      }
+    }
+    for (Int l = 0; l < W; ++l) {
+      v[i][l] /= lu(l, i, i);
+    }
+  }
+  for (Int i = 0; i < N; ++i) {
+    for (Int l = 0; l < W; ++l) {
+      x(l, i) = v[i][l];
+    }
+  }
+}
+
+// y = A x
+template <Int W, Int N>
+HOSTDEV void
+matvec(Lanes<Float, N, N> const a, Lanes<Float, N, 1> const x,
+       Lanes<Float, N, 1> const y) noexcept
+{
+  for (Int i = 0; i < N; ++i) {
+    for (Int l = 0; l < W; ++l) {
+      y(l, i) = 0;
+    }
+    for (Int j = 0; j < N; ++j) {
+      for (Int l = 0; l < W; ++l) {
+        y(l, i) += a(l, i, j) * x(l, j);
+      }
+    }
+  }
+}
+
+// The operations on a batch, as functors of the first matrix of W lanes. Functors
+// rather than lambdas, so that the dispatch below can call them with different W.
+template <Int N, class MemSpace>
+struct LUFactor {
+  MatrixBatch<N, MemSpace> a;
+  PivotBatch<N, MemSpace> pivots;
+
+  [[nodiscard]] auto
+  interleaved() const noexcept -> bool
+  {
+    return a.tile % simd_lanes == 0 && pivots.tile % simd_lanes == 0;
+  }
+
+  template <Int W>
+  HOSTDEV auto
+  apply(Int const b) const noexcept -> Int
+  {
+    return impl::luFactor<W, N>(lanes(a, b), lanes(pivots, b));
+  }
+};
+
+template <Int N, class MemSpace>
+struct LUSolve {
+  MatrixBatch<N, MemSpace> lu;
+  PivotBatch<N, MemSpace> pivots;
+  VectorBatch<N, MemSpace> x;
+
+  [[nodiscard]] auto
+  interleaved() const noexcept -> bool
+  {
+    return lu.tile % simd_lanes == 0 && pivots.tile % simd_lanes == 0 &&
+           x.tile % simd_lanes == 0;
+  }
+
+  template <Int W>
+  HOSTDEV auto
+  apply(Int const b) const noexcept -> Int
+  {
+    impl::luSolve<W, N>(lanes(lu, b), lanes(pivots, b), lanes(x, b));
+    return 0;
+  }
+};
+
+template <Int N, class MemSpace>
+struct Matvec {
+  MatrixBatch<N, MemSpace> a;
+  VectorBatch<N, MemSpace> x;
+  VectorBatch<N, MemSpace> y;
+
+  [[nodiscard]] auto
+  interleaved() const noexcept -> bool
+  {
+    return a.tile % simd_lanes == 0 && x.tile % simd_lanes == 0 &&
+           y.tile % simd_lanes == 0;
+  }
+
+  template <Int W>
+  HOSTDEV auto
+  apply(Int const b) const noexcept -> Int
+  {
+    impl::matvec<W, N>(lanes(a, b), lanes(x, b), lanes(y, b));
+    return 0;
+  }
+};
+
+// The sum of the results of op over the matrices [0, size) of a batch. On the host,
+// interleaved batches are done simd_lanes matrices at a time, but for the last partial
+// tile. The other matrices, and all of them on the device, are done one at a time.
+template <class ExecSpace, class Op>
+auto
+sumOverBatch(char const * label, Int const size, Op const & op) -> Int
+{
+  Int sum = 0;
+  if constexpr (Kokkos::SpaceAccessibility<ExecSpace, Kokkos::HostSpace>::accessible) {
+    Int const num_groups = (size + simd_lanes - 1) / simd_lanes;
+    bool const interleaved = op.interleaved();
+    // The default static chunks, so that small batches are split between the threads
+    Kokkos::parallel_reduce(
+        label, TunedRangePolicy<ExecSpace>(ExecSpace(), 0, num_groups),
+        [&](Int const group, Int & update) {
+          Int const begin = group * simd_lanes;
+          Int const end = std::min(begin + simd_lanes, size);
+          if (interleaved && end - begin == simd_lanes) {
+            update += op.template apply<simd_lanes>(begin);
+          } else {
+            for (Int b = begin; b < end; ++b) {
+              update += op.template apply<1>(b);
+            }
+          }
+        },
+        sum);
+  } else {
+    using Member = typename TunedTeamPolicy<ExecSpace>::member_type;
+    Kokkos::parallel_reduce(
+        label, gridStridePolicy<ExecSpace>(size),
+        KOKKOS_LAMBDA(Member const & member, Int & update) {
+          for (Int b = gridStrideBegin(member); b < size; b += gridStrideStep(member)) {
+            update += op.template apply<1>(b);
+          }
+        },
+        sum);
+  }
+  return sum;
+}
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+// Kernels on a single matrix b of a batch, for use in other kernels
+//----------------------------------------------------------------------------------------
+
+// Returns false if the matrix is singular
+template <Int N, class MemSpace>
+HOSTDEV auto
+luFactor(MatrixBatch<N, MemSpace> const & a, PivotBatch<N, MemSpace> const & pivots,
+         Int const b) noexcept -> bool
+{
+  return impl::luFactor<1, N>(impl::lanes(a, b), impl::lanes(pivots, b)) == 0;
+}
+
+template <Int N, class MemSpace>
+HOSTDEV void
+luSolve(MatrixBatch<N, MemSpace> const & lu, PivotBatch<N, MemSpace> const & pivots,
+        VectorBatch<N, MemSpace> const & x, Int const b) noexcept
+{
+  impl::luSolve<1, N>(impl::lanes(lu, b), impl::lanes(pivots, b), impl::lanes(x, b));
+}
+
+template <Int N, class MemSpace>
+HOSTDEV void
+matvec(MatrixBatch<N, MemSpace> const & a, VectorBatch<N, MemSpace> const & x,
+       VectorBatch<N, MemSpace> const & y, Int const b) noexcept
+{
+  impl::matvec<1, N>(impl::lanes(a, b), impl::lanes(x, b), impl::lanes(y, b));
+}
+
+//----------------------------------------------------------------------------------------
+// Kernels on a whole batch
+//----------------------------------------------------------------------------------------
+
+// Factor each matrix in place. Returns the number of singular matrices.
+template <Int N, class MemSpace>
+auto
+luFactor(MatrixBatch<N, MemSpace> const & a, PivotBatch<N, MemSpace> const & pivots)
+    -> Int
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  return impl::sumOverBatch<ExecSpace>("juno::luFactor", a.size,
+                                       impl::LUFactor<N, MemSpace>{a, pivots});
+}
+
+// Solve each system in place, given the factorizations of luFactor
+template <Int N, class MemSpace>
+void
+luSolve(MatrixBatch<N, MemSpace> const & lu, PivotBatch<N, MemSpace> const & pivots,
+        VectorBatch<N, MemSpace> const & x)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  impl::sumOverBatch<ExecSpace>("juno::luSolve", lu.size,
+                                impl::LUSolve<N, MemSpace>{lu, pivots, x});
+}
+
+// Solve A x = rhs in place for each matrix, overwriting A with its factorization.
+// Returns the number of singular matrices, whose solutions are not usable.
+template <Int N, class MemSpace>
+auto
+solve(MatrixBatch<N, MemSpace> const & a, VectorBatch<N, MemSpace> const & x) -> Int
+{
+  // The pivots have the layout of the right-hand sides
+  PivotBatch<N, MemSpace> pivots;
+  pivots.values = Kokkos::View<Int *, MemSpace>(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, std::string("juno::pivots")),
+      x.values.size());
+  pivots.size = x.size;
+  pivots.tile = x.tile;
+  Int const num_singular = luFactor(a, pivots);
+  luSolve(a, pivots, x);
+  return num_singular;
+}
+
+// y = A x for each matrix
+template <Int N, class MemSpace>
+void
+matvec(MatrixBatch<N, MemSpace> const & a, VectorBatch<N, MemSpace> const & x,
+       VectorBatch<N, MemSpace> const & y)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  impl::sumOverBatch<ExecSpace>("juno::matvec", a.size,
+                                impl::Matvec<N, MemSpace>{a, x, y});
+}
+
+//----------------------------------------------------------------------------------------
+// The host kernels for the common sizes are compiled once, in src/math/matrix.cpp
+//----------------------------------------------------------------------------------------
+
+#define JUNO_MATRIX_EXTERN(N)                                                            \
+  extern template auto luFactor<N, HostMemSpace>(MatrixBatch<N, HostMemSpace> const &,   \
+                                                 PivotBatch<N, HostMemSpace> const &)    \
+      -> Int;                                                                            \
+  extern template void luSolve<N, HostMemSpace>(MatrixBatch<N, HostMemSpace> const &,    \
+                                                PivotBatch<N, HostMemSpace> const &,     \
+                                                VectorBatch<N, HostMemSpace> const &);   \
+  extern template void matvec<N, HostMemSpace>(MatrixBatch<N, HostMemSpace> const &,     \
+                                               VectorBatch<N, HostMemSpace> const &,     \
+                                               VectorBatch<N, HostMemSpace> const &);
+
+JUNO_MATRIX_EXTERN(2)
+JUNO_MATRIX_EXTERN(3)
+JUNO_MATRIX_EXTERN(4)
+JUNO_MATRIX_EXTERN(8)
+JUNO_MATRIX_EXTERN(16)
+
+#undef JUNO_MATRIX_EXTERN
+
+} // namespace juno
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/mirrored_view.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/config.hpp>
+#include <juno/math/compare.hpp>
+#include <juno/math/sparse_matrix.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm> // std::max
+#include <vector>
+
+//========================================================================================
+// PRECONDITIONERS
+//========================================================================================
+// Preconditioners M ~ A for the Krylov solvers. Each has apply(r, z), which computes
+// z = M^-1 r on MemSpace, without copying anything back to the host:
+//  - IdentityPreconditioner: no preconditioning.
+//  - JacobiPreconditioner: the inverse of the diagonal of A.
+//  - ILU0Preconditioner: the incomplete LU factorization of A, with the sparsity
+//    pattern of A. The triangular solves are sequential by nature, so the rows are
+//    grouped into levels: the rows of a level only depend on rows of earlier levels,
+//    and are solved in parallel. The levels are computed once, on the host, from the
+//    pattern of A; the factorization and the solves then run level by level, with a
+//    kernel per level. Diffusion operators on meshes have few levels relative to
+//    their rows, since the rows of each level form a front through the mesh.
+//
+// Build the preconditioners from a CSR matrix with make...Preconditioner(a). ILU(0)
+// requires sorted columns and a nonzero diagonal, and logs an error otherwise.
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace = HostMemSpace>
+struct IdentityPreconditioner {
+  void
+  apply(Kokkos::View<Float *, MemSpace> const & r,
+        Kokkos::View<Float *, MemSpace> const & z) const
+  {
+    Kokkos::deep_copy(z, r);
+  }
+};
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace = HostMemSpace>
+struct JacobiPreconditioner {
+  Kokkos::View<Float *, MemSpace> inverse_diagonal;
+
+  void
+  apply(Kokkos::View<Float *, MemSpace> const & r,
+        Kokkos::View<Float *, MemSpace> const & z) const
+  {
+    using ExecSpace = typename MemSpace::execution_space;
+    auto const d = inverse_diagonal;
+    Kokkos::parallel_for(
+        "juno::JacobiPreconditioner::apply",
+        rangePolicy<ExecSpace>(0, static_cast<Int>(d.size())),
+        KOKKOS_LAMBDA(Int const i) { z(i) = d(i) * r(i); });
+  }
+};
+
+// A zero or missing diagonal entry is replaced by 1
+template <class MemSpace>
+auto
+makeJacobiPreconditioner(CSRMatrix<MemSpace> const & a) -> JacobiPreconditioner<MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  auto const diagonal = diagonalIndices(a);
+  JacobiPreconditioner<MemSpace> m;
+  Kokkos::View<Float *, MemSpace> const d("inverse_diagonal",
+                                          static_cast<size_t>(a.num_rows));
+  m.inverse_diagonal = d;
+  Kokkos::parallel_for(
+      "juno::makeJacobiPreconditioner", rangePolicy<ExecSpace>(0, a.num_rows),
+      KOKKOS_LAMBDA(Int const i) {
+        Float const aii = diagonal(i) >= 0 ? a.values(diagonal(i)) : 0;
+        d(i) = isZero(aii) ? 1 : 1 / aii;
+      });
+  return m;
+}
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace = HostMemSpace>
+struct ILU0Preconditioner {
+  using IntView = Kokkos::View<Int *, MemSpace>;
+
+  // L and U in the pattern of A: L is unit lower triangular, and its diagonal is not
+  // stored
+  CSRMatrix<MemSpace> lu;
+  IntView diagonal; // the position of the diagonal entry of each row
+
+  // The rows of each level of the forward and backward solves. The rows of level l are
+  // rows[levels[l] ... levels[l + 1]). The level offsets are on the host, since each
+  // level is a kernel launch.
+  IntView lower_rows;
+  IntView upper_rows;
+  std::vector<Int> lower_levels;
+  std::vector<Int> upper_levels;
+
+  void
+  apply(Kokkos::View<Float *, MemSpace> const & r,
+        Kokkos::View<Float *, MemSpace> const & z) const
+  {
+    using ExecSpace = typename MemSpace::execution_space;
+    auto const a = lu;
+    auto const diag = diagonal;
+
+    // L y = r
+    auto const lower = lower_rows;
+    for (size_t l = 0; l + 1 < lower_levels.size(); ++l) {
+      Kokkos::parallel_for(
+          "juno::ILU0Preconditioner::apply",
+          rangePolicy<ExecSpace>(lower_levels[l], lower_levels[l + 1]),
+          KOKKOS_LAMBDA(Int const k) {
+            Int const i = lower(k);
+            Float zi = r(i);
+            for (Int e = a.row_offsets(i); e < diag(i); ++e) {
+              zi -= a.values(e) * z(a.columns(e));
+            }
+            z(i) = zi;
+          });
+    }
+
+    // U z = y, in place
+    auto const upper = upper_rows;
+    for (size_t l = 0; l + 1 < upper_levels.size(); ++l) {
+      Kokkos::parallel_for(
+          "juno::ILU0Preconditioner::apply",
+          rangePolicy<ExecSpace>(upper_levels[l], upper_levels[l + 1]),
+          KOKKOS_LAMBDA(Int const k) {
+            Int const i = upper(k);
+            Float zi = z(i);
+            for (Int e = diag(i) + 1; e < a.row_offsets(i + 1); ++e) {
+              zi -= a.values(e) * z(a.columns(e));
+            }
+            z(i) = zi / a.values(diag(i));
+          });
+    }
+  }
+};
+
+namespace impl
+{
+
+//----------------------------------------------------------------------------------------
+// Group the rows of the lower (or upper) triangle of a pattern into levels, on the
+// host: a row is one level past the latest level of the rows it depends on. Returns the
+// level offsets, and sets rows to the rows in order of level.
+inline auto
+levelSchedule(Kokkos::View<Int *, HostMemSpace> const & row_offsets,
+              Kokkos::View<Int *, HostMemSpace> const & columns, bool const lower,
+              std::vector<Int> & rows) -> std::vector<Int>
+{
+  auto const num_rows = static_cast<Int>(row_offsets.size()) - 1;
+  std::vector<Int> level(static_cast<size_t>(num_rows), 0);
+  Int num_levels = num_rows > 0 ? 1 : 0;
+  for (Int n = 0; n < num_rows; ++n) {
+    Int const i = lower ? n : num_rows - 1 - n;
+    Int li = 0;
+    for (Int k = row_offsets(i); k < row_offsets(i + 1); ++k) {
+      Int const j = columns(k);
+      if (lower ? j < i : j > i) {
+        li = std::max(li, level[static_cast<size_t>(j)] + 1);
+      }
+    }
+    level[static_cast<size_t>(i)] = li;
+    num_levels = std::max(num_levels, li + 1);
+  }
+
+  // Counting sort of the rows by level, in order of the rows within each level
+  std::vector<Int> offsets(static_cast<size_t>(num_levels) + 1, 0);
+  for (Int const l : level) {
+    ++offsets[static_cast<size_t>(l) + 1];
+  }
+  for (size_t l = 0; l < static_cast<size_t>(num_levels); ++l) {
+    offsets[l + 1] += offsets[l];
+  }
+  rows.resize(static_cast<size_t>(num_rows));
+  std::vector<Int> next(offsets.begin(), offsets.end() - 1);
+  for (Int i = 0; i < num_rows; ++i) {
+    Int & slot = next[static_cast<size_t>(level[static_cast<size_t>(i)])];
+    rows[static_cast<size_t>(slot++)] = i;
+  }
+  return offsets;
+}
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+// Factor a square CSR matrix with sorted columns. Returns an empty preconditioner, and
+// logs an error, if a diagonal entry is missing or a pivot is zero.
+template <class MemSpace>
+auto
+makeILU0Preconditioner(CSRMatrix<MemSpace> const & a) -> ILU0Preconditioner<MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  PROFILE_SCOPE("juno::makeILU0Preconditioner");
+  ILU0Preconditioner<MemSpace> m;
+  m.diagonal = diagonalIndices(a);
+  auto const diag = m.diagonal;
+  Int num_missing = 0;
+  Kokkos::parallel_reduce(
+      "juno::makeILU0Preconditioner", rangePolicy<ExecSpace>(0, a.num_rows),
+      KOKKOS_LAMBDA(Int const i, Int & missing) { missing += diag(i) < 0 ? 1 : 0; },
+      num_missing);
+  if (num_missing > 0) {
+    LOG_ERROR("ILU(0): ", num_missing, " rows have no diagonal entry");
+    return {};
+  }
+
+  // The levels, from the pattern on the host
+  auto const h_row_offsets =
+      Kokkos::create_mirror_view_and_copy(HostMemSpace(), a.row_offsets);
+  auto const h_columns = Kokkos::create_mirror_view_and_copy(HostMemSpace(), a.columns);
+  std::vector<Int> rows;
+  m.lower_levels = impl::levelSchedule(h_row_offsets, h_columns, true, rows);
+  m.lower_rows = toView<MemSpace>("lower_rows", rows);
+  m.upper_levels = impl::levelSchedule(h_row_offsets, h_columns, false, rows);
+  m.upper_rows = toView<MemSpace>("upper_rows", rows);
+
+  // Factor in place, level by level: row i is final once the rows above it that it
+  // depends on are
+  m.lu = a;
+  m.lu.values = Kokkos::View<Float *, MemSpace>("lu", a.values.size());
+  Kokkos::deep_copy(m.lu.values, a.values);
+  auto const lu = m.lu;
+  auto const lower = m.lower_rows;
+  for (size_t l = 0; l + 1 < m.lower_levels.size(); ++l) {
+    Kokkos::parallel_for(
+        "juno::makeILU0Preconditioner",
+        rangePolicy<ExecSpace>(m.lower_levels[l], m.lower_levels[l + 1]),
+        KOKKOS_LAMBDA(Int const k) {
+          Int const i = lower(k);
+          Int const end = lu.row_offsets(i + 1);
+          for (Int e = lu.row_offsets(i); e < diag(i); ++e) {
+            // l_ij, then subtract l_ij times row j of U, on the pattern of row i
+            Int const j = lu.columns(e);
+            Float const lij = lu.values(e) / lu.values(diag(j));
+            lu.values(e) = lij;
+            Int f = diag(j) + 1;
+            Int const f_end = lu.row_offsets(j + 1);
+            for (Int g = e + 1; g < end && f < f_end; ++g) {
+              while (f < f_end && lu.columns(f) < lu.columns(g)) {
+                ++f;
+              }
+              if (f < f_end && lu.columns(f) == lu.columns(g)) {
+                lu.values(g) -= lij * lu.values(f);
+              }
+            }
+          }
+        });
+  }
+
+  Int num_zero = 0;
+  Kokkos::parallel_reduce(
+      "juno::makeILU0Preconditioner", rangePolicy<ExecSpace>(0, a.num_rows),
+      KOKKOS_LAMBDA(Int const i, Int & zero) {
+        zero += isZero(lu.values(diag(i))) ? 1 : 0;
+      },
+      num_zero);
+  if (num_zero > 0) {
+    LOG_ERROR("ILU(0): ", num_zero, " zero pivots");
+    return {};
+  }
+  return m;
+}
+
+} // namespace juno
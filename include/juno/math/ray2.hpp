@@ -0,0 +1,50 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/compare.hpp>
+#include <juno/math/vec2.hpp>
+
+//========================================================================================
+// RAY2
+//========================================================================================
+// A 2D ray of finite length, e.g. a characteristic track, usable in host and device
+// code. The points of the ray are origin + t * direction for t in [0, length], so with a
+// unit direction, t is the distance from the origin.
+
+namespace juno
+{
+
+struct Ray2 {
+  Vec2 origin;
+  Vec2 direction;
+  Float length;
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  operator()(Float const t) const noexcept -> Vec2
+  {
+    return origin + t * direction;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// The parameter t at which the ray crosses the line segment [a, b], or a negative value
+// if it does not cross it within [0, length]. Segments parallel to the ray are not
+// crossed.
+HOSTDEV constexpr auto
+intersect(Ray2 const & ray, Vec2 const a, Vec2 const b) noexcept -> Float
+{
+  Vec2 const v = b - a;
+  Float const denom = cross(ray.direction, v);
+  if (isZero(denom)) {
+    return -1;
+  }
+  Vec2 const w = a - ray.origin;
+  Float const t = cross(w, v) / denom;
+  Float const s = cross(w, ray.direction) / denom;
+  if (s < 0 || 1 < s || t < 0 || ray.length < t) {
+    return -1;
+  }
+  return t;
+}
+
+} // namespace juno
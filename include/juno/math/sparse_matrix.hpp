@@ -0,0 +1,201 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/scan.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+//========================================================================================
+// SPARSE MATRICES
+//========================================================================================
+// Sparse matrices for the operators of the coarse-mesh problems, e.g. the CMFD
+// diffusion operator, which couples each face of a mesh to its neighbors.
+//
+// Two storage formats, both as structures of Views in MemSpace:
+//  - CSRMatrix: compressed sparse rows. The entries of row i are
+//    [row_offsets[i] ... row_offsets[i + 1]), with their columns in increasing order.
+//    This is the format in which matrices are assembled, and the one that the
+//    preconditioners factor.
+//  - SlicedELLMatrix: sliced ELLPACK, for products on GPUs. The rows are grouped into
+//    slices of ell_slice_height rows, and each row of a slice is padded to the length of
+//    the longest row of the slice. Within a slice, the entries are column-major: entry
+//    k of row i is at slice_offsets[s] + k * ell_slice_height + i % ell_slice_height.
+//    One thread per row then reads the entries of a warp in a single coalesced access,
+//    instead of a strided one as in CSR. The padding is zero, with column 0, and costs
+//    little for meshes, whose rows have similar lengths.
+//
+// spmv(A, x, y) computes y = A x with a thread per row, for either format. The matrices
+// only hold Views, so they may be captured by value in kernels on MemSpace.
+//
+// Usage:
+//   auto const a = juno::assembleDiffusionOperator(mesh, diffusion, removal, boundary);
+//   auto const ell = juno::makeSlicedELLMatrix(a);
+//   juno::spmv(ell, x, y);
+
+namespace juno
+{
+
+// Rows per slice: a warp of NVIDIA GPUs, half a wavefront of AMD GPUs
+inline constexpr Int ell_slice_height = 32;
+
+//----------------------------------------------------------------------------------------
+// A matrix in compressed sparse row format
+template <class MemSpace = HostMemSpace>
+struct CSRMatrix {
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+
+  Int num_rows = 0;
+  Int num_cols = 0;
+  IntView row_offsets; // num_rows + 1
+  IntView columns;
+  FloatView values;
+
+  [[nodiscard]] auto
+  numNonzeros() const noexcept -> Int
+  {
+    return static_cast<Int>(columns.size());
+  }
+
+  // The dot product of row i with x, accumulated in FloatAccum
+  template <class Vector>
+  [[nodiscard]] HOSTDEV auto
+  rowDot(Int const i, Vector const & x) const noexcept -> FloatAccum
+  {
+    FloatAccum sum = 0;
+    for (Int k = row_offsets(i); k < row_offsets(i + 1); ++k) {
+      sum += static_cast<FloatAccum>(values(k)) * static_cast<FloatAccum>(x(columns(k)));
+    }
+    return sum;
+  }
+
+  // Copy the matrix to OtherMemSpace, or not at all if OtherMemSpace is MemSpace
+  template <class OtherMemSpace>
+  [[nodiscard]] auto
+  mirror() const -> CSRMatrix<OtherMemSpace>
+  {
+    auto const copy = [](auto const & v) {
+      return Kokkos::create_mirror_view_and_copy(OtherMemSpace(), v);
+    };
+    return {num_rows, num_cols, copy(row_offsets), copy(columns), copy(values)};
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// A matrix in sliced ELLPACK format
+template <class MemSpace = HostMemSpace>
+struct SlicedELLMatrix {
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+
+  Int num_rows = 0;
+  Int num_cols = 0;
+  IntView slice_offsets; // the number of slices + 1
+  IntView columns;
+  FloatView values;
+
+  template <class Vector>
+  [[nodiscard]] HOSTDEV auto
+  rowDot(Int const i, Vector const & x) const noexcept -> FloatAccum
+  {
+    Int const s = i / ell_slice_height;
+    Int const begin = slice_offsets(s) + i % ell_slice_height;
+    Int const end = slice_offsets(s + 1);
+    FloatAccum sum = 0;
+    for (Int k = begin; k < end; k += ell_slice_height) {
+      sum += static_cast<FloatAccum>(values(k)) * static_cast<FloatAccum>(x(columns(k)));
+    }
+    return sum;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Convert a CSR matrix to sliced ELLPACK, in parallel
+template <class MemSpace>
+auto
+makeSlicedELLMatrix(CSRMatrix<MemSpace> const & a) -> SlicedELLMatrix<MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+  Int const num_rows = a.num_rows;
+  Int const num_slices = (num_rows + ell_slice_height - 1) / ell_slice_height;
+
+  // The entries of each slice: its longest row times its height
+  IntView const counts("counts", static_cast<size_t>(num_slices));
+  Kokkos::parallel_for(
+      "juno::makeSlicedELLMatrix", rangePolicy<ExecSpace>(0, num_slices),
+      KOKKOS_LAMBDA(Int const s) {
+        Int width = 0;
+        Int const end = (s + 1) * ell_slice_height;
+        for (Int i = s * ell_slice_height; i < end && i < num_rows; ++i) {
+          Int const length = a.row_offsets(i + 1) - a.row_offsets(i);
+          width = length > width ? length : width;
+        }
+        counts(s) = width * ell_slice_height;
+      });
+
+  SlicedELLMatrix<MemSpace> result;
+  result.num_rows = num_rows;
+  result.num_cols = a.num_cols;
+  result.slice_offsets = IntView("slice_offsets", static_cast<size_t>(num_slices + 1));
+  Size const num_entries = impl::exclusiveScan(counts, result.slice_offsets);
+  if (num_entries > intMax()) {
+    LOG_ERROR("makeSlicedELLMatrix: ", num_entries, " entries are too many for Int");
+    return {};
+  }
+  result.columns = IntView("columns", static_cast<size_t>(num_entries));
+  result.values =
+      Kokkos::View<Float *, MemSpace>("values", static_cast<size_t>(num_entries));
+
+  auto const ell = result;
+  Kokkos::parallel_for(
+      "juno::makeSlicedELLMatrix", rangePolicy<ExecSpace>(0, num_rows),
+      KOKKOS_LAMBDA(Int const i) {
+        Int k = ell.slice_offsets(i / ell_slice_height) + i % ell_slice_height;
+        for (Int e = a.row_offsets(i); e < a.row_offsets(i + 1); ++e) {
+          ell.columns(k) = a.columns(e);
+          ell.values(k) = a.values(e);
+          k += ell_slice_height;
+        }
+      });
+  return result;
+}
+
+//----------------------------------------------------------------------------------------
+// y = A x, with a thread per row
+template <class Matrix, class MemSpace>
+void
+spmv(Matrix const & a, Kokkos::View<Float *, MemSpace> const & x,
+     Kokkos::View<Float *, MemSpace> const & y)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Kokkos::parallel_for(
+      "juno::spmv", rangePolicy<ExecSpace>(0, a.num_rows),
+      KOKKOS_LAMBDA(Int const i) { y(i) = static_cast<Float>(a.rowDot(i, x)); });
+}
+
+//----------------------------------------------------------------------------------------
+// The position in values of the diagonal entry of each row, or -1 if it is not stored
+template <class MemSpace>
+auto
+diagonalIndices(CSRMatrix<MemSpace> const & a) -> Kokkos::View<Int *, MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Kokkos::View<Int *, MemSpace> const indices("diagonal_indices",
+                                             static_cast<size_t>(a.num_rows));
+  Kokkos::parallel_for(
+      "juno::diagonalIndices", rangePolicy<ExecSpace>(0, a.num_rows),
+      KOKKOS_LAMBDA(Int const i) {
+        indices(i) = -1;
+        for (Int k = a.row_offsets(i); k < a.row_offsets(i + 1); ++k) {
+          if (a.columns(k) == i) {
+            indices(i) = k;
+          }
+        }
+      });
+  return indices;
+}
+
+} // namespace juno
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <juno/config.hpp>
+
+#include <cmath> // std::sqrt
+
+//========================================================================================
+// VEC2
+//========================================================================================
+// A 2D point or vector, usable in host and device code. It is an aggregate, so that
+// arrays of Vec2 are trivially copyable and can be stored in Views.
+
+namespace juno
+{
+
+struct Vec2 {
+  Float x;
+  Float y;
+};
+
+//----------------------------------------------------------------------------------------
+// Arithmetic
+//----------------------------------------------------------------------------------------
+
+HOSTDEV constexpr auto
+operator+(Vec2 const a, Vec2 const b) noexcept -> Vec2
+{
+  return {a.x + b.x, a.y + b.y};
+}
+
+HOSTDEV constexpr auto
+operator-(Vec2 const a, Vec2 const b) noexcept -> Vec2
+{
+  return {a.x - b.x, a.y - b.y};
+}
+
+HOSTDEV constexpr auto
+operator*(Float const s, Vec2 const a) noexcept -> Vec2
+{
+  return {s * a.x, s * a.y};
+}
+
+HOSTDEV constexpr auto
+operator*(Vec2 const a, Float const s) noexcept -> Vec2
+{
+  return {s * a.x, s * a.y};
+}
+
+HOSTDEV constexpr auto
+operator/(Vec2 const a, Float const s) noexcept -> Vec2
+{
+  return {a.x / s, a.y / s};
+}
+
+//----------------------------------------------------------------------------------------
+// Products and norms
+//----------------------------------------------------------------------------------------
+
+HOSTDEV constexpr auto
+dot(Vec2 const a, Vec2 const b) noexcept -> Float
+{
+  return a.x * b.x + a.y * b.y;
+}
+
+// The z-component of the 3D cross product. Positive if b is counter-clockwise of a.
+HOSTDEV constexpr auto
+cross(Vec2 const a, Vec2 const b) noexcept -> Float
+{
+  return a.x * b.y - a.y * b.x;
+}
+
+HOSTDEV constexpr auto
+squaredNorm(Vec2 const a) noexcept -> Float
+{
+  return dot(a, a);
+}
+
+HOSTDEV inline auto
+norm(Vec2 const a) noexcept -> Float
+{
+  return std::sqrt(squaredNorm(a));
+}
+
+HOSTDEV constexpr auto
+squaredDistance(Vec2 const a, Vec2 const b) noexcept -> Float
+{
+  return squaredNorm(a - b);
+}
+
+HOSTDEV inline auto
+distance(Vec2 const a, Vec2 const b) noexcept -> Float
+{
+  return norm(a - b);
+}
+
+} // namespace juno
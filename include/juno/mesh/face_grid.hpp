@@ -0,0 +1,491 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/scan.hpp>
+#include <juno/config.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/math/compare.hpp>
+#include <juno/math/ray2.hpp>
+#include <juno/math/vec2.hpp>
+#include <juno/mesh/face_vertex_mesh.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath>  // std::floor, std::sqrt, std::ceil
+#include <limits> // std::numeric_limits
+#include <string>
+
+//========================================================================================
+// FACE GRID
+//========================================================================================
+// A uniform grid over a FaceVertexMesh. Each cell lists the faces whose bounding box
+// overlaps it, so that a query only tests the faces near it, instead of every face.
+//
+// A uniform grid suits the meshes of reactor geometries, whose faces have similar
+// sizes, and is cheap to build and to traverse on a GPU:
+//  - The cells are stored in CSR form: the faces of cell c are
+//    cell_faces[cell_offsets[c] ... cell_offsets[c + 1]).
+//  - The grid is built in parallel: each face counts the cells it overlaps with
+//    atomics, a scan gives the offsets, and each face writes its ID into its cells.
+//  - A point is located by testing the faces of the cell that contains it.
+//  - A ray visits the cells along it in order (Amanatides and Woo), and is intersected
+//    with the edges of the faces in each cell.
+//
+// Usage:
+//  - buildFaceGrid(mesh, faces_per_cell): build the grid of a mesh in its memory space
+//  - locatePoints(grid, points, faces): the face that contains each point, or -1
+//  - segmentRays(grid, rays): the faces that each ray crosses, and the length of the ray
+//    in each face, in CSR form
+// The grid only reads the Views of the mesh and its own, so it may be captured by value
+// in kernels on MemSpace, and queried there with the HOSTDEV member functions.
+
+namespace juno
+{
+
+template <class MemSpace = HostMemSpace>
+class FaceGrid
+{
+public:
+  using Mesh = FaceVertexMesh<MemSpace>;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+
+  Mesh mesh;
+  AABB2 box;         // the bounding box of the mesh
+  Int nx = 0;        // the number of cells in x
+  Int ny = 0;        // the number of cells in y
+  Float dx = 0;      // the width of a cell
+  Float dy = 0;      // the height of a cell
+  Float tolerance = 0; // intersections closer than this are merged
+  IntView cell_offsets;
+  IntView cell_faces;
+
+  //--------------------------------------------------------------------------------------
+  // Cells
+  //--------------------------------------------------------------------------------------
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  numCells() const noexcept -> Int
+  {
+    return nx * ny;
+  }
+
+  // The column of the cell containing x, clamped to the grid
+  [[nodiscard]] HOSTDEV auto
+  cellX(Float const x) const noexcept -> Int
+  {
+    auto const i = static_cast<Int>(std::floor((x - box.min.x) / dx));
+    return i < 0 ? 0 : (i >= nx ? nx - 1 : i);
+  }
+
+  // The row of the cell containing y, clamped to the grid
+  [[nodiscard]] HOSTDEV auto
+  cellY(Float const y) const noexcept -> Int
+  {
+    auto const j = static_cast<Int>(std::floor((y - box.min.y) / dy));
+    return j < 0 ? 0 : (j >= ny ? ny - 1 : j);
+  }
+
+  [[nodiscard]] HOSTDEV constexpr auto
+  cellIndex(Int const i, Int const j) const noexcept -> Int
+  {
+    return j * nx + i;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Queries
+  //--------------------------------------------------------------------------------------
+
+  // The face that contains p, or -1 if p is outside the mesh
+  [[nodiscard]] HOSTDEV auto
+  locate(Vec2 const p) const noexcept -> Int
+  {
+    if (!box.contains(p)) {
+      return -1;
+    }
+    Int const c = cellIndex(cellX(p.x), cellY(p.y));
+    for (Int k = cell_offsets(c); k < cell_offsets(c + 1); ++k) {
+      Int const f = cell_faces(k);
+      if (mesh.faceBoundingBox(f).contains(p) && mesh.faceContains(f, p)) {
+        return f;
+      }
+    }
+    return -1;
+  }
+
+  // Call f(cell) for each cell that the ray crosses, in order along the ray
+  template <class F>
+  HOSTDEV void
+  forEachCellOnRay(Ray2 const & ray, F && f) const noexcept
+  {
+    // Clip the ray to the box (slab test)
+    Float t0 = 0;
+    Float t1 = ray.length;
+    Float const o[2] = {ray.origin.x, ray.origin.y};
+    Float const d[2] = {ray.direction.x, ray.direction.y};
+    Float const lo[2] = {box.min.x, box.min.y};
+    Float const hi[2] = {box.max.x, box.max.y};
+    for (Int a = 0; a < 2; ++a) {
+      if (isZero(d[a])) {
+        if (o[a] < lo[a] || hi[a] < o[a]) {
+          return;
+        }
+      } else {
+        Float ta = (lo[a] - o[a]) / d[a];
+        Float tb = (hi[a] - o[a]) / d[a];
+        if (tb < ta) {
+          Float const tmp = ta;
+          ta = tb;
+          tb = tmp;
+        }
+        t0 = ta > t0 ? ta : t0;
+        t1 = tb < t1 ? tb : t1;
+      }
+    }
+    if (t1 < t0) {
+      return;
+    }
+
+    // Step through the cells
+    Vec2 const p = ray(t0);
+    Int i = cellX(p.x);
+    Int j = cellY(p.y);
+    Float constexpr inf = std::numeric_limits<Float>::max();
+    Int const step_x = ray.direction.x > 0 ? 1 : -1;
+    Int const step_y = ray.direction.y > 0 ? 1 : -1;
+    Float t_max_x = inf;
+    Float t_max_y = inf;
+    Float t_delta_x = inf;
+    Float t_delta_y = inf;
+    if (!isZero(ray.direction.x)) {
+      Float const next_x = box.min.x + static_cast<Float>(i + (step_x > 0 ? 1 : 0)) * dx;
+      t_max_x = (next_x - ray.origin.x) / ray.direction.x;
+      t_delta_x = dx / (ray.direction.x > 0 ? ray.direction.x : -ray.direction.x);
+    }
+    if (!isZero(ray.direction.y)) {
+      Float const next_y = box.min.y + static_cast<Float>(j + (step_y > 0 ? 1 : 0)) * dy;
+      t_max_y = (next_y - ray.origin.y) / ray.direction.y;
+      t_delta_y = dy / (ray.direction.y > 0 ? ray.direction.y : -ray.direction.y);
+    }
+    while (true) {
+      f(cellIndex(i, j));
+      if (t_max_x < t_max_y) {
+        if (t_max_x > t1) {
+          return;
+        }
+        i += step_x;
+        if (i < 0 || nx <= i) {
+          return;
+        }
+        t_max_x += t_delta_x;
+      } else {
+        if (t_max_y > t1) {
+          return;
+        }
+        j += step_y;
+        if (j < 0 || ny <= j) {
+          return;
+        }
+        t_max_y += t_delta_y;
+      }
+    }
+  }
+
+  // Call f(t) for each crossing of the ray with an edge of a face in a cell along the
+  // ray, in the order of the cells. An edge that is in several cells along the ray is
+  // reported once for each.
+  template <class F>
+  HOSTDEV void
+  forEachIntersection(Ray2 const & ray, F && f) const noexcept
+  {
+    forEachCellOnRay(ray, [&](Int const c) {
+      for (Int k = cell_offsets(c); k < cell_offsets(c + 1); ++k) {
+        Int const face = cell_faces(k);
+        Int const n = mesh.faceSize(face);
+        Vec2 a = mesh.getFaceVertex(face, n - 1);
+        for (Int v = 0; v < n; ++v) {
+          Vec2 const b = mesh.getFaceVertex(face, v);
+          Float const t = intersect(ray, a, b);
+          if (t >= 0) {
+            f(t);
+          }
+          a = b;
+        }
+      }
+    });
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Build the grid of a mesh, with about faces_per_cell faces in each cell
+template <class MemSpace>
+auto
+buildFaceGrid(FaceVertexMesh<MemSpace> const & mesh, Float const faces_per_cell = 2)
+    -> FaceGrid<MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  using IntView = typename FaceGrid<MemSpace>::IntView;
+  Int const num_faces = mesh.numFaces();
+
+  FaceGrid<MemSpace> grid;
+  grid.mesh = mesh;
+
+  // The bounding box of the mesh
+  AABB2 box;
+  auto const x = mesh.x();
+  auto const y = mesh.y();
+  Kokkos::parallel_reduce(
+      "juno::buildFaceGrid::box", rangePolicy<ExecSpace>(0, mesh.numVertices()),
+      KOKKOS_LAMBDA(Int const i, Float & min_x, Float & min_y, Float & max_x,
+                    Float & max_y) {
+        min_x = x(i) < min_x ? x(i) : min_x;
+        min_y = y(i) < min_y ? y(i) : min_y;
+        max_x = x(i) > max_x ? x(i) : max_x;
+        max_y = y(i) > max_y ? y(i) : max_y;
+      },
+      Kokkos::Min<Float>(box.min.x), Kokkos::Min<Float>(box.min.y),
+      Kokkos::Max<Float>(box.max.x), Kokkos::Max<Float>(box.max.y));
+  grid.box = box;
+
+  // Cells of about the same width and height
+  Float const width = box.width() > 0 ? box.width() : 1;
+  Float const height = box.height() > 0 ? box.height() : 1;
+  Float const target_cells = static_cast<Float>(num_faces) / faces_per_cell;
+  Float const num_target_cells = target_cells > 1 ? target_cells : 1;
+  Float const cell_size = std::sqrt(width * height / num_target_cells);
+  grid.nx = static_cast<Int>(std::ceil(width / cell_size));
+  grid.ny = static_cast<Int>(std::ceil(height / cell_size));
+  grid.nx = grid.nx > 0 ? grid.nx : 1;
+  grid.ny = grid.ny > 0 ? grid.ny : 1;
+  grid.dx = width / static_cast<Float>(grid.nx);
+  grid.dy = height / static_cast<Float>(grid.ny);
+  Float const extent = width > height ? width : height;
+  grid.tolerance = 16 * std::numeric_limits<Float>::epsilon() * extent;
+
+  // Count the faces in each cell. Use the grid, without its cells, to find the cells of
+  // each face.
+  Int const num_cells = grid.numCells();
+  IntView const offsets("juno::FaceGrid::cell_offsets",
+                        static_cast<size_t>(num_cells) + 1);
+  FaceGrid<MemSpace> const g = grid;
+  Kokkos::parallel_for(
+      "juno::buildFaceGrid::count", rangePolicy<ExecSpace>(0, num_faces),
+      KOKKOS_LAMBDA(Int const f) {
+        AABB2 const fbox = g.mesh.faceBoundingBox(f);
+        for (Int j = g.cellY(fbox.min.y); j <= g.cellY(fbox.max.y); ++j) {
+          for (Int i = g.cellX(fbox.min.x); i <= g.cellX(fbox.max.x); ++i) {
+            Kokkos::atomic_add(&offsets(g.cellIndex(i, j) + 1), Int{1});
+          }
+        }
+      });
+
+  // Offsets, by an inclusive scan of the counts
+  Kokkos::parallel_scan(
+      "juno::buildFaceGrid::scan", rangePolicy<ExecSpace>(1, num_cells + 1),
+      KOKKOS_LAMBDA(Int const c, Int & partial, bool const is_final) {
+        partial += offsets(c);
+        if (is_final) {
+          offsets(c) = partial;
+        }
+      });
+
+  // Fill the cells, then sort each cell, so that the order does not depend on the
+  // scheduling of the threads
+  Int num_entries = 0;
+  Kokkos::deep_copy(num_entries, Kokkos::subview(offsets, num_cells));
+  IntView const faces(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                         std::string("juno::FaceGrid::cell_faces")),
+                      static_cast<size_t>(num_entries));
+  IntView const next(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                        std::string("juno::FaceGrid::next")),
+                     static_cast<size_t>(num_cells));
+  Kokkos::parallel_for(
+      "juno::buildFaceGrid::init", rangePolicy<ExecSpace>(0, num_cells),
+      KOKKOS_LAMBDA(Int const c) { next(c) = offsets(c); });
+  Kokkos::parallel_for(
+      "juno::buildFaceGrid::fill", rangePolicy<ExecSpace>(0, num_faces),
+      KOKKOS_LAMBDA(Int const f) {
+        AABB2 const fbox = g.mesh.faceBoundingBox(f);
+        for (Int j = g.cellY(fbox.min.y); j <= g.cellY(fbox.max.y); ++j) {
+          for (Int i = g.cellX(fbox.min.x); i <= g.cellX(fbox.max.x); ++i) {
+            Int const k = Kokkos::atomic_fetch_add(&next(g.cellIndex(i, j)), Int{1});
+            faces(k) = f;
+          }
+        }
+      });
+  Kokkos::parallel_for(
+      "juno::buildFaceGrid::sort", rangePolicy<ExecSpace>(0, num_cells),
+      KOKKOS_LAMBDA(Int const c) {
+        // Insertion sort: cells hold few faces
+        for (Int k = offsets(c) + 1; k < offsets(c + 1); ++k) {
+          Int const f = faces(k);
+          Int m = k;
+          for (; m > offsets(c) && faces(m - 1) > f; --m) {
+            faces(m) = faces(m - 1);
+          }
+          faces(m) = f;
+        }
+      });
+
+  grid.cell_offsets = offsets;
+  grid.cell_faces = faces;
+  return grid;
+}
+
+//----------------------------------------------------------------------------------------
+// Find the face that contains each point, or -1 for points outside the mesh
+template <class MemSpace>
+void
+locatePoints(FaceGrid<MemSpace> const & grid,
+             Kokkos::View<Vec2 *, MemSpace> const & points,
+             Kokkos::View<Int *, MemSpace> const & faces)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Kokkos::parallel_for(
+      "juno::locatePoints", rangePolicy<ExecSpace>(0, static_cast<Int>(points.size())),
+      KOKKOS_LAMBDA(Int const i) { faces(i) = grid.locate(points(i)); });
+}
+
+//----------------------------------------------------------------------------------------
+// The segments of a batch of rays, in CSR form. The segments of ray r are
+// [offsets[r] ... offsets[r + 1]), in order along the ray. Segment s is the part of the
+// ray in face faces[s], and has length lengths[s].
+template <class MemSpace = HostMemSpace>
+struct RaySegments {
+  Kokkos::View<Int *, MemSpace> offsets;
+  Kokkos::View<Int *, MemSpace> faces;
+  Kokkos::View<Float *, MemSpace> lengths;
+};
+
+namespace impl
+{
+
+//----------------------------------------------------------------------------------------
+// Call f(face, length) for each segment of a ray, given its sorted crossings
+// ts[0 ... num_crossings). The segments are the intervals between 0, the crossings, and
+// the length of the ray, whose midpoint is in a face.
+template <class MemSpace, class F>
+HOSTDEV void
+forEachSegment(FaceGrid<MemSpace> const & grid, Ray2 const & ray, Float const * ts,
+               Int const num_crossings, F && f) noexcept
+{
+  Float t_prev = 0;
+  for (Int k = 0; k <= num_crossings; ++k) {
+    Float const t = k < num_crossings ? ts[k] : ray.length;
+    if (t - t_prev > grid.tolerance) {
+      Int const face = grid.locate(ray((t_prev + t) / 2));
+      if (face >= 0) {
+        f(face, t - t_prev);
+      }
+    }
+    t_prev = t;
+  }
+}
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+// Split each ray into the segments in each face of the mesh. Parts of a ray outside the
+// mesh are skipped.
+//
+// This is done in three passes over the rays, so that no kernel needs storage of
+// unknown size:
+//  1. count the edge crossings of each ray, and scan the counts.
+//  2. store the crossings, sort them, merge those closer than the tolerance, and count
+//     the segments whose midpoint is in a face. Scan the counts.
+//  3. write the face and length of each segment.
+template <class MemSpace>
+auto
+segmentRays(FaceGrid<MemSpace> const & grid, Kokkos::View<Ray2 *, MemSpace> const & rays)
+    -> RaySegments<MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+  auto const num_rays = static_cast<Int>(rays.size());
+  auto const alloc = [](std::string const & label) {
+    return Kokkos::view_alloc(Kokkos::WithoutInitializing, label);
+  };
+
+  // 1. Count the crossings
+  IntView const counts("juno::segmentRays::counts", static_cast<size_t>(num_rays));
+  Kokkos::parallel_for(
+      "juno::segmentRays::countCrossings", rangePolicy<ExecSpace>(0, num_rays),
+      KOKKOS_LAMBDA(Int const r) {
+        Int n = 0;
+        grid.forEachIntersection(rays(r), [&n](Float) { ++n; });
+        counts(r) = n;
+      });
+  IntView const crossing_offsets("juno::segmentRays::crossing_offsets",
+                                 static_cast<size_t>(num_rays) + 1);
+  Size const num_crossings = impl::exclusiveScan(counts, crossing_offsets);
+  if (num_crossings > intMax()) {
+    LOG_ERROR("segmentRays: ", num_crossings, " crossings are too many for Int; segment "
+              "fewer rays at a time");
+    return {};
+  }
+
+  // 2. Store, sort, and merge the crossings, then count the segments
+  FloatView const ts(alloc("juno::segmentRays::crossings"),
+                     static_cast<size_t>(num_crossings));
+  IntView const unique_counts(alloc("juno::segmentRays::unique_counts"),
+                              static_cast<size_t>(num_rays));
+  Kokkos::parallel_for(
+      "juno::segmentRays::sortCrossings", rangePolicy<ExecSpace>(0, num_rays),
+      KOKKOS_LAMBDA(Int const r) {
+        Float * const t_ray = ts.data() + crossing_offsets(r);
+        Int n = 0;
+        grid.forEachIntersection(rays(r), [&](Float const t) {
+          // Insertion sort: the cells are visited in order along the ray, so the
+          // crossings are almost sorted
+          Int m = n;
+          for (; m > 0 && t_ray[m - 1] > t; --m) {
+            t_ray[m] = t_ray[m - 1];
+          }
+          t_ray[m] = t;
+          ++n;
+        });
+        // Merge crossings within the tolerance, e.g. an edge shared by two faces
+        Int unique = 0;
+        for (Int k = 0; k < n; ++k) {
+          if (unique == 0 || t_ray[k] - t_ray[unique - 1] > grid.tolerance) {
+            t_ray[unique] = t_ray[k];
+            ++unique;
+          }
+        }
+        unique_counts(r) = unique;
+        Int num_ray_segments = 0;
+        impl::forEachSegment(grid, rays(r), t_ray, unique,
+                             [&num_ray_segments](Int, Float) { ++num_ray_segments; });
+        counts(r) = num_ray_segments;
+      });
+  RaySegments<MemSpace> segments;
+  segments.offsets =
+      IntView("juno::RaySegments::offsets", static_cast<size_t>(num_rays) + 1);
+  // No more than the crossings
+  auto const num_segments =
+      static_cast<Int>(impl::exclusiveScan(counts, segments.offsets));
+
+  // 3. Write the segments
+  segments.faces =
+      IntView(alloc("juno::RaySegments::faces"), static_cast<size_t>(num_segments));
+  segments.lengths =
+      FloatView(alloc("juno::RaySegments::lengths"), static_cast<size_t>(num_segments));
+  auto const offsets = segments.offsets;
+  auto const faces = segments.faces;
+  auto const lengths = segments.lengths;
+  Kokkos::parallel_for(
+      "juno::segmentRays::writeSegments", rangePolicy<ExecSpace>(0, num_rays),
+      KOKKOS_LAMBDA(Int const r) {
+        Int s = offsets(r);
+        impl::forEachSegment(grid, rays(r), ts.data() + crossing_offsets(r),
+                             unique_counts(r), [&](Int const face, Float const length) {
+                               faces(s) = face;
+                               lengths(s) = length;
+                               ++s;
+                             });
+      });
+  return segments;
+}
+
+} // namespace juno
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/math/vec2.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <utility> // std::move
+
+//========================================================================================
+// FACE-VERTEX MESH
+//========================================================================================
+// A 2D mesh of linear polygons, defined by the vertices of each face, for geometry
+// queries on the host or the device.
+//
+// The data is stored as a structure of arrays in Views in MemSpace:
+//  - x, y: the vertex coordinates
+//  - face_offsets, face_vertices: the vertices of each face in CSR form, in
+//    counter-clockwise order. The vertices of face i are face_vertices[face_offsets[i]
+//    ... face_offsets[i + 1]).
+//  - vertex_face_offsets, vertex_faces: the faces that share each vertex in CSR form,
+//    in increasing order.
+//
+// The member functions that take a face or vertex ID only read the Views, so a mesh
+// may be captured by value in a kernel on MemSpace, and queried there.
+// Build a mesh from a PolytopeSoup on the host with makeFaceVertexMesh, then mirror it
+// to the device with mirror<MemSpace>(), which copies each View in a single transfer.
+// Like Kokkos::View, copies of a mesh are shallow.
+
+namespace juno
+{
+
+template <class MemSpace = HostMemSpace>
+class FaceVertexMesh
+{
+public:
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+
+private:
+  FloatView _x;
+  FloatView _y;
+  IntView _face_offsets;
+  IntView _face_vertices;
+  IntView _vertex_face_offsets;
+  IntView _vertex_faces;
+
+public:
+  //--------------------------------------------------------------------------------------
+  // Constructors
+  //--------------------------------------------------------------------------------------
+
+  FaceVertexMesh() = default;
+
+  FaceVertexMesh(FloatView x, FloatView y, IntView face_offsets, IntView face_vertices,
+                 IntView vertex_face_offsets, IntView vertex_faces) noexcept
+      : _x(std::move(x)),
+        _y(std::move(y)),
+        _face_offsets(std::move(face_offsets)),
+        _face_vertices(std::move(face_vertices)),
+        _vertex_face_offsets(std::move(vertex_face_offsets)),
+        _vertex_faces(std::move(vertex_faces))
+  {
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Accessors
+  //--------------------------------------------------------------------------------------
+
+  [[nodiscard]] HOSTDEV auto
+  numVertices() const noexcept -> Int
+  {
+    return static_cast<Int>(_x.size());
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  numFaces() const noexcept -> Int
+  {
+    return _face_offsets.size() == 0 ? 0 : static_cast<Int>(_face_offsets.size()) - 1;
+  }
+
+  [[nodiscard]] auto
+  x() const noexcept -> FloatView const &
+  {
+    return _x;
+  }
+
+  [[nodiscard]] auto
+  y() const noexcept -> FloatView const &
+  {
+    return _y;
+  }
+
+  [[nodiscard]] auto
+  faceOffsets() const noexcept -> IntView const &
+  {
+    return _face_offsets;
+  }
+
+  [[nodiscard]] auto
+  faceVertices() const noexcept -> IntView const &
+  {
+    return _face_vertices;
+  }
+
+  [[nodiscard]] auto
+  vertexFaceOffsets() const noexcept -> IntView const &
+  {
+    return _vertex_face_offsets;
+  }
+
+  [[nodiscard]] auto
+  vertexFaces() const noexcept -> IntView const &
+  {
+    return _vertex_faces;
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  getVertex(Int const i) const noexcept -> Vec2
+  {
+    return {_x(i), _y(i)};
+  }
+
+  // The number of vertices of face f
+  [[nodiscard]] HOSTDEV auto
+  faceSize(Int const f) const noexcept -> Int
+  {
+    return _face_offsets(f + 1) - _face_offsets(f);
+  }
+
+  // The ID of the k-th vertex of face f
+  [[nodiscard]] HOSTDEV auto
+  faceVertex(Int const f, Int const k) const noexcept -> Int
+  {
+    return _face_vertices(_face_offsets(f) + k);
+  }
+
+  // The k-th vertex of face f
+  [[nodiscard]] HOSTDEV auto
+  getFaceVertex(Int const f, Int const k) const noexcept -> Vec2
+  {
+    return getVertex(faceVertex(f, k));
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Geometry
+  //--------------------------------------------------------------------------------------
+
+  // The signed area of face f, by the shoelace formula. Positive, since the vertices
+  // are counter-clockwise.
+  [[nodiscard]] HOSTDEV auto
+  faceArea(Int const f) const noexcept -> Float
+  {
+    Int const n = faceSize(f);
+    Vec2 const origin = getFaceVertex(f, 0);
+    Float twice_area = 0;
+    for (Int k = 1; k + 1 < n; ++k) {
+      twice_area += cross(getFaceVertex(f, k) - origin, getFaceVertex(f, k + 1) - origin);
+    }
+    return twice_area / 2;
+  }
+
+  // The centroid of face f
+  [[nodiscard]] HOSTDEV auto
+  faceCentroid(Int const f) const noexcept -> Vec2
+  {
+    // Area-weighted centroids of the triangles of a fan around the first vertex,
+    // relative to the first vertex to limit round-off
+    Int const n = faceSize(f);
+    Vec2 const origin = getFaceVertex(f, 0);
+    Float twice_area = 0;
+    Vec2 sum = {0, 0};
+    for (Int k = 1; k + 1 < n; ++k) {
+      Vec2 const a = getFaceVertex(f, k) - origin;
+      Vec2 const b = getFaceVertex(f, k + 1) - origin;
+      Float const t = cross(a, b);
+      twice_area += t;
+      sum = sum + t * (a + b);
+    }
+    return origin + sum / (3 * twice_area);
+  }
+
+  // The bounding box of face f
+  [[nodiscard]] HOSTDEV auto
+  faceBoundingBox(Int const f) const noexcept -> AABB2
+  {
+    AABB2 box;
+    for (Int k = 0; k < faceSize(f); ++k) {
+      box.grow(getFaceVertex(f, k));
+    }
+    return box;
+  }
+
+  // True if p is in face f. A point on an edge shared by two faces is assigned to one
+  // of them, so that the faces of a mesh do not overlap.
+  [[nodiscard]] HOSTDEV auto
+  faceContains(Int const f, Vec2 const p) const noexcept -> bool
+  {
+    // Crossing number: count the edges that cross the horizontal ray from p to +x.
+    // Half-open in y, so a vertex on the ray is counted once.
+    Int const n = faceSize(f);
+    bool inside = false;
+    Vec2 a = getFaceVertex(f, n - 1);
+    for (Int k = 0; k < n; ++k) {
+      Vec2 const b = getFaceVertex(f, k);
+      if ((a.y <= p.y) != (b.y <= p.y)) {
+        Float const x_cross = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+        if (p.x < x_cross) {
+          inside = !inside;
+        }
+      }
+      a = b;
+    }
+    return inside;
+  }
+
+  // The face across edge k of face f, from vertex k to vertex k + 1, or -1 if the edge
+  // is on the boundary: the face other than f in the sorted face lists of both
+  // vertices.
+  [[nodiscard]] HOSTDEV auto
+  edgeNeighbor(Int const f, Int const k) const noexcept -> Int
+  {
+    Int const a = faceVertex(f, k);
+    Int const b = faceVertex(f, (k + 1) % faceSize(f));
+    Int i = _vertex_face_offsets(a);
+    Int j = _vertex_face_offsets(b);
+    Int const i_end = _vertex_face_offsets(a + 1);
+    Int const j_end = _vertex_face_offsets(b + 1);
+    while (i < i_end && j < j_end) {
+      Int const fa = _vertex_faces(i);
+      Int const fb = _vertex_faces(j);
+      if (fa < fb) {
+        ++i;
+      } else if (fb < fa) {
+        ++j;
+      } else {
+        if (fa != f) {
+          return fa;
+        }
+        ++i;
+        ++j;
+      }
+    }
+    return -1;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Copy the mesh to OtherMemSpace. Each View is copied in a single transfer, or not at
+  // all if OtherMemSpace is MemSpace.
+  template <class OtherMemSpace>
+  [[nodiscard]] auto
+  mirror() const -> FaceVertexMesh<OtherMemSpace>
+  {
+    auto const copy = [](auto const & v) {
+      return Kokkos::create_mirror_view_and_copy(OtherMemSpace(), v);
+    };
+    return {copy(_x),
+            copy(_y),
+            copy(_face_offsets),
+            copy(_face_vertices),
+            copy(_vertex_face_offsets),
+            copy(_vertex_faces)};
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Build a face-vertex mesh from the 2D faces of a soup: triangles, quadrilaterals, and
+// polygons. The z-coordinates are ignored. Faces with clockwise vertices are reversed.
+// Logs an error if the soup contains other element types.
+auto
+makeFaceVertexMesh(PolytopeSoup<HostMemSpace> const & soup)
+    -> FaceVertexMesh<HostMemSpace>;
+
+} // namespace juno
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <juno/common/communicator.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/mirrored_view.hpp>
+#include <juno/config.hpp>
+#include <juno/mesh/face_vertex_mesh.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility> // std::make_pair
+#include <vector>
+
+//========================================================================================
+// FIELD WRITER
+//========================================================================================
+// Output of fields on the faces of a mesh, e.g. the scalar flux and the pin powers of
+// each iteration, as HDF5 files with XDMF metadata, for ParaView or VisIt.
+//
+// The writer:
+//  - writes one HDF5 file per rank, <prefix>_r<rank>.h5, with the rank's part of the
+//    mesh (/mesh/vertices and /mesh/topology, in the XDMF "Mixed" layout) and, for
+//    each step, the fields of its faces (/steps/<step>/<name>), so no rank waits for
+//    another, and nothing is gathered to rank 0. Rank 0 also writes <prefix>.xmf, a
+//    temporal collection of the steps, each a spatial collection of the ranks' parts.
+//  - chunks the datasets by FieldWriterOptions::chunk_size faces, and compresses them
+//    with deflate at FieldWriterOptions::compression, if it is not 0.
+//  - writes asynchronously. write() copies the fields, from any memory space, to pinned
+//    host buffers on the execution space instance given, fences it, and returns; a
+//    thread of the writer writes the files while the solver continues. The staging
+//    buffers are reused once their step is written. At most max_pending steps wait to
+//    be written: write() blocks until there is room, so a slow disk bounds the memory.
+//  - flush() waits for the pending steps, then adds those that every rank has written
+//    to the XDMF file, so that it never names data that another rank has yet to write,
+//    or failed to. Until then, the steps are in the HDF5 files only. The destructor
+//    flushes and closes the files.
+//  - logs an error and is not open if the files cannot be created, or if juno was
+//    built without HDF5 (JUNO_USE_HDF5). Errors of the writer thread are logged, and
+//    the steps that failed are skipped.
+//
+// The constructor, flush() and the destructor are collective: every rank of the
+// communicator must construct the writer, write the same fields in the same steps, and
+// flush it at the same points.
+//
+// Usage:
+//   juno::FieldWriter writer("output/flux", mesh, comm);
+//   for (Int iteration = 0; ...; ++iteration) {
+//     sweeper.sweep(xs, face_materials, source, flux);
+//     // flux: num_faces * stride values, by face then group
+//     writer.write(iteration, {{"flux", flux, num_groups, stride}});
+//   }
+//   writer.flush();
+
+namespace juno
+{
+
+struct FieldWriterOptions {
+  Int chunk_size = 1 << 14; // faces per chunk
+  int32_t compression = 0;  // deflate level, 1 to 9, or 0 for none
+  Int max_pending = 2;      // steps that may wait to be written
+};
+
+// A field to write: num_components values per face, every stride values, from a View
+// in MemSpace
+template <class MemSpace = DeviceMemSpace>
+struct Field {
+  std::string name;
+  Kokkos::View<Float *, MemSpace> values;
+  Int num_components = 1;
+  Int stride = 0; // num_components if 0
+};
+
+namespace impl
+{
+
+using StagingView = Kokkos::View<Float *, HostPinnedSpace>;
+
+struct StagedField {
+  std::string name;
+  StagingView buffer; // the field is its first size values
+  size_t size;
+  Int num_components;
+  Int stride;
+};
+
+struct FieldWriterState;
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+class FieldWriter
+{
+  std::unique_ptr<impl::FieldWriterState> _state;
+  Int _num_faces = 0;
+
+  // A pinned host buffer of at least n values, reused from a written step if possible
+  [[nodiscard]] auto
+  acquireStaging(size_t n) -> impl::StagingView;
+
+  // Queue the staged fields of a step for the writer thread
+  void
+  enqueue(double time, std::vector<impl::StagedField> && fields);
+
+public:
+  FieldWriter();
+
+  // Create the files of this rank, and write its part of the mesh
+  FieldWriter(std::string const & prefix, FaceVertexMesh<HostMemSpace> const & mesh,
+              Communicator const & comm = {}, FieldWriterOptions const & options = {});
+
+  FieldWriter(FieldWriter const &) = delete;
+  FieldWriter(FieldWriter &&) noexcept;
+  auto
+  operator=(FieldWriter const &) -> FieldWriter & = delete;
+  auto
+  operator=(FieldWriter &&) noexcept -> FieldWriter &;
+
+  // Flush, and close the files
+  ~FieldWriter();
+
+  [[nodiscard]] auto
+  isOpen() const noexcept -> bool;
+
+  // The number of steps written or queued
+  [[nodiscard]] auto
+  numSteps() const noexcept -> Int;
+
+  // Copy the fields to the staging buffers, and queue them as the next step, at time
+  // "time". Each field must have num_faces * stride values.
+  template <class MemSpace, class ExecSpace = typename MemSpace::execution_space>
+  void
+  write(double time, std::vector<Field<MemSpace>> const & fields,
+        ExecSpace const & space = ExecSpace());
+
+  // Wait until the queued steps are written, and add them to the XDMF file. Collective.
+  void
+  flush();
+};
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace, class ExecSpace>
+void
+FieldWriter::write(double const time, std::vector<Field<MemSpace>> const & fields,
+                   ExecSpace const & space)
+{
+  if (!isOpen()) {
+    return;
+  }
+  for (auto const & field : fields) {
+    Int const stride = field.stride > 0 ? field.stride : field.num_components;
+    auto const n = static_cast<size_t>(_num_faces) * static_cast<size_t>(stride);
+    if (field.values.size() != n || field.num_components < 1 ||
+        field.num_components > stride) {
+      LOG_ERROR("FieldWriter: field '", field.name, "' has ",
+                static_cast<uint64_t>(field.values.size()), " values, not ",
+                static_cast<uint64_t>(n));
+      return;
+    }
+  }
+  std::vector<impl::StagedField> staged;
+  for (auto const & field : fields) {
+    Int const stride = field.stride > 0 ? field.stride : field.num_components;
+    auto const n = static_cast<size_t>(_num_faces) * static_cast<size_t>(stride);
+    auto const buffer = acquireStaging(n);
+    Kokkos::deep_copy(space, Kokkos::subview(buffer, std::make_pair(size_t{0}, n)),
+                      field.values);
+    staged.push_back({field.name, buffer, n, field.num_components, stride});
+  }
+  space.fence("juno::FieldWriter::write");
+  enqueue(time, std::move(staged));
+}
+
+} // namespace juno
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <juno/common/mapped_file.hpp>
+#include <juno/mesh/face_grid.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//========================================================================================
+// MESH CACHE
+//========================================================================================
+// A binary file holding a mesh after it has been parsed and indexed, so that later runs
+// can skip reading the mesh file and building the spatial index.
+//
+// The file:
+//  - is versioned, and records the sizes of Float and Int. A file written by another
+//    version or build configuration is rejected.
+//  - records the hash of the source of the mesh (e.g. hashFile of the Gmsh file). A
+//    file whose source hash differs from the one given on reading is stale, and is
+//    rejected. It also records a hash of its contents, to detect a damaged file.
+//  - holds the arrays of the FaceGrid (including its FaceVertexMesh) and the element
+//    sets, each aligned to 64 bytes.
+//  - is written to a temporary file which then replaces the destination, so a reader
+//    never sees a partly written cache.
+//
+// Reading maps the file (copy-on-write) and points the Views at the mapped arrays, so
+// nothing is copied or parsed. The mapped Views are unmanaged: they stay valid while
+// any copy of the MeshCache they were read into is alive. Mirroring the mesh to a
+// device copies it, so the device copy does not depend on the cache.
+//
+// Usage:
+//   uint64_t const source_hash = juno::hashFile("mesh.msh");
+//   auto cache = juno::readMeshCache("mesh.cache", source_hash);
+//   if (cache.empty()) {
+//     auto const soup = juno::readGmshFile("mesh.msh");
+//     cache = juno::makeMeshCache(soup);
+//     juno::writeMeshCache("mesh.cache", cache, source_hash);
+//   }
+
+namespace juno
+{
+
+namespace mesh_cache
+{
+inline constexpr uint32_t version = 1;
+inline constexpr size_t alignment = 64;
+} // namespace mesh_cache
+
+struct MeshCache {
+  using IntView = Kokkos::View<Int *, HostMemSpace>;
+
+  FaceGrid<HostMemSpace> grid;
+  std::vector<std::string> element_set_names;
+  IntView element_set_offsets;
+  IntView element_set_elements;
+
+  // The mapping that the Views point into, if the cache was read from a file
+  std::shared_ptr<MappedFile const> file;
+
+  [[nodiscard]] auto
+  empty() const noexcept -> bool
+  {
+    return grid.mesh.numFaces() == 0;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Build the mesh and its spatial index, and take the element sets, from a soup
+auto
+makeMeshCache(PolytopeSoup<HostMemSpace> const & soup, Float faces_per_cell = 2)
+    -> MeshCache;
+
+//----------------------------------------------------------------------------------------
+// Write a cache to a file. Logs an error and returns false if it cannot be written.
+auto
+writeMeshCache(std::string const & filename, MeshCache const & cache,
+               uint64_t source_hash) -> bool;
+
+//----------------------------------------------------------------------------------------
+// Read a cache from a file. Returns an empty cache if the file does not exist, or is
+// stale, from another version, or damaged, and logs the reason at the info level,
+// since a missing or stale cache is expected.
+auto
+readMeshCache(std::string const & filename, uint64_t source_hash) -> MeshCache;
+
+} // namespace juno
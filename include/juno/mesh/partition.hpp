@@ -0,0 +1,105 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/mesh/face_vertex_mesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+//========================================================================================
+// PARTITION
+//========================================================================================
+// The decomposition of a 2D domain into blocks, for distributed runs: one block per
+// rank, each with the mesh of its faces.
+//
+// The blocks are a num_x by num_y grid of boxes of the same size over the bounding box
+// of the mesh, numbered by row, b = j num_x + i. Slabs are a grid with one row or one
+// column. The blocks are boxes, rather than the parts of a graph partition, since the
+// tracks of a transport sweep are laid over each block: with boxes of the same size, the
+// tracks of every block are the same, translated, and each track that leaves a block
+// continues into a track of its neighbor (see TrackLayout::translated_links). The
+// neighbor across a side of the domain is -1, unless the domain is periodic in that
+// direction, in which case it is the block on the other side, which may be the block
+// itself.
+//
+// Each face belongs to the block that contains its centroid. The mesh must conform to
+// the blocks, with no face across the side of a block, since the tracks of a block
+// only cross its box; partitionFaces logs an error if a face does not fit its block.
+//
+// Usage:
+//   auto const blocks = juno::makeBlockDecomposition(box, comm.size());
+//   auto const face_blocks = juno::partitionFaces(mesh, blocks);
+//   auto const submesh = juno::extractSubmesh(mesh, face_blocks, comm.rank());
+//   // submesh.faces[f] is the face of the mesh that is face f of submesh.mesh
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+struct BlockDecomposition {
+  AABB2 box;
+  Int num_x = 0;
+  Int num_y = 0;
+  bool periodic_x = false;
+  bool periodic_y = false;
+
+  [[nodiscard]] auto
+  numBlocks() const noexcept -> Int
+  {
+    return num_x * num_y;
+  }
+
+  [[nodiscard]] auto
+  blockWidth() const noexcept -> Float
+  {
+    return box.width() / static_cast<Float>(num_x);
+  }
+
+  [[nodiscard]] auto
+  blockHeight() const noexcept -> Float
+  {
+    return box.height() / static_cast<Float>(num_y);
+  }
+
+  // The box of block b
+  [[nodiscard]] auto
+  blockBox(Int b) const noexcept -> AABB2;
+
+  // The block that contains p, or the nearest block if none does
+  [[nodiscard]] auto
+  blockOf(Vec2 p) const noexcept -> Int;
+
+  // The neighbor of block b across a side (box_sides), or -1 if there is none
+  [[nodiscard]] auto
+  neighbor(Int b, int32_t side) const noexcept -> Int;
+};
+
+// A grid of num_blocks blocks over the box, with the blocks as square as possible.
+// Logs an error and returns an empty decomposition if the box is empty or num_blocks
+// is not positive.
+auto
+makeBlockDecomposition(AABB2 const & box, Int num_blocks) -> BlockDecomposition;
+
+// A num_x by num_y grid of blocks over the box
+auto
+makeBlockDecomposition(AABB2 const & box, Int num_x, Int num_y) -> BlockDecomposition;
+
+//----------------------------------------------------------------------------------------
+// The block of each face. Logs an error and returns an empty vector if a face does not
+// fit in its block.
+auto
+partitionFaces(FaceVertexMesh<HostMemSpace> const & mesh,
+               BlockDecomposition const & blocks) -> std::vector<Int>;
+
+struct Submesh {
+  FaceVertexMesh<HostMemSpace> mesh;
+  std::vector<Int> faces; // the face of the whole mesh of each face, in increasing order
+};
+
+// The faces of a block, and their vertices, as a mesh of their own
+auto
+extractSubmesh(FaceVertexMesh<HostMemSpace> const & mesh,
+               std::vector<Int> const & face_blocks, Int block) -> Submesh;
+
+} // namespace juno
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility> // std::move
+#include <vector>
+
+//========================================================================================
+// POLYTOPE SOUP
+//========================================================================================
+// A collection of vertices and elements of mixed types, with no connectivity beyond
+// the vertices of each element. This is the interchange format between mesh files and
+// the meshes used for computation (e.g. FaceVertexMesh).
+//
+// The data is stored as a structure of arrays in Views in MemSpace:
+//  - x, y, z: the vertex coordinates
+//  - element_types: the VTK type of each element (see vtk_types)
+//  - element_offsets, element_vertices: the vertices of each element in CSR form.
+//    The vertices of element i are element_vertices[element_offsets[i] ...
+//    element_offsets[i + 1]).
+//  - element_set_offsets, element_set_elements: the sorted element IDs of each element
+//    set (e.g. a material or a Gmsh physical group) in CSR form. The names of the sets
+//    are kept on the host.
+//
+// A soup is usually built on the host by allocating it with its final sizes and
+// writing the Views directly (see the Gmsh reader), then mirrored to the device with
+// mirror<MemSpace>(), which copies each View in a single transfer.
+// Like Kokkos::View, copies of a soup are shallow.
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+// VTK element types
+//----------------------------------------------------------------------------------------
+
+namespace vtk_types
+{
+inline constexpr int8_t vertex = 1;
+inline constexpr int8_t line = 3;
+inline constexpr int8_t triangle = 5;
+inline constexpr int8_t polygon = 7;
+inline constexpr int8_t quad = 9;
+inline constexpr int8_t tetra = 10;
+inline constexpr int8_t hexahedron = 12;
+inline constexpr int8_t quadratic_edge = 21;
+inline constexpr int8_t quadratic_triangle = 22;
+inline constexpr int8_t quadratic_quad = 23;
+} // namespace vtk_types
+
+//----------------------------------------------------------------------------------------
+// The number of vertices of an element of the given type, 0 for types with a variable
+// number of vertices (polygon), or -1 for unknown types.
+HOSTDEV constexpr auto
+verticesPerElement(int8_t const type) noexcept -> Int
+{
+  switch (type) {
+  case vtk_types::vertex:
+    return 1;
+  case vtk_types::line:
+    return 2;
+  case vtk_types::triangle:
+    return 3;
+  case vtk_types::polygon:
+    return 0;
+  case vtk_types::quad:
+    return 4;
+  case vtk_types::tetra:
+    return 4;
+  case vtk_types::hexahedron:
+    return 8;
+  case vtk_types::quadratic_edge:
+    return 3;
+  case vtk_types::quadratic_triangle:
+    return 6;
+  case vtk_types::quadratic_quad:
+    return 8;
+  default:
+    return -1;
+  }
+}
+
+template <class MemSpace = HostMemSpace>
+class PolytopeSoup
+{
+public:
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+  using TypeView = Kokkos::View<int8_t *, MemSpace>;
+
+private:
+  // Vertices
+  FloatView _x;
+  FloatView _y;
+  FloatView _z;
+
+  // Elements
+  TypeView _element_types;
+  IntView _element_offsets;
+  IntView _element_vertices;
+
+  // Element sets
+  std::vector<std::string> _element_set_names;
+  IntView _element_set_offsets;
+  IntView _element_set_elements;
+
+  template <class OtherMemSpace>
+  friend class PolytopeSoup;
+
+  //--------------------------------------------------------------------------------------
+  // Allocate a View without initializing it, since the caller writes every entry
+  template <class View>
+  static auto
+  allocate(std::string const & label, Int const n) -> View
+  {
+    return View(Kokkos::view_alloc(Kokkos::WithoutInitializing, label),
+                static_cast<size_t>(n));
+  }
+
+  //--------------------------------------------------------------------------------------
+  template <class OtherMemSpace, class View>
+  static auto
+  mirrorView(View const & v)
+  {
+    return Kokkos::create_mirror_view_and_copy(OtherMemSpace(), v);
+  }
+
+public:
+  //--------------------------------------------------------------------------------------
+  // Constructors
+  //--------------------------------------------------------------------------------------
+
+  PolytopeSoup() = default;
+
+  // Allocate a soup with the given number of vertices, elements, and total number of
+  // element vertices. The Views are not initialized, except for element_offsets[0].
+  PolytopeSoup(Int const num_vertices, Int const num_elements,
+               Int const num_element_vertices)
+      : _x(allocate<FloatView>("soup_x", num_vertices)),
+        _y(allocate<FloatView>("soup_y", num_vertices)),
+        _z(allocate<FloatView>("soup_z", num_vertices)),
+        _element_types(allocate<TypeView>("soup_element_types", num_elements)),
+        _element_offsets(allocate<IntView>("soup_element_offsets", num_elements + 1)),
+        _element_vertices(
+            allocate<IntView>("soup_element_vertices", num_element_vertices)),
+        _element_set_offsets("soup_element_set_offsets", 1)
+  {
+    Kokkos::deep_copy(Kokkos::subview(_element_offsets, 0), 0);
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Accessors
+  //--------------------------------------------------------------------------------------
+
+  [[nodiscard]] auto
+  numVertices() const noexcept -> Int
+  {
+    return static_cast<Int>(_x.size());
+  }
+
+  [[nodiscard]] auto
+  numElements() const noexcept -> Int
+  {
+    return static_cast<Int>(_element_types.size());
+  }
+
+  [[nodiscard]] auto
+  numElementSets() const noexcept -> Int
+  {
+    return static_cast<Int>(_element_set_names.size());
+  }
+
+  [[nodiscard]] auto
+  x() const noexcept -> FloatView const &
+  {
+    return _x;
+  }
+
+  [[nodiscard]] auto
+  y() const noexcept -> FloatView const &
+  {
+    return _y;
+  }
+
+  [[nodiscard]] auto
+  z() const noexcept -> FloatView const &
+  {
+    return _z;
+  }
+
+  [[nodiscard]] auto
+  elementTypes() const noexcept -> TypeView const &
+  {
+    return _element_types;
+  }
+
+  [[nodiscard]] auto
+  elementOffsets() const noexcept -> IntView const &
+  {
+    return _element_offsets;
+  }
+
+  [[nodiscard]] auto
+  elementVertices() const noexcept -> IntView const &
+  {
+    return _element_vertices;
+  }
+
+  [[nodiscard]] auto
+  elementSetNames() const noexcept -> std::vector<std::string> const &
+  {
+    return _element_set_names;
+  }
+
+  [[nodiscard]] auto
+  elementSetOffsets() const noexcept -> IntView const &
+  {
+    return _element_set_offsets;
+  }
+
+  [[nodiscard]] auto
+  elementSetElements() const noexcept -> IntView const &
+  {
+    return _element_set_elements;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // The index of the element set with the given name, or -1 if there is none
+  [[nodiscard]] auto
+  getElementSetIndex(std::string const & name) const noexcept -> Int
+  {
+    for (size_t i = 0; i < _element_set_names.size(); ++i) {
+      if (_element_set_names[i] == name) {
+        return static_cast<Int>(i);
+      }
+    }
+    return -1;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Modifiers
+  //--------------------------------------------------------------------------------------
+
+  // Replace the element sets. offsets has names.size() + 1 entries, and the elements of
+  // each set are sorted.
+  void
+  setElementSets(std::vector<std::string> names, IntView offsets, IntView elements)
+  {
+    _element_set_names = std::move(names);
+    _element_set_offsets = std::move(offsets);
+    _element_set_elements = std::move(elements);
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Copy the soup to OtherMemSpace. Each View is copied in a single transfer, or not
+  // at all if OtherMemSpace is MemSpace.
+  template <class OtherMemSpace>
+  [[nodiscard]] auto
+  mirror() const -> PolytopeSoup<OtherMemSpace>
+  {
+    PolytopeSoup<OtherMemSpace> other;
+    other._x = mirrorView<OtherMemSpace>(_x);
+    other._y = mirrorView<OtherMemSpace>(_y);
+    other._z = mirrorView<OtherMemSpace>(_z);
+    other._element_types = mirrorView<OtherMemSpace>(_element_types);
+    other._element_offsets = mirrorView<OtherMemSpace>(_element_offsets);
+    other._element_vertices = mirrorView<OtherMemSpace>(_element_vertices);
+    other._element_set_names = _element_set_names;
+    other._element_set_offsets = mirrorView<OtherMemSpace>(_element_set_offsets);
+    other._element_set_elements = mirrorView<OtherMemSpace>(_element_set_elements);
+    return other;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Check the consistency of a soup on the host: the offsets are non-decreasing, the
+// element types are known and match their number of vertices, the vertex IDs and
+// element IDs are in range, and the element sets are sorted. Logs an error describing
+// the first problem found and returns false, if the error policy returns.
+auto
+validate(PolytopeSoup<HostMemSpace> const & soup) -> bool;
+
+} // namespace juno
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+#include <juno/mesh/face_vertex_mesh.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+//========================================================================================
+// MESH REORDERING
+//========================================================================================
+// Renumber the vertices and elements of a mesh along a space-filling curve, so that
+// entities that are close in space are close in memory. Mesh files list elements in
+// the order the mesher created them, which scatters the memory accesses of sweeps and
+// of assembling matrices over neighboring faces.
+//
+// The reordering:
+//  - quantizes the coordinates of each vertex, and the centroid of each element, to a
+//    2^16 by 2^16 grid over the bounding box of the mesh. Its Morton (Z-order) or
+//    Hilbert key on that grid gives its place in the new order. Hilbert keys keep
+//    neighbors closer, with no long jumps between quadrants, but cost more to compute.
+//  - computes the keys in parallel, and sorts them with a parallel, stable radix sort,
+//    so entities with the same key keep their relative order.
+//  - is returned as permutations, from new to old index, so that other arrays indexed
+//    by vertex or element can be permuted the same way with permute().
+//
+// The locality of a face order is measured by the bandwidth of the face adjacency
+// graph, in which faces that share an edge are adjacent: the largest and the mean
+// difference of the indices of adjacent faces.
+//
+// Usage:
+//   auto const ordering = juno::computeReordering(soup, juno::curves::hilbert);
+//   auto const reordered = juno::applyReordering(soup, ordering);
+//   auto const densities = juno::permute(old_densities, ordering.element_order);
+// or reorderSoup(soup, curve), which does both and logs the bandwidth before and after.
+
+namespace juno
+{
+
+namespace curves
+{
+inline constexpr int32_t morton = 0;
+inline constexpr int32_t hilbert = 1;
+} // namespace curves
+
+//----------------------------------------------------------------------------------------
+// Keys of the point (x, y) on a 2^16 by 2^16 grid
+//----------------------------------------------------------------------------------------
+
+// Interleave the bits of x and y: bit i of x is bit 2i of the key
+HOSTDEV constexpr auto
+mortonKey(uint32_t x, uint32_t y) noexcept -> uint32_t
+{
+  auto const spread = [](uint32_t v) {
+    v &= 0x0000ffffU;
+    v = (v | (v << 8)) & 0x00ff00ffU;
+    v = (v | (v << 4)) & 0x0f0f0f0fU;
+    v = (v | (v << 2)) & 0x33333333U;
+    v = (v | (v << 1)) & 0x55555555U;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+}
+
+// The distance along the Hilbert curve that fills the grid
+HOSTDEV constexpr auto
+hilbertKey(uint32_t x, uint32_t y) noexcept -> uint32_t
+{
+  uint32_t constexpr n = 1U << 16;
+  x &= n - 1;
+  y &= n - 1;
+  uint32_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    uint32_t const rx = (x & s) > 0 ? 1 : 0;
+    uint32_t const ry = (y & s) > 0 ? 1 : 0;
+    d += s * s * ((3 * rx) ^ ry);
+    // Rotate the quadrant, so the curve within it starts and ends at the right corners
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      uint32_t const t = x;
+      x = y;
+      y = t;
+    }
+  }
+  return d;
+}
+
+//----------------------------------------------------------------------------------------
+// Permutations from the new index to the old index
+struct Reordering {
+  Kokkos::View<Int *, HostMemSpace> vertex_order;
+  Kokkos::View<Int *, HostMemSpace> element_order;
+};
+
+// The bandwidth of the face adjacency graph
+struct Bandwidth {
+  Int max = 0;    // the largest |i - j| over adjacent faces i and j
+  Float mean = 0; // the mean |i - j| over adjacent faces i and j
+};
+
+//----------------------------------------------------------------------------------------
+// The order of the vertices and elements of a soup along a space-filling curve
+auto
+computeReordering(PolytopeSoup<HostMemSpace> const & soup,
+                  int32_t curve = curves::hilbert) -> Reordering;
+
+//----------------------------------------------------------------------------------------
+// A copy of the soup with its vertices and elements renumbered. The vertices of each
+// element, and the elements of each element set, are renumbered too, and the element
+// sets are kept sorted.
+auto
+applyReordering(PolytopeSoup<HostMemSpace> const & soup, Reordering const & ordering)
+    -> PolytopeSoup<HostMemSpace>;
+
+//----------------------------------------------------------------------------------------
+// computeReordering, then applyReordering. Logs the bandwidth of the face adjacency
+// graph before and after, if the soup holds faces and info messages are logged.
+auto
+reorderSoup(PolytopeSoup<HostMemSpace> const & soup, int32_t curve = curves::hilbert)
+    -> PolytopeSoup<HostMemSpace>;
+
+//----------------------------------------------------------------------------------------
+auto
+faceAdjacencyBandwidth(FaceVertexMesh<HostMemSpace> const & mesh) -> Bandwidth;
+
+//----------------------------------------------------------------------------------------
+// values permuted by order: result[i] = values[order[i]]
+template <class T>
+auto
+permute(Kokkos::View<T *, HostMemSpace> const & values,
+        Kokkos::View<Int *, HostMemSpace> const & order)
+    -> Kokkos::View<T *, HostMemSpace>
+{
+  Kokkos::View<T *, HostMemSpace> const result(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, std::string("permuted")),
+      order.size());
+  Kokkos::parallel_for(
+      "juno::permute", rangePolicy<HostExecSpace>(0, static_cast<Int>(order.size())),
+      [&](Int const i) { result(i) = values(order(i)); });
+  return result;
+}
+
+} // namespace juno
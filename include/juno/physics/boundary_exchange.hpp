@@ -0,0 +1,184 @@
+#pragma once
+
+#include <juno/common/communicator.hpp>
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/mirrored_view.hpp>
+#include <juno/config.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/mesh/partition.hpp>
+#include <juno/physics/tracks.hpp>
+
+#include <Kokkos_Core.hpp>
+
+//========================================================================================
+// BOUNDARY EXCHANGE
+//========================================================================================
+// The angular fluxes that cross between the blocks of a decomposed transport sweep.
+//
+// Each rank sweeps the tracks of its block (a BlockDecomposition), which are the tracks
+// of makeBlockTrackLayout: the same on every block, translated. A direction that leaves
+// the block through a side with a neighbor continues, in the neighbor, into the
+// direction translated_links of the layout, so its outgoing angular flux is sent to the
+// neighbor, which takes it as the incoming flux of that direction. The flat-source
+// sweep only couples the blocks through these fluxes, so no halo of faces is needed.
+//
+// For each side with a neighbor, the directions that leave through the side, in
+// increasing order, are packed into one message, and the neighbor unpacks them into
+// the directions that they translate into, in the same order. Every block builds both
+// lists from its own layout, since the layouts are the same.
+//  - begin(psi_out) packs the outgoing fluxes on the device, and starts the messages
+//    with non-blocking MPI. If the MPI library is GPU-aware (Communicator::gpuAware),
+//    the device buffers are sent directly; otherwise they are staged through pinned
+//    host buffers (MirroredView).
+//  - Meanwhile, the directions that are not fed() by a neighbor can be swept: their
+//    incoming fluxes are local. progress() lets MPI advance the messages between the
+//    kernels.
+//  - finish(psi_in) waits for the messages, and unpacks the incoming fluxes of the
+//    directions that are fed by a neighbor, which can then be swept.
+// A block that is its own neighbor, in a periodic direction, copies its messages
+// itself, so a decomposition of one block needs no MPI.
+//
+// The boundaries of the domain, with no neighbor, keep the boundary condition of the
+// sweep (reflective or vacuum).
+//
+// Usage:
+//   auto const blocks = juno::makeBlockDecomposition(box, comm.size());
+//   auto const layout = juno::makeBlockTrackLayout(blocks, comm.rank(), parameters);
+//   juno::BoundaryExchange<MemSpace> exchange(layout, blocks, comm.rank(), comm);
+//   juno::MOCSweeper<MemSpace> sweeper(grid, layout);
+//   sweeper.sweep(xs, face_materials, source, flux, exchange);
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+// The tracks of a block: the tracks of a box of the size of the blocks, translated to
+// the block, so that every block has the same tracks. Logs an error and returns an empty
+// layout if the block is not in the decomposition.
+auto
+makeBlockTrackLayout(BlockDecomposition const & blocks, Int block,
+                     TrackParameters const & parameters) -> TrackLayout;
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace = HostMemSpace>
+class BoundaryExchange
+{
+public:
+  using ExecSpace = typename MemSpace::execution_space;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+  using Buffer = MirroredView<Float, ExecSpace>;
+
+private:
+  Communicator _comm;
+  Int _neighbors[box_sides::count] = {-1, -1, -1, -1};
+  // The directions of each side are [offsets[s], offsets[s + 1]) of the directions
+  Int _send_offsets[box_sides::count + 1] = {};
+  Int _recv_offsets[box_sides::count + 1] = {};
+  IntView _send_directions;
+  IntView _recv_directions;
+  IntView _fed; // per direction: 1 if its incoming flux is received
+
+  Int _angular_size = 0;
+  Buffer _send;
+  Buffer _recv;
+  Requests _requests;
+  bool _in_flight = false;
+
+  // Whether the messages go through the host copies of the buffers
+  [[nodiscard]] auto
+  staged() const noexcept -> bool
+  {
+    return !Buffer::aliased && !_comm.gpuAware();
+  }
+
+  // The data of the buffer to pass to MPI, from direction "first" of the buffer
+  [[nodiscard]] auto
+  messageData(Buffer const & buffer, Int first) const -> Float *;
+
+public:
+  //--------------------------------------------------------------------------------------
+  // Constructors
+  //--------------------------------------------------------------------------------------
+
+  BoundaryExchange() = default;
+
+  // The exchange of block "block" of the decomposition, whose tracks are "layout", on
+  // the rank of the same number. Logs an error and returns an empty exchange if the
+  // ranks of the communicator are not the blocks, or if a neighbor is another rank
+  // without MPI.
+  BoundaryExchange(TrackLayout const & layout, BlockDecomposition const & blocks,
+                   Int block, Communicator const & comm = {});
+
+  BoundaryExchange(BoundaryExchange const &) = delete;
+  BoundaryExchange(BoundaryExchange &&) noexcept = default;
+  auto
+  operator=(BoundaryExchange const &) -> BoundaryExchange & = delete;
+  auto
+  operator=(BoundaryExchange &&) noexcept -> BoundaryExchange & = default;
+  ~BoundaryExchange() = default;
+
+  //--------------------------------------------------------------------------------------
+  // Accessors
+  //--------------------------------------------------------------------------------------
+
+  // The rank of the neighbor across a side (box_sides), or -1
+  [[nodiscard]] auto
+  neighbor(int32_t const side) const noexcept -> Int
+  {
+    return _neighbors[side];
+  }
+
+  // The number of directions sent, and received, across all the sides
+  [[nodiscard]] auto
+  numSent() const noexcept -> Int
+  {
+    return _send_offsets[box_sides::count];
+  }
+
+  [[nodiscard]] auto
+  numReceived() const noexcept -> Int
+  {
+    return _recv_offsets[box_sides::count];
+  }
+
+  // For each direction 2 t + d, 1 if its incoming flux is received from a neighbor
+  [[nodiscard]] auto
+  fed() const noexcept -> IntView const &
+  {
+    return _fed;
+  }
+
+  [[nodiscard]] auto
+  inFlight() const noexcept -> bool
+  {
+    return _in_flight;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Exchanging
+  //--------------------------------------------------------------------------------------
+
+  // Pack the outgoing fluxes (angular_size values per direction) and start the
+  // messages. psi_out may be overwritten when begin returns.
+  void
+  begin(FloatView const & psi_out, Int angular_size);
+
+  // Let MPI advance the messages in flight, without waiting
+  void
+  progress();
+
+  // Wait for the messages, and unpack the incoming fluxes of the fed directions
+  void
+  finish(FloatView const & psi_in);
+};
+
+// Compiled for the host and the device memory spaces, in
+// src/physics/boundary_exchange.cpp
+extern template class BoundaryExchange<HostMemSpace>;
+
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+extern template class BoundaryExchange<DeviceMemSpace>;
+#endif
+
+} // namespace juno
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/sparse_matrix.hpp>
+#include <juno/mesh/face_vertex_mesh.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+//========================================================================================
+// CMFD
+//========================================================================================
+// Coarse-mesh finite difference: the diffusion problem on a coarse mesh that
+// accelerates the convergence of the transport sweeps. Each face of a FaceVertexMesh is
+// a cell, with a flux at its centroid, coupled to the faces that share an edge with it.
+//
+// The one-group operator, for the net loss of neutrons from each cell f:
+//   A phi (f) = sum_edges J_fg + removal_f area_f phi_f
+// where the net current across an edge of length L between cells f and g is
+//   J_fg = L / (h_f / D_f + h_g / D_g) (phi_f - phi_g)
+// with h the distance from the centroid of a cell to the line of the edge, and D the
+// diffusion coefficient of the cell. That is, the harmonic mean of the coefficients
+// weighted by distance, which keeps the current continuous across the edge. On the
+// boundary of the mesh:
+//  - reflective: no current.
+//  - vacuum: J = D L / (h + 2 D) phi, from the Marshak condition that the incoming
+//    partial current is zero.
+//
+// The matrix is assembled in parallel on MemSpace: each cell counts itself and its
+// neighbors, a scan gives the row offsets, and each cell fills its row and sorts it by
+// column.
+//
+// Usage:
+//   auto const a = juno::assembleDiffusionOperator(mesh, diffusion, removal,
+//                                                  juno::cmfd_boundaries::vacuum);
+//   auto const m = juno::makeILU0Preconditioner(a);
+//   auto const result = juno::gmres(a, m, source, phi);
+
+namespace juno
+{
+
+namespace cmfd_boundaries
+{
+inline constexpr int32_t reflective = 0;
+inline constexpr int32_t vacuum = 1;
+} // namespace cmfd_boundaries
+
+//----------------------------------------------------------------------------------------
+// The one-group diffusion operator on the faces of the mesh, given the diffusion
+// coefficient and the removal cross section of each face
+template <class MemSpace>
+auto
+assembleDiffusionOperator(FaceVertexMesh<MemSpace> const & mesh,
+                          Kokkos::View<Float *, MemSpace> const & diffusion,
+                          Kokkos::View<Float *, MemSpace> const & removal,
+                          int32_t boundary) -> CSRMatrix<MemSpace>;
+
+// Compiled for the host and the device memory spaces, in src/physics/cmfd.cpp
+extern template auto
+assembleDiffusionOperator<HostMemSpace>(FaceVertexMesh<HostMemSpace> const &,
+                                        Kokkos::View<Float *, HostMemSpace> const &,
+                                        Kokkos::View<Float *, HostMemSpace> const &,
+                                        int32_t) -> CSRMatrix<HostMemSpace>;
+
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+extern template auto
+assembleDiffusionOperator<DeviceMemSpace>(FaceVertexMesh<DeviceMemSpace> const &,
+                                          Kokkos::View<Float *, DeviceMemSpace> const &,
+                                          Kokkos::View<Float *, DeviceMemSpace> const &,
+                                          int32_t) -> CSRMatrix<DeviceMemSpace>;
+#endif
+
+} // namespace juno
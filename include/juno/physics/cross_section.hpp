@@ -0,0 +1,198 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility> // std::make_pair
+
+//========================================================================================
+// CROSS SECTIONS
+//========================================================================================
+// Multigroup cross sections of a set of entries: the nuclides of a library
+// (microscopic), or the materials of a model (macroscopic).
+//
+// The sweep looks up the cross sections of each cell's material, then loops over the
+// energy groups. So the data is stored group-contiguous, in Views in MemSpace:
+//  - vectors: for each entry and reaction, a row of the group values. Row (e, r) is
+//    vectors[(e * num_reactions + r) * group_stride ...).
+//  - scatter: for each entry, the scattering matrix by source group. Row (e, g) holds
+//    the cross sections from g into each destination group, at
+//    scatter[(e * num_groups + g) * group_stride ...). The scattering source of a cell
+//    is then a sum of rows scaled by the flux of their source group: each term is an
+//    axpy over the destination groups, which vectorizes without reassociating a sum,
+//    unlike a dot product per destination group.
+//  - The rows are padded to group_stride, a multiple of 64 bytes, and the Views start
+//    on a 64-byte boundary. So every row is aligned to a cache line and to the widest
+//    vector registers, and the loops over groups vectorize without peeling.
+//
+// row(e, r) and scatterRow(e, g) return the aligned pointer to a row, for use in
+// kernels. Like Kokkos::View, copies are shallow; mirror<MemSpace>() makes a deep copy
+// in another memory space, aligned there too.
+
+namespace juno
+{
+
+// The reactions stored as group vectors
+namespace reactions
+{
+inline constexpr Int total = 0;
+inline constexpr Int absorption = 1;
+inline constexpr Int nu_fission = 2;
+inline constexpr Int chi = 3; // the fission spectrum
+inline constexpr Int count = 4;
+} // namespace reactions
+
+inline constexpr Int xs_alignment = 64; // bytes
+
+//----------------------------------------------------------------------------------------
+// The number of groups, rounded up to a whole number of 64-byte rows
+HOSTDEV constexpr auto
+paddedGroups(Int const num_groups) noexcept -> Int
+{
+  Int constexpr per_row = xs_alignment / static_cast<Int>(sizeof(Float));
+  return (num_groups + per_row - 1) / per_row * per_row;
+}
+
+namespace impl
+{
+
+//----------------------------------------------------------------------------------------
+// A zero-initialized View of n values that starts on an xs_alignment boundary: a
+// subview of a slightly larger allocation
+template <class MemSpace>
+auto
+alignedView(std::string const & label, Int const n) -> Kokkos::View<Float *, MemSpace>
+{
+  Int constexpr pad = xs_alignment / static_cast<Int>(sizeof(Float));
+  Kokkos::View<Float *, MemSpace> const storage(label, static_cast<size_t>(n + pad));
+  auto const address = reinterpret_cast<uintptr_t>(storage.data());
+  auto const misalignment = static_cast<Int>(address % xs_alignment);
+  Int const gap = misalignment == 0 ? 0 : xs_alignment - misalignment;
+  Int const offset = gap / static_cast<Int>(sizeof(Float));
+  return Kokkos::subview(storage, std::make_pair(offset, offset + n));
+}
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace = HostMemSpace>
+class CrossSections
+{
+public:
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+
+private:
+  Int _num_entries = 0;
+  Int _num_groups = 0;
+  Int _group_stride = 0;
+  FloatView _vectors;
+  FloatView _scatter;
+
+public:
+  //--------------------------------------------------------------------------------------
+  // Constructors
+  //--------------------------------------------------------------------------------------
+
+  CrossSections() = default;
+
+  // Zero cross sections for num_entries entries
+  CrossSections(std::string const & label, Int const num_entries, Int const num_groups)
+      : _num_entries(num_entries),
+        _num_groups(num_groups),
+        _group_stride(paddedGroups(num_groups)),
+        _vectors(impl::alignedView<MemSpace>(
+            label + "_vectors", num_entries * reactions::count * _group_stride)),
+        _scatter(impl::alignedView<MemSpace>(label + "_scatter",
+                                             num_entries * num_groups * _group_stride))
+  {
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Accessors
+  //--------------------------------------------------------------------------------------
+
+  [[nodiscard]] HOSTDEV auto
+  numEntries() const noexcept -> Int
+  {
+    return _num_entries;
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  numGroups() const noexcept -> Int
+  {
+    return _num_groups;
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  groupStride() const noexcept -> Int
+  {
+    return _group_stride;
+  }
+
+  [[nodiscard]] auto
+  vectorValues() const noexcept -> FloatView const &
+  {
+    return _vectors;
+  }
+
+  [[nodiscard]] auto
+  scatterValues() const noexcept -> FloatView const &
+  {
+    return _scatter;
+  }
+
+  // The group values of reaction r of entry e
+  [[nodiscard]] HOSTDEV auto
+  row(Int const e, Int const r) const noexcept -> Float *
+  {
+    ASSUME(0 <= r && r < reactions::count);
+    Float * const p = _vectors.data() + (e * reactions::count + r) * _group_stride;
+    return static_cast<Float *>(__builtin_assume_aligned(p, xs_alignment));
+  }
+
+  // The cross sections of entry e for scattering from group g into each group
+  [[nodiscard]] HOSTDEV auto
+  scatterRow(Int const e, Int const g) const noexcept -> Float *
+  {
+    Float * const p = _scatter.data() + (e * _num_groups + g) * _group_stride;
+    return static_cast<Float *>(__builtin_assume_aligned(p, xs_alignment));
+  }
+
+  [[nodiscard]] HOSTDEV auto
+  operator()(Int const e, Int const r, Int const g) const noexcept -> Float &
+  {
+    return row(e, r)[g];
+  }
+
+  // Scattering from group g_from into group g_to
+  [[nodiscard]] HOSTDEV auto
+  scatter(Int const e, Int const g_from, Int const g_to) const noexcept -> Float &
+  {
+    return scatterRow(e, g_from)[g_to];
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Copy the cross sections to OtherMemSpace. Each View is copied in a single transfer.
+  template <class OtherMemSpace>
+  [[nodiscard]] auto
+  mirror() const -> CrossSections<OtherMemSpace>
+  {
+    CrossSections<OtherMemSpace> result("xs", _num_entries, _num_groups);
+    Kokkos::deep_copy(result.vectorValues(), _vectors);
+    Kokkos::deep_copy(result.scatterValues(), _scatter);
+    return result;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// Check that the cross sections are finite and nonnegative, that the total is at least
+// the absorption, and that each fission spectrum sums to 1, or 0 for entries that do not
+// fission. Logs the first problem found.
+auto
+validate(CrossSections<HostMemSpace> const & xs) -> bool;
+
+} // namespace juno
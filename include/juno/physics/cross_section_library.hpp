@@ -0,0 +1,149 @@
+#pragma once
+
+#include <juno/common/mapped_file.hpp>
+#include <juno/config.hpp>
+#include <juno/physics/cross_section.hpp>
+#include <juno/physics/nuclide.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex> // std::once_flag
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//========================================================================================
+// CROSS SECTION LIBRARY
+//========================================================================================
+// A binary file of the multigroup cross sections of many nuclides, of which a model
+// uses only a few. Opening a library reads only its index, and the data of a nuclide is
+// read the first time it is asked for. So the time to start and the memory used scale
+// with the nuclides of the model, not with the size of the library.
+//
+// The file:
+//  - is versioned, and begins with a header and the index: for each nuclide, its name,
+//    ZAID, and the offset and hash of its data. The index is hashed too, to detect a
+//    damaged file on opening. Both hashes can be read without the data, to tell whether
+//    the nuclides of a model changed.
+//  - holds the data of each nuclide in one block, aligned to 64 bytes: the total,
+//    absorption, nu-fission and chi vectors, then the scattering matrix by source
+//    group, as doubles whatever the precision of the build.
+//
+// Opening maps the file, so that reading a nuclide touches only its pages. A nuclide
+// is read, checked against its hash, and converted to Float once, on first access;
+// nuclide() is thread-safe, so nuclides can be loaded in parallel. The loaded
+// nuclides are kept until the library is destroyed.
+//
+// Usage:
+//   juno::CrossSectionLibrary const library("library.xs");
+//   auto const xs = library.load({"U235", "U238", "O16"});
+
+namespace juno
+{
+
+namespace cross_section_library
+{
+inline constexpr uint32_t version = 1;
+inline constexpr size_t alignment = 64;
+} // namespace cross_section_library
+
+//----------------------------------------------------------------------------------------
+// Write a library of nuclides, which must have the same number of groups. Logs an
+// error and returns false if they are invalid or the file cannot be written.
+auto
+writeCrossSectionLibrary(std::string const & filename,
+                         std::vector<Nuclide> const & nuclides) -> bool;
+
+//----------------------------------------------------------------------------------------
+class CrossSectionLibrary
+{
+  struct Entry {
+    std::string name;
+    int32_t zaid;
+    uint64_t offset; // of the data, from the beginning of the file
+    uint64_t hash;   // of the data
+  };
+
+  // A nuclide, read on first access
+  struct Slot {
+    std::once_flag once;
+    Nuclide nuclide;
+  };
+
+  MappedFile _file;
+  Int _num_groups = 0;
+  uint64_t _index_hash = 0;
+  std::vector<Entry> _index;
+  std::unordered_map<std::string, Int> _by_name;
+  std::unique_ptr<Slot[]> _slots;
+  std::unique_ptr<std::atomic<Int>> _num_loaded;
+
+  void
+  read(Int i, Nuclide & nuclide) const;
+
+public:
+  CrossSectionLibrary() = default;
+
+  // Map the library and read its index. Logs an error if it cannot be read, and the
+  // library is then not open.
+  explicit CrossSectionLibrary(std::string const & filename);
+
+  [[nodiscard]] auto
+  isOpen() const noexcept -> bool
+  {
+    return _file.isOpen();
+  }
+
+  [[nodiscard]] auto
+  numNuclides() const noexcept -> Int
+  {
+    return static_cast<Int>(_index.size());
+  }
+
+  [[nodiscard]] auto
+  numGroups() const noexcept -> Int
+  {
+    return _num_groups;
+  }
+
+  // The number of nuclides that have been read
+  [[nodiscard]] auto
+  numLoaded() const noexcept -> Int
+  {
+    return _num_loaded ? _num_loaded->load(std::memory_order_relaxed) : 0;
+  }
+
+  [[nodiscard]] auto
+  name(Int i) const -> std::string const &;
+
+  [[nodiscard]] auto
+  zaid(Int i) const -> int32_t;
+
+  // The hash of the index, which changes with the data of any nuclide
+  [[nodiscard]] auto
+  indexHash() const noexcept -> uint64_t
+  {
+    return _index_hash;
+  }
+
+  // The hash of the data of nuclide i, from the index, without reading the data
+  [[nodiscard]] auto
+  dataHash(Int i) const -> uint64_t;
+
+  // The index of the nuclide with the name, or -1 if there is none
+  [[nodiscard]] auto
+  find(std::string const & name) const -> Int;
+
+  // Nuclide i, read on the first call. Thread-safe. If the data of the nuclide is
+  // damaged, logs an error and returns a nuclide with no groups.
+  [[nodiscard]] auto
+  nuclide(Int i) const -> Nuclide const &;
+
+  // The cross sections of the named nuclides, in order, read in parallel. Logs an error
+  // and returns empty cross sections if a nuclide is not in the library, or is damaged.
+  [[nodiscard]] auto
+  load(std::vector<std::string> const & names) const -> CrossSections<HostMemSpace>;
+};
+
+} // namespace juno
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <juno/common/execution_policy.hpp>
+#include <juno/config.hpp>
+#include <juno/physics/cross_section.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//========================================================================================
+// MATERIAL
+//========================================================================================
+// A material is a mixture of nuclides. Its macroscopic cross sections are the sums of
+// the microscopic ones, weighted by number density:
+//   Sigma_x(g) = sum_n N_n sigma_x,n(g)
+// except for the fission spectrum, which is weighted by the fission neutrons that each
+// nuclide produces: chi(g) = sum_n w_n chi_n(g) / sum_n w_n, w_n = N_n sum_g nu_sigma_f.
+//
+// The sweep reads the macroscopic cross sections of every cell in its inner loop, so
+// they are mixed once ahead of time, in parallel over the materials, and looked up by
+// material ID. MaterialCrossSections holds the result on the host and on the device:
+//  - The device copy is made when the materials are mixed, in one transfer per View,
+//    and kernels use device() from then on. It is never copied on access.
+//  - update() re-mixes only the materials whose composition has changed since they
+//    were last mixed, e.g. after a depletion step, detected by a hash of the
+//    composition and of the nuclide data.
+//
+// Usage:
+//   juno::MaterialCrossSections const xs(nuclide_xs, materials);
+//   auto const & device_xs = xs.device();
+//   ... in a kernel: Float const * RESTRICT total = device_xs.row(m, reactions::total);
+
+namespace juno
+{
+
+struct Material {
+  std::string name;
+  std::vector<Int> nuclides;           // entries of the nuclide cross sections
+  std::vector<Float> number_densities; // in atoms / (barn cm)
+};
+
+//----------------------------------------------------------------------------------------
+// The macroscopic cross sections of each material, in order, in parallel. Logs an
+// error and returns empty cross sections if a material refers to an unknown nuclide.
+auto
+mixMaterials(CrossSections<HostMemSpace> const & nuclides,
+             std::vector<Material> const & materials) -> CrossSections<HostMemSpace>;
+
+//----------------------------------------------------------------------------------------
+class MaterialCrossSections
+{
+  CrossSections<HostMemSpace> _host;
+  CrossSections<DeviceMemSpace> _device;
+  std::vector<uint64_t> _hashes; // of the composition of each material, as mixed
+
+public:
+  MaterialCrossSections() = default;
+
+  MaterialCrossSections(CrossSections<HostMemSpace> const & nuclides,
+                        std::vector<Material> const & materials);
+
+  [[nodiscard]] auto
+  host() const noexcept -> CrossSections<HostMemSpace> const &
+  {
+    return _host;
+  }
+
+  [[nodiscard]] auto
+  device() const noexcept -> CrossSections<DeviceMemSpace> const &
+  {
+    return _device;
+  }
+
+  [[nodiscard]] auto
+  numMaterials() const noexcept -> Int
+  {
+    return _host.numEntries();
+  }
+
+  // Re-mix the materials that have changed, and update the device copy if any did.
+  // Returns the number of materials that were mixed.
+  auto
+  update(CrossSections<HostMemSpace> const & nuclides,
+         std::vector<Material> const & materials) -> Int;
+};
+
+} // namespace juno
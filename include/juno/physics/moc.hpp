@@ -0,0 +1,251 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/exponential.hpp>
+#include <juno/mesh/face_grid.hpp>
+#include <juno/physics/boundary_exchange.hpp>
+#include <juno/physics/cross_section.hpp>
+#include <juno/physics/tracks.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+//========================================================================================
+// MOC
+//========================================================================================
+// The transport sweep of the 2D method of characteristics with flat sources: along each
+// track of a TrackLayout, in both directions, for each polar angle and energy group, the
+// angular flux is attenuated through each face it crosses, and the change of the flux
+// is tallied into the scalar flux of the face:
+//   tau = sigma_t l / sin(theta)
+//   delta = (psi - q / sigma_t) (1 - exp(-tau)),  psi -= delta
+//   phi = 4 pi q / sigma_t + sum(w delta) / (sigma_t V)
+// where q is the isotropic source per steradian, V the volume of the face, from the
+// tracks, and w = 4 pi omega_azimuthal omega_polar spacing sin(theta).
+//
+// The segments of the tracks are found with the FaceGrid of the mesh, in batches of
+// tracks, and stored compactly: the face of each segment, and its length quantized to
+// 16 bits, in units of the largest face's bounding box diagonal / 65535. That is 6
+// bytes per segment instead of 8 (or 12 in double precision), and the volumes are
+// computed from the quantized lengths, so the flat source is conserved exactly.
+//  - If all the segments fit in SweepOptions::memory_budget, they are cached, and each
+//    sweep reads them.
+//  - Otherwise the segments of each batch are found again on the fly in each sweep,
+//    which costs the ray tracing but only needs the memory of one batch.
+// Both modes sweep the same compact segments, so they give the same fluxes. The segments
+// of a batch are indexed by Int, so a batch must have at most intMax() of them, but the
+// total over the batches is a Size, and may exceed it.
+//
+// Each (track, direction) is a thread. For each segment, the groups are swept in chunks
+// of one cache line of cross sections, with the polar angles inside the chunk, so the
+// innermost loop is over contiguous groups and the exponentials of the polar angles
+// are independent. The tallies of a chunk are accumulated over the polar angles before
+// they are added atomically, into tallies in FloatAccum: each face sums the segments of
+// every track that crosses it, so with mixed precision the tallies and the volumes are
+// summed in double, while the segments, cross sections and fluxes stay in Float.
+//
+// The angular fluxes on the boundary are stored per (track, direction, polar angle,
+// group). After each sweep, the outgoing flux of each direction becomes the incoming
+// flux of the direction that it reflects into, for reflective boundaries, and the
+// incoming flux stays zero for vacuum boundaries.
+//
+// For a decomposed domain, sweep with a BoundaryExchange: the outgoing fluxes through
+// the sides with a neighbor are sent to it after each sweep, and the next sweep first
+// sweeps the directions whose incoming fluxes are local, while the messages are in
+// flight, then the directions fed by the neighbors once they arrive. Without cached
+// segments, the batches are traced once per sweep, so the sweep waits for the messages
+// instead.
+//
+// The exponential of the attenuation is the library exp, a RationalExp accurate to about
+// the precision of Float, or an ExpTable with SweepOptions::exp_tolerance, which is also
+// about the error of the attenuation.
+//
+// The cross sections must be positive in each group of each face's material.
+//
+// Usage:
+//   auto const layout = juno::makeTrackLayout(grid.box, parameters);
+//   juno::MOCSweeper<juno::HostMemSpace> sweeper(grid, layout);
+//   for (...) {
+//     // source and flux: num_faces * xs.groupStride(), by face then group
+//     sweeper.sweep(xs, face_materials, source, flux);
+//   }
+//   // Decomposed, with the BoundaryExchange of the block (see boundary_exchange.hpp)
+//   sweeper.sweep(xs, face_materials, source, flux, exchange);
+
+namespace juno
+{
+
+namespace moc_boundaries
+{
+inline constexpr int32_t reflective = 0;
+inline constexpr int32_t vacuum = 1;
+} // namespace moc_boundaries
+
+namespace sweep_exponentials
+{
+inline constexpr int32_t library = 0;
+inline constexpr int32_t rational = 1;
+inline constexpr int32_t table = 2;
+} // namespace sweep_exponentials
+
+inline constexpr Int max_quantized_length = 65535;
+
+//----------------------------------------------------------------------------------------
+// The segments of a batch of tracks, in CSR form, like RaySegments, with lengths in
+// units of MOCSweeper::lengthScale()
+template <class MemSpace = HostMemSpace>
+struct TrackSegments {
+  Kokkos::View<Int *, MemSpace> offsets;
+  Kokkos::View<Int *, MemSpace> faces;
+  Kokkos::View<uint16_t *, MemSpace> lengths;
+};
+
+struct SweepOptions {
+  int64_t memory_budget = int64_t{1} << 30; // bytes, for cached segments
+  Int tracks_per_batch = 4096;
+  int32_t boundary = moc_boundaries::reflective;
+  int32_t exponential = sweep_exponentials::rational;
+  double exp_tolerance = 1e-5; // for sweep_exponentials::table
+};
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace = HostMemSpace>
+class MOCSweeper
+{
+public:
+  using IntView = Kokkos::View<Int *, MemSpace>;
+  using FloatView = Kokkos::View<Float *, MemSpace>;
+  using AccumView = Kokkos::View<FloatAccum *, MemSpace>;
+
+private:
+  FaceGrid<MemSpace> _grid;
+  SweepOptions _options;
+  Int _num_tracks = 0;
+  Int _num_polar = 0;
+  Float _length_scale = 0;
+  Float _inv_sin_theta[max_polar_angles] = {};
+  Kokkos::View<Ray2 *, MemSpace> _tracks;
+  IntView _azimuths;
+  IntView _links;
+  FloatView _track_weights; // per (azimuth, polar angle)
+  FloatView _volumes;
+
+  bool _cached = true;
+  Size _num_segments = 0;
+  std::vector<TrackSegments<MemSpace>> _batches;
+
+  Int _group_stride = 0;
+  FloatView _psi_in;  // per (track, direction, polar angle, group)
+  FloatView _psi_out;
+  FloatView _reduced_source; // q / sigma_t
+  AccumView _tally;          // per (face, group)
+  ExpTable<MemSpace> _exp_table;
+
+  [[nodiscard]] auto
+  numBatches() const noexcept -> Int;
+
+  [[nodiscard]] auto
+  segmentBatch(Int batch) const -> TrackSegments<MemSpace>;
+
+  template <class Exp>
+  void
+  sweepBatch(Int batch, TrackSegments<MemSpace> const & segments,
+             CrossSections<MemSpace> const & xs, IntView const & face_materials,
+             AccumView const & tally, Exp const & exp, IntView const & fed,
+             Int pass) const;
+
+  void
+  sweepImpl(CrossSections<MemSpace> const & xs, IntView const & face_materials,
+            FloatView const & source, FloatView const & scalar_flux,
+            BoundaryExchange<MemSpace> * exchange);
+
+public:
+  //--------------------------------------------------------------------------------------
+  // Constructors
+  //--------------------------------------------------------------------------------------
+
+  MOCSweeper() = default;
+
+  // Trace the tracks over the mesh of the grid, compute the volumes of the faces, and
+  // cache the segments if they fit in the memory budget
+  MOCSweeper(FaceGrid<MemSpace> const & grid, TrackLayout const & layout,
+             SweepOptions const & options = {});
+
+  //--------------------------------------------------------------------------------------
+  // Accessors
+  //--------------------------------------------------------------------------------------
+
+  [[nodiscard]] auto
+  numTracks() const noexcept -> Int
+  {
+    return _num_tracks;
+  }
+
+  [[nodiscard]] auto
+  numSegments() const noexcept -> Size
+  {
+    return _num_segments;
+  }
+
+  // The bytes of the compact segments of all the tracks
+  [[nodiscard]] auto
+  segmentBytes() const noexcept -> Size
+  {
+    return _num_segments * static_cast<Size>(sizeof(Int) + sizeof(uint16_t)) +
+           static_cast<Size>(_num_tracks + numBatches()) * static_cast<Size>(sizeof(Int));
+  }
+
+  // Whether the segments are cached, or found on the fly in each sweep
+  [[nodiscard]] auto
+  isCached() const noexcept -> bool
+  {
+    return _cached;
+  }
+
+  // The length of one unit of the quantized segment lengths
+  [[nodiscard]] auto
+  lengthScale() const noexcept -> Float
+  {
+    return _length_scale;
+  }
+
+  // The volume of each face, from the tracks
+  [[nodiscard]] auto
+  volumes() const noexcept -> FloatView const &
+  {
+    return _volumes;
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Sweeping
+  //--------------------------------------------------------------------------------------
+
+  // Sweep all the tracks once with the source (num_faces * xs.groupStride() values, by
+  // face then group), and write the scalar flux in the same layout. The boundary
+  // fluxes carry over from the previous sweep.
+  void
+  sweep(CrossSections<MemSpace> const & xs, IntView const & face_materials,
+        FloatView const & source, FloatView const & scalar_flux);
+
+  // Sweep the tracks of a block of a decomposed domain, exchanging the boundary fluxes
+  // with the neighbors through the exchange, which must be of the same layout
+  void
+  sweep(CrossSections<MemSpace> const & xs, IntView const & face_materials,
+        FloatView const & source, FloatView const & scalar_flux,
+        BoundaryExchange<MemSpace> & exchange);
+
+  // Zero the incoming angular fluxes on the boundary
+  void
+  resetBoundaryFluxes();
+};
+
+// Compiled for the host and the device memory spaces, in src/physics/moc.cpp
+extern template class MOCSweeper<HostMemSpace>;
+
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+extern template class MOCSweeper<DeviceMemSpace>;
+#endif
+
+} // namespace juno
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/physics/cross_section.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//========================================================================================
+// NUCLIDE
+//========================================================================================
+// The microscopic multigroup cross sections of a nuclide, in barns, as read from a
+// library. This is host-side input data; the solvers use the packed, group-contiguous
+// CrossSections built from a set of nuclides by makeCrossSections.
+
+namespace juno
+{
+
+struct Nuclide {
+  std::string name;
+  int32_t zaid = 0;
+  Int num_groups = 0;
+
+  std::vector<Float> total;
+  std::vector<Float> absorption;
+  std::vector<Float> nu_fission;
+  std::vector<Float> chi;
+
+  // Scattering from group g_from into group g_to at [g_from * num_groups + g_to]
+  std::vector<Float> scatter;
+};
+
+//----------------------------------------------------------------------------------------
+// Check that the arrays of the nuclide have num_groups entries, num_groups^2 for the
+// scattering matrix. Logs an error otherwise.
+auto
+validate(Nuclide const & nuclide) -> bool;
+
+//----------------------------------------------------------------------------------------
+// Copy the cross sections of a valid nuclide into entry e of xs, which must have the
+// same number of groups
+void
+packNuclide(Nuclide const & nuclide, CrossSections<HostMemSpace> const & xs, Int e);
+
+//----------------------------------------------------------------------------------------
+// Pack the cross sections of the nuclides into one entry each, in order, in parallel.
+// The nuclides must have the same number of groups. Logs an error and returns empty
+// cross sections otherwise.
+auto
+makeCrossSections(std::vector<Nuclide> const & nuclides) -> CrossSections<HostMemSpace>;
+
+} // namespace juno
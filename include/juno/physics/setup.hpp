@@ -0,0 +1,85 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/physics/cross_section_library.hpp>
+#include <juno/physics/material.hpp>
+#include <juno/physics/tracks.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//========================================================================================
+// SETUP
+//========================================================================================
+// The inputs of the stages that set up a model for a solve, and the keys by which a
+// StageCache (see stage_cache.hpp) caches their results:
+//   import:  the soup of the mesh file            <- the contents of the mesh file
+//   reorder: the soup along a space-filling curve <- import, the curve
+//   index:   the mesh and its FaceGrid            <- reorder, faces_per_cell
+//   mix:     the cross sections of the materials  <- the library, the materials
+//   tracks:  the track layout                     <- the box of the mesh, the tracks
+//
+// A stage whose key is unchanged is read from the cache instead of run. The key of a
+// stage downstream of another includes its key, so that a change only runs the stages
+// that depend on it. The mix key takes the library from its index: the hash of the
+// index, and the hashes of the data of the nuclides used, which the index holds. So it
+// costs nothing however large the library is. The settings of the solver are inputs of
+// no stage.
+//
+// Usage:
+//   juno::CrossSectionLibrary const library(setup.library);
+//   auto const keys = juno::stageKeys(setup, library);
+//   auto reader = cache.read("mix", keys.mix);
+//   ...
+//   uint64_t const tracks_key = juno::tracksKey(box, setup.tracks);
+
+namespace juno
+{
+
+struct MaterialInput {
+  std::string name; // of the element set of its faces
+  std::vector<std::string> nuclides;
+  std::vector<Float> number_densities;
+};
+
+struct SetupInput {
+  std::string mesh;
+  std::string reorder = "hilbert"; // hilbert, morton, or none
+  Float faces_per_cell = 2;
+  std::string library;
+  std::vector<MaterialInput> materials;
+  TrackParameters tracks;
+};
+
+struct StageKeys {
+  uint64_t import = 0;
+  uint64_t reorder = 0; // the import key if the soup is not reordered
+  uint64_t index = 0;
+  uint64_t mix = 0;
+};
+
+//----------------------------------------------------------------------------------------
+// The curve of setup.reorder, which is not "none"
+auto
+reorderCurve(SetupInput const & setup) -> int32_t;
+
+//----------------------------------------------------------------------------------------
+// The materials, with their nuclides as entries of names. The nuclides are appended to
+// names in the order of first use.
+auto
+makeMaterials(std::vector<MaterialInput> const & inputs, std::vector<std::string> & names)
+    -> std::vector<Material>;
+
+//----------------------------------------------------------------------------------------
+// The keys of the stages but tracks, whose box is a result of index. Logs an error and
+// returns zero keys if the mesh cannot be read, or a nuclide is not in the library.
+auto
+stageKeys(SetupInput const & setup, CrossSectionLibrary const & library) -> StageKeys;
+
+//----------------------------------------------------------------------------------------
+auto
+tracksKey(AABB2 const & box, TrackParameters const & parameters) -> uint64_t;
+
+} // namespace juno
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/math/ray2.hpp>
+
+#include <cstdint>
+#include <vector>
+
+//========================================================================================
+// TRACKS
+//========================================================================================
+// The characteristic tracks of a 2D method of characteristics (MOC) sweep, and the
+// angular quadrature that weights them.
+//
+// The tracks are cyclic over the bounding box of the mesh: for each azimuthal angle
+// phi in (0, pi), parallel tracks cross the box, and the angle and the spacing are
+// adjusted so that the tracks start and end at evenly spaced points on each side:
+//   nx = floor(width sin(phi) / spacing) + 1 tracks start on the bottom side,
+//   ny = floor(height |cos(phi)| / spacing) + 1 start on the left or right side,
+//   tan(phi') = (height nx) / (width ny), spacing' = (width / nx) sin(phi')
+// Then the track of angle phi' that ends at a point of the boundary is continued, on
+// reflection, by a track of the complementary angle pi - phi' that starts or ends at
+// the same point. Each track is swept in both directions, forward (along phi') and
+// backward; links[2 t + d] is the (track, direction) that continues direction d of
+// track t, as 2 t' + d'. Following the links from any track returns to it.
+//
+// For a domain decomposed into boxes of the same size, the tracks of each box are the
+// same, translated, so a track that leaves one box continues into the same angle and
+// direction of the neighboring box, where it enters the opposite side at the same
+// point. translated_links[2 t + d] is that direction, as an index into the layout of
+// the neighbor, and exit_sides[2 t + d] the side of the box it leaves through.
+//
+// The weights are such that each direction (azimuth a, polar angle p, and either
+// direction along the track) stands for the solid angle
+//   4 pi * azimuthal_weights[a] * polar.weights[p]
+// of both half spaces, which are symmetric in 2D. The azimuthal weights sum to 1/2 over
+// (0, pi), and the polar weights to 1.
+//
+// Usage:
+//   juno::TrackParameters parameters;
+//   parameters.num_azimuthal = 32;
+//   parameters.spacing = 0.02;
+//   auto const layout = juno::makeTrackLayout(grid.box, parameters);
+
+namespace juno
+{
+
+inline constexpr Int max_polar_angles = 3;
+
+//----------------------------------------------------------------------------------------
+// A polar quadrature over the half space: the sines of the angles with the axis
+// normal to the plane, and weights that sum to 1
+struct PolarQuadrature {
+  Int num_angles = 0;
+  Float sin_theta[max_polar_angles] = {};
+  Float weights[max_polar_angles] = {};
+};
+
+// The Tabuchi-Yamamoto quadrature, optimized for 2D MOC, with 1 to 3 angles. Logs an
+// error and returns an empty quadrature for other numbers of angles.
+auto
+tabuchiYamamoto(Int num_angles) -> PolarQuadrature;
+
+//----------------------------------------------------------------------------------------
+struct TrackParameters {
+  Int num_azimuthal = 16; // in (0, pi); must be even
+  Float spacing = static_cast<Float>(0.05);
+  Int num_polar = 3;      // per half space
+};
+
+struct TrackLayout {
+  AABB2 box;
+  PolarQuadrature polar;
+
+  // For each azimuthal angle, in increasing order: the angle, the spacing of its
+  // tracks, its weight, and its tracks [azimuth_offsets[a], azimuth_offsets[a + 1])
+  std::vector<Float> phi;
+  std::vector<Float> spacing;
+  std::vector<Float> azimuthal_weights;
+  std::vector<Int> azimuth_offsets;
+
+  std::vector<Ray2> tracks;
+  std::vector<Int> azimuths; // of each track
+  std::vector<Int> links;    // for each track and direction
+  std::vector<Int> translated_links;
+  std::vector<int32_t> exit_sides;
+
+  [[nodiscard]] auto
+  numAzimuthal() const noexcept -> Int
+  {
+    return static_cast<Int>(phi.size());
+  }
+
+  [[nodiscard]] auto
+  numTracks() const noexcept -> Int
+  {
+    return static_cast<Int>(tracks.size());
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// The cyclic tracks over a box. Logs an error and returns an empty layout if the box is
+// empty or the parameters are invalid.
+auto
+makeTrackLayout(AABB2 const & box, TrackParameters const & parameters) -> TrackLayout;
+
+} // namespace juno
@@ -0,0 +1,87 @@
+#include <juno/common/assert.hpp>
+
+#include <juno/common/logger.hpp>
+#include <juno/config.hpp>
+
+#if JUNO_ENABLE_DEFERRED_ASSERTS
+#  include <Kokkos_Core.hpp>
+
+#  include <algorithm> // std::min
+#  include <cstring>   // std::memset
+#endif
+
+namespace juno
+{
+
+#if JUNO_ENABLE_DEFERRED_ASSERTS
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables) OK, global records
+FailedAsserts host_failed_asserts = {};
+#  if JUNO_USE_GPU
+__device__ FailedAsserts device_failed_asserts = {};
+#  endif
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------
+// Log the recorded failures, then reset them. Returns the number of failures.
+auto
+reportFailedAsserts(FailedAsserts & failed, char const * const where) -> int64_t
+{
+  auto const count = static_cast<int64_t>(failed.count);
+  if (count == 0) {
+    return 0;
+  }
+  auto const recorded = std::min(count, int64_t{failed_asserts::capacity});
+  for (int64_t i = 0; i < recorded; ++i) {
+    FailedAssert const & record = failed.records[i];
+    LOG_WARN("Assertion failed in ", where, " code: ", record.file, ":", record.line, ": ",
+             record.message, " (thread ", record.thread, ")");
+  }
+  if (count > recorded) {
+    LOG_WARN(count - recorded, " more assertions failed in ", where, " code");
+  }
+  std::memset(&failed, 0, sizeof(FailedAsserts));
+  return count;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+checkAsserts(char const * const label) -> int64_t
+{
+  // The kernels that record must be done before the records are read
+  Kokkos::fence("juno::checkAsserts");
+  int64_t count = reportFailedAsserts(host_failed_asserts, "host");
+#  if JUNO_USE_GPU
+  // The count is read first, so the records are only copied after a failure
+  unsigned device_count = 0;
+  gpuMemcpyFromSymbol(&device_count, device_failed_asserts, sizeof(unsigned));
+  if (device_count != 0) {
+    FailedAsserts failed;
+    gpuMemcpyFromSymbol(&failed, device_failed_asserts, sizeof(FailedAsserts));
+    count += reportFailedAsserts(failed, "device");
+    gpuMemcpyToSymbol(device_failed_asserts, &failed, sizeof(FailedAsserts));
+  }
+#  endif
+  if (count != 0) {
+    LOG_ERROR("Failed assertions before '", label, "': ", count);
+  }
+  return count;
+}
+
+#else
+
+//----------------------------------------------------------------------------------------
+auto
+checkAsserts(char const * const /*label*/) -> int64_t
+{
+  return 0;
+}
+
+#endif // JUNO_ENABLE_DEFERRED_ASSERTS
+
+} // namespace juno
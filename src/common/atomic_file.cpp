@@ -0,0 +1,51 @@
+#include <juno/common/atomic_file.hpp>
+#include <juno/common/logger.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem> // std::filesystem::rename, std::filesystem::remove
+#include <random>     // std::random_device
+#include <string>
+#include <system_error>
+
+#include <unistd.h> // getpid
+
+namespace juno::impl
+{
+
+//----------------------------------------------------------------------------------------
+auto
+temporaryFilename(std::string const & filename) -> std::string
+{
+  // The process id, and a random number for processes on other hosts that share the
+  // file system. Then the number of the write in the process.
+  static uint64_t const process =
+      (uint64_t{static_cast<uint32_t>(getpid())} << 32U) ^ std::random_device{}();
+  static std::atomic<uint64_t> num_writes = 0;
+  uint64_t const n = num_writes.fetch_add(1, std::memory_order_relaxed);
+  return filename + ".tmp." + std::to_string(process) + "." + std::to_string(n);
+}
+
+//----------------------------------------------------------------------------------------
+auto
+replaceFile(std::string const & temporary, std::string const & filename) -> bool
+{
+  std::error_code error;
+  std::filesystem::rename(temporary, filename, error);
+  if (error) {
+    LOG_ERROR("Cannot rename '", temporary, "' to '", filename, "': ", error.message());
+    removeFile(temporary);
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+void
+removeFile(std::string const & temporary)
+{
+  std::error_code error;
+  std::filesystem::remove(temporary, error);
+}
+
+} // namespace juno::impl
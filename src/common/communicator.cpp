@@ -0,0 +1,240 @@
+#include <juno/common/communicator.hpp>
+#include <juno/common/logger.hpp>
+
+#include <climits> // INT_MAX
+
+#if JUNO_USE_MPI && defined(OPEN_MPI) && OPEN_MPI
+#  include <mpi-ext.h> // MPIX_Query_cuda_support, MPIX_Query_rocm_support
+#endif
+
+namespace juno
+{
+
+namespace
+{
+
+#if JUNO_USE_MPI
+auto
+isInitialized() noexcept -> bool
+{
+  int initialized = 0;
+  int finalized = 0;
+  MPI_Initialized(&initialized);
+  MPI_Finalized(&finalized);
+  return initialized != 0 && finalized == 0;
+}
+
+// Whether the MPI library can read and write device memory
+auto
+detectGPUAware() noexcept -> bool
+{
+#  if defined(KOKKOS_ENABLE_CUDA) && defined(MPIX_CUDA_AWARE_SUPPORT) &&                 \
+      MPIX_CUDA_AWARE_SUPPORT
+  return MPIX_Query_cuda_support() == 1;
+#  elif defined(KOKKOS_ENABLE_HIP) && defined(MPIX_ROCM_AWARE_SUPPORT) &&                \
+      MPIX_ROCM_AWARE_SUPPORT
+  return MPIX_Query_rocm_support() == 1;
+#  else
+  return false;
+#  endif
+}
+
+auto
+checkedCount(size_t const bytes) noexcept -> int
+{
+  if (bytes > static_cast<size_t>(INT_MAX)) {
+    LOG_ERROR("Communicator: a message of more than INT_MAX bytes");
+    return 0;
+  }
+  return static_cast<int>(bytes);
+}
+#endif
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+// Requests
+//----------------------------------------------------------------------------------------
+
+Requests::~Requests()
+{
+  waitAll();
+}
+
+auto
+Requests::empty() const noexcept -> bool
+{
+#if JUNO_USE_MPI
+  return _requests.empty();
+#else
+  return true;
+#endif
+}
+
+auto
+Requests::testAll() -> bool
+{
+#if JUNO_USE_MPI
+  if (_requests.empty()) {
+    return true;
+  }
+  int done = 0;
+  MPI_Testall(static_cast<int>(_requests.size()), _requests.data(), &done,
+              MPI_STATUSES_IGNORE);
+  if (done != 0) {
+    _requests.clear();
+  }
+  return done != 0;
+#else
+  return true;
+#endif
+}
+
+void
+Requests::waitAll()
+{
+#if JUNO_USE_MPI
+  if (_requests.empty()) {
+    return;
+  }
+  MPI_Waitall(static_cast<int>(_requests.size()), _requests.data(), MPI_STATUSES_IGNORE);
+  _requests.clear();
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+// Communicator
+//----------------------------------------------------------------------------------------
+
+Communicator::Communicator()
+{
+#if JUNO_USE_MPI
+  if (isInitialized()) {
+    *this = Communicator(MPI_COMM_WORLD);
+  }
+#endif
+}
+
+#if JUNO_USE_MPI
+Communicator::Communicator(MPI_Comm const comm)
+    : _comm(comm)
+{
+  int rank = 0;
+  int size = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  _rank = rank;
+  _size = size;
+  _gpu_aware = settings::mpi::gpu_aware < 0 ? detectGPUAware()
+                                            : settings::mpi::gpu_aware != 0;
+}
+#endif
+
+void
+Communicator::send([[maybe_unused]] void const * const data,
+                   [[maybe_unused]] size_t const bytes, int32_t const dest,
+                   [[maybe_unused]] int32_t const tag,
+                   [[maybe_unused]] Requests & requests) const
+{
+#if JUNO_USE_MPI
+  if (_comm != MPI_COMM_NULL) {
+    MPI_Request request = MPI_REQUEST_NULL;
+    MPI_Isend(data, checkedCount(bytes), MPI_BYTE, dest, tag, _comm, &request);
+    requests.add(request);
+    return;
+  }
+#endif
+  LOG_ERROR("Communicator: no MPI to send to rank ", dest);
+}
+
+void
+Communicator::receive([[maybe_unused]] void * const data,
+                      [[maybe_unused]] size_t const bytes, int32_t const source,
+                      [[maybe_unused]] int32_t const tag,
+                      [[maybe_unused]] Requests & requests) const
+{
+#if JUNO_USE_MPI
+  if (_comm != MPI_COMM_NULL) {
+    MPI_Request request = MPI_REQUEST_NULL;
+    MPI_Irecv(data, checkedCount(bytes), MPI_BYTE, source, tag, _comm, &request);
+    requests.add(request);
+    return;
+  }
+#endif
+  LOG_ERROR("Communicator: no MPI to receive from rank ", source);
+}
+
+auto
+Communicator::maxAll(double const value) const -> double
+{
+#if JUNO_USE_MPI
+  if (_comm != MPI_COMM_NULL) {
+    double result = value;
+    MPI_Allreduce(&value, &result, 1, MPI_DOUBLE, MPI_MAX, _comm);
+    return result;
+  }
+#endif
+  return value;
+}
+
+auto
+Communicator::sumAll(double const value) const -> double
+{
+#if JUNO_USE_MPI
+  if (_comm != MPI_COMM_NULL) {
+    double result = value;
+    MPI_Allreduce(&value, &result, 1, MPI_DOUBLE, MPI_SUM, _comm);
+    return result;
+  }
+#endif
+  return value;
+}
+
+auto
+Communicator::allGather(int64_t const value) const -> std::vector<int64_t>
+{
+  std::vector<int64_t> values(static_cast<size_t>(_size), value);
+#if JUNO_USE_MPI
+  if (_comm != MPI_COMM_NULL) {
+    MPI_Allgather(&value, 1, MPI_INT64_T, values.data(), 1, MPI_INT64_T, _comm);
+  }
+#endif
+  return values;
+}
+
+void
+Communicator::barrier() const
+{
+#if JUNO_USE_MPI
+  if (_comm != MPI_COMM_NULL) {
+    MPI_Barrier(_comm);
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+// MPIGuard
+//----------------------------------------------------------------------------------------
+
+MPIGuard::MPIGuard([[maybe_unused]] int & argc, [[maybe_unused]] char **& argv)
+{
+#if JUNO_USE_MPI
+  int initialized = 0;
+  MPI_Initialized(&initialized);
+  if (initialized == 0) {
+    MPI_Init(&argc, &argv);
+    _owner = true;
+  }
+#endif
+}
+
+MPIGuard::~MPIGuard()
+{
+#if JUNO_USE_MPI
+  if (_owner) {
+    MPI_Finalize();
+  }
+#endif
+}
+
+} // namespace juno
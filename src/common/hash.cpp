@@ -0,0 +1,68 @@
+#include <juno/common/hash.hpp>
+#include <juno/common/mapped_file.hpp>
+
+#include <cstring> // std::memcpy
+#include <vector>
+
+namespace juno
+{
+
+namespace
+{
+
+size_t constexpr chunk_bytes = size_t{1} << 20;
+
+//----------------------------------------------------------------------------------------
+// The hash of one chunk: each 8-byte word is mixed into the state with a multiply
+auto
+hashChunk(unsigned char const * data, size_t const size) -> uint64_t
+{
+  uint64_t constexpr prime = 0x100000001b3ULL;
+  uint64_t h = 0xcbf29ce484222325ULL ^ size;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word = 0;
+    std::memcpy(&word, data + i, 8);
+    word *= 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (word ^ (word >> 32))) * prime;
+  }
+  for (; i < size; ++i) {
+    h = (h ^ data[i]) * prime;
+  }
+  return hashCombine(h, size);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+hashBytes(void const * const data, size_t const size) -> uint64_t
+{
+  auto const * const bytes = static_cast<unsigned char const *>(data);
+  auto const num_chunks = static_cast<int64_t>((size + chunk_bytes - 1) / chunk_bytes);
+  std::vector<uint64_t> chunk_hashes(static_cast<size_t>(num_chunks));
+#pragma omp parallel for schedule(static)
+  for (int64_t c = 0; c < num_chunks; ++c) {
+    size_t const begin = static_cast<size_t>(c) * chunk_bytes;
+    size_t const end = begin + chunk_bytes < size ? begin + chunk_bytes : size;
+    chunk_hashes[static_cast<size_t>(c)] = hashChunk(bytes + begin, end - begin);
+  }
+  uint64_t h = hashCombine(0, size);
+  for (uint64_t const chunk_hash : chunk_hashes) {
+    h = hashCombine(h, chunk_hash);
+  }
+  return h;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+hashFile(std::string const & path) -> uint64_t
+{
+  MappedFile const file(path);
+  if (!file.isOpen()) {
+    return 0;
+  }
+  return hashBytes(file.data(), file.size());
+}
+
+} // namespace juno
@@ -4,12 +4,29 @@
 #include <juno/common/settings.hpp>
 #include <juno/config.hpp>
 
-#include <algorithm> // std::copy
-#include <cstdint>   // int32_t
-#include <cstdio>    // snprintf
-#include <memory>    // std::addressof
+#if JUNO_USE_MPI
+#  include <mpi.h>
+#endif
+
+#include <algorithm> // std::copy, std::min, std::max
+#include <array>
+#include <atomic>
+#include <charconv> // std::to_chars
+#include <chrono>
+#include <cstddef> // ptrdiff_t
+#include <cstdint> // int32_t
+#include <cstdio>  // fwrite
+#include <cstdlib> // exit, getenv
+#include <cstring> // memcpy, strlen
+#include <deque>
+#include <memory> // std::addressof
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <system_error> // std::errc
+#include <thread>       // std::this_thread::yield
+#include <unordered_map>
+#include <vector>
 
 namespace juno::logger
 {
@@ -25,13 +42,425 @@ namespace juno::logger
 int32_t & level = juno::settings::logger::level;
 bool & timestamped = juno::settings::logger::timestamped;
 bool & colorized = juno::settings::logger::colorized;
+bool & asynchronous = juno::settings::logger::asynchronous;
+int32_t & float_precision = juno::settings::logger::float_precision;
+int32_t & rank_filter = juno::settings::logger::rank_filter;
+int32_t & rank_stride = juno::settings::logger::rank_stride;
+bool & aggregated = juno::settings::logger::aggregated;
+int32_t & error_policy = juno::settings::logger::error_policy;
+juno::settings::logger::ErrorCallback & error_callback =
+    juno::settings::logger::error_callback;
 
 TimePoint start_time = Clock::now();
-char buffer[buffer_size] = {0};
-char const * const buffer_end = buffer + buffer_size;
+thread_local char buffer[buffer_size] = {0};
+thread_local char const * const buffer_end = buffer + buffer_size;
+thread_local char binary_buffer[buffer_size] = {0};
 
 // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
 
+//========================================================================================
+// Error record
+//========================================================================================
+// A ring of the most recent errors. Errors are rare, so a mutex is fine here.
+
+namespace
+{
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+std::mutex errors_mutex;
+ErrorRecord error_records[error_record_capacity];
+uint64_t error_count = 0;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+//---------------------------------------------------------------------------------------
+void
+recordError(std::string_view const message) noexcept
+{
+  std::scoped_lock const lock(errors_mutex);
+  ErrorRecord & record = error_records[error_count % error_record_capacity];
+  record.time = Clock::now();
+  size_t const size = std::min(message.size(), error_message_size - 1);
+  std::copy(message.begin(), message.begin() + size, std::addressof(record.message[0]));
+  record.message[size] = '\0';
+  ++error_count;
+}
+
+} // namespace
+
+//========================================================================================
+// Output queue
+//========================================================================================
+// A bounded multi-producer queue of finished lines. Any thread may push a line. The
+// thread that wins the "draining" flag pops and writes lines until the queue is empty.
+// In synchronous mode, the thread that pushed a line tries to drain the queue. In
+// asynchronous mode, a background thread drains the queue, so logging never waits on
+// the output.
+//
+// Each slot has a "turn" counter. For the n-th push, lap = n / queue_capacity:
+//  - turn == 2 * lap:     the slot is free for the n-th push
+//  - turn == 2 * lap + 1: the slot holds the line from the n-th push
+// Since the turns start at 0, the zero-initialized queue is valid.
+
+namespace
+{
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+
+struct Line {
+  std::atomic<uint64_t> turn;
+  int32_t level;
+  int32_t size; // including the newline
+  char data[buffer_size];
+};
+
+Line queue[queue_capacity];
+alignas(64) std::atomic<uint64_t> push_count{0};
+alignas(64) std::atomic<uint64_t> pop_count{0};
+alignas(64) std::atomic<bool> draining{false};
+std::atomic<uint64_t> dropped_count{0};
+
+// Does the calling thread hold the draining flag? flush() must not wait for a flag that
+// its own thread holds, e.g. when the process exits while the thread writes the queue.
+thread_local bool holds_draining = false;
+
+// Lines are copied out of the queue into the staging buffer, so that their slots may
+// be reused while the write is in progress. Only the thread holding the draining flag
+// touches the staging buffer.
+inline constexpr size_t staging_size = 1 << 16;
+char staging[staging_size];
+size_t staged_size = 0;
+
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+//---------------------------------------------------------------------------------------
+constexpr auto
+lap(uint64_t const n) noexcept -> uint64_t
+{
+  return n / queue_capacity;
+}
+
+//---------------------------------------------------------------------------------------
+constexpr auto
+slot(uint64_t const n) noexcept -> Line &
+{
+  return queue[n & (queue_capacity - 1)];
+}
+
+//---------------------------------------------------------------------------------------
+// Try to push a line onto the queue. Returns false if the queue is full.
+auto
+tryPush(int32_t const msg_level, char const * const data, int32_t const size) noexcept
+    -> bool
+{
+  uint64_t n = push_count.load(std::memory_order_relaxed);
+  for (;;) {
+    Line & line = slot(n);
+    uint64_t const turn = line.turn.load(std::memory_order_acquire);
+    if (turn == 2 * lap(n)) {
+      // The slot is free. Try to claim it.
+      if (push_count.compare_exchange_weak(n, n + 1, std::memory_order_relaxed)) {
+        line.level = msg_level;
+        line.size = size + 1;
+        std::copy(data, data + size, std::addressof(line.data[0]));
+        line.data[size] = '\n';
+        // Sequentially consistent, as the draining flag: see tryDrain
+        line.turn.store(2 * lap(n) + 1);
+        return true;
+      }
+    } else if (turn < 2 * lap(n)) {
+      // The slot still holds a line from the previous lap
+      return false;
+    } else {
+      // Another thread claimed the slot first
+      n = push_count.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// Does the slot at the front of the queue hold a finished line?
+auto
+hasLine() noexcept -> bool
+{
+  uint64_t const n = pop_count.load();
+  return slot(n).turn.load() == 2 * lap(n) + 1;
+}
+
+//---------------------------------------------------------------------------------------
+// Write the staged lines to the stream with a single fwrite
+void
+writeStaged(FILE * const stream) noexcept
+{
+  if (staged_size == 0) {
+    return;
+  }
+  size_t const written = fwrite(std::addressof(staging[0]), 1, staged_size, stream);
+  if (written != staged_size) {
+    // Do not end the process over a failed write. It may be a full disk or a closed
+    // pipe, and the process may be a long-running service.
+    recordError("failed to write to the log");
+  }
+  staged_size = 0;
+}
+
+//---------------------------------------------------------------------------------------
+// Pop every finished line, batching consecutive lines for the same stream into large
+// writes. Errors go to stderr, everything else to stdout.
+// Must only be called by the thread that holds the draining flag.
+void
+drainQueue() noexcept
+{
+  FILE * stream = stdout;
+  uint64_t n = pop_count.load(std::memory_order_relaxed);
+  for (;;) {
+    Line & line = slot(n);
+    if (line.turn.load(std::memory_order_acquire) != 2 * lap(n) + 1) {
+      break;
+    }
+    FILE * const line_stream = line.level == levels::error ? stderr : stdout;
+    auto const size = static_cast<size_t>(line.size);
+    if (line_stream != stream || staged_size + size > staging_size) {
+      writeStaged(stream);
+      stream = line_stream;
+    }
+    std::copy(line.data, line.data + size, staging + staged_size);
+    staged_size += size;
+    line.turn.store(2 * lap(n) + 2, std::memory_order_release);
+    ++n;
+    pop_count.store(n, std::memory_order_release);
+  }
+  writeStaged(stream);
+}
+
+//---------------------------------------------------------------------------------------
+// Drain the queue, unless another thread is already doing so.
+// The store that publishes a line in tryPush, the exchange and the store of the flag,
+// and the loads in hasLine are all sequentially consistent. A release store of the
+// turn would not do: the pushing thread could then see the flag still set while the
+// drainer's re-check misses the line. In the single total order of these operations,
+// either the drainer's re-check sees the line, or the pushing thread's exchange sees
+// the flag released and it drains the line itself.
+void
+tryDrain() noexcept
+{
+  do {
+    if (draining.exchange(true)) {
+      return;
+    }
+    holds_draining = true;
+    drainQueue();
+    holds_draining = false;
+    draining.store(false);
+  } while (hasLine());
+}
+
+//========================================================================================
+// Deferred messages
+//========================================================================================
+// Each thread that defers a message owns a ring of records (see impl::DeferredHeader).
+// The owner is the only producer. The thread holding the "rendering" flag is the only
+// consumer. It formats the records and pushes the resulting lines onto the queue.
+// Records are 8-byte aligned and never wrap around the end of the ring. If a record
+// does not fit at the end, the rest of the ring is marked as padding.
+//
+// Rings are allocated once per thread, and are reused by new threads when the owner
+// exits, so the rings live until the program exits.
+
+inline constexpr uint64_t record_alignment = 8;
+static_assert(ring_capacity % record_alignment == 0);
+static_assert(sizeof(impl::DeferredHeader) % record_alignment == 0);
+
+struct DeferredRing {
+  alignas(64) std::atomic<uint64_t> head{0}; // bytes written by the owner
+  alignas(64) std::atomic<uint64_t> tail{0}; // bytes consumed by the renderer
+  std::atomic<bool> owned{false};
+  alignas(record_alignment) char data[ring_capacity];
+};
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+std::mutex rings_mutex; // guards the rings container, not the rings themselves
+std::deque<DeferredRing> rings;
+std::atomic<bool> rendering{false};
+thread_local bool holds_rendering = false; // as holds_draining
+// The rings to render, copied under rings_mutex, so that rendering does not hold the
+// mutex. The deque never moves its elements. Only the renderer touches it.
+std::vector<DeferredRing *> rendered_rings;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+//---------------------------------------------------------------------------------------
+// Take a ring that no thread owns, or allocate a new one
+auto
+acquireRing() noexcept -> DeferredRing &
+{
+  std::scoped_lock const lock(rings_mutex);
+  for (auto & ring : rings) {
+    bool expected = false;
+    if (ring.owned.compare_exchange_strong(expected, true)) {
+      return ring;
+    }
+  }
+  DeferredRing & ring = rings.emplace_back();
+  ring.owned.store(true);
+  return ring;
+}
+
+//---------------------------------------------------------------------------------------
+// The calling thread's ring, which is released when the thread exits
+class RingOwner
+{
+  DeferredRing & _ring;
+
+public:
+  RingOwner() noexcept
+      : _ring(acquireRing())
+  {
+  }
+
+  RingOwner(RingOwner const &) = delete;
+  RingOwner(RingOwner &&) = delete;
+  auto
+  operator=(RingOwner const &) -> RingOwner & = delete;
+  auto
+  operator=(RingOwner &&) -> RingOwner & = delete;
+
+  ~RingOwner() { _ring.owned.store(false, std::memory_order_release); }
+
+  [[nodiscard]] auto
+  ring() const noexcept -> DeferredRing &
+  {
+    return _ring;
+  }
+};
+
+//---------------------------------------------------------------------------------------
+// Try to copy the record to the end of the ring. Returns false if the ring is full.
+// The head is stored with sequentially consistent ordering, for the same reason as the
+// turn counters of the queue.
+auto
+tryPushRecord(DeferredRing & ring, char const * const record,
+              uint64_t const size) noexcept -> bool
+{
+  uint64_t head = ring.head.load(std::memory_order_relaxed);
+  uint64_t const tail = ring.tail.load(std::memory_order_acquire);
+  uint64_t const offset = head % ring_capacity;
+  uint64_t const padding = offset + size > ring_capacity ? ring_capacity - offset : 0;
+  if (ring_capacity - (head - tail) < padding + size) {
+    return false;
+  }
+  if (padding != 0) {
+    impl::Decoder const none = nullptr;
+    std::memcpy(std::addressof(ring.data[offset]), std::addressof(none), sizeof(none));
+    head += padding;
+  }
+  std::memcpy(std::addressof(ring.data[head % ring_capacity]), record, size);
+  ring.head.store(head + size);
+  return true;
+}
+
+//---------------------------------------------------------------------------------------
+// Is there a record that has not been rendered?
+auto
+hasRecord() noexcept -> bool
+{
+  std::scoped_lock const lock(rings_mutex);
+  return std::any_of(rings.begin(), rings.end(), [](DeferredRing const & ring) {
+    return ring.head.load() != ring.tail.load();
+  });
+}
+
+//---------------------------------------------------------------------------------------
+// Format the records of every ring and push the lines onto the queue, unless another
+// thread is already doing so. Defined below, after the preamble functions.
+void
+tryRender() noexcept;
+
+//---------------------------------------------------------------------------------------
+// Write the messages counted by this rank since the last aggregate(), with the counts
+// of this rank only. Unlike aggregate(), this is not collective. Defined below, with
+// the aggregation.
+void
+writeCountedMessages() noexcept;
+
+//---------------------------------------------------------------------------------------
+// The background thread that writes queued lines in asynchronous mode.
+// The thread sleeps on "wake" while idle. Producers only notify it if it is idle, so
+// logging does not make a system call when the thread is already busy writing. The
+// idle flag and the queue use sequentially consistent ordering, so either the flusher
+// sees a pushed line before going to sleep, or the producer sees that it is idle.
+class Flusher
+{
+  std::atomic<uint64_t> _wake{0};
+  std::atomic<bool> _idle{false};
+  std::atomic<bool> _stop{false};
+  std::thread _thread;
+
+  void
+  run() noexcept
+  {
+    while (!_stop.load()) {
+      uint64_t const wake = _wake.load();
+      _idle.store(true);
+      if (!hasLine() && !hasRecord() && !_stop.load()) {
+        _wake.wait(wake);
+      }
+      _idle.store(false);
+      tryRender();
+      tryDrain();
+      fflush(stdout);
+      fflush(stderr);
+    }
+  }
+
+public:
+  Flusher()
+      : _thread([this] { run(); })
+  {
+  }
+
+  Flusher(Flusher const &) = delete;
+  Flusher(Flusher &&) = delete;
+  auto
+  operator=(Flusher const &) -> Flusher & = delete;
+  auto
+  operator=(Flusher &&) -> Flusher & = delete;
+
+  // Stop the thread at exit. Whatever is left in the queue is written by flush().
+  ~Flusher()
+  {
+    _stop.store(true);
+    _wake.fetch_add(1);
+    _wake.notify_one();
+    if (_thread.get_id() == std::this_thread::get_id()) {
+      // exit() was called from the flusher itself
+      _thread.detach();
+    } else {
+      _thread.join();
+    }
+    flush();
+  }
+
+  void
+  notify() noexcept
+  {
+    // Only write the shared flag if the flusher is idle
+    if (_idle.load() && _idle.exchange(false)) {
+      _wake.fetch_add(1);
+      _wake.notify_one();
+    }
+  }
+};
+
+//---------------------------------------------------------------------------------------
+// Start the flusher on first use. It is stopped by its destructor at exit.
+auto
+getFlusher() noexcept -> Flusher &
+{
+  static Flusher flusher;
+  return flusher;
+}
+
+} // namespace
+
 //========================================================================================
 // Functions
 //========================================================================================
@@ -39,13 +468,92 @@ char const * const buffer_end = buffer + buffer_size;
 void
 reset() noexcept
 {
+  // Write everything logged under the old settings. The messages counted for
+  // aggregation are written without the other ranks, since reset() is not collective.
+  writeCountedMessages();
+  flush();
+
   // Reset options to default
   level = juno::settings::logger::defaults::level;
   timestamped = juno::settings::logger::defaults::timestamped;
   colorized = juno::settings::logger::defaults::colorized;
+  asynchronous = juno::settings::logger::defaults::asynchronous;
+  float_precision = juno::settings::logger::defaults::float_precision;
+  rank_filter = juno::settings::logger::defaults::rank_filter;
+  rank_stride = juno::settings::logger::defaults::rank_stride;
+  aggregated = juno::settings::logger::defaults::aggregated;
+
+  error_policy = juno::settings::logger::defaults::error_policy;
+  error_callback = juno::settings::logger::defaults::error_callback;
 
   // Reset data
   start_time = Clock::now();
+  dropped_count.store(0);
+  clearErrors();
+}
+
+void
+flush() noexcept
+{
+  // A thread that holds the draining flag cannot drain the queue, nor wait for the flag
+  // to be released, since it is the one to release it
+  if (holds_draining) {
+    fflush(stdout);
+    fflush(stderr);
+    return;
+  }
+
+  // Render the deferred messages, waiting for another renderer to finish. A thread that
+  // holds the rendering flag is in the middle of rendering, so it only drains.
+  while (!holds_rendering && (hasRecord() || rendering.load())) {
+    tryRender();
+    std::this_thread::yield();
+  }
+
+  // Wait for lines that have been claimed, but not yet pushed, and for lines that the
+  // flusher has popped, but not yet written.
+  while (pop_count.load() != push_count.load() || draining.load()) {
+    tryDrain();
+    std::this_thread::yield();
+  }
+  fflush(stdout);
+  fflush(stderr);
+}
+
+auto
+errorCount() noexcept -> uint64_t
+{
+  std::scoped_lock const lock(errors_mutex);
+  return error_count;
+}
+
+auto
+getErrors() -> std::vector<ErrorRecord>
+{
+  std::scoped_lock const lock(errors_mutex);
+  uint64_t const num_records = std::min<uint64_t>(error_count, error_record_capacity);
+  std::vector<ErrorRecord> records;
+  records.reserve(num_records);
+  for (uint64_t i = error_count - num_records; i < error_count; ++i) {
+    records.push_back(error_records[i % error_record_capacity]);
+  }
+  return records;
+}
+
+void
+clearErrors() noexcept
+{
+  std::scoped_lock const lock(errors_mutex);
+  for (auto & record : error_records) {
+    record.message[0] = '\0';
+  }
+  error_count = 0;
+}
+
+auto
+droppedMessages() noexcept -> uint64_t
+{
+  return dropped_count.load(std::memory_order_relaxed);
 }
 
 //========================================================================================
@@ -71,6 +579,58 @@ appendStringViewToBuffer(char * buffer_pos, std::string_view const sv) noexcept
   return new_pos;
 }
 
+//---------------------------------------------------------------------------------------
+// Use std::to_chars to write the value to the buffer in a single pass.
+// Unlike snprintf, this does not need to compute the length first, nor does it depend
+// on the locale.
+template <class T, class... Format>
+auto
+numberToBuffer(char * buffer_pos, T const value, Format const... format) noexcept
+    -> char *
+{
+  char * const last = std::addressof(buffer[0]) + buffer_size;
+  auto const [ptr, ec] = std::to_chars(buffer_pos, last, value, format...);
+  ASSERT(ec == std::errc());
+  // If the value does not fit, write nothing
+  return ec == std::errc() ? ptr : buffer_pos;
+}
+
+//---------------------------------------------------------------------------------------
+// Floating point values are written either in fixed-point notation with
+// float_precision digits after the decimal point, or, if float_precision < 0, using the
+// shortest representation that round-trips.
+template <class T>
+auto
+floatToBuffer(char * buffer_pos, T const value) noexcept -> char *
+{
+  if (float_precision < 0) {
+    return numberToBuffer(buffer_pos, value);
+  }
+  return numberToBuffer(buffer_pos, value, std::chars_format::fixed, float_precision);
+}
+
+//---------------------------------------------------------------------------------------
+// "00", "01", ..., "99", so that two digits can be written with a single lookup
+constexpr auto two_digits = [] {
+  std::array<char, 200> digits{};
+  for (size_t i = 0; i < 100; ++i) {
+    digits[2 * i] = static_cast<char>('0' + (i / 10));
+    digits[2 * i + 1] = static_cast<char>('0' + (i % 10));
+  }
+  return digits;
+}();
+
+//---------------------------------------------------------------------------------------
+// Write a value in [0, 100) as exactly two digits
+auto
+twoDigitsToBuffer(char * buffer_pos, uint64_t const value) noexcept -> char *
+{
+  ASSERT(value < 100);
+  buffer_pos[0] = two_digits[2 * value];
+  buffer_pos[1] = two_digits[2 * value + 1];
+  return buffer_pos + 2;
+}
+
 } // namespace
 
 namespace impl
@@ -99,17 +659,11 @@ toBuffer(char * buffer_pos, char const & value) noexcept -> char *
 }
 
 //---------------------------------------------------------------------------------------
-// Use snprintf to convert the value to a string and store it in the buffer
 template <>
 auto
 toBuffer(char * buffer_pos, int32_t const & value) noexcept -> char *
 {
-  int32_t const len = snprintf(nullptr, 0, "%d", value);
-  int32_t const written =
-      snprintf(buffer_pos, static_cast<uint64_t>(buffer_end - buffer_pos), "%d", value);
-  ASSERT(len == written);
-  ASSERT(buffer_pos + len < buffer_end);
-  return buffer_pos + len;
+  return numberToBuffer(buffer_pos, value);
 }
 
 //---------------------------------------------------------------------------------------
@@ -127,12 +681,7 @@ template <>
 auto
 toBuffer(char * buffer_pos, uint32_t const & value) noexcept -> char *
 {
-  int32_t const len = snprintf(nullptr, 0, "%u", value);
-  int32_t const written =
-      snprintf(buffer_pos, static_cast<uint64_t>(buffer_end - buffer_pos), "%u", value);
-  ASSERT(len == written);
-  ASSERT(buffer_pos + len < buffer_end);
-  return buffer_pos + len;
+  return numberToBuffer(buffer_pos, value);
 }
 
 //---------------------------------------------------------------------------------------
@@ -140,12 +689,7 @@ template <>
 auto
 toBuffer(char * buffer_pos, int64_t const & value) noexcept -> char *
 {
-  int32_t const len = snprintf(nullptr, 0, "%ld", value);
-  int32_t const written =
-      snprintf(buffer_pos, static_cast<uint64_t>(buffer_end - buffer_pos), "%ld", value);
-  ASSERT(len == written);
-  ASSERT(buffer_pos + len < buffer_end);
-  return buffer_pos + len;
+  return numberToBuffer(buffer_pos, value);
 }
 
 //---------------------------------------------------------------------------------------
@@ -153,12 +697,7 @@ template <>
 auto
 toBuffer(char * buffer_pos, uint64_t const & value) noexcept -> char *
 {
-  int32_t const len = snprintf(nullptr, 0, "%lu", value);
-  int32_t const written =
-      snprintf(buffer_pos, static_cast<uint64_t>(buffer_end - buffer_pos), "%lu", value);
-  ASSERT(len == written);
-  ASSERT(buffer_pos + len < buffer_end);
-  return buffer_pos + len;
+  return numberToBuffer(buffer_pos, value);
 }
 
 //---------------------------------------------------------------------------------------
@@ -166,12 +705,7 @@ template <>
 auto
 toBuffer(char * buffer_pos, double const & value) noexcept -> char *
 {
-  int32_t const len = snprintf(nullptr, 0, "%f", value);
-  int32_t const written =
-      snprintf(buffer_pos, static_cast<uint64_t>(buffer_end - buffer_pos), "%f", value);
-  ASSERT(len == written);
-  ASSERT(buffer_pos + len < buffer_end);
-  return buffer_pos + len;
+  return floatToBuffer(buffer_pos, value);
 }
 
 //---------------------------------------------------------------------------------------
@@ -179,9 +713,7 @@ template <>
 auto
 toBuffer(char * buffer_pos, float const & value) noexcept -> char *
 {
-  // snprintf does not support float, so we cast to double
-  auto const dvalue = static_cast<double>(value);
-  return toBuffer(buffer_pos, dvalue);
+  return floatToBuffer(buffer_pos, value);
 }
 
 //---------------------------------------------------------------------------------------
@@ -224,6 +756,80 @@ toBuffer(char * buffer_pos, std::string const & value) noexcept -> char *
   return toBuffer(buffer_pos, sv);
 }
 
+//========================================================================================
+// toBinary/fromBinary functions
+//========================================================================================
+
+//---------------------------------------------------------------------------------------
+template <>
+auto
+toBinary(char * binary_pos, std::string_view const & value) noexcept -> char *
+{
+  // Truncate the string, rather than write past the end of binary_buffer. A string takes
+  // at most half of the room left in the record, so the arguments that follow still fit.
+  char const * const binary_end = binary_buffer + buffer_size;
+  auto const room = (binary_end - binary_pos - ptrdiff_t{sizeof(uint32_t)}) / 2;
+  ASSERT(room >= 0);
+  auto const size =
+      static_cast<uint32_t>(std::min(value.size(), static_cast<size_t>(room)));
+  std::memcpy(binary_pos, std::addressof(size), sizeof(size));
+  binary_pos += sizeof(size);
+  std::copy(value.begin(), value.begin() + size, binary_pos);
+  return binary_pos + size;
+}
+
+//---------------------------------------------------------------------------------------
+template <>
+auto
+toBinary(char * binary_pos, char const * const & value) noexcept -> char *
+{
+  std::string_view const sv(value);
+  return toBinary(binary_pos, sv);
+}
+
+//---------------------------------------------------------------------------------------
+template <>
+auto
+toBinary(char * binary_pos, std::string const & value) noexcept -> char *
+{
+  std::string_view const sv(value);
+  return toBinary(binary_pos, sv);
+}
+
+//---------------------------------------------------------------------------------------
+template <>
+auto
+fromBinary<std::string_view>(char const *& binary_pos, char * buffer_pos) noexcept
+    -> char *
+{
+  uint32_t size = 0;
+  std::memcpy(std::addressof(size), binary_pos, sizeof(size));
+  binary_pos += sizeof(size);
+  std::string_view const sv(binary_pos, size);
+  binary_pos += size;
+  // The record holds up to a full buffer of text: truncate it to the room left before
+  // the postamble (the color reset and the null character)
+  auto const room = buffer_end - buffer_pos - 5;
+  ASSERT(room >= 0);
+  return appendStringViewToBuffer(buffer_pos, sv.substr(0, static_cast<size_t>(room)));
+}
+
+//---------------------------------------------------------------------------------------
+template <>
+auto
+fromBinary<char const *>(char const *& binary_pos, char * buffer_pos) noexcept -> char *
+{
+  return fromBinary<std::string_view>(binary_pos, buffer_pos);
+}
+
+//---------------------------------------------------------------------------------------
+template <>
+auto
+fromBinary<std::string>(char const *& binary_pos, char * buffer_pos) noexcept -> char *
+{
+  return fromBinary<std::string_view>(binary_pos, buffer_pos);
+}
+
 // NOLINTEND(clang-analyzer-deadcode.DeadStores,clang-diagnostic-unused-variable)
 #pragma GCC diagnostic pop
 
@@ -233,54 +839,43 @@ toBuffer(char * buffer_pos, std::string const & value) noexcept -> char *
 // Add the timestamp to the buffer if the log is timestamped
 auto
 addTimestamp(char * buffer_pos) noexcept -> char *
+{
+  return addTimestamp(buffer_pos, Clock::now());
+}
+
+//---------------------------------------------------------------------------------------
+// Add the timestamp for the given time to the buffer if the log is timestamped
+auto
+addTimestamp(char * buffer_pos, TimePoint const time) noexcept -> char *
 {
   if (timestamped) {
-    Duration const elapsed_seconds = Clock::now() - start_time;
-    Int const hours = static_cast<Int>(elapsed_seconds.count()) / 3600;
-    Int const minutes = (static_cast<Int>(elapsed_seconds.count()) / 60) % 60;
-    Int const seconds = static_cast<Int>(elapsed_seconds.count()) % 60;
-    Int const milliseconds = static_cast<Int>(elapsed_seconds.count() * 1000) % 1000;
+    // Work in integer milliseconds, so the elapsed time is only converted once
+    auto const elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(time - start_time);
+    auto const total_ms = static_cast<uint64_t>(elapsed.count());
+    uint64_t const total_seconds = total_ms / 1000;
+    uint64_t const hours = total_seconds / 3600;
+    uint64_t const minutes = (total_seconds / 60) % 60;
+    uint64_t const seconds = total_seconds % 60;
+    uint64_t const milliseconds = total_ms % 1000;
     buffer_pos[0] = '[';
-    if (hours < 10) {
-      buffer_pos[1] = '0';
-      buffer_pos[2] = static_cast<char>(hours + '0');
-    } else {
-      buffer_pos[1] = static_cast<char>((hours / 10) + '0');
-      buffer_pos[2] = static_cast<char>((hours % 10) + '0');
-    }
-    buffer_pos[3] = ':';
-    if (minutes < 10) {
-      buffer_pos[4] = '0';
-      buffer_pos[5] = static_cast<char>(minutes + '0');
+    ++buffer_pos;
+    // Hours are at least two digits, but may be more for very long runs
+    if (hours < 100) {
+      buffer_pos = twoDigitsToBuffer(buffer_pos, hours);
     } else {
-      buffer_pos[4] = static_cast<char>((minutes / 10) + '0');
-      buffer_pos[5] = static_cast<char>((minutes % 10) + '0');
+      buffer_pos = numberToBuffer(buffer_pos, hours);
     }
-    buffer_pos[6] = ':';
-    if (seconds < 10) {
-      buffer_pos[7] = '0';
-      buffer_pos[8] = static_cast<char>(seconds + '0');
-    } else {
-      buffer_pos[7] = static_cast<char>((seconds / 10) + '0');
-      buffer_pos[8] = static_cast<char>((seconds % 10) + '0');
-    }
-    buffer_pos[9] = '.';
-    if (milliseconds < 10) {
-      buffer_pos[10] = '0';
-      buffer_pos[11] = '0';
-      buffer_pos[12] = static_cast<char>(milliseconds + '0');
-    } else if (milliseconds < 100) {
-      buffer_pos[10] = '0';
-      buffer_pos[11] = static_cast<char>((milliseconds / 10) + '0');
-      buffer_pos[12] = static_cast<char>((milliseconds % 10) + '0');
-    } else {
-      buffer_pos[10] = static_cast<char>((milliseconds / 100) + '0');
-      buffer_pos[11] = static_cast<char>(((milliseconds % 100) / 10) + '0');
-      buffer_pos[12] = static_cast<char>(((milliseconds % 100) % 10) + '0');
-    }
-    buffer_pos[13] = ']';
-    buffer_pos[14] = ' ';
-    buffer_pos += 15;
+    buffer_pos[0] = ':';
+    buffer_pos = twoDigitsToBuffer(buffer_pos + 1, minutes);
+    buffer_pos[0] = ':';
+    buffer_pos = twoDigitsToBuffer(buffer_pos + 1, seconds);
+    buffer_pos[0] = '.';
+    buffer_pos[1] = static_cast<char>('0' + (milliseconds / 100));
+    buffer_pos = twoDigitsToBuffer(buffer_pos + 2, milliseconds % 100);
+    buffer_pos[0] = ']';
+    buffer_pos[1] = ' ';
+    buffer_pos += 2;
   } // timestamped
   return buffer_pos;
 } // addTimestamp
@@ -373,18 +968,26 @@ addLevel(int32_t const msg_level, char * buffer_pos) noexcept -> char *
 // Set the preamble of the message
 auto
 setPreamble(int32_t const msg_level) noexcept -> char *
+{
+  return setPreamble(msg_level, Clock::now());
+}
+
+//---------------------------------------------------------------------------------------
+// Set the preamble of a message that was logged at the given time
+auto
+setPreamble(int32_t const msg_level, TimePoint const time) noexcept -> char *
 {
   char * buffer_pos = std::addressof(buffer[0]);
   buffer_pos = addColor(msg_level, buffer_pos);
-  buffer_pos = addTimestamp(buffer_pos);
+  buffer_pos = addTimestamp(buffer_pos, time);
   buffer_pos = addLevel(msg_level, buffer_pos);
   return buffer_pos;
 }
 
 //---------------------------------------------------------------------------------------
 // Set the postamble of the message
-void
-setPostamble(char * buffer_pos) noexcept
+auto
+setPostamble(char * buffer_pos) noexcept -> char *
 {
   // Reset color
   if (colorized) {
@@ -398,6 +1001,474 @@ setPostamble(char * buffer_pos) noexcept
 
   // Ensure null-terminated string
   buffer_pos[0] = '\0';
+  return buffer_pos;
+}
+
+//---------------------------------------------------------------------------------------
+// Push the message onto the output queue and write the queued messages
+void
+writeMessage(int32_t const msg_level, char const * const message_end) noexcept
+{
+  char const * const message = std::addressof(buffer[0]);
+  auto const size = static_cast<int32_t>(message_end - message);
+  ASSERT(size < buffer_size);
+
+  // Asynchronous: hand the line to the flusher. If the queue is full, drop the line
+  // rather than wait for the output. Errors are never dropped.
+  if (asynchronous && msg_level != levels::error) {
+    Flusher & flusher = getFlusher();
+    if (tryPush(msg_level, message, size)) {
+      flusher.notify();
+    } else {
+      dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+
+  // Synchronous: if the queue is full, help drain it until there is room
+  while (!tryPush(msg_level, message, size)) {
+    tryDrain();
+    std::this_thread::yield();
+  }
+  tryDrain();
+}
+
+//---------------------------------------------------------------------------------------
+// Handle an error that has been written to the output
+void
+handleError(std::string_view const message)
+{
+  recordError(message);
+  switch (error_policy) {
+  case error_policies::exception:
+    throw Error(std::string(message));
+  case error_policies::callback:
+    if (error_callback != nullptr) {
+      error_callback(message);
+    }
+    break;
+  default:
+    // Make sure every queued message reaches the output first
+    flush();
+    exit(1);
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// Copy the deferred message to the calling thread's ring
+void
+commitDeferred(int32_t const msg_level, Decoder const decode,
+               char const * const record_end) noexcept
+{
+  thread_local RingOwner const owner;
+  char * const record = std::addressof(binary_buffer[0]);
+  auto const used = static_cast<uint64_t>(record_end - record);
+  // Round up, so the next record is aligned
+  uint64_t const size = (used + record_alignment - 1) & ~(record_alignment - 1);
+  ASSERT(size <= buffer_size);
+  DeferredHeader const header = {decode, Clock::now().time_since_epoch().count(),
+                                 msg_level, static_cast<uint32_t>(size)};
+  std::memcpy(record, std::addressof(header), sizeof(header));
+
+  DeferredRing & ring = owner.ring();
+  if (asynchronous) {
+    Flusher & flusher = getFlusher();
+    if (tryPushRecord(ring, record, size)) {
+      flusher.notify();
+    } else {
+      dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+  // Synchronous: render the ring to make room
+  while (!tryPushRecord(ring, record, size)) {
+    tryRender();
+    std::this_thread::yield();
+  }
+}
+
+} // namespace impl
+
+//========================================================================================
+// Rendering deferred messages
+//========================================================================================
+
+namespace
+{
+
+//---------------------------------------------------------------------------------------
+// Format a record into the calling thread's buffer and push it onto the queue. Unlike
+// writeMessage, this never drops the line, so that the renderer does not lose messages
+// that were already accepted into a ring.
+void
+renderRecord(impl::DeferredHeader const & header, char const * const args) noexcept
+{
+  TimePoint const time{Clock::duration{header.time}};
+  char * buffer_pos = impl::setPreamble(header.level, time);
+  buffer_pos = header.decode(args, buffer_pos);
+  buffer_pos = impl::setPostamble(buffer_pos);
+  char const * const message = std::addressof(buffer[0]);
+  auto const size = static_cast<int32_t>(buffer_pos - message);
+  while (!tryPush(header.level, message, size)) {
+    tryDrain();
+    std::this_thread::yield();
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// Render every record in the ring. Must only be called by the thread holding the
+// rendering flag.
+void
+renderRing(DeferredRing & ring) noexcept
+{
+  uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+  uint64_t const head = ring.head.load(std::memory_order_acquire);
+  while (tail != head) {
+    char const * const record = std::addressof(ring.data[tail % ring_capacity]);
+    impl::DeferredHeader header;
+    std::memcpy(std::addressof(header.decode), record, sizeof(header.decode));
+    if (header.decode == nullptr) {
+      // Padding: skip to the start of the ring
+      tail += ring_capacity - (tail % ring_capacity);
+      continue;
+    }
+    std::memcpy(std::addressof(header), record, sizeof(header));
+    renderRecord(header, record + sizeof(header));
+    tail += header.size;
+    ring.tail.store(tail, std::memory_order_release);
+  }
+  ring.tail.store(tail, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------
+void
+tryRender() noexcept
+{
+  if (rendering.exchange(true)) {
+    return;
+  }
+  holds_rendering = true;
+  {
+    std::scoped_lock const lock(rings_mutex);
+    rendered_rings.clear();
+    for (auto & ring : rings) {
+      rendered_rings.push_back(std::addressof(ring));
+    }
+  }
+  for (auto * const ring : rendered_rings) {
+    renderRing(*ring);
+  }
+  holds_rendering = false;
+  rendering.store(false);
+  tryDrain();
+}
+
+} // namespace
+
+//========================================================================================
+// Ranks and aggregation
+//========================================================================================
+
+namespace
+{
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+std::atomic<int32_t> cached_rank{-1};
+
+// The messages counted by this rank since the last aggregate(), in the order in which
+// they were first logged. The index is keyed by the level, followed by the text.
+struct AggregatedMessage {
+  int32_t level;
+  int32_t ranks; // the number of ranks that logged the message
+  uint64_t count;
+  std::string text;
+};
+
+std::mutex aggregated_mutex;
+std::vector<AggregatedMessage> aggregated_messages;
+std::unordered_map<std::string, size_t> aggregated_index;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+//---------------------------------------------------------------------------------------
+// The rank, as set by the launcher, or -1 if it is not set
+auto
+rankFromEnvironment() noexcept -> int32_t
+{
+  // Open MPI, MPICH and Intel MPI, PMIx, and Slurm, respectively
+  char const * const names[] = {"OMPI_COMM_WORLD_RANK", "PMI_RANK", "PMIX_RANK",
+                                "SLURM_PROCID"};
+  for (char const * const name : names) {
+    char const * const value = std::getenv(name);
+    if (value != nullptr) {
+      int32_t env_rank = -1;
+      auto const [ptr, ec] = std::from_chars(value, value + std::strlen(value), env_rank);
+      if (ec == std::errc() && env_rank >= 0) {
+        return env_rank;
+      }
+    }
+  }
+  return -1;
+}
+
+//---------------------------------------------------------------------------------------
+// Count a message under the key (level, text). If other_rank, the count comes from a
+// rank that has not been counted for this message yet.
+void
+countMessage(int32_t const msg_level, std::string_view const text, uint64_t const count,
+             bool const other_rank, std::vector<AggregatedMessage> & messages,
+             std::unordered_map<std::string, size_t> & index)
+{
+  std::string key(1, static_cast<char>('0' + msg_level));
+  key.append(text);
+  auto const [it, inserted] = index.try_emplace(std::move(key), messages.size());
+  if (inserted) {
+    messages.push_back({msg_level, 1, count, std::string(text)});
+  } else {
+    messages[it->second].count += count;
+    if (other_rank) {
+      messages[it->second].ranks += 1;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// Write "<preamble><text> [count: N, ranks: M]<postamble>", truncating the text if the
+// line would not fit in the buffer
+void
+writeAggregated(AggregatedMessage const & message) noexcept
+{
+  auto const num_digits = [](auto const value) noexcept -> ptrdiff_t {
+    char digits[24];
+    return std::to_chars(digits, digits + sizeof(digits), value).ptr - digits;
+  };
+  // The suffix, the color reset of the postamble, and the null character
+  ptrdiff_t const reserved = static_cast<ptrdiff_t>(sizeof(" [count: , ranks: ]")) +
+                             num_digits(message.count) + num_digits(message.ranks) +
+                             (colorized ? 4 : 0);
+  char * buffer_pos = impl::setPreamble(message.level);
+  ptrdiff_t const available = std::max(buffer_end - buffer_pos - reserved, ptrdiff_t{0});
+  std::string_view const text(
+      message.text.data(), std::min(message.text.size(), static_cast<size_t>(available)));
+  buffer_pos = impl::toBuffer(buffer_pos, text);
+  buffer_pos = impl::toBuffer(buffer_pos, " [count: ");
+  buffer_pos = impl::toBuffer(buffer_pos, message.count);
+  buffer_pos = impl::toBuffer(buffer_pos, ", ranks: ");
+  buffer_pos = impl::toBuffer(buffer_pos, message.ranks);
+  buffer_pos = impl::toBuffer(buffer_pos, ']');
+  buffer_pos = impl::setPostamble(buffer_pos);
+  impl::writeMessage(message.level, buffer_pos);
+}
+
+#if JUNO_USE_MPI
+//---------------------------------------------------------------------------------------
+// Serialize messages as (level, count, size, text) tuples
+auto
+serializeMessages(std::vector<AggregatedMessage> const & messages) -> std::vector<char>
+{
+  std::vector<char> bytes;
+  for (auto const & message : messages) {
+    auto const size = static_cast<uint32_t>(message.text.size());
+    size_t const offset = bytes.size();
+    bytes.resize(offset + sizeof(message.level) + sizeof(message.count) + sizeof(size) +
+                 size);
+    char * pos = bytes.data() + offset;
+    std::memcpy(pos, std::addressof(message.level), sizeof(message.level));
+    pos += sizeof(message.level);
+    std::memcpy(pos, std::addressof(message.count), sizeof(message.count));
+    pos += sizeof(message.count);
+    std::memcpy(pos, std::addressof(size), sizeof(size));
+    pos += sizeof(size);
+    std::copy(message.text.begin(), message.text.end(), pos);
+  }
+  return bytes;
+}
+
+//---------------------------------------------------------------------------------------
+// Count the serialized messages of one rank
+void
+countSerialized(char const * pos, char const * const end,
+                std::vector<AggregatedMessage> & messages,
+                std::unordered_map<std::string, size_t> & index)
+{
+  while (pos < end) {
+    int32_t msg_level = 0;
+    uint64_t count = 0;
+    uint32_t size = 0;
+    std::memcpy(std::addressof(msg_level), pos, sizeof(msg_level));
+    pos += sizeof(msg_level);
+    std::memcpy(std::addressof(count), pos, sizeof(count));
+    pos += sizeof(count);
+    std::memcpy(std::addressof(size), pos, sizeof(size));
+    pos += sizeof(size);
+    countMessage(msg_level, std::string_view(pos, size), count, /*other_rank=*/true,
+                 messages, index);
+    pos += size;
+  }
+}
+#endif // JUNO_USE_MPI
+
+} // namespace
+
+//---------------------------------------------------------------------------------------
+auto
+rank() noexcept -> int32_t
+{
+  int32_t const cached = cached_rank.load(std::memory_order_relaxed);
+  if (cached >= 0) {
+    return cached;
+  }
+#if JUNO_USE_MPI
+  int initialized = 0;
+  int finalized = 0;
+  MPI_Initialized(&initialized);
+  MPI_Finalized(&finalized);
+  if (initialized != 0 && finalized == 0) {
+    int mpi_rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    cached_rank.store(mpi_rank, std::memory_order_relaxed);
+    return mpi_rank;
+  }
+#endif
+  int32_t const env_rank = rankFromEnvironment();
+  if (env_rank >= 0) {
+    cached_rank.store(env_rank, std::memory_order_relaxed);
+    return env_rank;
+  }
+#if JUNO_USE_MPI
+  // Unknown until MPI is initialized
+  return 0;
+#else
+  cached_rank.store(0, std::memory_order_relaxed);
+  return 0;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+void
+aggregate() noexcept
+{
+  std::vector<AggregatedMessage> local;
+  {
+    std::scoped_lock const lock(aggregated_mutex);
+    local.swap(aggregated_messages);
+    aggregated_index.clear();
+  }
+
+  std::vector<AggregatedMessage> merged;
+#if JUNO_USE_MPI
+  int initialized = 0;
+  int finalized = 0;
+  MPI_Initialized(&initialized);
+  MPI_Finalized(&finalized);
+  if (initialized != 0 && finalized == 0) {
+    int mpi_rank = 0;
+    int num_ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+    std::vector<char> const bytes = serializeMessages(local);
+    int const num_bytes = static_cast<int>(bytes.size());
+    std::vector<int> sizes(mpi_rank == 0 ? static_cast<size_t>(num_ranks) : 0);
+    MPI_Gather(&num_bytes, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    std::vector<int> offsets(sizes.size() + 1, 0);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      offsets[i + 1] = offsets[i] + sizes[i];
+    }
+    std::vector<char> all_bytes(mpi_rank == 0 ? static_cast<size_t>(offsets.back()) : 0);
+    MPI_Gatherv(bytes.data(), num_bytes, MPI_CHAR, all_bytes.data(), sizes.data(),
+                offsets.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (mpi_rank != 0) {
+      return;
+    }
+    std::unordered_map<std::string, size_t> index;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      char const * const first = all_bytes.data() + offsets[i];
+      countSerialized(first, first + sizes[i], merged, index);
+    }
+  } else {
+    merged.swap(local);
+  }
+#else
+  merged.swap(local);
+#endif
+
+  for (auto const & message : merged) {
+    writeAggregated(message);
+  }
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------------------
+void
+writeCountedMessages() noexcept
+{
+  std::vector<AggregatedMessage> local;
+  {
+    std::scoped_lock const lock(aggregated_mutex);
+    local.swap(aggregated_messages);
+    aggregated_index.clear();
+  }
+  for (auto const & message : local) {
+    writeAggregated(message);
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// Render and write whatever is left at exit, including the messages counted for
+// aggregation. This is destroyed before the rings and the counted messages, since it is
+// constructed after them.
+class FlushAtExit
+{
+public:
+  FlushAtExit() = default;
+  FlushAtExit(FlushAtExit const &) = delete;
+  FlushAtExit(FlushAtExit &&) = delete;
+  auto
+  operator=(FlushAtExit const &) -> FlushAtExit & = delete;
+  auto
+  operator=(FlushAtExit &&) -> FlushAtExit & = delete;
+  ~FlushAtExit()
+  {
+    writeCountedMessages();
+    flush();
+  }
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+FlushAtExit const flush_at_exit;
+
+} // namespace
+
+namespace impl
+{
+
+//---------------------------------------------------------------------------------------
+auto
+isRankLogged(int32_t const msg_level) noexcept -> bool
+{
+  if (msg_level == levels::error) {
+    return true;
+  }
+  switch (rank_filter) {
+  case rank_filters::root:
+    return rank() == 0;
+  case rank_filters::strided:
+    return rank_stride > 0 && rank() % rank_stride == 0;
+  default:
+    return true;
+  }
+}
+
+//---------------------------------------------------------------------------------------
+void
+aggregateMessage(int32_t const msg_level, char const * const message_end) noexcept
+{
+  char const * const message = std::addressof(buffer[0]);
+  std::string_view const text(message, static_cast<size_t>(message_end - message));
+  std::scoped_lock const lock(aggregated_mutex);
+  countMessage(msg_level, text, 1, /*other_rank=*/false, aggregated_messages,
+               aggregated_index);
 }
 
 } // namespace impl
@@ -0,0 +1,103 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/mapped_file.hpp>
+
+#include <cerrno>  // errno
+#include <cstring> // std::strerror
+#include <utility> // std::exchange
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+namespace juno
+{
+
+namespace
+{
+
+// The description of errno, as the logger expects
+auto
+lastError() -> char const *
+{
+  return std::strerror(errno);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+MappedFile::MappedFile(std::string const & path, bool const copy_on_write)
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+  int const fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR("Cannot open file '", path, "': ", lastError());
+    return;
+  }
+  struct stat info = {};
+  if (::fstat(fd, &info) != 0) {
+    LOG_ERROR("Cannot stat file '", path, "': ", lastError());
+    ::close(fd);
+    return;
+  }
+  auto const size = static_cast<size_t>(info.st_size);
+  if (size > 0) {
+    int const protection = copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+    void * const data = ::mmap(nullptr, size, protection, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      LOG_ERROR("Cannot map file '", path, "': ", lastError());
+      ::close(fd);
+      return;
+    }
+    // The readers of large files mostly scan them once, front to back
+    ::madvise(data, size, MADV_SEQUENTIAL);
+    _data = static_cast<char const *>(data);
+  }
+  // The mapping stays valid after the file is closed
+  ::close(fd);
+  _size = size;
+  _open = true;
+  _copy_on_write = copy_on_write;
+}
+
+//----------------------------------------------------------------------------------------
+MappedFile::MappedFile(MappedFile && other) noexcept
+    : _data(std::exchange(other._data, nullptr)),
+      _size(std::exchange(other._size, 0)),
+      _open(std::exchange(other._open, false)),
+      _copy_on_write(std::exchange(other._copy_on_write, false))
+{
+}
+
+//----------------------------------------------------------------------------------------
+auto
+MappedFile::operator=(MappedFile && other) noexcept -> MappedFile &
+{
+  if (this != &other) {
+    close();
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+    _open = std::exchange(other._open, false);
+    _copy_on_write = std::exchange(other._copy_on_write, false);
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------
+MappedFile::~MappedFile() { close(); }
+
+//----------------------------------------------------------------------------------------
+void
+MappedFile::close() noexcept
+{
+  if (_data != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<char *>(_data), _size);
+  }
+  _data = nullptr;
+  _size = 0;
+  _open = false;
+  _copy_on_write = false;
+}
+
+} // namespace juno
@@ -0,0 +1,280 @@
+#include <juno/common/profiler.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm> // std::min
+#include <cstring>   // strcmp
+#include <deque>
+#include <mutex>
+#include <string_view>
+
+namespace juno::profiler
+{
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+bool & enabled = settings::profiler::enabled;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+//========================================================================================
+// Per-thread call trees
+//========================================================================================
+// Each thread appends nodes to its own tree, which only that thread modifies between
+// resets. The trees are owned by a registry, in which they are never moved or freed,
+// since a thread may exit before the profile is queried.
+
+namespace
+{
+
+struct Node {
+  std::string name;
+  int32_t parent;
+  uint64_t calls;
+  Clock::duration time;
+  std::vector<int32_t> children;
+};
+
+struct ThreadProfile {
+  // nodes[0] is the root, which is never timed
+  std::vector<Node> nodes = {Node{"", -1, 0, Clock::duration::zero(), {}}};
+  std::vector<Clock::time_point> starts; // the start times of the running timers
+  int32_t current = 0;                   // the node of the innermost running timer
+};
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+std::mutex profiles_mutex;
+std::deque<ThreadProfile> profiles;
+Clock::time_point reset_time = Clock::now();
+thread_local ThreadProfile * thread_profile = nullptr;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+//----------------------------------------------------------------------------------------
+auto
+getThreadProfile() -> ThreadProfile &
+{
+  if (thread_profile == nullptr) {
+    std::scoped_lock const lock(profiles_mutex);
+    thread_profile = &profiles.emplace_back();
+  }
+  return *thread_profile;
+}
+
+//----------------------------------------------------------------------------------------
+// Find the child of "parent" with the given name, or add it.
+auto
+findChild(ThreadProfile & tp, int32_t const parent, char const * name) -> int32_t
+{
+  for (int32_t const child : tp.nodes[static_cast<size_t>(parent)].children) {
+    // Compare the contents, since names from Kokkos may reuse the same storage
+    if (std::strcmp(tp.nodes[static_cast<size_t>(child)].name.c_str(), name) == 0) {
+      return child;
+    }
+  }
+  auto const child = static_cast<int32_t>(tp.nodes.size());
+  tp.nodes.push_back(Node{name, parent, 0, Clock::duration::zero(), {}});
+  tp.nodes[static_cast<size_t>(parent)].children.push_back(child);
+  return child;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+void
+start(char const * name)
+{
+  ThreadProfile & tp = getThreadProfile();
+  tp.current = findChild(tp, tp.current, name);
+  // Read the clock last, so the bookkeeping above is not timed
+  tp.starts.push_back(Clock::now());
+}
+
+//----------------------------------------------------------------------------------------
+void
+stop() noexcept
+{
+  // Read the clock first, so the bookkeeping below is not timed
+  Clock::time_point const now = Clock::now();
+  ThreadProfile * const tp = thread_profile;
+  if (tp == nullptr || tp->starts.empty()) {
+    return;
+  }
+  Node & node = tp->nodes[static_cast<size_t>(tp->current)];
+  node.time += now - tp->starts.back();
+  ++node.calls;
+  tp->starts.pop_back();
+  tp->current = node.parent;
+}
+
+//========================================================================================
+// Merging and reporting
+//========================================================================================
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------
+// Add the subtree of "tp" rooted at "node" to the subtree of "merged" rooted at
+// "merged_node". Children of a merged node are found by name.
+void
+mergeTree(ThreadProfile const & tp, int32_t const node, ThreadProfile & merged,
+          int32_t const merged_node, std::vector<int32_t> & threads)
+{
+  for (int32_t const child : tp.nodes[static_cast<size_t>(node)].children) {
+    Node const & src = tp.nodes[static_cast<size_t>(child)];
+    int32_t const dst = findChild(merged, merged_node, src.name.c_str());
+    if (static_cast<size_t>(dst) == threads.size()) {
+      threads.push_back(0);
+    }
+    Node & dst_node = merged.nodes[static_cast<size_t>(dst)];
+    dst_node.calls += src.calls;
+    dst_node.time += src.time;
+    ++threads[static_cast<size_t>(dst)];
+    mergeTree(tp, child, merged, dst, threads);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// Append the subtree rooted at "node" to "out" in pre-order.
+void
+flattenTree(ThreadProfile const & merged, std::vector<int32_t> const & threads,
+            int32_t const node, int32_t const parent, int32_t const depth,
+            std::vector<ProfileNode> & out)
+{
+  for (int32_t const child : merged.nodes[static_cast<size_t>(node)].children) {
+    Node const & src = merged.nodes[static_cast<size_t>(child)];
+    auto const index = static_cast<int32_t>(out.size());
+    out.push_back(ProfileNode{src.name, parent, depth, src.calls,
+                              std::chrono::duration_cast<Duration>(src.time),
+                              threads[static_cast<size_t>(child)]});
+    flattenTree(merged, threads, child, index, depth + 1, out);
+  }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+getProfile() -> std::vector<ProfileNode>
+{
+  ThreadProfile merged;
+  std::vector<int32_t> threads = {0}; // per merged node
+  {
+    std::scoped_lock const lock(profiles_mutex);
+    for (ThreadProfile const & tp : profiles) {
+      mergeTree(tp, 0, merged, 0, threads);
+    }
+  }
+  std::vector<ProfileNode> out;
+  out.reserve(merged.nodes.size() - 1);
+  flattenTree(merged, threads, 0, -1, 0, out);
+  return out;
+}
+
+//----------------------------------------------------------------------------------------
+void
+report()
+{
+  Duration const wall_time = Clock::now() - reset_time;
+  std::vector<ProfileNode> const profile = getProfile();
+  LOG_INFO("Profile: ", wall_time.count(), " s since reset");
+  // Enough indentation for any sensible nesting depth
+  std::string_view constexpr spaces = "                                ";
+  for (ProfileNode const & node : profile) {
+    Duration const parent_time =
+        node.parent < 0 ? wall_time : profile[static_cast<size_t>(node.parent)].time;
+    double const percent = parent_time.count() > 0.0
+                               ? 100.0 * node.time.count() / parent_time.count()
+                               : 0.0;
+    double const mean =
+        node.calls > 0 ? node.time.count() / static_cast<double>(node.calls) : 0.0;
+    std::string_view const indent =
+        spaces.substr(0, std::min(spaces.size(), 2 * static_cast<size_t>(node.depth)));
+    LOG_INFO(indent, node.name, ": ", node.time.count(), " s, ", node.calls,
+             " calls, ", mean, " s/call, ", percent, "%, ", node.threads, " threads");
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void
+reset()
+{
+  enabled = settings::profiler::defaults::enabled;
+  std::scoped_lock const lock(profiles_mutex);
+  for (ThreadProfile & tp : profiles) {
+    tp = ThreadProfile();
+  }
+  reset_time = Clock::now();
+}
+
+//========================================================================================
+// Kokkos Tools
+//========================================================================================
+
+namespace
+{
+
+// The kernel ID tells the end callback whether the begin callback started a timer.
+// Regions have no ID, so the same is recorded on a per-thread stack.
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+thread_local std::vector<bool> region_started;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+//----------------------------------------------------------------------------------------
+void
+beginKernel(char const * name, uint32_t const /*device_id*/, uint64_t * kernel_id)
+{
+  *kernel_id = enabled ? 1 : 0;
+  if (enabled) {
+    start(name);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void
+endKernel(uint64_t const kernel_id)
+{
+  if (kernel_id == 1) {
+    stop();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void
+pushRegion(char const * name)
+{
+  region_started.push_back(enabled);
+  if (enabled) {
+    start(name);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void
+popRegion()
+{
+  if (region_started.empty()) {
+    return;
+  }
+  if (region_started.back()) {
+    stop();
+  }
+  region_started.pop_back();
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+void
+enableKokkosHooks()
+{
+  namespace tools = Kokkos::Tools::Experimental;
+  tools::set_begin_parallel_for_callback(beginKernel);
+  tools::set_end_parallel_for_callback(endKernel);
+  tools::set_begin_parallel_reduce_callback(beginKernel);
+  tools::set_end_parallel_reduce_callback(endKernel);
+  tools::set_begin_parallel_scan_callback(beginKernel);
+  tools::set_end_parallel_scan_callback(endKernel);
+  tools::set_push_region_callback(pushRegion);
+  tools::set_pop_region_callback(popRegion);
+}
+
+} // namespace juno::profiler
@@ -15,6 +15,31 @@ namespace juno::settings::logger
 int32_t level = defaults::level;
 bool timestamped = defaults::timestamped;
 bool colorized = defaults::colorized;
+bool asynchronous = defaults::asynchronous;
+int32_t float_precision = defaults::float_precision;
+int32_t rank_filter = defaults::rank_filter;
+int32_t rank_stride = defaults::rank_stride;
+bool aggregated = defaults::aggregated;
+int32_t error_policy = defaults::error_policy;
+ErrorCallback error_callback = defaults::error_callback;
 } // namespace juno::settings::logger
 
+//========================================================================================
+// PROFILER
+//========================================================================================
+
+namespace juno::settings::profiler
+{
+bool enabled = defaults::enabled;
+} // namespace juno::settings::profiler
+
+//========================================================================================
+// MPI
+//========================================================================================
+
+namespace juno::settings::mpi
+{
+int32_t gpu_aware = defaults::gpu_aware;
+} // namespace juno::settings::mpi
+
 // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
@@ -0,0 +1,148 @@
+#include <juno/common/atomic_file.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/stage_cache.hpp>
+
+#include <cstdio>     // std::snprintf
+#include <cstring>    // std::memcmp, std::memcpy
+#include <filesystem> // std::filesystem::create_directories, std::filesystem::path
+#include <fstream>    // std::ifstream, std::ofstream
+#include <system_error>
+
+namespace juno
+{
+
+namespace
+{
+
+char constexpr magic[8] = {'J', 'U', 'N', 'O', 'S', 'T', 'A', 'G'};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t float_size;
+  uint32_t int_size;
+  uint32_t padding;
+  uint64_t key;
+  uint64_t size; // of the contents, which follow
+  uint64_t content_hash;
+};
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+stageKey(std::string const & stage, std::vector<uint64_t> const & inputs) -> uint64_t
+{
+  uint64_t key = hashString(stage);
+  for (auto const input : inputs) {
+    key = hashCombine(key, input);
+  }
+  return key;
+}
+
+//----------------------------------------------------------------------------------------
+// StageWriter and StageReader
+//----------------------------------------------------------------------------------------
+
+void
+StageWriter::append(void const * const data, size_t const bytes)
+{
+  auto const * const first = static_cast<char const *>(data);
+  _bytes.insert(_bytes.end(), first, first + bytes);
+}
+
+auto
+StageReader::take(size_t const bytes) -> int64_t
+{
+  if (!_ok || bytes > _bytes.size() - _position) {
+    _ok = false;
+    return -1;
+  }
+  auto const at = static_cast<int64_t>(_position);
+  _position += bytes;
+  return at;
+}
+
+//----------------------------------------------------------------------------------------
+// StageCache
+//----------------------------------------------------------------------------------------
+
+StageCache::StageCache(std::string directory)
+{
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    LOG_ERROR("Cannot create the stage cache '", directory, "': ", error.message());
+    return;
+  }
+  _directory = std::move(directory);
+}
+
+auto
+StageCache::filename(std::string const & stage, uint64_t const key) const
+    -> std::string
+{
+  char hex[17] = {};
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+  return (std::filesystem::path(_directory) / (stage + "-" + hex + ".stage")).string();
+}
+
+auto
+StageCache::read(std::string const & stage, uint64_t const key) const -> StageReader
+{
+  if (!enabled()) {
+    return {};
+  }
+  auto const name = filename(stage, key);
+  std::ifstream file(name, std::ios::binary);
+  if (!file) {
+    LOG_INFO("Stage '", stage, "' is not cached");
+    return {};
+  }
+  Header header = {};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char *>(&header), sizeof(Header));
+  if (!file || std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+    LOG_INFO("Stage cache '", name, "' is not a stage result");
+    return {};
+  }
+  if (header.version != stage_cache::version || header.float_size != sizeof(Float) ||
+      header.int_size != sizeof(Int) || header.key != key) {
+    LOG_INFO("Stage cache '", name, "' was written by another version or build");
+    return {};
+  }
+  std::vector<char> bytes(static_cast<size_t>(header.size));
+  file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  if (!file || hashBytes(bytes.data(), bytes.size()) != header.content_hash) {
+    LOG_INFO("Stage cache '", name, "' is damaged");
+    return {};
+  }
+  return StageReader(std::move(bytes));
+}
+
+auto
+StageCache::write(std::string const & stage, uint64_t const key,
+                  StageWriter const & writer) const -> bool
+{
+  if (!enabled()) {
+    return false;
+  }
+  auto const & bytes = writer.bytes();
+  Header header = {};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = stage_cache::version;
+  header.float_size = sizeof(Float);
+  header.int_size = sizeof(Int);
+  header.key = key;
+  header.size = bytes.size();
+  header.content_hash = hashBytes(bytes.data(), bytes.size());
+
+  auto const write = [&](std::ofstream & file) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  };
+  return writeFileAtomically(filename(stage, key), "stage cache", write);
+}
+
+} // namespace juno
@@ -0,0 +1,223 @@
+#include <juno/common/assert.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/common/task_scheduler.hpp>
+
+#include <omp.h>
+
+#include <algorithm> // std::lower_bound, std::max
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory> // std::make_unique
+
+namespace juno
+{
+
+namespace
+{
+
+// The tasks [begin, end) left to a thread, in one word: end in the high half. The
+// owner takes tasks from the front and thieves from the back, both by compare-and-swap
+// of the whole word, so a task is claimed exactly once. Ranges only shrink, so there is
+// no ABA problem. Each range is on its own cache line.
+struct alignas(64) WorkRange {
+  std::atomic<uint64_t> bits;
+};
+
+constexpr auto
+pack(uint32_t const begin, uint32_t const end) noexcept -> uint64_t
+{
+  return (static_cast<uint64_t>(end) << 32) | begin;
+}
+
+auto
+takeFront(WorkRange & range, Int & task) noexcept -> bool
+{
+  uint64_t bits = range.bits.load(std::memory_order_relaxed);
+  for (;;) {
+    auto const begin = static_cast<uint32_t>(bits);
+    auto const end = static_cast<uint32_t>(bits >> 32);
+    if (begin >= end) {
+      return false;
+    }
+    if (range.bits.compare_exchange_weak(bits, pack(begin + 1, end),
+                                         std::memory_order_relaxed)) {
+      task = static_cast<Int>(begin);
+      return true;
+    }
+  }
+}
+
+auto
+takeBack(WorkRange & range, Int & task) noexcept -> bool
+{
+  uint64_t bits = range.bits.load(std::memory_order_relaxed);
+  for (;;) {
+    auto const begin = static_cast<uint32_t>(bits);
+    auto const end = static_cast<uint32_t>(bits >> 32);
+    if (begin >= end) {
+      return false;
+    }
+    if (range.bits.compare_exchange_weak(bits, pack(begin, end - 1),
+                                         std::memory_order_relaxed)) {
+      task = static_cast<Int>(end - 1);
+      return true;
+    }
+  }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+LoadBalance::imbalance() const noexcept -> double
+{
+  double max_seconds = 0;
+  double sum_seconds = 0;
+  for (double const seconds : busy_seconds) {
+    max_seconds = std::max(max_seconds, seconds);
+    sum_seconds += seconds;
+  }
+  if (sum_seconds <= 0) {
+    return 1;
+  }
+  return max_seconds * static_cast<double>(busy_seconds.size()) / sum_seconds;
+}
+
+void
+logLoadBalance(std::string const & label, LoadBalance const & balance)
+{
+  Int num_tasks = 0;
+  for (Int const n : balance.num_tasks) {
+    num_tasks += n;
+  }
+  LOG_INFO(label, ": ", num_tasks, " tasks on ", balance.busy_seconds.size(),
+           " threads, load imbalance ", balance.imbalance(), ", ", balance.num_steals,
+           " steals");
+  for (size_t t = 0; t < balance.busy_seconds.size(); ++t) {
+    LOG_INFO(label, ": thread ", t, " ran ", balance.num_tasks[t], " tasks in ",
+             balance.busy_seconds[t], " s");
+  }
+}
+
+//----------------------------------------------------------------------------------------
+auto
+partitionByCost(std::vector<double> const & costs, Int const num_parts)
+    -> std::vector<Int>
+{
+  ASSERT_ASSUME(num_parts > 0);
+  auto const n = static_cast<Int>(costs.size());
+  std::vector<double> prefix(costs.size() + 1, 0);
+  for (size_t i = 0; i < costs.size(); ++i) {
+    prefix[i + 1] = prefix[i] + costs[i];
+  }
+  double const total = prefix.back();
+
+  std::vector<Int> offsets(static_cast<size_t>(num_parts) + 1, 0);
+  offsets.back() = n;
+  for (Int p = 1; p < num_parts; ++p) {
+    Int offset = 0;
+    if (total <= 0) {
+      // Without costs, split by count
+      offset = static_cast<Int>(static_cast<int64_t>(n) * p / num_parts);
+    } else {
+      // The boundary whose prefix cost is nearest the target
+      double const target =
+          total * static_cast<double>(p) / static_cast<double>(num_parts);
+      auto const it = std::lower_bound(prefix.begin(), prefix.end(), target);
+      offset = static_cast<Int>(it - prefix.begin());
+      if (offset > 0 && target - prefix[static_cast<size_t>(offset) - 1] <
+                            prefix[static_cast<size_t>(offset)] - target) {
+        --offset;
+      }
+    }
+    auto const i = static_cast<size_t>(p);
+    offsets[i] = std::max(offset < n ? offset : n, offsets[i - 1]);
+  }
+  return offsets;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+impl::numTaskThreads() noexcept -> Int
+{
+  return static_cast<Int>(omp_get_max_threads());
+}
+
+auto
+impl::runTasks(std::string const & label, std::vector<double> const & costs,
+               TaskFunction const f, void const * const context) -> LoadBalance
+{
+  PROFILE_SCOPE("juno::runTasks");
+  Int const num_threads = numTaskThreads();
+  auto const num_tasks = static_cast<Int>(costs.size());
+  LoadBalance balance;
+  balance.busy_seconds.assign(static_cast<size_t>(num_threads), 0);
+  balance.num_tasks.assign(static_cast<size_t>(num_threads), 0);
+  if (num_tasks == 0) {
+    return balance;
+  }
+
+  // Each thread starts with a contiguous run of tasks of about equal cost
+  auto const runs = partitionByCost(costs, num_threads);
+  auto const ranges = std::make_unique<WorkRange[]>(static_cast<size_t>(num_threads));
+  for (Int t = 0; t < num_threads; ++t) {
+    auto const i = static_cast<size_t>(t);
+    ranges[i].bits.store(pack(static_cast<uint32_t>(runs[i]),
+                              static_cast<uint32_t>(runs[i + 1])),
+                         std::memory_order_relaxed);
+  }
+
+  std::atomic<Int> num_steals = 0;
+  Int team_size = num_threads;
+#pragma omp parallel num_threads(num_threads)
+  {
+    // If OpenMP gave us fewer threads, the runs of the missing ones are stolen
+#pragma omp single nowait
+    team_size = static_cast<Int>(omp_get_num_threads());
+    Int const me = omp_get_thread_num();
+    auto const my = static_cast<size_t>(me);
+    double seconds = 0;
+    Int count = 0;
+    auto const run = [&](Int const task) {
+      auto const start = std::chrono::steady_clock::now();
+      f(context, task);
+      seconds +=
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      ++count;
+    };
+
+    Int task = 0;
+    while (takeFront(ranges[my], task)) {
+      run(task);
+    }
+    // Steal from the others, starting with the next thread, until no tasks are left
+    Int steals = 0;
+    bool found = true;
+    while (found) {
+      found = false;
+      for (Int k = 1; k < num_threads && !found; ++k) {
+        auto const victim = static_cast<size_t>((me + k) % num_threads);
+        if (takeBack(ranges[victim], task)) {
+          run(task);
+          ++steals;
+          found = true;
+        }
+      }
+    }
+    balance.busy_seconds[my] = seconds;
+    balance.num_tasks[my] = count;
+    num_steals += steals;
+  }
+  // Only the threads of the team ran tasks
+  balance.busy_seconds.resize(static_cast<size_t>(team_size));
+  balance.num_tasks.resize(static_cast<size_t>(team_size));
+  balance.num_steals = num_steals.load();
+  LOG_DEBUG(label, ": ", num_tasks, " tasks on ", team_size,
+            " threads, load imbalance ", balance.imbalance(), ", ", balance.num_steals,
+            " steals");
+  return balance;
+}
+
+} // namespace juno
@@ -0,0 +1,734 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/mapped_file.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/gmsh/io.hpp>
+
+#include <algorithm>    // std::upper_bound, std::count
+#include <charconv>     // std::from_chars
+#include <cstring>      // std::memchr
+#include <limits>       // std::numeric_limits
+#include <map>          // std::map
+#include <string>       // std::string, std::to_string
+#include <string_view>  // std::string_view
+#include <system_error> // std::errc
+#include <utility>      // std::pair, std::move
+#include <vector>       // std::vector
+
+namespace juno
+{
+
+namespace
+{
+
+using Soup = PolytopeSoup<HostMemSpace>;
+
+// The target size of the chunks that are parsed in parallel. Small enough that finding
+// a line within a chunk is cheap, large enough that there are few chunks.
+size_t constexpr chunk_bytes = size_t{64} * 1024;
+
+//----------------------------------------------------------------------------------------
+// Parse whitespace-separated fields from [begin, end)
+class FieldParser
+{
+  char const * _p;
+  char const * _end;
+  bool _ok = true;
+
+  void
+  skipSpace() noexcept
+  {
+    while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n')) {
+      ++_p;
+    }
+  }
+
+public:
+  FieldParser(char const * begin, char const * end) noexcept
+      : _p(begin),
+        _end(end)
+  {
+  }
+
+  // The next field as a number. Sets ok() to false if it is not one.
+  template <class T>
+  auto
+  next() noexcept -> T
+  {
+    skipSpace();
+    T value{};
+    auto const [ptr, ec] = std::from_chars(_p, _end, value);
+    if (ec != std::errc()) {
+      _ok = false;
+      return value;
+    }
+    _p = ptr;
+    return value;
+  }
+
+  // The next field as a double-quoted string, without the quotes
+  auto
+  nextQuoted() noexcept -> std::string_view
+  {
+    skipSpace();
+    if (_p == _end || *_p != '"') {
+      _ok = false;
+      return {};
+    }
+    char const * const begin = _p + 1;
+    auto const size = static_cast<size_t>(_end - begin);
+    auto const * const close = static_cast<char const *>(std::memchr(begin, '"', size));
+    if (close == nullptr) {
+      _ok = false;
+      return {};
+    }
+    _p = close + 1;
+    return {begin, static_cast<size_t>(close - begin)};
+  }
+
+  // Skip n numeric fields
+  void
+  skip(int32_t const n) noexcept
+  {
+    for (int32_t i = 0; i < n; ++i) {
+      next<double>();
+    }
+  }
+
+  [[nodiscard]] auto
+  ok() const noexcept -> bool
+  {
+    return _ok;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// The lines of [begin, end), split into chunks of whole lines. The lines of each chunk
+// are counted in parallel, so that any line can then be found by searching only the
+// chunk that contains it.
+class Lines
+{
+  char const * _end;
+  std::vector<char const *> _chunk_begins;   // num_chunks + 1, the last is end
+  std::vector<int64_t> _chunk_first_lines;   // num_chunks + 1, the last is num_lines
+
+public:
+  Lines(char const * begin, char const * end)
+      : _end(end)
+  {
+    // Start each chunk at the beginning of a line
+    char const * p = begin;
+    while (true) {
+      _chunk_begins.push_back(p);
+      if (static_cast<size_t>(end - p) <= chunk_bytes) {
+        break;
+      }
+      char const * const from = p + chunk_bytes;
+      auto const * const newline = static_cast<char const *>(
+          std::memchr(from, '\n', static_cast<size_t>(end - from)));
+      if (newline == nullptr || newline + 1 >= end) {
+        break;
+      }
+      p = newline + 1;
+    }
+    _chunk_begins.push_back(end);
+
+    // Count the lines of each chunk, then take the prefix sum
+    auto const num_chunks = static_cast<int64_t>(_chunk_begins.size()) - 1;
+    _chunk_first_lines.resize(_chunk_begins.size(), 0);
+#pragma omp parallel for schedule(static)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+      auto const b = static_cast<size_t>(c);
+      _chunk_first_lines[b + 1] =
+          std::count(_chunk_begins[b], _chunk_begins[b + 1], '\n');
+    }
+    for (size_t c = 1; c < _chunk_first_lines.size(); ++c) {
+      _chunk_first_lines[c] += _chunk_first_lines[c - 1];
+    }
+    // A last line without a newline
+    if (begin < end && end[-1] != '\n') {
+      ++_chunk_first_lines.back();
+    }
+  }
+
+  [[nodiscard]] auto
+  numLines() const noexcept -> int64_t
+  {
+    return _chunk_first_lines.back();
+  }
+
+  [[nodiscard]] auto
+  numChunks() const noexcept -> int64_t
+  {
+    return static_cast<int64_t>(_chunk_begins.size()) - 1;
+  }
+
+  [[nodiscard]] auto
+  chunkBegin(int64_t const c) const noexcept -> char const *
+  {
+    return _chunk_begins[static_cast<size_t>(c)];
+  }
+
+  [[nodiscard]] auto
+  chunkFirstLine(int64_t const c) const noexcept -> int64_t
+  {
+    return _chunk_first_lines[static_cast<size_t>(c)];
+  }
+
+  // The end of the line that starts at p, before its newline
+  [[nodiscard]] auto
+  lineEnd(char const * const p) const noexcept -> char const *
+  {
+    auto const * const newline =
+        static_cast<char const *>(std::memchr(p, '\n', static_cast<size_t>(_end - p)));
+    return newline == nullptr ? _end : newline;
+  }
+
+  // The beginning of line i, which must be less than numLines()
+  [[nodiscard]] auto
+  lineBegin(int64_t const i) const noexcept -> char const *
+  {
+    auto const it =
+        std::upper_bound(_chunk_first_lines.begin(), _chunk_first_lines.end() - 1, i);
+    auto const c = static_cast<size_t>(it - _chunk_first_lines.begin()) - 1;
+    char const * p = _chunk_begins[c];
+    for (int64_t k = _chunk_first_lines[c]; k < i; ++k) {
+      p = lineEnd(p) + 1;
+    }
+    return p;
+  }
+
+  // Line i, without its newline or carriage return
+  [[nodiscard]] auto
+  line(int64_t const i) const noexcept -> std::string_view
+  {
+    if (i >= numLines()) {
+      return {};
+    }
+    char const * const p = lineBegin(i);
+    char const * e = lineEnd(p);
+    if (e > p && e[-1] == '\r') {
+      --e;
+    }
+    return {p, static_cast<size_t>(e - p)};
+  }
+
+  // Call f(line, begin, end) for each line of chunk c in [first, last)
+  template <class F>
+  void
+  forEachLine(int64_t const c, int64_t const first, int64_t const last, F && f) const
+  {
+    char const * p = chunkBegin(c);
+    char const * const chunk_end = chunkBegin(c + 1);
+    for (int64_t i = chunkFirstLine(c); p < chunk_end && i < last; ++i) {
+      char const * const e = lineEnd(p);
+      if (i >= first) {
+        f(i, p, e);
+      }
+      p = e + 1;
+    }
+  }
+
+  // The chunks that contain lines in [first, last)
+  [[nodiscard]] auto
+  chunkRange(int64_t const first, int64_t const last) const noexcept
+      -> std::pair<int64_t, int64_t>
+  {
+    auto const begin = _chunk_first_lines.begin();
+    auto const end = _chunk_first_lines.end() - 1;
+    auto const lo = std::upper_bound(begin, end, first);
+    auto const hi = std::upper_bound(begin, end, last - 1);
+    return {lo - begin - 1, hi - begin};
+  }
+};
+
+//----------------------------------------------------------------------------------------
+// A block of nodes or elements, with the line of its header. The nodes of a block are
+// in the header_line + 1 + i lines (tags) and the header_line + 1 + size + i lines
+// (coordinates). The elements of a block are in the header_line + 1 + i lines.
+struct Block {
+  int64_t header_line;
+  int64_t size;
+  int32_t dim;
+  int32_t entity_tag;
+  int64_t first = 0;        // the index of its first node or element
+  int64_t first_vertex = 0; // the index of the first vertex of its first element
+  int8_t vtk_type = 0;
+  int32_t nodes_per_element = 0;
+  bool skipped = false; // elements of a lower dimension than the mesh
+};
+
+// The block that contains line i, if the blocks are sorted by header line and the
+// first block starts at or before i
+auto
+findBlock(std::vector<Block> const & blocks, int64_t const i) -> size_t
+{
+  auto const it = std::upper_bound(blocks.begin(), blocks.end(), i,
+                                   [](int64_t const line, Block const & block) {
+                                     return line < block.header_line;
+                                   });
+  return static_cast<size_t>(it - blocks.begin()) - 1;
+}
+
+//----------------------------------------------------------------------------------------
+// The VTK type and number of nodes of a Gmsh element type, or {-1, 0} if unsupported
+auto
+convertElementType(int32_t const gmsh_type) -> std::pair<int8_t, int32_t>
+{
+  switch (gmsh_type) {
+  case 1:
+    return {vtk_types::line, 2};
+  case 2:
+    return {vtk_types::triangle, 3};
+  case 3:
+    return {vtk_types::quad, 4};
+  case 4:
+    return {vtk_types::tetra, 4};
+  case 5:
+    return {vtk_types::hexahedron, 8};
+  case 8:
+    return {vtk_types::quadratic_edge, 3};
+  case 9:
+    return {vtk_types::quadratic_triangle, 6};
+  case 15:
+    return {vtk_types::vertex, 1};
+  case 16:
+    return {vtk_types::quadratic_quad, 8};
+  default:
+    return {-1, 0};
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// The position of the line "$name" in text at or after pos, or npos
+auto
+findSection(std::string_view const text, std::string_view const name, size_t pos)
+    -> size_t
+{
+  while ((pos = text.find(name, pos)) != std::string_view::npos) {
+    size_t const after = pos + name.size();
+    bool const at_line_begin = pos == 0 || text[pos - 1] == '\n';
+    bool const at_line_end =
+        after == text.size() || text[after] == '\n' || text[after] == '\r';
+    if (at_line_begin && at_line_end) {
+      return pos;
+    }
+    pos = after;
+  }
+  return std::string_view::npos;
+}
+
+//----------------------------------------------------------------------------------------
+// The text between the lines "$name" and "$Endname", or an empty view if there is no
+// such section before end_pos
+auto
+sectionBody(std::string_view const text, std::string_view const name,
+            size_t const end_pos) -> std::string_view
+{
+  std::string const begin_tag = "$" + std::string(name);
+  std::string const end_tag = "$End" + std::string(name);
+  size_t const begin = findSection(text.substr(0, end_pos), begin_tag, 0);
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+  size_t const newline = text.find('\n', begin);
+  if (newline == std::string_view::npos) {
+    return {};
+  }
+  size_t const body = newline + 1;
+  size_t const end = findSection(text, end_tag, body);
+  if (end == std::string_view::npos) {
+    return {};
+  }
+  return text.substr(body, end - body);
+}
+
+// Kinds of errors in the parallel passes, encoded with the line as line * 4 + kind, so
+// that the first error can be found with a min reduction
+inline constexpr int64_t error_malformed = 0;
+inline constexpr int64_t error_node_tag = 1;
+inline constexpr int64_t no_error = std::numeric_limits<int64_t>::max();
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+readGmshFile(std::string const & filename) -> PolytopeSoup<HostMemSpace>
+{
+  PROFILE_SCOPE("juno::readGmshFile");
+  LOG_INFO("Reading Gmsh file: ", filename);
+
+  MappedFile const file(filename);
+  if (!file.isOpen()) {
+    return {};
+  }
+  std::string_view const text = file.view();
+
+  //--------------------------------------------------------------------------------------
+  // Small sections, parsed serially
+  //--------------------------------------------------------------------------------------
+
+  size_t const nodes_pos = findSection(text, "$Nodes", 0);
+  if (nodes_pos == std::string_view::npos) {
+    LOG_ERROR("Gmsh file '", filename, "' has no $Nodes section");
+    return {};
+  }
+
+  // $MeshFormat: version, file type (0 for ASCII), and data size
+  {
+    std::string_view const format = sectionBody(text, "MeshFormat", nodes_pos);
+    FieldParser parser(format.data(), format.data() + format.size());
+    std::string_view const version = format.substr(0, format.find_first_of(" \n"));
+    parser.next<double>();
+    auto const file_type = parser.next<int32_t>();
+    if (!parser.ok() || version != "4.1" || file_type != 0) {
+      LOG_ERROR("Gmsh file '", filename, "' is version ", version,
+                file_type == 0 ? " ASCII" : " binary",
+                ", but only version 4.1 ASCII files are supported");
+      return {};
+    }
+  }
+
+  // $PhysicalNames: dim, tag, and name of each physical group
+  std::map<std::pair<int32_t, int32_t>, std::string> physical_names;
+  {
+    std::string_view const names = sectionBody(text, "PhysicalNames", nodes_pos);
+    if (!names.empty()) {
+      FieldParser parser(names.data(), names.data() + names.size());
+      auto const num_names = parser.next<int32_t>();
+      for (int32_t i = 0; i < num_names && parser.ok(); ++i) {
+        auto const dim = parser.next<int32_t>();
+        auto const tag = parser.next<int32_t>();
+        physical_names[{dim, tag}] = std::string(parser.nextQuoted());
+      }
+      if (!parser.ok()) {
+        LOG_ERROR("Gmsh file '", filename, "' has a malformed $PhysicalNames section");
+        return {};
+      }
+    }
+  }
+
+  // $Entities: the physical groups of each entity
+  std::map<std::pair<int32_t, int32_t>, std::vector<int32_t>> entity_groups;
+  {
+    std::string_view const entities = sectionBody(text, "Entities", nodes_pos);
+    if (!entities.empty()) {
+      FieldParser parser(entities.data(), entities.data() + entities.size());
+      int64_t num_entities[4];
+      for (auto & n : num_entities) {
+        n = parser.next<int64_t>();
+      }
+      for (int32_t dim = 0; dim < 4 && parser.ok(); ++dim) {
+        for (int64_t i = 0; i < num_entities[dim] && parser.ok(); ++i) {
+          auto const tag = parser.next<int32_t>();
+          // A point has its coordinates, others their bounding box
+          parser.skip(dim == 0 ? 3 : 6);
+          auto const num_groups = parser.next<int32_t>();
+          auto & groups = entity_groups[{dim, tag}];
+          for (int32_t g = 0; g < num_groups; ++g) {
+            groups.push_back(parser.next<int32_t>());
+          }
+          if (dim > 0) {
+            parser.skip(parser.next<int32_t>());
+          }
+        }
+      }
+      if (!parser.ok()) {
+        LOG_ERROR("Gmsh file '", filename, "' has a malformed $Entities section");
+        return {};
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Block headers of $Nodes and $Elements
+  //--------------------------------------------------------------------------------------
+
+  // Line 0 of "lines" is "$Nodes"
+  Lines const lines(text.data() + nodes_pos, text.data() + text.size());
+  int64_t const line_offset =
+      std::count(text.data(), text.data() + nodes_pos, '\n') + 1; // 1-based
+  auto const fileLine = [&](int64_t const i) { return line_offset + i; };
+  auto const parseLine = [&](int64_t const i) {
+    std::string_view const l = lines.line(i);
+    return FieldParser(l.data(), l.data() + l.size());
+  };
+
+  // Nodes: numEntityBlocks numNodes minNodeTag maxNodeTag, then for each block
+  // entityDim entityTag parametric numNodesInBlock, the tags, and the coordinates
+  std::vector<Block> node_blocks;
+  int64_t num_nodes = 0;
+  int64_t min_node_tag = 0;
+  int64_t max_node_tag = 0;
+  int64_t line = 1;
+  {
+    FieldParser header = parseLine(line);
+    auto const num_blocks = header.next<int64_t>();
+    num_nodes = header.next<int64_t>();
+    min_node_tag = header.next<int64_t>();
+    max_node_tag = header.next<int64_t>();
+    if (!header.ok() || num_blocks < 0 || num_nodes < 0 || max_node_tag < min_node_tag) {
+      LOG_ERROR("Gmsh file '", filename, "': malformed $Nodes header on line ",
+                fileLine(line));
+      return {};
+    }
+    ++line;
+    node_blocks.reserve(static_cast<size_t>(num_blocks));
+    int64_t first = 0;
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      FieldParser parser = parseLine(line);
+      Block block{line, 0, 0, 0};
+      block.dim = parser.next<int32_t>();
+      block.entity_tag = parser.next<int32_t>();
+      auto const parametric = parser.next<int32_t>();
+      block.size = parser.next<int64_t>();
+      block.first = first;
+      if (!parser.ok() || block.size < 0) {
+        LOG_ERROR("Gmsh file '", filename, "': malformed node block header on line ",
+                  fileLine(line));
+        return {};
+      }
+      if (parametric != 0) {
+        LOG_ERROR("Gmsh file '", filename, "': parametric nodes on line ", fileLine(line),
+                  " are not supported");
+        return {};
+      }
+      first += block.size;
+      line += 1 + 2 * block.size;
+      node_blocks.push_back(block);
+    }
+    if (first != num_nodes || lines.line(line) != "$EndNodes") {
+      LOG_ERROR("Gmsh file '", filename, "': the node blocks do not match the ",
+                num_nodes, " nodes in the $Nodes header");
+      return {};
+    }
+    ++line;
+  }
+  int64_t const nodes_end = line - 1;
+
+  // Elements: numEntityBlocks numElements minElementTag maxElementTag, then for each
+  // block entityDim entityTag elementType numElementsInBlock, and the elements
+  std::vector<Block> element_blocks;
+  if (lines.line(line) != "$Elements") {
+    LOG_ERROR("Gmsh file '", filename, "': expected $Elements on line ", fileLine(line));
+    return {};
+  }
+  ++line;
+  int32_t max_dim = -1;
+  {
+    FieldParser header = parseLine(line);
+    auto const num_blocks = header.next<int64_t>();
+    if (!header.ok() || num_blocks < 0) {
+      LOG_ERROR("Gmsh file '", filename, "': malformed $Elements header on line ",
+                fileLine(line));
+      return {};
+    }
+    ++line;
+    element_blocks.reserve(static_cast<size_t>(num_blocks));
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      FieldParser parser = parseLine(line);
+      Block block{line, 0, 0, 0};
+      block.dim = parser.next<int32_t>();
+      block.entity_tag = parser.next<int32_t>();
+      auto const gmsh_type = parser.next<int32_t>();
+      block.size = parser.next<int64_t>();
+      if (!parser.ok() || block.size < 0) {
+        LOG_ERROR("Gmsh file '", filename, "': malformed element block header on line ",
+                  fileLine(line));
+        return {};
+      }
+      auto const [vtk_type, nodes_per_element] = convertElementType(gmsh_type);
+      if (vtk_type < 0) {
+        LOG_ERROR("Gmsh file '", filename, "': element type ", gmsh_type, " on line ",
+                  fileLine(line), " is not supported");
+        return {};
+      }
+      block.vtk_type = vtk_type;
+      block.nodes_per_element = nodes_per_element;
+      if (block.size > 0 && block.dim > max_dim) {
+        max_dim = block.dim;
+      }
+      line += 1 + block.size;
+      element_blocks.push_back(block);
+    }
+    if (lines.line(line) != "$EndElements") {
+      LOG_ERROR("Gmsh file '", filename, "': expected $EndElements on line ",
+                fileLine(line));
+      return {};
+    }
+  }
+  int64_t const elements_end = line;
+
+  // Number the elements of the highest dimension
+  int64_t num_elements = 0;
+  int64_t num_element_vertices = 0;
+  for (auto & block : element_blocks) {
+    block.skipped = block.dim != max_dim;
+    if (!block.skipped) {
+      block.first = num_elements;
+      block.first_vertex = num_element_vertices;
+      num_elements += block.size;
+      num_element_vertices += block.size * block.nodes_per_element;
+    }
+  }
+  auto constexpr int_max = static_cast<int64_t>(std::numeric_limits<Int>::max());
+  if (num_nodes > int_max || num_elements > int_max || num_element_vertices > int_max) {
+    LOG_ERROR("Gmsh file '", filename, "' has more nodes or elements than Int can index");
+    return {};
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Parse the nodes and elements in parallel
+  //--------------------------------------------------------------------------------------
+
+  Soup soup(static_cast<Int>(num_nodes), static_cast<Int>(num_elements),
+            static_cast<Int>(num_element_vertices));
+  auto const & x = soup.x();
+  auto const & y = soup.y();
+  auto const & z = soup.z();
+  auto const & types = soup.elementTypes();
+  auto const & offsets = soup.elementOffsets();
+  auto const & vertices = soup.elementVertices();
+
+  // The index of each node tag, or -1 for tags without a node
+  std::vector<Int> node_index(static_cast<size_t>(max_node_tag - min_node_tag + 1), -1);
+
+  // Parse line k of a block of nodes, which is its k-th tag if k < size, or the
+  // coordinates of its (k - size)-th node. Returns the kind of error, or -1.
+  auto const parseNodeLine = [&](Block const & block, int64_t const k,
+                                 char const * begin, char const * end) -> int64_t {
+    FieldParser parser(begin, end);
+    if (k < block.size) {
+      auto const tag = parser.next<int64_t>();
+      if (!parser.ok() || tag < min_node_tag || max_node_tag < tag) {
+        return error_malformed;
+      }
+      node_index[static_cast<size_t>(tag - min_node_tag)] =
+          static_cast<Int>(block.first + k);
+      return -1;
+    }
+    auto const n = static_cast<size_t>(block.first + k - block.size);
+    x(n) = parser.next<Float>();
+    y(n) = parser.next<Float>();
+    z(n) = parser.next<Float>();
+    return parser.ok() ? -1 : error_malformed;
+  };
+
+  // Parse line k of a block of elements: its tag, then its node tags
+  auto const parseElementLine = [&](Block const & block, int64_t const k,
+                                    char const * begin, char const * end) -> int64_t {
+    FieldParser parser(begin, end);
+    parser.next<int64_t>();
+    auto const e = static_cast<size_t>(block.first + k);
+    auto const first_vertex =
+        static_cast<size_t>(block.first_vertex + k * block.nodes_per_element);
+    for (int32_t v = 0; v < block.nodes_per_element; ++v) {
+      auto const tag = parser.next<int64_t>();
+      if (!parser.ok()) {
+        return error_malformed;
+      }
+      Int const index = tag < min_node_tag || max_node_tag < tag
+                            ? -1
+                            : node_index[static_cast<size_t>(tag - min_node_tag)];
+      if (index < 0) {
+        return error_node_tag;
+      }
+      vertices(first_vertex + static_cast<size_t>(v)) = index;
+    }
+    types(e) = block.vtk_type;
+    offsets(e + 1) = static_cast<Int>(first_vertex) + block.nodes_per_element;
+    return -1;
+  };
+
+  // Parse the lines of the blocks in [first_line, last_line) in parallel over chunks,
+  // calling parse_line(block, k, begin, end) on line k of each block that is not
+  // skipped. Returns the first error, or no_error.
+  auto const parseBlocks = [&](std::vector<Block> const & blocks, int64_t const last_line,
+                               auto const & parse_line) {
+    int64_t error = no_error;
+    if (blocks.empty()) {
+      return error;
+    }
+    int64_t const first_line = blocks.front().header_line;
+    auto const [chunk_begin, chunk_end] = lines.chunkRange(first_line, last_line);
+#pragma omp parallel for schedule(dynamic) reduction(min : error)
+    for (int64_t c = chunk_begin; c < chunk_end; ++c) {
+      size_t b = findBlock(blocks, std::max(first_line, lines.chunkFirstLine(c)));
+      lines.forEachLine(c, first_line, last_line, [&](int64_t const i, char const * begin,
+                                                      char const * end) {
+        while (b + 1 < blocks.size() && blocks[b + 1].header_line <= i) {
+          ++b;
+        }
+        int64_t const k = i - blocks[b].header_line - 1;
+        if (k < 0 || blocks[b].skipped) {
+          return;
+        }
+        int64_t const kind = parse_line(blocks[b], k, begin, end);
+        if (kind >= 0) {
+          error = std::min(error, i * 4 + kind);
+        }
+      });
+    }
+    return error;
+  };
+
+  // The nodes first, since the elements refer to their indices
+  int64_t error = parseBlocks(node_blocks, nodes_end, parseNodeLine);
+  if (error == no_error) {
+    error = parseBlocks(element_blocks, elements_end, parseElementLine);
+  }
+  if (error != no_error) {
+    int64_t const error_line = fileLine(error / 4);
+    if (error % 4 == error_node_tag) {
+      LOG_ERROR("Gmsh file '", filename, "': unknown node tag on line ", error_line);
+    } else {
+      LOG_ERROR("Gmsh file '", filename, "': malformed line ", error_line);
+    }
+    return {};
+  }
+
+  //--------------------------------------------------------------------------------------
+  // Element sets from the physical groups
+  //--------------------------------------------------------------------------------------
+
+  // The element ranges of each group. The blocks are numbered in order, so the ranges
+  // of a group are sorted.
+  std::map<int32_t, std::vector<std::pair<int64_t, int64_t>>> group_ranges;
+  for (auto const & block : element_blocks) {
+    auto const it = entity_groups.find({block.dim, block.entity_tag});
+    if (block.skipped || it == entity_groups.end()) {
+      continue;
+    }
+    for (int32_t const group : it->second) {
+      group_ranges[group].emplace_back(block.first, block.first + block.size);
+    }
+  }
+  std::vector<std::string> set_names;
+  Soup::IntView const set_offsets("soup_element_set_offsets", group_ranges.size() + 1);
+  int64_t num_set_elements = 0;
+  for (auto const & [group, ranges] : group_ranges) {
+    auto const name = physical_names.find({max_dim, group});
+    set_names.push_back(name == physical_names.end() ? std::to_string(group)
+                                                     : name->second);
+    for (auto const & [begin, end] : ranges) {
+      num_set_elements += end - begin;
+    }
+    set_offsets(set_names.size()) = static_cast<Int>(num_set_elements);
+  }
+  Soup::IntView const set_elements(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, "soup_element_set_elements"),
+      static_cast<size_t>(num_set_elements));
+  size_t s = 0;
+  for (auto const & [group, ranges] : group_ranges) {
+    for (auto const & [begin, end] : ranges) {
+      for (int64_t e = begin; e < end; ++e) {
+        set_elements(s++) = static_cast<Int>(e);
+      }
+    }
+  }
+  soup.setElementSets(std::move(set_names), set_offsets, set_elements);
+
+  LOG_INFO("Read ", num_nodes, " nodes and ", num_elements, " elements from ", filename);
+  return soup;
+}
+
+} // namespace juno
@@ -0,0 +1,657 @@
+#include <juno/common/assert.hpp>
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/stage_cache.hpp>
+#include <juno/config.hpp>
+#include <juno/gmsh/io.hpp>
+#include <juno/mesh/field_writer.hpp>
+#include <juno/mesh/mesh_cache.hpp>
+#include <juno/mesh/reorder.hpp>
+#include <juno/physics/cross_section_library.hpp>
+#include <juno/physics/material.hpp>
+#include <juno/physics/moc.hpp>
+#include <juno/physics/setup.hpp>
+#include <juno/physics/tracks.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <charconv> // std::from_chars
+#include <chrono>
+#include <cmath> // std::abs
+#include <cstdint>
+#include <cstdio>  // std::printf
+#include <fstream> // std::ifstream
+#include <sstream> // std::istringstream
+#include <string>
+#include <system_error> // std::errc
+#include <type_traits>
+#include <utility> // std::move
+#include <vector>
+
+//========================================================================================
+// JUNOC
+//========================================================================================
+// The command-line driver: solve the k-eigenvalue problem of a 2D model with MOC.
+//
+//   junoc <input> [key=value ...]
+//
+// The input has one "key = value" per line; "#" starts a comment. The key=value
+// arguments override the input, e.g. "junoc pin.inp tolerance=1e-7". The keys:
+//   mesh = pin.msh            the Gmsh mesh, whose physical groups are the materials
+//   reorder = hilbert         hilbert, morton, or none
+//   faces_per_cell = 2        of the spatial index
+//   library = library.xs      the cross section library
+//   material fuel = U235 7.2e-4 U238 2.2e-2 O16 4.6e-2
+//                             nuclides and number densities of the faces of group fuel
+//   azimuthal = 16, spacing = 0.05, polar = 3
+//                             the tracks
+//   boundary = reflective     reflective or vacuum
+//   tolerance = 1e-5          on the change of k between iterations
+//   max_iterations = 200
+//   cache = junoc_cache       the directory of the stage cache, or none
+//   output = flux             write the scalar flux to flux.xmf (needs HDF5)
+//
+// The setup is a pipeline of stages, each cached in a StageCache by a key of its inputs
+// (see setup.hpp): import, reorder, index (a MeshCache), mix, and tracks.
+// A stage only runs if its result is not cached, and only asks for the results of the
+// stages upstream of it then. So a run that changes the composition of a material only
+// mixes again, one that changes the tolerance runs no stage, and one that changes
+// faces_per_cell reads the reordered soup and only indexes it again. The iterations
+// themselves are not cached.
+
+using HostSoup = juno::PolytopeSoup<juno::HostMemSpace>;
+using HostXS = juno::CrossSections<juno::HostMemSpace>;
+using MemSpace = juno::DeviceMemSpace;
+using ExecSpace = MemSpace::execution_space;
+
+namespace
+{
+
+Float constexpr four_pi = static_cast<Float>(4 * 3.14159265358979323846);
+
+//========================================================================================
+// Input
+//========================================================================================
+
+// The inputs of the setup stages, and the settings of the solver
+struct Input : juno::SetupInput {
+  std::string boundary = "reflective";
+  double tolerance = 1e-5;
+  Int max_iterations = 200;
+  std::string cache = "junoc_cache";
+  std::string output;
+};
+
+template <class T>
+auto
+parseNumber(std::string const & s, T & value) -> bool
+{
+  auto const [end, error] = std::from_chars(s.data(), s.data() + s.size(), value);
+  return error == std::errc() && end == s.data() + s.size();
+}
+
+auto
+trim(std::string const & s) -> std::string
+{
+  auto const first = s.find_first_not_of(" \t\r");
+  if (first == std::string::npos) {
+    return {};
+  }
+  return s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+}
+
+// Set a key of the input. "where" locates the setting in the error messages.
+auto
+setValue(Input & input, std::string const & key, std::string const & value,
+         std::string const & where) -> bool
+{
+  auto const number = [&](auto & x) {
+    if (!parseNumber(value, x)) {
+      LOG_ERROR(where, ": '", value, "' is not a valid ", key);
+      return false;
+    }
+    return true;
+  };
+  if (key.rfind("material ", 0) == 0) {
+    juno::MaterialInput material;
+    material.name = trim(key.substr(9));
+    std::istringstream tokens(value);
+    std::string nuclide;
+    std::string density;
+    while (tokens >> nuclide) {
+      Float n = 0;
+      if (!(tokens >> density) || !parseNumber(density, n) || n < 0) {
+        LOG_ERROR(where, ": nuclide '", nuclide, "' of material '", material.name,
+                  "' has no valid number density");
+        return false;
+      }
+      material.nuclides.push_back(nuclide);
+      material.number_densities.push_back(n);
+    }
+    for (auto & existing : input.materials) {
+      if (existing.name == material.name) {
+        existing = material;
+        return true;
+      }
+    }
+    input.materials.push_back(material);
+    return true;
+  }
+  if (key == "mesh") {
+    input.mesh = value;
+  } else if (key == "reorder") {
+    input.reorder = value;
+  } else if (key == "faces_per_cell") {
+    return number(input.faces_per_cell);
+  } else if (key == "library") {
+    input.library = value;
+  } else if (key == "azimuthal") {
+    return number(input.tracks.num_azimuthal);
+  } else if (key == "spacing") {
+    return number(input.tracks.spacing);
+  } else if (key == "polar") {
+    return number(input.tracks.num_polar);
+  } else if (key == "boundary") {
+    input.boundary = value;
+  } else if (key == "tolerance") {
+    return number(input.tolerance);
+  } else if (key == "max_iterations") {
+    return number(input.max_iterations);
+  } else if (key == "cache") {
+    input.cache = value;
+  } else if (key == "output") {
+    input.output = value;
+  } else {
+    LOG_ERROR(where, ": unknown key '", key, "'");
+    return false;
+  }
+  return true;
+}
+
+// A "key = value" line, or a "key=value" argument
+auto
+setLine(Input & input, std::string const & line, std::string const & where) -> bool
+{
+  auto const equals = line.find('=');
+  if (equals == std::string::npos) {
+    LOG_ERROR(where, ": expected 'key = value', not '", line, "'");
+    return false;
+  }
+  return setValue(input, trim(line.substr(0, equals)), trim(line.substr(equals + 1)),
+                  where);
+}
+
+auto
+readInput(int argc, char ** argv, Input & input) -> bool
+{
+  std::string const filename = argv[1];
+  std::ifstream file(filename);
+  if (!file) {
+    LOG_ERROR("Cannot open the input '", filename, "'");
+    return false;
+  }
+  std::string line;
+  for (Int number = 1; std::getline(file, line); ++number) {
+    line = trim(line.substr(0, line.find('#')));
+    if (!line.empty() &&
+        !setLine(input, line, filename + ":" + std::to_string(number))) {
+      return false;
+    }
+  }
+  for (int i = 2; i < argc; ++i) {
+    if (!setLine(input, argv[i], "argument " + std::to_string(i - 1))) {
+      return false;
+    }
+  }
+
+  if (input.mesh.empty() || input.library.empty() || input.materials.empty()) {
+    LOG_ERROR(filename, ": the mesh, the library and the materials are required");
+    return false;
+  }
+  if (input.reorder != "hilbert" && input.reorder != "morton" &&
+      input.reorder != "none") {
+    LOG_ERROR(filename, ": reorder is hilbert, morton, or none, not '", input.reorder,
+              "'");
+    return false;
+  }
+  if (input.boundary != "reflective" && input.boundary != "vacuum") {
+    LOG_ERROR(filename, ": boundary is reflective or vacuum, not '", input.boundary,
+              "'");
+    return false;
+  }
+  if (!input.output.empty() && !JUNO_USE_HDF5) {
+    LOG_ERROR(filename, ": output needs juno built with HDF5 (JUNO_USE_HDF5)");
+    return false;
+  }
+  return true;
+}
+
+//========================================================================================
+// Stages
+//========================================================================================
+// save and load write and read the result of a stage, in the same order; isEmpty tells
+// a failed stage, whose result is not cached.
+
+void
+save(juno::StageWriter & writer, HostSoup const & soup)
+{
+  writer.write(soup.numVertices());
+  writer.write(soup.numElements());
+  writer.write(static_cast<Int>(soup.elementVertices().size()));
+  writer.writeView(soup.x());
+  writer.writeView(soup.y());
+  writer.writeView(soup.z());
+  writer.writeView(soup.elementTypes());
+  writer.writeView(soup.elementOffsets());
+  writer.writeView(soup.elementVertices());
+  writer.write(soup.numElementSets());
+  for (auto const & name : soup.elementSetNames()) {
+    writer.writeString(name);
+  }
+  writer.writeView(soup.elementSetOffsets());
+  writer.writeView(soup.elementSetElements());
+}
+
+void
+load(juno::StageReader & reader, HostSoup & soup)
+{
+  auto const num_vertices = reader.read<Int>();
+  auto const num_elements = reader.read<Int>();
+  auto const num_element_vertices = reader.read<Int>();
+  if (!reader.ok() || num_vertices < 0 || num_elements < 0 || num_element_vertices < 0) {
+    return;
+  }
+  soup = HostSoup(num_vertices, num_elements, num_element_vertices);
+  reader.readInto(soup.x());
+  reader.readInto(soup.y());
+  reader.readInto(soup.z());
+  reader.readInto(soup.elementTypes());
+  reader.readInto(soup.elementOffsets());
+  reader.readInto(soup.elementVertices());
+  auto const num_sets = reader.read<Int>();
+  std::vector<std::string> names;
+  for (Int i = 0; i < num_sets && reader.ok(); ++i) {
+    names.push_back(reader.readString());
+  }
+  auto offsets = reader.readView<Int>("soup_element_set_offsets");
+  auto elements = reader.readView<Int>("soup_element_set_elements");
+  soup.setElementSets(std::move(names), std::move(offsets), std::move(elements));
+}
+
+auto
+isEmpty(HostSoup const & soup) -> bool
+{
+  return soup.numElements() == 0;
+}
+
+void
+save(juno::StageWriter & writer, HostXS const & xs)
+{
+  writer.write(xs.numEntries());
+  writer.write(xs.numGroups());
+  writer.writeView(xs.vectorValues());
+  writer.writeView(xs.scatterValues());
+}
+
+void
+load(juno::StageReader & reader, HostXS & xs)
+{
+  auto const num_entries = reader.read<Int>();
+  auto const num_groups = reader.read<Int>();
+  if (!reader.ok() || num_entries < 0 || num_groups < 0) {
+    return;
+  }
+  xs = HostXS("xs", num_entries, num_groups);
+  reader.readInto(xs.vectorValues());
+  reader.readInto(xs.scatterValues());
+}
+
+auto
+isEmpty(HostXS const & xs) -> bool
+{
+  return xs.numEntries() == 0;
+}
+
+void
+save(juno::StageWriter & writer, juno::TrackLayout const & layout)
+{
+  writer.write(layout.box);
+  writer.write(layout.polar);
+  writer.writeVector(layout.phi);
+  writer.writeVector(layout.spacing);
+  writer.writeVector(layout.azimuthal_weights);
+  writer.writeVector(layout.azimuth_offsets);
+  writer.writeVector(layout.tracks);
+  writer.writeVector(layout.azimuths);
+  writer.writeVector(layout.links);
+  writer.writeVector(layout.translated_links);
+  writer.writeVector(layout.exit_sides);
+}
+
+void
+load(juno::StageReader & reader, juno::TrackLayout & layout)
+{
+  layout.box = reader.read<juno::AABB2>();
+  layout.polar = reader.read<juno::PolarQuadrature>();
+  layout.phi = reader.readVector<Float>();
+  layout.spacing = reader.readVector<Float>();
+  layout.azimuthal_weights = reader.readVector<Float>();
+  layout.azimuth_offsets = reader.readVector<Int>();
+  layout.tracks = reader.readVector<juno::Ray2>();
+  layout.azimuths = reader.readVector<Int>();
+  layout.links = reader.readVector<Int>();
+  layout.translated_links = reader.readVector<Int>();
+  layout.exit_sides = reader.readVector<int32_t>();
+}
+
+auto
+isEmpty(juno::TrackLayout const & layout) -> bool
+{
+  return layout.tracks.empty();
+}
+
+auto
+secondsSince(std::chrono::steady_clock::time_point const start) -> double
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The result of a stage: from the cache, or from run(), which is then cached
+template <class T, class Run>
+auto
+runStage(juno::StageCache const & cache, std::string const & stage, uint64_t const key,
+         Run const & run) -> T
+{
+  auto const start = std::chrono::steady_clock::now();
+  auto reader = cache.read(stage, key);
+  if (reader.ok()) {
+    T result;
+    load(reader, result);
+    if (reader.ok() && reader.atEnd()) {
+      LOG_INFO("junoc: ", stage, ": cached, read in ", secondsSince(start), " s");
+      return result;
+    }
+    LOG_INFO("junoc: ", stage, ": the cached result is malformed");
+  }
+  T result = run();
+  if (!isEmpty(result) && cache.enabled()) {
+    juno::StageWriter writer;
+    save(writer, result);
+    cache.write(stage, key, writer);
+  }
+  LOG_INFO("junoc: ", stage, ": ran in ", secondsSince(start), " s");
+  return result;
+}
+
+// The cross sections of the materials, in order
+auto
+mixStage(Input const & input, juno::CrossSectionLibrary const & library) -> HostXS
+{
+  std::vector<std::string> names;
+  auto const materials = juno::makeMaterials(input.materials, names);
+  auto const nuclides = library.load(names);
+  if (nuclides.numEntries() != static_cast<Int>(names.size())) {
+    return {};
+  }
+  return juno::mixMaterials(nuclides, materials);
+}
+
+// The material of each face, from the element sets of the mesh
+auto
+faceMaterials(juno::MeshCache const & mesh,
+              std::vector<juno::MaterialInput> const & materials)
+    -> std::vector<Int>
+{
+  Int const num_faces = mesh.grid.mesh.numFaces();
+  std::vector<Int> face_materials(static_cast<size_t>(num_faces), -1);
+  for (size_t m = 0; m < materials.size(); ++m) {
+    size_t set = 0;
+    while (set < mesh.element_set_names.size() &&
+           mesh.element_set_names[set] != materials[m].name) {
+      ++set;
+    }
+    if (set == mesh.element_set_names.size()) {
+      LOG_ERROR("The mesh has no physical group '", materials[m].name, "'");
+      return {};
+    }
+    for (Int i = mesh.element_set_offsets(set); i < mesh.element_set_offsets(set + 1);
+         ++i) {
+      face_materials[static_cast<size_t>(mesh.element_set_elements(i))] =
+          static_cast<Int>(m);
+    }
+  }
+  for (Int f = 0; f < num_faces; ++f) {
+    if (face_materials[static_cast<size_t>(f)] < 0) {
+      LOG_ERROR("Face ", f, " of the mesh is in none of the materials");
+      return {};
+    }
+  }
+  return face_materials;
+}
+
+//========================================================================================
+// Solve
+//========================================================================================
+
+// The fission neutrons produced in the faces, weighted by their volumes
+auto
+production(juno::CrossSections<MemSpace> const & xs,
+           Kokkos::View<Int *, MemSpace> const & materials,
+           Kokkos::View<Float *, MemSpace> const & volumes,
+           Kokkos::View<Float *, MemSpace> const & flux) -> double
+{
+  Int const num_groups = xs.numGroups();
+  Int const stride = xs.groupStride();
+  FloatAccum total = 0;
+  Kokkos::parallel_reduce(
+      "junoc::production",
+      juno::rangePolicy<ExecSpace>(0, static_cast<Int>(volumes.size())),
+      KOKKOS_LAMBDA(Int const f, FloatAccum & sum) {
+        Float const * const nu_fission =
+            xs.row(materials(f), juno::reactions::nu_fission);
+        FloatAccum p = 0;
+        for (Int g = 0; g < num_groups; ++g) {
+          p += static_cast<FloatAccum>(nu_fission[g] * flux(f * stride + g));
+        }
+        sum += p * static_cast<FloatAccum>(volumes(f));
+      },
+      total);
+  return static_cast<double>(total);
+}
+
+// The isotropic source per steradian of each face: scattering, and fission / k
+void
+computeSource(juno::CrossSections<MemSpace> const & xs,
+              Kokkos::View<Int *, MemSpace> const & materials,
+              Kokkos::View<Float *, MemSpace> const & flux, double const k,
+              Kokkos::View<Float *, MemSpace> const & source)
+{
+  Int const num_groups = xs.numGroups();
+  Int const stride = xs.groupStride();
+  auto const inv_k = static_cast<Float>(1 / k);
+  Kokkos::parallel_for(
+      "junoc::source",
+      juno::rangePolicy<ExecSpace>(0, static_cast<Int>(materials.size())),
+      KOKKOS_LAMBDA(Int const f) {
+        Int const m = materials(f);
+        Float const * const phi = flux.data() + f * stride;
+        Float * const q = source.data() + f * stride;
+        Float const * const nu_fission = xs.row(m, juno::reactions::nu_fission);
+        Float const * const chi = xs.row(m, juno::reactions::chi);
+        Float fission = 0;
+        for (Int g = 0; g < num_groups; ++g) {
+          fission += nu_fission[g] * phi[g];
+        }
+        for (Int g = 0; g < num_groups; ++g) {
+          q[g] = chi[g] * fission * inv_k;
+        }
+        for (Int from = 0; from < num_groups; ++from) {
+          Float const * const scatter = xs.scatterRow(m, from);
+          for (Int g = 0; g < num_groups; ++g) {
+            q[g] += scatter[g] * phi[from];
+          }
+        }
+        for (Int g = 0; g < num_groups; ++g) {
+          q[g] /= four_pi;
+        }
+      });
+}
+
+auto
+solve(Input const & input, juno::MeshCache const & mesh,
+      juno::TrackLayout const & layout, HostXS const & host_xs,
+      std::vector<Int> const & face_materials) -> int
+{
+  juno::FaceGrid<MemSpace> grid;
+  if constexpr (std::is_same_v<MemSpace, juno::HostMemSpace>) {
+    grid = mesh.grid;
+  } else {
+    grid = juno::buildFaceGrid(mesh.grid.mesh.mirror<MemSpace>(), input.faces_per_cell);
+  }
+  juno::SweepOptions options;
+  options.boundary = input.boundary == "vacuum" ? juno::moc_boundaries::vacuum
+                                                : juno::moc_boundaries::reflective;
+  juno::MOCSweeper<MemSpace> sweeper(grid, layout, options);
+  auto const xs = host_xs.mirror<MemSpace>();
+
+  Int const num_faces = mesh.grid.mesh.numFaces();
+  Int const stride = xs.groupStride();
+  Kokkos::View<Int *, juno::HostMemSpace> const host_materials("materials",
+                                                               face_materials.size());
+  for (size_t f = 0; f < face_materials.size(); ++f) {
+    host_materials(f) = face_materials[f];
+  }
+  auto const materials = Kokkos::create_mirror_view_and_copy(MemSpace(), host_materials);
+  Kokkos::View<Float *, MemSpace> const flux("flux", static_cast<size_t>(num_faces) *
+                                                         static_cast<size_t>(stride));
+  Kokkos::View<Float *, MemSpace> const source("source", flux.size());
+  Kokkos::deep_copy(flux, 1);
+
+  double k = 1;
+  double produced = production(xs, materials, sweeper.volumes(), flux);
+  if (produced <= 0) {
+    LOG_ERROR("The materials do not fission");
+    return 1;
+  }
+  bool converged = false;
+  Int iteration = 0;
+  auto const start = std::chrono::steady_clock::now();
+  while (!converged && iteration < input.max_iterations) {
+    ++iteration;
+    computeSource(xs, materials, flux, k, source);
+    sweeper.sweep(xs, materials, source, flux);
+    double const next = production(xs, materials, sweeper.volumes(), flux);
+    // With deferred assertions, the contracts of the kernels are checked once per
+    // iteration, rather than aborting inside them
+    if (juno::checkAsserts("junoc: iteration") != 0) {
+      return 1;
+    }
+    double const next_k = k * next / produced;
+    converged = std::abs(next_k - k) < input.tolerance;
+    LOG_INFO("junoc: iteration ", iteration, ": k = ", next_k, ", dk = ", next_k - k);
+    k = next_k;
+    produced = next;
+  }
+  LOG_INFO("junoc: solved in ", secondsSince(start), " s");
+  if (!converged) {
+    LOG_WARN("junoc: k did not converge in ", input.max_iterations, " iterations");
+  }
+  LOG_INFO("junoc: k = ", k);
+
+  if (!input.output.empty()) {
+    juno::FieldWriter writer(input.output, mesh.grid.mesh);
+    writer.write(static_cast<double>(iteration),
+                 std::vector<juno::Field<MemSpace>>{
+                     {"flux", flux, xs.numGroups(), stride}});
+  }
+  return converged ? 0 : 2;
+}
+
+//========================================================================================
+// Run
+//========================================================================================
+
+auto
+run(Input const & input) -> int
+{
+  juno::StageCache const cache =
+      input.cache == "none" ? juno::StageCache() : juno::StageCache(input.cache);
+
+  // The keys of the stages, from their inputs. Opening the library reads only its index.
+  juno::CrossSectionLibrary const library(input.library);
+  auto const keys = juno::stageKeys(input, library);
+  if (keys.import == 0) {
+    return 1;
+  }
+  int32_t const curve = juno::reorderCurve(input);
+
+  auto const import = [&]() {
+    return runStage<HostSoup>(cache, "import", keys.import,
+                              [&]() { return juno::readGmshFile(input.mesh); });
+  };
+  auto const reorder = [&]() {
+    if (input.reorder == "none") {
+      return import();
+    }
+    return runStage<HostSoup>(cache, "reorder", keys.reorder,
+                              [&]() { return juno::reorderSoup(import(), curve); });
+  };
+
+  // The index has a file format of its own, the MeshCache
+  auto const start = std::chrono::steady_clock::now();
+  juno::MeshCache mesh;
+  if (cache.enabled()) {
+    mesh = juno::readMeshCache(cache.filename("index", keys.index), keys.index);
+  }
+  if (mesh.empty()) {
+    mesh = juno::makeMeshCache(reorder(), input.faces_per_cell);
+    if (mesh.empty()) {
+      LOG_ERROR("The mesh '", input.mesh, "' has no faces");
+      return 1;
+    }
+    if (cache.enabled()) {
+      juno::writeMeshCache(cache.filename("index", keys.index), mesh, keys.index);
+    }
+    LOG_INFO("junoc: index: ran in ", secondsSince(start), " s");
+  } else {
+    LOG_INFO("junoc: index: cached, read in ", secondsSince(start), " s");
+  }
+  auto const face_materials = faceMaterials(mesh, input.materials);
+  if (face_materials.empty()) {
+    return 1;
+  }
+
+  auto const xs = runStage<HostXS>(cache, "mix", keys.mix,
+                                   [&]() { return mixStage(input, library); });
+  if (isEmpty(xs)) {
+    return 1;
+  }
+
+  auto const & parameters = input.tracks;
+  uint64_t const tracks_key = juno::tracksKey(mesh.grid.box, parameters);
+  auto const layout = runStage<juno::TrackLayout>(cache, "tracks", tracks_key, [&]() {
+    return juno::makeTrackLayout(mesh.grid.box, parameters);
+  });
+  if (isEmpty(layout)) {
+    return 1;
+  }
+
+  return solve(input, mesh, layout, xs, face_materials);
+}
+
+} // namespace
+
+auto
+main(int argc, char ** argv) -> int
+{
+  if (argc < 2) {
+    std::printf("usage: junoc <input> [key=value ...]\n");
+    return 1;
+  }
+  Kokkos::ScopeGuard const guard(argc, argv);
+  Input input;
+  if (!readInput(argc, argv, input)) {
+    return 1;
+  }
+  return run(input);
+}
@@ -0,0 +1,24 @@
+#include <juno/math/matrix.hpp>
+
+namespace juno
+{
+
+#define JUNO_MATRIX_INSTANTIATE(N)                                                       \
+  template auto luFactor<N, HostMemSpace>(MatrixBatch<N, HostMemSpace> const &,          \
+                                          PivotBatch<N, HostMemSpace> const &) -> Int;   \
+  template void luSolve<N, HostMemSpace>(MatrixBatch<N, HostMemSpace> const &,           \
+                                         PivotBatch<N, HostMemSpace> const &,            \
+                                         VectorBatch<N, HostMemSpace> const &);          \
+  template void matvec<N, HostMemSpace>(MatrixBatch<N, HostMemSpace> const &,            \
+                                        VectorBatch<N, HostMemSpace> const &,            \
+                                        VectorBatch<N, HostMemSpace> const &);
+
+JUNO_MATRIX_INSTANTIATE(2)
+JUNO_MATRIX_INSTANTIATE(3)
+JUNO_MATRIX_INSTANTIATE(4)
+JUNO_MATRIX_INSTANTIATE(8)
+JUNO_MATRIX_INSTANTIATE(16)
+
+#undef JUNO_MATRIX_INSTANTIATE
+
+} // namespace juno
@@ -0,0 +1,78 @@
+#include <juno/common/logger.hpp>
+#include <juno/mesh/face_vertex_mesh.hpp>
+
+#include <algorithm> // std::reverse
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+auto
+makeFaceVertexMesh(PolytopeSoup<HostMemSpace> const & soup)
+    -> FaceVertexMesh<HostMemSpace>
+{
+  using Mesh = FaceVertexMesh<HostMemSpace>;
+  using FloatView = Mesh::FloatView;
+  using IntView = Mesh::IntView;
+  auto const no_init = [](char const * label) {
+    return Kokkos::view_alloc(Kokkos::WithoutInitializing, std::string(label));
+  };
+
+  Int const num_vertices = soup.numVertices();
+  Int const num_faces = soup.numElements();
+  auto const & types = soup.elementTypes();
+  auto const & soup_offsets = soup.elementOffsets();
+  auto const & soup_vertices = soup.elementVertices();
+  for (Int i = 0; i < num_faces; ++i) {
+    int8_t const type = types(i);
+    if (type != vtk_types::triangle && type != vtk_types::quad &&
+        type != vtk_types::polygon) {
+      LOG_ERROR("Face-vertex mesh: element ", i, " has VTK type ", type,
+                ", which is not a linear polygon");
+      return {};
+    }
+  }
+
+  // The coordinates and the face offsets are shared with the soup, since they are
+  // immutable once built
+  FloatView const & x = soup.x();
+  FloatView const & y = soup.y();
+  IntView const & face_offsets = soup_offsets;
+
+  // Copy the face vertices, reversing clockwise faces
+  IntView const face_vertices(no_init("mesh_face_vertices"), soup_vertices.size());
+  Kokkos::deep_copy(face_vertices, soup_vertices);
+  Mesh const unoriented(x, y, face_offsets, face_vertices, IntView(), IntView());
+  Kokkos::parallel_for(
+      "juno::makeFaceVertexMesh::orient", rangePolicy<HostExecSpace>(0, num_faces),
+      [&](Int const f) {
+        if (unoriented.faceArea(f) < 0) {
+          std::reverse(face_vertices.data() + face_offsets(f),
+                       face_vertices.data() + face_offsets(f + 1));
+        }
+      });
+
+  // Vertex-face adjacency: count, prefix sum, then fill in increasing face order
+  IntView const vertex_face_offsets("mesh_vertex_face_offsets",
+                                    static_cast<size_t>(num_vertices) + 1);
+  for (size_t i = 0; i < face_vertices.size(); ++i) {
+    ++vertex_face_offsets(face_vertices(i) + 1);
+  }
+  for (Int v = 0; v < num_vertices; ++v) {
+    vertex_face_offsets(v + 1) += vertex_face_offsets(v);
+  }
+  IntView const vertex_faces(no_init("mesh_vertex_faces"), face_vertices.size());
+  IntView const next(no_init("next"), static_cast<size_t>(num_vertices));
+  Kokkos::deep_copy(next, Kokkos::subview(vertex_face_offsets,
+                                          Kokkos::make_pair(0, num_vertices)));
+  for (Int f = 0; f < num_faces; ++f) {
+    for (Int i = face_offsets(f); i < face_offsets(f + 1); ++i) {
+      Int const v = face_vertices(i);
+      vertex_faces(next(v)) = f;
+      ++next(v);
+    }
+  }
+  return {x, y, face_offsets, face_vertices, vertex_face_offsets, vertex_faces};
+}
+
+} // namespace juno
@@ -0,0 +1,516 @@
+#include <juno/common/atomic_file.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/mesh/field_writer.hpp>
+
+#include <algorithm>          // std::min, std::max
+#include <cstddef>            // std::ptrdiff_t
+#include <condition_variable> // std::condition_variable
+#include <deque>              // std::deque
+#include <filesystem>         // std::filesystem::path
+#include <fstream>            // std::ofstream
+#include <mutex>              // std::mutex, std::lock_guard, std::unique_lock
+#include <thread> // std::thread
+#include <type_traits>
+
+#if JUNO_USE_HDF5
+#  include <hdf5.h>
+#endif
+
+namespace juno
+{
+
+namespace impl
+{
+
+// A step queued for the writer thread
+struct QueuedStep {
+  Int step;
+  double time;
+  std::vector<StagedField> fields;
+};
+
+// A step written, for the XDMF file: its time, the names and components of its
+// fields, and whether this rank wrote it
+struct WrittenStep {
+  Int step;
+  double time;
+  std::vector<std::pair<std::string, Int>> fields;
+  bool ok;
+};
+
+struct FieldWriterState {
+  Communicator comm;
+  FieldWriterOptions options;
+  std::string prefix;
+
+  // Of each rank, for the XDMF file
+  std::vector<int64_t> num_vertices;
+  std::vector<int64_t> num_faces;
+  std::vector<int64_t> topology_size;
+
+#if JUNO_USE_HDF5
+  hid_t file = H5I_INVALID_HID;
+#endif
+
+  // The steps in the XDMF file. Only flush() touches them.
+  std::vector<WrittenStep> published;
+
+  std::mutex mutex;
+  std::condition_variable queued;  // a step is queued, or the writer stops
+  std::condition_variable written_one;
+  std::deque<QueuedStep> queue;
+  std::vector<WrittenStep> written; // since the last flush()
+  std::vector<StagingView> free_buffers;
+  Int pending = 0; // queued, or being written
+  Int num_steps = 0;
+  bool stop = false;
+  std::thread thread;
+
+  FieldWriterState() = default;
+  FieldWriterState(FieldWriterState const &) = delete;
+  FieldWriterState(FieldWriterState &&) = delete;
+  auto
+  operator=(FieldWriterState const &) -> FieldWriterState & = delete;
+  auto
+  operator=(FieldWriterState &&) -> FieldWriterState & = delete;
+
+  // Write the queued steps, and close the file
+  ~FieldWriterState();
+};
+
+} // namespace impl
+
+namespace
+{
+
+#if JUNO_USE_HDF5
+
+// HDF5 is not thread-safe, unless it is built so: every writer, and the threads of the
+// writers, call it under this lock
+std::mutex hdf5_mutex;
+
+// Silence the error stack that HDF5 prints, while in scope, since the writer logs its
+// own errors
+class QuietErrors
+{
+  H5E_auto2_t _function = nullptr;
+  void * _data = nullptr;
+
+public:
+  QuietErrors()
+  {
+    H5Eget_auto2(H5E_DEFAULT, &_function, &_data);
+    H5Eset_auto2(H5E_DEFAULT, nullptr, nullptr);
+  }
+
+  QuietErrors(QuietErrors const &) = delete;
+  QuietErrors(QuietErrors &&) = delete;
+  auto
+  operator=(QuietErrors const &) -> QuietErrors & = delete;
+  auto
+  operator=(QuietErrors &&) -> QuietErrors & = delete;
+
+  ~QuietErrors() { H5Eset_auto2(H5E_DEFAULT, _function, _data); }
+};
+
+template <class T>
+auto
+nativeType() -> hid_t
+{
+  if constexpr (std::is_same_v<T, float>) {
+    return H5T_NATIVE_FLOAT;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return H5T_NATIVE_DOUBLE;
+  } else if constexpr (std::is_same_v<T, int32_t>) {
+    return H5T_NATIVE_INT32;
+  } else {
+    static_assert(std::is_same_v<T, int64_t>);
+    return H5T_NATIVE_INT64;
+  }
+}
+
+// Write a rows by cols dataset, chunked by rows, from rows of stride values
+template <class T>
+auto
+writeDataset(hid_t const parent, std::string const & name, T const * const data,
+             hsize_t const rows, hsize_t const cols, hsize_t const stride,
+             FieldWriterOptions const & options) -> bool
+{
+  hsize_t const dims[2] = {rows, cols};
+  hid_t const file_space = H5Screate_simple(2, dims, nullptr);
+  hid_t const properties = H5Pcreate(H5P_DATASET_CREATE);
+  if (rows > 0) {
+    auto const chunk_rows =
+        std::min(rows, static_cast<hsize_t>(std::max(options.chunk_size, Int{1})));
+    hsize_t const chunk[2] = {chunk_rows, cols};
+    H5Pset_chunk(properties, 2, chunk);
+    if (options.compression > 0) {
+      auto const level = static_cast<unsigned>(std::min(options.compression, 9));
+      H5Pset_deflate(properties, level);
+    }
+  }
+  hid_t const dataset = H5Dcreate2(parent, name.c_str(), nativeType<T>(), file_space,
+                                   H5P_DEFAULT, properties, H5P_DEFAULT);
+  bool ok = dataset >= 0;
+  if (ok && rows > 0) {
+    // The first cols values of each row of the data
+    hsize_t const memory_dims[2] = {rows, stride};
+    hid_t const memory_space = H5Screate_simple(2, memory_dims, nullptr);
+    hsize_t const start[2] = {0, 0};
+    H5Sselect_hyperslab(memory_space, H5S_SELECT_SET, start, nullptr, dims, nullptr);
+    ok = H5Dwrite(dataset, nativeType<T>(), memory_space, file_space, H5P_DEFAULT,
+                  data) >= 0;
+    H5Sclose(memory_space);
+  }
+  if (dataset >= 0) {
+    H5Dclose(dataset);
+  }
+  H5Pclose(properties);
+  H5Sclose(file_space);
+  return ok;
+}
+
+// The file of a rank: <prefix>_r<rank>.h5
+auto
+rankFileName(std::string const & prefix, Int const rank) -> std::string
+{
+  return prefix + "_r" + std::to_string(rank) + ".h5";
+}
+
+// Rewrite the XDMF file of the written steps. The HDF5 files are named relative to it,
+// so that the output can be moved.
+void
+writeXDMF(impl::FieldWriterState const & state)
+{
+  auto const base = std::filesystem::path(state.prefix).filename().string();
+  auto const write = [&](std::ofstream & out) {
+    out << "<?xml version=\"1.0\" ?>\n"
+        << "<Xdmf Version=\"3.0\">\n"
+        << "  <Domain>\n"
+        << "    <Grid Name=\"steps\" GridType=\"Collection\" "
+           "CollectionType=\"Temporal\">\n";
+    for (auto const & step : state.published) {
+      out << "      <Grid Name=\"step_" << step.step
+          << "\" GridType=\"Collection\" CollectionType=\"Spatial\">\n"
+          << "        <Time Value=\"" << step.time << "\"/>\n";
+      for (size_t r = 0; r < state.num_faces.size(); ++r) {
+        if (state.num_faces[r] == 0) {
+          continue;
+        }
+        auto const file = rankFileName(base, static_cast<Int>(r));
+        out << "        <Grid Name=\"rank_" << r << "\" GridType=\"Uniform\">\n"
+            << "          <Topology TopologyType=\"Mixed\" NumberOfElements=\""
+            << state.num_faces[r] << "\">\n"
+            << "            <DataItem Dimensions=\"" << state.topology_size[r]
+            << "\" NumberType=\"Int\" Precision=\"" << sizeof(Int)
+            << "\" Format=\"HDF\">" << file << ":/mesh/topology</DataItem>\n"
+            << "          </Topology>\n"
+            << "          <Geometry GeometryType=\"XY\">\n"
+            << "            <DataItem Dimensions=\"" << state.num_vertices[r]
+            << " 2\" NumberType=\"Float\" Precision=\"" << sizeof(Float)
+            << "\" Format=\"HDF\">" << file << ":/mesh/vertices</DataItem>\n"
+            << "          </Geometry>\n";
+        for (auto const & [name, num_components] : step.fields) {
+          out << "          <Attribute Name=\"" << name << "\" AttributeType=\""
+              << (num_components == 1 ? "Scalar" : "Matrix") << "\" Center=\"Cell\">\n"
+              << "            <DataItem Dimensions=\"" << state.num_faces[r] << " "
+              << num_components << "\" NumberType=\"Float\" Precision=\""
+              << sizeof(Float) << "\" Format=\"HDF\">" << file << ":/steps/"
+              << step.step << "/" << name << "</DataItem>\n"
+              << "          </Attribute>\n";
+        }
+        out << "        </Grid>\n";
+      }
+      out << "      </Grid>\n";
+    }
+    out << "    </Grid>\n"
+        << "  </Domain>\n"
+        << "</Xdmf>\n";
+  };
+  // Readers never see a partial file
+  writeFileAtomically(state.prefix + ".xmf", "XDMF file", write);
+}
+
+// Write the fields of a step to /steps/<step> of the file of the rank
+auto
+writeStep(impl::FieldWriterState const & state, impl::QueuedStep const & step) -> bool
+{
+  std::lock_guard const lock(hdf5_mutex);
+  QuietErrors const quiet;
+  auto const name = "/steps/" + std::to_string(step.step);
+  hid_t const group =
+      H5Gcreate2(state.file, name.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (group < 0) {
+    LOG_ERROR("FieldWriter: cannot create '", name, "' in '",
+              rankFileName(state.prefix, state.comm.rank()), "'");
+    return false;
+  }
+  hid_t const scalar = H5Screate(H5S_SCALAR);
+  hid_t const time =
+      H5Acreate2(group, "time", H5T_NATIVE_DOUBLE, scalar, H5P_DEFAULT, H5P_DEFAULT);
+  bool ok = time >= 0 && H5Awrite(time, H5T_NATIVE_DOUBLE, &step.time) >= 0;
+  if (time >= 0) {
+    H5Aclose(time);
+  }
+  H5Sclose(scalar);
+  auto const rank = static_cast<size_t>(state.comm.rank());
+  auto const rows = static_cast<hsize_t>(state.num_faces[rank]);
+  for (auto const & field : step.fields) {
+    if (ok && !writeDataset(group, field.name, field.buffer.data(), rows,
+                            static_cast<hsize_t>(field.num_components),
+                            static_cast<hsize_t>(field.stride), state.options)) {
+      LOG_ERROR("FieldWriter: cannot write '", name, "/", field.name, "'");
+      ok = false;
+    }
+  }
+  H5Gclose(group);
+  // So that the step can be read while the solver runs
+  H5Fflush(state.file, H5F_SCOPE_LOCAL);
+  return ok;
+}
+
+// The loop of the writer thread: write the queued steps until the writer stops, and
+// the queue is empty
+void
+writeSteps(impl::FieldWriterState & state)
+{
+  for (;;) {
+    impl::QueuedStep step;
+    {
+      std::unique_lock lock(state.mutex);
+      state.queued.wait(lock, [&] { return state.stop || !state.queue.empty(); });
+      if (state.queue.empty()) {
+        return;
+      }
+      step = std::move(state.queue.front());
+      state.queue.pop_front();
+    }
+    bool const ok = writeStep(state, step);
+    std::vector<std::pair<std::string, Int>> fields;
+    for (auto const & field : step.fields) {
+      fields.emplace_back(field.name, field.num_components);
+    }
+    {
+      std::lock_guard const lock(state.mutex);
+      state.written.push_back({step.step, step.time, std::move(fields), ok});
+      for (auto & field : step.fields) {
+        state.free_buffers.push_back(std::move(field.buffer));
+      }
+      --state.pending;
+    }
+    state.written_one.notify_all();
+  }
+}
+
+// Add the steps that every rank has written to the XDMF file. A step that a rank
+// failed to write is left out, so that the file never names data that is missing.
+// Collective, once the queued steps are written.
+void
+publishSteps(impl::FieldWriterState & state)
+{
+  std::vector<impl::WrittenStep> written;
+  {
+    std::lock_guard const lock(state.mutex);
+    written.swap(state.written);
+  }
+  bool any = false;
+  for (auto & step : written) {
+    // The number of ranks that failed, as a double
+    if (state.comm.sumAll(step.ok ? 0.0 : 1.0) < 0.5) {
+      state.published.push_back(std::move(step));
+      any = true;
+    }
+  }
+  if (any && state.comm.rank() == 0) {
+    writeXDMF(state);
+  }
+}
+
+#endif // JUNO_USE_HDF5
+
+} // namespace
+
+impl::FieldWriterState::~FieldWriterState()
+{
+  {
+    std::lock_guard const lock(mutex);
+    stop = true;
+  }
+  queued.notify_all();
+  bool const started = thread.joinable();
+  if (started) {
+    thread.join();
+  }
+#if JUNO_USE_HDF5
+  // The steps since the last flush()
+  if (started) {
+    publishSteps(*this);
+  }
+  if (file >= 0) {
+    std::lock_guard const lock(hdf5_mutex);
+    H5Fclose(file);
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+// FieldWriter
+//----------------------------------------------------------------------------------------
+
+FieldWriter::FieldWriter() = default;
+FieldWriter::FieldWriter(FieldWriter &&) noexcept = default;
+FieldWriter::~FieldWriter() = default;
+
+auto
+FieldWriter::operator=(FieldWriter &&) noexcept -> FieldWriter & = default;
+
+FieldWriter::FieldWriter([[maybe_unused]] std::string const & prefix,
+                         [[maybe_unused]] FaceVertexMesh<HostMemSpace> const & mesh,
+                         [[maybe_unused]] Communicator const & comm,
+                         [[maybe_unused]] FieldWriterOptions const & options)
+{
+#if JUNO_USE_HDF5
+  PROFILE_SCOPE("juno::FieldWriter::FieldWriter");
+  // The faces in the XDMF "Mixed" layout: the type of each face, then its vertices.
+  // Triangles are 4, quadrilaterals 5, and other polygons 3, followed by their size.
+  Int const num_faces = mesh.numFaces();
+  std::vector<Int> topology;
+  topology.reserve(mesh.faceVertices().size() + 2 * static_cast<size_t>(num_faces));
+  for (Int f = 0; f < num_faces; ++f) {
+    Int const n = mesh.faceSize(f);
+    if (n == 3) {
+      topology.push_back(4);
+    } else if (n == 4) {
+      topology.push_back(5);
+    } else {
+      topology.push_back(3);
+      topology.push_back(n);
+    }
+    for (Int k = 0; k < n; ++k) {
+      topology.push_back(mesh.faceVertex(f, k));
+    }
+  }
+  std::vector<Float> vertices(2 * static_cast<size_t>(mesh.numVertices()));
+  for (Int v = 0; v < mesh.numVertices(); ++v) {
+    vertices[2 * static_cast<size_t>(v)] = mesh.x()(v);
+    vertices[2 * static_cast<size_t>(v) + 1] = mesh.y()(v);
+  }
+
+  auto state = std::make_unique<impl::FieldWriterState>();
+  state->comm = comm;
+  state->options = options;
+  state->prefix = prefix;
+  state->num_vertices = comm.allGather(mesh.numVertices());
+  state->num_faces = comm.allGather(num_faces);
+  state->topology_size = comm.allGather(static_cast<int64_t>(topology.size()));
+
+  auto const filename = rankFileName(prefix, comm.rank());
+  auto const create = [&]() -> bool {
+    std::lock_guard const lock(hdf5_mutex);
+    QuietErrors const quiet;
+    state->file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (state->file < 0) {
+      LOG_ERROR("FieldWriter: cannot create '", filename, "'");
+      return false;
+    }
+    bool ok = true;
+    for (char const * const group : {"/mesh", "/steps"}) {
+      hid_t const id =
+          H5Gcreate2(state->file, group, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      ok = ok && id >= 0;
+      if (id >= 0) {
+        H5Gclose(id);
+      }
+    }
+    ok = ok &&
+         writeDataset(state->file, "/mesh/vertices", vertices.data(),
+                      static_cast<hsize_t>(mesh.numVertices()), 2, 2, options) &&
+         writeDataset(state->file, "/mesh/topology", topology.data(),
+                      static_cast<hsize_t>(topology.size()), 1, 1, options);
+    if (!ok) {
+      LOG_ERROR("FieldWriter: cannot write the mesh to '", filename, "'");
+    }
+    return ok;
+  };
+  // The writer is open on every rank or on none, since flush() is collective
+  bool const created = create();
+  if (comm.sumAll(created ? 0.0 : 1.0) > 0.5) {
+    if (created) {
+      LOG_ERROR("FieldWriter: another rank cannot create its file");
+    }
+    return;
+  }
+  if (comm.rank() == 0) {
+    writeXDMF(*state);
+  }
+  state->thread = std::thread(writeSteps, std::ref(*state));
+  _state = std::move(state);
+  _num_faces = num_faces;
+#else
+  LOG_ERROR("FieldWriter: juno was built without HDF5 (JUNO_USE_HDF5)");
+#endif
+}
+
+auto
+FieldWriter::isOpen() const noexcept -> bool
+{
+  return _state != nullptr;
+}
+
+auto
+FieldWriter::numSteps() const noexcept -> Int
+{
+  return _state ? _state->num_steps : 0;
+}
+
+auto
+FieldWriter::acquireStaging(size_t const n) -> impl::StagingView
+{
+  {
+    std::lock_guard const lock(_state->mutex);
+    auto & buffers = _state->free_buffers;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      if (buffers[i].size() >= n) {
+        auto buffer = std::move(buffers[i]);
+        buffers.erase(buffers.begin() + static_cast<std::ptrdiff_t>(i));
+        return buffer;
+      }
+    }
+  }
+  return impl::StagingView(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, "juno::FieldWriter::staging"),
+      n);
+}
+
+void
+FieldWriter::enqueue(double const time, std::vector<impl::StagedField> && fields)
+{
+  auto & state = *_state;
+  {
+    std::unique_lock lock(state.mutex);
+    Int const max_pending = std::max(state.options.max_pending, Int{1});
+    state.written_one.wait(lock, [&] { return state.pending < max_pending; });
+    state.queue.push_back({state.num_steps, time, std::move(fields)});
+    ++state.num_steps;
+    ++state.pending;
+  }
+  state.queued.notify_one();
+}
+
+void
+FieldWriter::flush()
+{
+  if (!isOpen()) {
+    return;
+  }
+  {
+    std::unique_lock lock(_state->mutex);
+    _state->written_one.wait(lock, [&] { return _state->pending == 0; });
+  }
+#if JUNO_USE_HDF5
+  publishSteps(*_state);
+#endif
+}
+
+} // namespace juno
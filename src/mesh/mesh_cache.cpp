@@ -0,0 +1,277 @@
+#include <juno/common/atomic_file.hpp>
+#include <juno/common/hash.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/mesh/mesh_cache.hpp>
+
+#include <cstring>    // std::memcmp, std::memcpy
+#include <filesystem> // std::filesystem::exists
+#include <fstream>    // std::ofstream
+#include <system_error>
+
+namespace juno
+{
+
+namespace
+{
+
+// The arrays of a cache, in the order of the file
+namespace arrays
+{
+inline constexpr size_t x = 0;
+inline constexpr size_t y = 1;
+inline constexpr size_t face_offsets = 2;
+inline constexpr size_t face_vertices = 3;
+inline constexpr size_t vertex_face_offsets = 4;
+inline constexpr size_t vertex_faces = 5;
+inline constexpr size_t cell_offsets = 6;
+inline constexpr size_t cell_faces = 7;
+inline constexpr size_t element_set_offsets = 8;
+inline constexpr size_t element_set_elements = 9;
+inline constexpr size_t element_set_names = 10; // null-terminated names
+inline constexpr size_t count = 11;
+} // namespace arrays
+
+char constexpr magic[8] = {'J', 'U', 'N', 'O', 'M', 'E', 'S', 'H'};
+uint32_t constexpr endianness = 0x01020304;
+
+struct ArrayEntry {
+  uint64_t offset; // from the beginning of the file
+  uint64_t bytes;
+};
+
+// The beginning of the file. The arrays follow, each at an aligned offset.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t endianness;
+  uint32_t float_size;
+  uint32_t int_size;
+  uint64_t source_hash;
+  uint64_t content_hash; // of the arrays, in order
+  double box[4];         // min x, min y, max x, max y
+  int64_t nx;
+  int64_t ny;
+  double dx;
+  double dy;
+  double tolerance;
+  ArrayEntry arrays[arrays::count];
+};
+
+auto
+alignUp(uint64_t const n) -> uint64_t
+{
+  uint64_t const a = mesh_cache::alignment;
+  return (n + a - 1) / a * a;
+}
+
+auto
+contentHash(char const * const data, Header const & header) -> uint64_t
+{
+  uint64_t h = 0;
+  for (auto const & entry : header.arrays) {
+    h = hashCombine(h, hashBytes(data + entry.offset, entry.bytes));
+  }
+  return h;
+}
+
+// An unmanaged View of a mapped array
+template <class T>
+auto
+mappedView(char * const base, ArrayEntry const & entry) -> Kokkos::View<T *, HostMemSpace>
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return {reinterpret_cast<T *>(base + entry.offset), entry.bytes / sizeof(T)};
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+makeMeshCache(PolytopeSoup<HostMemSpace> const & soup, Float const faces_per_cell)
+    -> MeshCache
+{
+  PROFILE_SCOPE("juno::makeMeshCache");
+  MeshCache cache;
+  auto const mesh = makeFaceVertexMesh(soup);
+  if (mesh.numFaces() == 0) {
+    return cache;
+  }
+  cache.grid = buildFaceGrid(mesh, faces_per_cell);
+  cache.element_set_names = soup.elementSetNames();
+  cache.element_set_offsets = soup.elementSetOffsets();
+  cache.element_set_elements = soup.elementSetElements();
+  return cache;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+writeMeshCache(std::string const & filename, MeshCache const & cache,
+               uint64_t const source_hash) -> bool
+{
+  PROFILE_SCOPE("juno::writeMeshCache");
+  auto const & grid = cache.grid;
+  auto const & mesh = grid.mesh;
+
+  std::string names;
+  for (auto const & name : cache.element_set_names) {
+    names += name;
+    names += '\0';
+  }
+
+  // The data and size of each array
+  struct Array {
+    void const * data;
+    uint64_t bytes;
+  };
+  auto const array = [](auto const & view) {
+    return Array{view.data(), view.size() * sizeof(*view.data())};
+  };
+  Array const data[arrays::count] = {array(mesh.x()),
+                                     array(mesh.y()),
+                                     array(mesh.faceOffsets()),
+                                     array(mesh.faceVertices()),
+                                     array(mesh.vertexFaceOffsets()),
+                                     array(mesh.vertexFaces()),
+                                     array(grid.cell_offsets),
+                                     array(grid.cell_faces),
+                                     array(cache.element_set_offsets),
+                                     array(cache.element_set_elements),
+                                     Array{names.data(), names.size()}};
+
+  Header header = {};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = mesh_cache::version;
+  header.endianness = endianness;
+  header.float_size = sizeof(Float);
+  header.int_size = sizeof(Int);
+  header.source_hash = source_hash;
+  header.box[0] = static_cast<double>(grid.box.min.x);
+  header.box[1] = static_cast<double>(grid.box.min.y);
+  header.box[2] = static_cast<double>(grid.box.max.x);
+  header.box[3] = static_cast<double>(grid.box.max.y);
+  header.nx = grid.nx;
+  header.ny = grid.ny;
+  header.dx = static_cast<double>(grid.dx);
+  header.dy = static_cast<double>(grid.dy);
+  header.tolerance = static_cast<double>(grid.tolerance);
+  uint64_t offset = alignUp(sizeof(Header));
+  header.content_hash = 0;
+  for (size_t i = 0; i < arrays::count; ++i) {
+    header.arrays[i] = {offset, data[i].bytes};
+    header.content_hash =
+        hashCombine(header.content_hash, hashBytes(data[i].data, data[i].bytes));
+    offset = alignUp(offset + data[i].bytes);
+  }
+
+  bool const written =
+      writeFileAtomically(filename, "mesh cache", [&](std::ofstream & file) {
+        char const padding[mesh_cache::alignment] = {};
+        auto const write = [&file](void const * bytes, uint64_t const n) {
+          file.write(static_cast<char const *>(bytes), static_cast<std::streamsize>(n));
+        };
+        write(&header, sizeof(Header));
+        uint64_t position = sizeof(Header);
+        for (size_t i = 0; i < arrays::count; ++i) {
+          write(padding, header.arrays[i].offset - position);
+          write(data[i].data, data[i].bytes);
+          position = header.arrays[i].offset + data[i].bytes;
+        }
+      });
+  if (!written) {
+    return false;
+  }
+  LOG_INFO("Wrote mesh cache: ", filename);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+readMeshCache(std::string const & filename, uint64_t const source_hash) -> MeshCache
+{
+  PROFILE_SCOPE("juno::readMeshCache");
+  std::error_code error;
+  if (!std::filesystem::exists(filename, error)) {
+    LOG_INFO("No mesh cache: ", filename);
+    return {};
+  }
+  auto const file = std::make_shared<MappedFile const>(filename, true);
+  if (!file->isOpen()) {
+    return {};
+  }
+
+  // Check the header
+  Header header = {};
+  if (file->size() < sizeof(Header)) {
+    LOG_INFO("Mesh cache '", filename, "' is too small to be a cache");
+    return {};
+  }
+  std::memcpy(&header, file->data(), sizeof(Header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+    LOG_INFO("Mesh cache '", filename, "' is not a mesh cache");
+    return {};
+  }
+  if (header.version != mesh_cache::version || header.endianness != endianness ||
+      header.float_size != sizeof(Float) || header.int_size != sizeof(Int)) {
+    LOG_INFO("Mesh cache '", filename, "' was written by version ", header.version,
+             " with ", header.float_size, "-byte Floats and ", header.int_size,
+             "-byte Ints, which does not match this build");
+    return {};
+  }
+  if (header.source_hash != source_hash) {
+    LOG_INFO("Mesh cache '", filename, "' is stale");
+    return {};
+  }
+  for (auto const & entry : header.arrays) {
+    if (entry.offset % mesh_cache::alignment != 0 || entry.offset > file->size() ||
+        entry.bytes > file->size() - entry.offset) {
+      LOG_INFO("Mesh cache '", filename, "' is truncated");
+      return {};
+    }
+  }
+  if (contentHash(file->data(), header) != header.content_hash) {
+    LOG_INFO("Mesh cache '", filename, "' is damaged");
+    return {};
+  }
+
+  // Point the Views at the mapped arrays
+  char * const base = file->writableData();
+  auto const floats = [&](size_t const i) {
+    return mappedView<Float>(base, header.arrays[i]);
+  };
+  auto const ints = [&](size_t const i) {
+    return mappedView<Int>(base, header.arrays[i]);
+  };
+
+  MeshCache cache;
+  cache.file = file;
+  cache.grid.mesh = FaceVertexMesh<HostMemSpace>(
+      floats(arrays::x), floats(arrays::y), ints(arrays::face_offsets),
+      ints(arrays::face_vertices), ints(arrays::vertex_face_offsets),
+      ints(arrays::vertex_faces));
+  cache.grid.box.min = {static_cast<Float>(header.box[0]),
+                        static_cast<Float>(header.box[1])};
+  cache.grid.box.max = {static_cast<Float>(header.box[2]),
+                        static_cast<Float>(header.box[3])};
+  cache.grid.nx = static_cast<Int>(header.nx);
+  cache.grid.ny = static_cast<Int>(header.ny);
+  cache.grid.dx = static_cast<Float>(header.dx);
+  cache.grid.dy = static_cast<Float>(header.dy);
+  cache.grid.tolerance = static_cast<Float>(header.tolerance);
+  cache.grid.cell_offsets = ints(arrays::cell_offsets);
+  cache.grid.cell_faces = ints(arrays::cell_faces);
+  cache.element_set_offsets = ints(arrays::element_set_offsets);
+  cache.element_set_elements = ints(arrays::element_set_elements);
+
+  ArrayEntry const & names = header.arrays[arrays::element_set_names];
+  char const * p = file->data() + names.offset;
+  char const * const end = p + names.bytes;
+  while (p < end) {
+    cache.element_set_names.emplace_back(p);
+    p += cache.element_set_names.back().size() + 1;
+  }
+  LOG_INFO("Read mesh cache: ", filename);
+  return cache;
+}
+
+} // namespace juno
@@ -0,0 +1,201 @@
+#include <juno/common/assert.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/mesh/partition.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <cmath>  // std::abs, std::log
+#include <limits> // std::numeric_limits
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+// BlockDecomposition
+//----------------------------------------------------------------------------------------
+
+auto
+BlockDecomposition::blockBox(Int const b) const noexcept -> AABB2
+{
+  Int const i = b % num_x;
+  Int const j = b / num_x;
+  // The sides from the corners of the box, so that neighbors share them exactly
+  auto const x = [&](Int const k) {
+    return k == num_x ? box.max.x : box.min.x + static_cast<Float>(k) * blockWidth();
+  };
+  auto const y = [&](Int const k) {
+    return k == num_y ? box.max.y : box.min.y + static_cast<Float>(k) * blockHeight();
+  };
+  AABB2 block;
+  block.min = {x(i), y(j)};
+  block.max = {x(i + 1), y(j + 1)};
+  return block;
+}
+
+auto
+BlockDecomposition::blockOf(Vec2 const p) const noexcept -> Int
+{
+  auto const clamp = [](Int const k, Int const n) {
+    return k < 0 ? 0 : (k < n ? k : n - 1);
+  };
+  Int const i = clamp(static_cast<Int>((p.x - box.min.x) / blockWidth()), num_x);
+  Int const j = clamp(static_cast<Int>((p.y - box.min.y) / blockHeight()), num_y);
+  return j * num_x + i;
+}
+
+auto
+BlockDecomposition::neighbor(Int const b, int32_t const side) const noexcept -> Int
+{
+  Int i = b % num_x;
+  Int j = b / num_x;
+  switch (side) {
+  case box_sides::bottom:
+    j = j > 0 ? j - 1 : (periodic_y ? num_y - 1 : -1);
+    break;
+  case box_sides::right:
+    i = i + 1 < num_x ? i + 1 : (periodic_x ? 0 : -1);
+    break;
+  case box_sides::top:
+    j = j + 1 < num_y ? j + 1 : (periodic_y ? 0 : -1);
+    break;
+  default:
+    i = i > 0 ? i - 1 : (periodic_x ? num_x - 1 : -1);
+    break;
+  }
+  return i < 0 || j < 0 ? -1 : j * num_x + i;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+makeBlockDecomposition(AABB2 const & box, Int const num_blocks) -> BlockDecomposition
+{
+  if (box.isEmpty() || !(box.width() > 0) || !(box.height() > 0) || num_blocks <= 0) {
+    LOG_ERROR("makeBlockDecomposition: expected a box that is not empty, and a positive "
+              "number of blocks");
+    return {};
+  }
+  // The factorization whose blocks have the aspect ratio nearest 1
+  Int best_x = 1;
+  double best_ratio = std::numeric_limits<double>::max();
+  for (Int num_x = 1; num_x <= num_blocks; ++num_x) {
+    if (num_blocks % num_x != 0) {
+      continue;
+    }
+    Int const num_y = num_blocks / num_x;
+    // The log of the width over the height of a block
+    double const ratio = std::abs(
+        std::log(static_cast<double>(box.width()) * static_cast<double>(num_y)) -
+        std::log(static_cast<double>(box.height()) * static_cast<double>(num_x)));
+    if (ratio < best_ratio) {
+      best_ratio = ratio;
+      best_x = num_x;
+    }
+  }
+  return makeBlockDecomposition(box, best_x, num_blocks / best_x);
+}
+
+auto
+makeBlockDecomposition(AABB2 const & box, Int const num_x, Int const num_y)
+    -> BlockDecomposition
+{
+  if (box.isEmpty() || !(box.width() > 0) || !(box.height() > 0) || num_x <= 0 ||
+      num_y <= 0) {
+    LOG_ERROR("makeBlockDecomposition: expected a box that is not empty, and a positive "
+              "number of blocks");
+    return {};
+  }
+  BlockDecomposition blocks;
+  blocks.box = box;
+  blocks.num_x = num_x;
+  blocks.num_y = num_y;
+  return blocks;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+partitionFaces(FaceVertexMesh<HostMemSpace> const & mesh,
+               BlockDecomposition const & blocks) -> std::vector<Int>
+{
+  PROFILE_SCOPE("juno::partitionFaces");
+  Int const num_faces = mesh.numFaces();
+  std::vector<Int> face_blocks(static_cast<size_t>(num_faces));
+  // Vertices on the side of a block may be off by the rounding of the sides
+  Float const tolerance = 64 * std::numeric_limits<Float>::epsilon() *
+                          (blocks.box.width() + blocks.box.height());
+  Int num_across = 0;
+  for (Int f = 0; f < num_faces; ++f) {
+    Int const b = blocks.blockOf(mesh.faceCentroid(f));
+    face_blocks[static_cast<size_t>(f)] = b;
+    AABB2 const block = blocks.blockBox(b);
+    AABB2 const face = mesh.faceBoundingBox(f);
+    if (face.min.x < block.min.x - tolerance || face.max.x > block.max.x + tolerance ||
+        face.min.y < block.min.y - tolerance || face.max.y > block.max.y + tolerance) {
+      ++num_across;
+    }
+  }
+  if (num_across > 0) {
+    LOG_ERROR("partitionFaces: ", num_across,
+              " faces cross the side of a block; the mesh must conform to the blocks");
+    return {};
+  }
+  return face_blocks;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+extractSubmesh(FaceVertexMesh<HostMemSpace> const & mesh,
+               std::vector<Int> const & face_blocks, Int const block) -> Submesh
+{
+  PROFILE_SCOPE("juno::extractSubmesh");
+  Int const num_faces = mesh.numFaces();
+  ASSERT(static_cast<Int>(face_blocks.size()) == num_faces);
+  Submesh submesh;
+  Int num_face_vertices = 0;
+  for (Int f = 0; f < num_faces; ++f) {
+    if (face_blocks[static_cast<size_t>(f)] == block) {
+      submesh.faces.push_back(f);
+      num_face_vertices += mesh.faceSize(f);
+    }
+  }
+
+  // The vertices of the faces, numbered in order of first use
+  std::vector<Int> local_vertices(static_cast<size_t>(mesh.numVertices()), -1);
+  std::vector<Int> vertices;
+  for (Int const f : submesh.faces) {
+    for (Int k = 0; k < mesh.faceSize(f); ++k) {
+      Int const v = mesh.faceVertex(f, k);
+      if (local_vertices[static_cast<size_t>(v)] < 0) {
+        local_vertices[static_cast<size_t>(v)] = static_cast<Int>(vertices.size());
+        vertices.push_back(v);
+      }
+    }
+  }
+
+  auto const num_local_faces = static_cast<Int>(submesh.faces.size());
+  auto const num_local_vertices = static_cast<Int>(vertices.size());
+  PolytopeSoup<HostMemSpace> soup(num_local_vertices, num_local_faces, num_face_vertices);
+  for (Int i = 0; i < num_local_vertices; ++i) {
+    Vec2 const p = mesh.getVertex(vertices[static_cast<size_t>(i)]);
+    soup.x()(i) = p.x;
+    soup.y()(i) = p.y;
+    soup.z()(i) = 0;
+  }
+  soup.elementOffsets()(0) = 0;
+  for (Int i = 0; i < num_local_faces; ++i) {
+    Int const f = submesh.faces[static_cast<size_t>(i)];
+    Int const n = mesh.faceSize(f);
+    Int const offset = soup.elementOffsets()(i);
+    soup.elementTypes()(i) = n == 3   ? vtk_types::triangle
+                             : n == 4 ? vtk_types::quad
+                                      : vtk_types::polygon;
+    for (Int k = 0; k < n; ++k) {
+      soup.elementVertices()(offset + k) =
+          local_vertices[static_cast<size_t>(mesh.faceVertex(f, k))];
+    }
+    soup.elementOffsets()(i + 1) = offset + n;
+  }
+  submesh.mesh = makeFaceVertexMesh(soup);
+  return submesh;
+}
+
+} // namespace juno
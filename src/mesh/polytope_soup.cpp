@@ -0,0 +1,83 @@
+#include <juno/common/logger.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+auto
+validate(PolytopeSoup<HostMemSpace> const & soup) -> bool
+{
+  Int const num_vertices = soup.numVertices();
+  Int const num_elements = soup.numElements();
+  auto const & x = soup.x();
+  auto const & y = soup.y();
+  auto const & z = soup.z();
+  if (static_cast<Int>(y.size()) != num_vertices ||
+      static_cast<Int>(z.size()) != num_vertices) {
+    LOG_ERROR("Polytope soup: the coordinate arrays differ in size: ", x.size(), ", ",
+              y.size(), ", ", z.size());
+    return false;
+  }
+
+  // Elements
+  auto const & types = soup.elementTypes();
+  auto const & offsets = soup.elementOffsets();
+  auto const & vertices = soup.elementVertices();
+  if (static_cast<Int>(offsets.size()) != num_elements + 1 || offsets(0) != 0 ||
+      offsets(num_elements) != static_cast<Int>(vertices.size())) {
+    LOG_ERROR("Polytope soup: the element offsets do not match the ", num_elements,
+              " elements and ", vertices.size(), " element vertices");
+    return false;
+  }
+  for (Int i = 0; i < num_elements; ++i) {
+    Int const n = offsets(i + 1) - offsets(i);
+    Int const expected = verticesPerElement(types(i));
+    if (expected < 0) {
+      LOG_ERROR("Polytope soup: element ", i, " has unknown VTK type ", types(i));
+      return false;
+    }
+    if ((expected == 0 && n < 3) || (expected > 0 && n != expected)) {
+      LOG_ERROR("Polytope soup: element ", i, " of VTK type ", types(i), " has ", n,
+                " vertices");
+      return false;
+    }
+  }
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    if (vertices(i) < 0 || num_vertices <= vertices(i)) {
+      LOG_ERROR("Polytope soup: element vertex ", i, " is ", vertices(i),
+                ", which is not in [0, ", num_vertices, ")");
+      return false;
+    }
+  }
+
+  // Element sets
+  Int const num_sets = soup.numElementSets();
+  auto const & set_offsets = soup.elementSetOffsets();
+  auto const & set_elements = soup.elementSetElements();
+  if (static_cast<Int>(set_offsets.size()) != num_sets + 1 || set_offsets(0) != 0 ||
+      set_offsets(num_sets) != static_cast<Int>(set_elements.size())) {
+    LOG_ERROR("Polytope soup: the element set offsets do not match the ", num_sets,
+              " element sets and ", set_elements.size(), " element set elements");
+    return false;
+  }
+  for (Int s = 0; s < num_sets; ++s) {
+    for (Int i = set_offsets(s); i < set_offsets(s + 1); ++i) {
+      Int const element = set_elements(i);
+      if (element < 0 || num_elements <= element) {
+        LOG_ERROR("Polytope soup: element set '", soup.elementSetNames()[s],
+                  "' contains element ", element, ", which is not in [0, ", num_elements,
+                  ")");
+        return false;
+      }
+      if (i > set_offsets(s) && set_elements(i - 1) >= element) {
+        LOG_ERROR("Polytope soup: element set '", soup.elementSetNames()[s],
+                  "' is not sorted, or contains duplicates");
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace juno
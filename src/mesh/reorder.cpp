@@ -0,0 +1,292 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/mesh/reorder.hpp>
+
+#include <algorithm> // std::sort
+#include <vector>
+
+#include <omp.h>
+
+namespace juno
+{
+
+namespace
+{
+
+using IntView = Kokkos::View<Int *, HostMemSpace>;
+using KeyView = Kokkos::View<uint32_t *, HostMemSpace>;
+
+auto
+noInit(char const * label)
+{
+  return Kokkos::view_alloc(Kokkos::WithoutInitializing, std::string(label));
+}
+
+//----------------------------------------------------------------------------------------
+// Sort the indices 0 ... n - 1 by their keys, keeping the order of equal keys.
+// A least significant digit radix sort, 8 bits per pass. In each pass, each thread
+// counts the digits of its block of the input, the counts are scanned by digit then by
+// thread, and each thread scatters its block in order.
+auto
+sortByKey(KeyView const & keys) -> IntView
+{
+  auto const n = static_cast<Int>(keys.size());
+  int32_t constexpr radix_bits = 8;
+  int32_t constexpr radix = 1 << radix_bits;
+  std::vector<uint32_t> key_buffers[2] = {std::vector<uint32_t>(keys.size()),
+                                          std::vector<uint32_t>(keys.size())};
+  std::vector<Int> index_buffers[2] = {std::vector<Int>(keys.size()),
+                                       std::vector<Int>(keys.size())};
+  for (Int i = 0; i < n; ++i) {
+    key_buffers[0][static_cast<size_t>(i)] = keys(i);
+    index_buffers[0][static_cast<size_t>(i)] = i;
+  }
+
+  int32_t const num_threads = omp_get_max_threads();
+  std::vector<Int> counts(static_cast<size_t>(num_threads * radix));
+  for (int32_t pass = 0; pass < 32 / radix_bits; ++pass) {
+    int32_t const shift = pass * radix_bits;
+    auto const & keys_in = key_buffers[pass % 2];
+    auto const & indices_in = index_buffers[pass % 2];
+    auto & keys_out = key_buffers[1 - pass % 2];
+    auto & indices_out = index_buffers[1 - pass % 2];
+    std::fill(counts.begin(), counts.end(), 0);
+#pragma omp parallel num_threads(num_threads)
+    {
+      auto const t = static_cast<Int>(omp_get_thread_num());
+      auto const nt = static_cast<Int>(omp_get_num_threads());
+      auto const begin = static_cast<size_t>(static_cast<int64_t>(n) * t / nt);
+      auto const end = static_cast<size_t>(static_cast<int64_t>(n) * (t + 1) / nt);
+      Int * const count = counts.data() + static_cast<size_t>(t) * radix;
+      for (size_t i = begin; i < end; ++i) {
+        ++count[(keys_in[i] >> shift) & (radix - 1)];
+      }
+#pragma omp barrier
+#pragma omp single
+      {
+        // Exclusive scan, by digit, then by thread
+        Int sum = 0;
+        for (int32_t d = 0; d < radix; ++d) {
+          for (Int u = 0; u < nt; ++u) {
+            Int & c = counts[static_cast<size_t>(u * radix + d)];
+            Int const tmp = c;
+            c = sum;
+            sum += tmp;
+          }
+        }
+      }
+      for (size_t i = begin; i < end; ++i) {
+        auto const d = static_cast<size_t>((keys_in[i] >> shift) & (radix - 1));
+        auto const out = static_cast<size_t>(count[d]++);
+        keys_out[out] = keys_in[i];
+        indices_out[out] = indices_in[i];
+      }
+    }
+  }
+
+  // An even number of passes, so the result is in the first buffer
+  IntView const order(noInit("order"), keys.size());
+  for (Int i = 0; i < n; ++i) {
+    order(i) = index_buffers[0][static_cast<size_t>(i)];
+  }
+  return order;
+}
+
+//----------------------------------------------------------------------------------------
+// The keys of points on the curve, given by coordinate functions of the index
+template <class X, class Y>
+auto
+curveKeys(Int const n, AABB2 const & box, int32_t const curve, X const & x, Y const & y)
+    -> KeyView
+{
+  Float constexpr cells = 65535;
+  Float const sx = box.width() > 0 ? cells / box.width() : 0;
+  Float const sy = box.height() > 0 ? cells / box.height() : 0;
+  KeyView const keys(noInit("keys"), static_cast<size_t>(n));
+  Kokkos::parallel_for(
+      "juno::curveKeys", rangePolicy<HostExecSpace>(0, n), [&](Int const i) {
+        auto const qx = static_cast<uint32_t>((x(i) - box.min.x) * sx);
+        auto const qy = static_cast<uint32_t>((y(i) - box.min.y) * sy);
+        keys(i) = curve == curves::morton ? mortonKey(qx, qy) : hilbertKey(qx, qy);
+      });
+  return keys;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+computeReordering(PolytopeSoup<HostMemSpace> const & soup, int32_t const curve)
+    -> Reordering
+{
+  PROFILE_SCOPE("juno::computeReordering");
+  Int const num_vertices = soup.numVertices();
+  Int const num_elements = soup.numElements();
+  auto const & x = soup.x();
+  auto const & y = soup.y();
+  auto const & offsets = soup.elementOffsets();
+  auto const & vertices = soup.elementVertices();
+
+  AABB2 box;
+  for (Int i = 0; i < num_vertices; ++i) {
+    box.grow(Vec2{x(i), y(i)});
+  }
+
+  // Vertices by their coordinates
+  Reordering ordering;
+  ordering.vertex_order = sortByKey(curveKeys(
+      num_vertices, box, curve, [&](Int const i) { return x(i); },
+      [&](Int const i) { return y(i); }));
+
+  // Elements by their centroids, the mean of their vertices
+  auto const centroid = [&](Int const e, auto const & coord) {
+    Float sum = 0;
+    for (Int k = offsets(e); k < offsets(e + 1); ++k) {
+      sum += coord(vertices(k));
+    }
+    return sum / static_cast<Float>(offsets(e + 1) - offsets(e));
+  };
+  ordering.element_order = sortByKey(curveKeys(
+      num_elements, box, curve, [&](Int const e) { return centroid(e, x); },
+      [&](Int const e) { return centroid(e, y); }));
+  return ordering;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+applyReordering(PolytopeSoup<HostMemSpace> const & soup, Reordering const & ordering)
+    -> PolytopeSoup<HostMemSpace>
+{
+  PROFILE_SCOPE("juno::applyReordering");
+  Int const num_vertices = soup.numVertices();
+  Int const num_elements = soup.numElements();
+  auto const & vertex_order = ordering.vertex_order;
+  auto const & element_order = ordering.element_order;
+  auto const & old_offsets = soup.elementOffsets();
+  auto const & old_vertices = soup.elementVertices();
+
+  // The new index of each old vertex and element
+  IntView const vertex_rank(noInit("vertex_rank"), static_cast<size_t>(num_vertices));
+  IntView const element_rank(noInit("element_rank"), static_cast<size_t>(num_elements));
+  Kokkos::parallel_for(
+      "juno::applyReordering::rank", rangePolicy<HostExecSpace>(0, num_vertices),
+      [&](Int const i) { vertex_rank(vertex_order(i)) = i; });
+  Kokkos::parallel_for(
+      "juno::applyReordering::rank", rangePolicy<HostExecSpace>(0, num_elements),
+      [&](Int const i) { element_rank(element_order(i)) = i; });
+
+  PolytopeSoup<HostMemSpace> result(num_vertices, num_elements,
+                                    static_cast<Int>(old_vertices.size()));
+  Kokkos::parallel_for(
+      "juno::applyReordering::vertices", rangePolicy<HostExecSpace>(0, num_vertices),
+      [&](Int const i) {
+        Int const old = vertex_order(i);
+        result.x()(i) = soup.x()(old);
+        result.y()(i) = soup.y()(old);
+        result.z()(i) = soup.z()(old);
+      });
+
+  // Offsets by a prefix sum of the sizes, then the vertices of each element
+  auto const & offsets = result.elementOffsets();
+  for (Int i = 0; i < num_elements; ++i) {
+    Int const old = element_order(i);
+    offsets(i + 1) = offsets(i) + old_offsets(old + 1) - old_offsets(old);
+  }
+  Kokkos::parallel_for(
+      "juno::applyReordering::elements", rangePolicy<HostExecSpace>(0, num_elements),
+      [&](Int const i) {
+        Int const old = element_order(i);
+        result.elementTypes()(i) = soup.elementTypes()(old);
+        Int const n = old_offsets(old + 1) - old_offsets(old);
+        for (Int k = 0; k < n; ++k) {
+          result.elementVertices()(offsets(i) + k) =
+              vertex_rank(old_vertices(old_offsets(old) + k));
+        }
+      });
+
+  // Element sets, renumbered and sorted
+  auto const & set_offsets = soup.elementSetOffsets();
+  auto const & old_set_elements = soup.elementSetElements();
+  IntView const set_elements(noInit("soup_element_set_elements"),
+                             old_set_elements.size());
+  Kokkos::parallel_for(
+      "juno::applyReordering::sets", rangePolicy<HostExecSpace>(0, soup.numElementSets()),
+      [&](Int const s) {
+        for (Int k = set_offsets(s); k < set_offsets(s + 1); ++k) {
+          set_elements(k) = element_rank(old_set_elements(k));
+        }
+        std::sort(set_elements.data() + set_offsets(s),
+                  set_elements.data() + set_offsets(s + 1));
+      });
+  result.setElementSets(soup.elementSetNames(), set_offsets, set_elements);
+  return result;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+reorderSoup(PolytopeSoup<HostMemSpace> const & soup, int32_t const curve)
+    -> PolytopeSoup<HostMemSpace>
+{
+  PROFILE_SCOPE("juno::reorderSoup");
+  auto result = applyReordering(soup, computeReordering(soup, curve));
+
+  // The bandwidth only applies to meshes of faces
+  bool const report = logger::level >= logger::levels::info && soup.numElements() > 0;
+  bool is_faces = true;
+  for (Int i = 0; report && is_faces && i < soup.numElements(); ++i) {
+    int8_t const type = soup.elementTypes()(i);
+    is_faces = type == vtk_types::triangle || type == vtk_types::quad ||
+               type == vtk_types::polygon;
+  }
+  if (report && is_faces) {
+    auto const before = faceAdjacencyBandwidth(makeFaceVertexMesh(soup));
+    auto const after = faceAdjacencyBandwidth(makeFaceVertexMesh(result));
+    LOG_INFO("Reordered ", soup.numElements(), " faces along the ",
+             curve == curves::morton ? "Morton" : "Hilbert",
+             " curve. Face adjacency bandwidth: max ", before.max, " -> ", after.max,
+             ", mean ", before.mean, " -> ", after.mean);
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+faceAdjacencyBandwidth(FaceVertexMesh<HostMemSpace> const & mesh) -> Bandwidth
+{
+  PROFILE_SCOPE("juno::faceAdjacencyBandwidth");
+  Int const num_faces = mesh.numFaces();
+  IntView const max_distance("max_distance", static_cast<size_t>(num_faces));
+  Kokkos::View<int64_t *, HostMemSpace> const sum_distance(
+      "sum_distance", static_cast<size_t>(num_faces));
+  IntView const num_neighbors("num_neighbors", static_cast<size_t>(num_faces));
+  Kokkos::parallel_for(
+      "juno::faceAdjacencyBandwidth", rangePolicy<HostExecSpace>(0, num_faces),
+      [&](Int const f) {
+        for (Int k = 0; k < mesh.faceSize(f); ++k) {
+          Int const g = mesh.edgeNeighbor(f, k);
+          if (g >= 0) {
+            Int const d = g > f ? g - f : f - g;
+            max_distance(f) = d > max_distance(f) ? d : max_distance(f);
+            sum_distance(f) += d;
+            ++num_neighbors(f);
+          }
+        }
+      });
+
+  Bandwidth bandwidth;
+  int64_t sum = 0;
+  int64_t count = 0;
+  for (Int f = 0; f < num_faces; ++f) {
+    bandwidth.max = max_distance(f) > bandwidth.max ? max_distance(f) : bandwidth.max;
+    sum += sum_distance(f);
+    count += num_neighbors(f);
+  }
+  if (count > 0) {
+    bandwidth.mean =
+        static_cast<Float>(static_cast<double>(sum) / static_cast<double>(count));
+  }
+  return bandwidth;
+}
+
+} // namespace juno
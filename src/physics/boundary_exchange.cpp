@@ -0,0 +1,235 @@
+#include <juno/common/assert.hpp>
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/mirrored_view.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/physics/boundary_exchange.hpp>
+
+#include <string>
+#include <vector>
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+auto
+makeBlockTrackLayout(BlockDecomposition const & blocks, Int const block,
+                     TrackParameters const & parameters) -> TrackLayout
+{
+  if (block < 0 || block >= blocks.numBlocks()) {
+    LOG_ERROR("makeBlockTrackLayout: block ", block, " is not one of the ",
+              blocks.numBlocks(), " blocks");
+    return {};
+  }
+  // The tracks of a box at the origin, so that every block rounds them the same
+  AABB2 origin_box;
+  origin_box.min = {0, 0};
+  origin_box.max = {blocks.blockWidth(), blocks.blockHeight()};
+  TrackLayout layout = makeTrackLayout(origin_box, parameters);
+  AABB2 const box = blocks.blockBox(block);
+  for (Ray2 & track : layout.tracks) {
+    track.origin = track.origin + box.min;
+  }
+  layout.box = box;
+  return layout;
+}
+
+//----------------------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------------------
+
+template <class MemSpace>
+BoundaryExchange<MemSpace>::BoundaryExchange(TrackLayout const & layout,
+                                             BlockDecomposition const & blocks,
+                                             Int const block, Communicator const & comm)
+    : _comm(comm)
+{
+  PROFILE_SCOPE("juno::BoundaryExchange");
+  if (blocks.numBlocks() != static_cast<Int>(comm.size()) ||
+      block != static_cast<Int>(comm.rank())) {
+    LOG_ERROR("BoundaryExchange: expected one block per rank, on the rank of the same "
+              "number, not block ", block, " of ", blocks.numBlocks(), " on rank ",
+              comm.rank(), " of ", comm.size());
+    *this = BoundaryExchange();
+    return;
+  }
+  Int const num_directions = 2 * layout.numTracks();
+  std::vector<Int> send_directions;
+  std::vector<Int> recv_directions;
+  std::vector<Int> fed(static_cast<size_t>(num_directions), 0);
+  for (int32_t s = 0; s < box_sides::count; ++s) {
+    _neighbors[s] = blocks.neighbor(block, s);
+    _send_offsets[s] = static_cast<Int>(send_directions.size());
+    _recv_offsets[s] = static_cast<Int>(recv_directions.size());
+    if (_neighbors[s] < 0) {
+      continue;
+    }
+    // The directions that leave through the side, and those that the directions which
+    // leave the neighbor through the opposite side translate into
+    int32_t const opposite = oppositeSide(s);
+    for (Int i = 0; i < num_directions; ++i) {
+      auto const side = layout.exit_sides[static_cast<size_t>(i)];
+      if (side == s) {
+        send_directions.push_back(i);
+      }
+      if (side == opposite) {
+        Int const j = layout.translated_links[static_cast<size_t>(i)];
+        recv_directions.push_back(j);
+        fed[static_cast<size_t>(j)] = 1;
+      }
+    }
+  }
+  _send_offsets[box_sides::count] = static_cast<Int>(send_directions.size());
+  _recv_offsets[box_sides::count] = static_cast<Int>(recv_directions.size());
+
+  for (int32_t s = 0; s < box_sides::count; ++s) {
+    if (_neighbors[s] >= 0 && _neighbors[s] != block && comm.size() == 1) {
+      LOG_ERROR("BoundaryExchange: no MPI to exchange with rank ", _neighbors[s]);
+      *this = BoundaryExchange();
+      return;
+    }
+  }
+  _send_directions =
+      toView<MemSpace>("juno::BoundaryExchange::send_directions", send_directions);
+  _recv_directions =
+      toView<MemSpace>("juno::BoundaryExchange::recv_directions", recv_directions);
+  _fed = toView<MemSpace>("juno::BoundaryExchange::fed", fed);
+  LOG_DEBUG("BoundaryExchange: block ", block, " sends ", numSent(),
+            " and receives ", numReceived(), " directions");
+}
+
+//----------------------------------------------------------------------------------------
+// Exchanging
+//----------------------------------------------------------------------------------------
+
+template <class MemSpace>
+auto
+BoundaryExchange<MemSpace>::messageData(Buffer const & buffer, Int const first) const
+    -> Float *
+{
+  auto const offset = static_cast<size_t>(first) * static_cast<size_t>(_angular_size);
+  return staged() ? buffer.host().data() + offset : buffer.device().data() + offset;
+}
+
+template <class MemSpace>
+void
+BoundaryExchange<MemSpace>::begin(FloatView const & psi_out, Int const angular_size)
+{
+  PROFILE_SCOPE("juno::BoundaryExchange::begin");
+  ASSERT_ASSUME(!_in_flight);
+  if (angular_size != _angular_size) {
+    _angular_size = angular_size;
+    _send = Buffer("juno::BoundaryExchange::send", numSent() * angular_size);
+    _recv = Buffer("juno::BoundaryExchange::recv", numReceived() * angular_size);
+  }
+  ExecSpace const space;
+
+  // Pack the outgoing fluxes, side by side
+  auto const directions = _send_directions;
+  auto const send = _send.device();
+  Kokkos::parallel_for(
+      "juno::BoundaryExchange::pack", rangePolicy<ExecSpace>(0, numSent(), space),
+      KOKKOS_LAMBDA(Int const k) {
+        Int const from = directions(k) * angular_size;
+        for (Int j = 0; j < angular_size; ++j) {
+          send(k * angular_size + j) = psi_out(from + j);
+        }
+      });
+  if (staged()) {
+    _send.toHost(space);
+  }
+  space.fence("juno::BoundaryExchange::begin");
+
+  // Receive on each side what the neighbor sends through the opposite side, which is
+  // tagged with that side
+  for (int32_t s = 0; s < box_sides::count; ++s) {
+    Int const neighbor = _neighbors[s];
+    if (neighbor < 0) {
+      continue;
+    }
+    int32_t const opposite = oppositeSide(s);
+    auto const count = _recv_offsets[s + 1] - _recv_offsets[s];
+    if (neighbor == static_cast<Int>(_comm.rank())) {
+      // Our own message through the opposite side
+      auto const recv_range = std::make_pair(_recv_offsets[s] * angular_size,
+                                             _recv_offsets[s + 1] * angular_size);
+      auto const send_range = std::make_pair(_send_offsets[opposite] * angular_size,
+                                             _send_offsets[opposite + 1] * angular_size);
+      Kokkos::deep_copy(space, Kokkos::subview(_recv.device(), recv_range),
+                        Kokkos::subview(_send.device(), send_range));
+      continue;
+    }
+    auto const bytes = static_cast<size_t>(count) * static_cast<size_t>(angular_size) *
+                       sizeof(Float);
+    _comm.receive(messageData(_recv, _recv_offsets[s]), bytes,
+                  static_cast<int32_t>(neighbor), opposite, _requests);
+  }
+  for (int32_t s = 0; s < box_sides::count; ++s) {
+    Int const neighbor = _neighbors[s];
+    if (neighbor < 0 || neighbor == static_cast<Int>(_comm.rank())) {
+      continue;
+    }
+    auto const count = _send_offsets[s + 1] - _send_offsets[s];
+    auto const bytes = static_cast<size_t>(count) * static_cast<size_t>(angular_size) *
+                       sizeof(Float);
+    _comm.send(messageData(_send, _send_offsets[s]), bytes,
+               static_cast<int32_t>(neighbor), s, _requests);
+  }
+  _in_flight = true;
+}
+
+template <class MemSpace>
+void
+BoundaryExchange<MemSpace>::progress()
+{
+  if (_in_flight) {
+    _requests.testAll();
+  }
+}
+
+template <class MemSpace>
+void
+BoundaryExchange<MemSpace>::finish(FloatView const & psi_in)
+{
+  PROFILE_SCOPE("juno::BoundaryExchange::finish");
+  if (!_in_flight) {
+    return;
+  }
+  _requests.waitAll();
+  _in_flight = false;
+  ExecSpace const space;
+  if (staged()) {
+    // The messages from ourself were copied on the device, and the staged copy of the
+    // others must not overwrite them
+    for (int32_t s = 0; s < box_sides::count; ++s) {
+      if (_neighbors[s] < 0 || _neighbors[s] == static_cast<Int>(_comm.rank())) {
+        continue;
+      }
+      auto const range = std::make_pair(_recv_offsets[s] * _angular_size,
+                                        _recv_offsets[s + 1] * _angular_size);
+      Kokkos::deep_copy(space, Kokkos::subview(_recv.device(), range),
+                        Kokkos::subview(_recv.host(), range));
+    }
+  }
+
+  // Unpack the incoming fluxes
+  Int const angular_size = _angular_size;
+  auto const directions = _recv_directions;
+  auto const recv = _recv.device();
+  Kokkos::parallel_for(
+      "juno::BoundaryExchange::unpack", rangePolicy<ExecSpace>(0, numReceived(), space),
+      KOKKOS_LAMBDA(Int const k) {
+        Int const to = directions(k) * angular_size;
+        for (Int j = 0; j < angular_size; ++j) {
+          psi_in(to + j) = recv(k * angular_size + j);
+        }
+      });
+}
+
+template class BoundaryExchange<HostMemSpace>;
+
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+template class BoundaryExchange<DeviceMemSpace>;
+#endif
+
+} // namespace juno
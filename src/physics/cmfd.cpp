@@ -0,0 +1,130 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/common/scan.hpp>
+#include <juno/math/vec2.hpp>
+#include <juno/physics/cmfd.hpp>
+
+namespace juno
+{
+
+namespace
+{
+
+// The distance from the centroid of face f to the line of its edge k
+template <class MemSpace>
+HOSTDEV auto
+centroidToEdge(FaceVertexMesh<MemSpace> const & mesh, Vec2 const centroid, Int const f,
+               Int const k) noexcept -> Float
+{
+  Vec2 const a = mesh.getFaceVertex(f, k);
+  Vec2 const b = mesh.getFaceVertex(f, (k + 1) % mesh.faceSize(f));
+  return Kokkos::abs(cross(b - a, centroid - a)) / distance(a, b);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+template <class MemSpace>
+auto
+assembleDiffusionOperator(FaceVertexMesh<MemSpace> const & mesh,
+                          Kokkos::View<Float *, MemSpace> const & diffusion,
+                          Kokkos::View<Float *, MemSpace> const & removal,
+                          int32_t const boundary) -> CSRMatrix<MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  using IntView = Kokkos::View<Int *, MemSpace>;
+  PROFILE_SCOPE("juno::assembleDiffusionOperator");
+  Int const num_faces = mesh.numFaces();
+  auto const size = static_cast<size_t>(num_faces);
+
+  // Each row: the face, and its neighbors across interior edges
+  IntView const counts("counts", size);
+  Kokkos::parallel_for(
+      "juno::assembleDiffusionOperator", rangePolicy<ExecSpace>(0, num_faces),
+      KOKKOS_LAMBDA(Int const f) {
+        Int count = 1;
+        for (Int k = 0; k < mesh.faceSize(f); ++k) {
+          count += mesh.edgeNeighbor(f, k) >= 0 ? 1 : 0;
+        }
+        counts(f) = count;
+      });
+
+  CSRMatrix<MemSpace> a;
+  a.num_rows = num_faces;
+  a.num_cols = num_faces;
+  a.row_offsets = IntView("row_offsets", size + 1);
+  Size const num_entries = impl::exclusiveScan(counts, a.row_offsets);
+  if (num_entries > intMax()) {
+    LOG_ERROR("assembleDiffusionOperator: ", num_entries,
+              " entries are too many for Int");
+    return {};
+  }
+  a.columns = IntView("columns", static_cast<size_t>(num_entries));
+  a.values = Kokkos::View<Float *, MemSpace>("values", static_cast<size_t>(num_entries));
+
+  bool const vacuum = boundary == cmfd_boundaries::vacuum;
+  Kokkos::parallel_for(
+      "juno::assembleDiffusionOperator", rangePolicy<ExecSpace>(0, num_faces),
+      KOKKOS_LAMBDA(Int const f) {
+        Int const begin = a.row_offsets(f);
+        Vec2 const cf = mesh.faceCentroid(f);
+        Float const df = diffusion(f);
+        Float diagonal = removal(f) * mesh.faceArea(f);
+        Int e = begin + 1;
+        for (Int k = 0; k < mesh.faceSize(f); ++k) {
+          Int const g = mesh.edgeNeighbor(f, k);
+          Float const length =
+              distance(mesh.getFaceVertex(f, k),
+                       mesh.getFaceVertex(f, (k + 1) % mesh.faceSize(f)));
+          Float const hf = centroidToEdge(mesh, cf, f, k);
+          if (g >= 0) {
+            // The same edge, seen from g, gives the same coupling, so A is symmetric
+            Int kg = 0;
+            while (kg + 1 < mesh.faceSize(g) && mesh.edgeNeighbor(g, kg) != f) {
+              ++kg;
+            }
+            Float const hg = centroidToEdge(mesh, mesh.faceCentroid(g), g, kg);
+            Float const coupling = length / (hf / df + hg / diffusion(g));
+            a.columns(e) = g;
+            a.values(e) = -coupling;
+            diagonal += coupling;
+            ++e;
+          } else if (vacuum) {
+            diagonal += df * length / (hf + 2 * df);
+          }
+        }
+        a.columns(begin) = f;
+        a.values(begin) = diagonal;
+
+        // Sort the row by column. Rows are short, so by insertion.
+        for (Int i = begin + 1; i < e; ++i) {
+          Int const column = a.columns(i);
+          Float const value = a.values(i);
+          Int j = i;
+          while (j > begin && a.columns(j - 1) > column) {
+            a.columns(j) = a.columns(j - 1);
+            a.values(j) = a.values(j - 1);
+            --j;
+          }
+          a.columns(j) = column;
+          a.values(j) = value;
+        }
+      });
+  return a;
+}
+
+template auto
+assembleDiffusionOperator<HostMemSpace>(FaceVertexMesh<HostMemSpace> const &,
+                                        Kokkos::View<Float *, HostMemSpace> const &,
+                                        Kokkos::View<Float *, HostMemSpace> const &,
+                                        int32_t) -> CSRMatrix<HostMemSpace>;
+
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+template auto
+assembleDiffusionOperator<DeviceMemSpace>(FaceVertexMesh<DeviceMemSpace> const &,
+                                          Kokkos::View<Float *, DeviceMemSpace> const &,
+                                          Kokkos::View<Float *, DeviceMemSpace> const &,
+                                          int32_t) -> CSRMatrix<DeviceMemSpace>;
+#endif
+
+} // namespace juno
@@ -0,0 +1,55 @@
+#include <juno/common/logger.hpp>
+#include <juno/physics/cross_section.hpp>
+
+#include <cmath> // std::isfinite, std::abs
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+auto
+validate(CrossSections<HostMemSpace> const & xs) -> bool
+{
+  Int const num_groups = xs.numGroups();
+  Float const tolerance = static_cast<Float>(1e-4);
+  for (Int e = 0; e < xs.numEntries(); ++e) {
+    for (Int r = 0; r < reactions::count; ++r) {
+      for (Int g = 0; g < num_groups; ++g) {
+        Float const value = xs(e, r, g);
+        if (!std::isfinite(value) || value < 0) {
+          LOG_ERROR("Cross sections: entry ", e, " has value ", value, " for reaction ",
+                    r, " in group ", g);
+          return false;
+        }
+      }
+    }
+    for (Int g = 0; g < num_groups; ++g) {
+      for (Int to = 0; to < num_groups; ++to) {
+        Float const value = xs.scatter(e, g, to);
+        if (!std::isfinite(value) || value < 0) {
+          LOG_ERROR("Cross sections: entry ", e, " has value ", value,
+                    " for scattering from group ", g, " to ", to);
+          return false;
+        }
+      }
+      if (xs(e, reactions::total, g) < xs(e, reactions::absorption, g)) {
+        LOG_ERROR("Cross sections: entry ", e, " has a total less than the absorption in",
+                  " group ", g);
+        return false;
+      }
+    }
+    Float chi_sum = 0;
+    for (Int g = 0; g < num_groups; ++g) {
+      chi_sum += xs(e, reactions::chi, g);
+    }
+    // A nonfissile entry has no spectrum. A spectrum is never negative.
+    if (chi_sum > 0 && std::abs(chi_sum - 1) > tolerance) {
+      LOG_ERROR("Cross sections: the fission spectrum of entry ", e, " sums to ",
+                chi_sum);
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace juno
@@ -0,0 +1,328 @@
+#include <juno/common/assert.hpp>
+#include <juno/common/atomic_file.hpp>
+#include <juno/common/hash.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/physics/cross_section_library.hpp>
+
+#include <cstring>    // std::memchr, std::memcmp, std::memcpy
+#include <fstream> // std::ofstream
+
+namespace juno
+{
+
+namespace
+{
+
+char constexpr magic[8] = {'J', 'U', 'N', 'O', 'X', 'S', 'L', 'B'};
+uint32_t constexpr endianness = 0x01020304;
+
+// The beginning of the file. The index and the names follow, then the data of each
+// nuclide at an aligned offset.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t endianness;
+  uint32_t num_groups;
+  uint32_t num_nuclides;
+  uint64_t names_bytes; // null-terminated names, in the order of the index
+  uint64_t index_hash;  // of the index and the names
+};
+
+struct IndexEntry {
+  uint64_t offset; // of the data, from the beginning of the file
+  uint64_t hash;   // of the data
+  int32_t zaid;
+  uint32_t padding;
+};
+
+auto
+alignUp(uint64_t const n) -> uint64_t
+{
+  uint64_t const a = cross_section_library::alignment;
+  return (n + a - 1) / a * a;
+}
+
+// The number of doubles in the data of a nuclide
+auto
+dataSize(uint64_t const num_groups) -> uint64_t
+{
+  return (reactions::count + num_groups) * num_groups;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+writeCrossSectionLibrary(std::string const & filename,
+                         std::vector<Nuclide> const & nuclides) -> bool
+{
+  PROFILE_SCOPE("juno::writeCrossSectionLibrary");
+  if (nuclides.empty()) {
+    LOG_ERROR("Cross section library '", filename, "' would have no nuclides");
+    return false;
+  }
+  Int const num_groups = nuclides[0].num_groups;
+  for (auto const & nuclide : nuclides) {
+    if (!validate(nuclide)) {
+      return false;
+    }
+    if (nuclide.num_groups != num_groups) {
+      LOG_ERROR("Nuclide ", nuclide.name.c_str(), " has ", nuclide.num_groups,
+                " groups, but ", nuclides[0].name.c_str(), " has ", num_groups);
+      return false;
+    }
+  }
+
+  // The data of each nuclide as doubles
+  auto const groups = static_cast<uint64_t>(num_groups);
+  std::vector<std::vector<double>> data(nuclides.size());
+  for (size_t n = 0; n < nuclides.size(); ++n) {
+    auto const & nuclide = nuclides[n];
+    auto & values = data[n];
+    values.reserve(dataSize(groups));
+    for (auto const * v : {&nuclide.total, &nuclide.absorption, &nuclide.nu_fission,
+                           &nuclide.chi, &nuclide.scatter}) {
+      for (Float const x : *v) {
+        values.push_back(static_cast<double>(x));
+      }
+    }
+  }
+
+  std::string names;
+  for (auto const & nuclide : nuclides) {
+    names += nuclide.name;
+    names += '\0';
+  }
+  Header header = {};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = cross_section_library::version;
+  header.endianness = endianness;
+  header.num_groups = static_cast<uint32_t>(num_groups);
+  header.num_nuclides = static_cast<uint32_t>(nuclides.size());
+  header.names_bytes = names.size();
+  std::vector<IndexEntry> index(nuclides.size());
+  uint64_t offset =
+      alignUp(sizeof(Header) + index.size() * sizeof(IndexEntry) + names.size());
+  for (size_t n = 0; n < nuclides.size(); ++n) {
+    uint64_t const bytes = data[n].size() * sizeof(double);
+    index[n] = {offset, hashBytes(data[n].data(), bytes), nuclides[n].zaid, 0};
+    offset = alignUp(offset + bytes);
+  }
+  header.index_hash =
+      hashCombine(hashBytes(index.data(), index.size() * sizeof(IndexEntry)),
+                  hashBytes(names.data(), names.size()));
+
+  bool const written =
+      writeFileAtomically(filename, "cross section library", [&](std::ofstream & file) {
+        char const padding[cross_section_library::alignment] = {};
+        auto const write = [&file](void const * bytes, uint64_t const n) {
+          file.write(static_cast<char const *>(bytes), static_cast<std::streamsize>(n));
+        };
+        write(&header, sizeof(Header));
+        write(index.data(), index.size() * sizeof(IndexEntry));
+        write(names.data(), names.size());
+        uint64_t position =
+            sizeof(Header) + index.size() * sizeof(IndexEntry) + names.size();
+        for (size_t n = 0; n < nuclides.size(); ++n) {
+          write(padding, index[n].offset - position);
+          write(data[n].data(), data[n].size() * sizeof(double));
+          position = index[n].offset + data[n].size() * sizeof(double);
+        }
+      });
+  if (!written) {
+    return false;
+  }
+  LOG_INFO("Wrote cross section library: ", filename);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+CrossSectionLibrary::CrossSectionLibrary(std::string const & filename)
+    : _file(filename)
+{
+  PROFILE_SCOPE("juno::CrossSectionLibrary::CrossSectionLibrary");
+  if (!_file.isOpen()) {
+    return;
+  }
+
+  // Check the header and the index, without touching the data
+  Header header = {};
+  if (_file.size() < sizeof(Header)) {
+    LOG_ERROR("Cross section library '", filename, "' is too small to be a library");
+    _file.close();
+    return;
+  }
+  std::memcpy(&header, _file.data(), sizeof(Header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+    LOG_ERROR("'", filename, "' is not a cross section library");
+    _file.close();
+    return;
+  }
+  if (header.version != cross_section_library::version ||
+      header.endianness != endianness) {
+    LOG_ERROR("Cross section library '", filename, "' was written by version ",
+              header.version, " or on a machine of another endianness");
+    _file.close();
+    return;
+  }
+  uint64_t const index_bytes = uint64_t{header.num_nuclides} * sizeof(IndexEntry);
+  if (_file.size() - sizeof(Header) < index_bytes + header.names_bytes) {
+    LOG_ERROR("Cross section library '", filename, "' is truncated");
+    _file.close();
+    return;
+  }
+  char const * const index_data = _file.data() + sizeof(Header);
+  char const * const names = index_data + index_bytes;
+  if (hashCombine(hashBytes(index_data, index_bytes),
+                  hashBytes(names, header.names_bytes)) != header.index_hash) {
+    LOG_ERROR("The index of cross section library '", filename, "' is damaged");
+    _file.close();
+    return;
+  }
+
+  uint64_t const data_bytes = dataSize(header.num_groups) * sizeof(double);
+  _num_groups = static_cast<Int>(header.num_groups);
+  _index_hash = header.index_hash;
+  _index.resize(header.num_nuclides);
+  _by_name.reserve(header.num_nuclides);
+  char const * name = names;
+  char const * const names_end = names + header.names_bytes;
+  for (uint32_t i = 0; i < header.num_nuclides; ++i) {
+    IndexEntry entry = {};
+    std::memcpy(&entry, index_data + i * sizeof(IndexEntry), sizeof(IndexEntry));
+    auto const * const name_end = static_cast<char const *>(
+        std::memchr(name, '\0', static_cast<size_t>(names_end - name)));
+    if (name_end == nullptr || entry.offset > _file.size() ||
+        data_bytes > _file.size() - entry.offset) {
+      LOG_ERROR("Cross section library '", filename, "' is truncated");
+      _index.clear();
+      _by_name.clear();
+      _file.close();
+      return;
+    }
+    auto & e = _index[i];
+    e.name.assign(name, name_end);
+    e.zaid = entry.zaid;
+    e.offset = entry.offset;
+    e.hash = entry.hash;
+    _by_name.emplace(e.name, static_cast<Int>(i));
+    name = name_end + 1;
+  }
+  _slots = std::make_unique<Slot[]>(header.num_nuclides);
+  _num_loaded = std::make_unique<std::atomic<Int>>(0);
+  LOG_INFO("Opened cross section library '", filename, "' with ", numNuclides(),
+           " nuclides");
+}
+
+//----------------------------------------------------------------------------------------
+auto
+CrossSectionLibrary::name(Int const i) const -> std::string const &
+{
+  ASSERT_ASSUME(0 <= i && i < numNuclides());
+  return _index[static_cast<size_t>(i)].name;
+}
+
+auto
+CrossSectionLibrary::zaid(Int const i) const -> int32_t
+{
+  ASSERT_ASSUME(0 <= i && i < numNuclides());
+  return _index[static_cast<size_t>(i)].zaid;
+}
+
+auto
+CrossSectionLibrary::dataHash(Int const i) const -> uint64_t
+{
+  ASSERT_ASSUME(0 <= i && i < numNuclides());
+  return _index[static_cast<size_t>(i)].hash;
+}
+
+auto
+CrossSectionLibrary::find(std::string const & name) const -> Int
+{
+  auto const it = _by_name.find(name);
+  return it == _by_name.end() ? -1 : it->second;
+}
+
+//----------------------------------------------------------------------------------------
+void
+CrossSectionLibrary::read(Int const i, Nuclide & nuclide) const
+{
+  auto const & entry = _index[static_cast<size_t>(i)];
+  auto const num_groups = static_cast<size_t>(_num_groups);
+  size_t const bytes = dataSize(num_groups) * sizeof(double);
+  char const * const data = _file.data() + entry.offset;
+  if (hashBytes(data, bytes) != entry.hash) {
+    LOG_ERROR("The data of nuclide ", entry.name.c_str(), " is damaged");
+    return;
+  }
+  nuclide.name = entry.name;
+  nuclide.zaid = entry.zaid;
+  size_t position = 0;
+  auto const take = [&](std::vector<Float> & values, size_t const n) {
+    values.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+      double x = 0;
+      std::memcpy(&x, data + (position + k) * sizeof(double), sizeof(double));
+      values[k] = static_cast<Float>(x);
+    }
+    position += n;
+  };
+  take(nuclide.total, num_groups);
+  take(nuclide.absorption, num_groups);
+  take(nuclide.nu_fission, num_groups);
+  take(nuclide.chi, num_groups);
+  take(nuclide.scatter, num_groups * num_groups);
+  // Set last, so a damaged nuclide has no groups
+  nuclide.num_groups = _num_groups;
+}
+
+auto
+CrossSectionLibrary::nuclide(Int const i) const -> Nuclide const &
+{
+  ASSERT_ASSUME(0 <= i && i < numNuclides());
+  Slot & slot = _slots[static_cast<size_t>(i)];
+  std::call_once(slot.once, [&]() {
+    read(i, slot.nuclide);
+    _num_loaded->fetch_add(1, std::memory_order_relaxed);
+  });
+  return slot.nuclide;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+CrossSectionLibrary::load(std::vector<std::string> const & names) const
+    -> CrossSections<HostMemSpace>
+{
+  PROFILE_SCOPE("juno::CrossSectionLibrary::load");
+  std::vector<Int> ids(names.size());
+  for (size_t n = 0; n < names.size(); ++n) {
+    ids[n] = find(names[n]);
+    if (ids[n] < 0) {
+      LOG_ERROR("Nuclide ", names[n].c_str(), " is not in the cross section library");
+      return {};
+    }
+  }
+
+  // Read the nuclides in parallel, then check that none was damaged
+  auto const num_nuclides = static_cast<Int>(ids.size());
+  CrossSections<HostMemSpace> xs("nuclides", num_nuclides, _num_groups);
+  Int num_damaged = 0;
+  Kokkos::parallel_reduce(
+      "juno::CrossSectionLibrary::load", rangePolicy<HostExecSpace>(0, num_nuclides),
+      [&](Int const n, Int & damaged) {
+        Nuclide const & data = nuclide(ids[static_cast<size_t>(n)]);
+        if (data.num_groups == 0) {
+          ++damaged;
+          return;
+        }
+        packNuclide(data, xs, n);
+      },
+      num_damaged);
+  if (num_damaged != 0) {
+    return {};
+  }
+  return xs;
+}
+
+} // namespace juno
@@ -0,0 +1,221 @@
+#include <juno/common/hash.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/physics/material.hpp>
+
+#include <type_traits> // std::is_same_v
+#include <utility>     // std::move
+
+namespace juno
+{
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------
+auto
+checkMaterials(CrossSections<HostMemSpace> const & nuclides,
+               std::vector<Material> const & materials) -> bool
+{
+  for (auto const & material : materials) {
+    if (material.nuclides.size() != material.number_densities.size()) {
+      LOG_ERROR("Material ", material.name.c_str(), " has ", material.nuclides.size(),
+                " nuclides, but ", material.number_densities.size(),
+                " number densities");
+      return false;
+    }
+    for (Int const n : material.nuclides) {
+      if (n < 0 || n >= nuclides.numEntries()) {
+        LOG_ERROR("Material ", material.name.c_str(), " refers to nuclide ", n, ", but ",
+                  "there are ", nuclides.numEntries());
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+// Overwrite entry m of xs with the macroscopic cross sections of the material. The
+// rows are aligned and padded, so the loops over groups vectorize.
+void
+mix(CrossSections<HostMemSpace> const & nuclides, Material const & material,
+    CrossSections<HostMemSpace> const & xs, Int const m)
+{
+  Int const stride = xs.groupStride();
+  Int const num_groups = xs.numGroups();
+  for (Int r = 0; r < reactions::count; ++r) {
+    Float * RESTRICT const row = xs.row(m, r);
+    for (Int g = 0; g < stride; ++g) {
+      row[g] = 0;
+    }
+  }
+  for (Int g = 0; g < num_groups; ++g) {
+    Float * RESTRICT const row = xs.scatterRow(m, g);
+    for (Int to = 0; to < stride; ++to) {
+      row[to] = 0;
+    }
+  }
+
+  Float fission_weight = 0;
+  for (size_t i = 0; i < material.nuclides.size(); ++i) {
+    Int const n = material.nuclides[i];
+    Float const density = material.number_densities[i];
+    for (Int const r : {reactions::total, reactions::absorption, reactions::nu_fission}) {
+      Float * RESTRICT const row = xs.row(m, r);
+      Float const * RESTRICT const micro = nuclides.row(n, r);
+      for (Int g = 0; g < stride; ++g) {
+        row[g] += density * micro[g];
+      }
+    }
+    for (Int g = 0; g < num_groups; ++g) {
+      Float * RESTRICT const row = xs.scatterRow(m, g);
+      Float const * RESTRICT const micro = nuclides.scatterRow(n, g);
+      for (Int to = 0; to < stride; ++to) {
+        row[to] += density * micro[to];
+      }
+    }
+
+    // Weight the fission spectrum by the fission neutrons of the nuclide
+    Float const * RESTRICT const nu_fission = nuclides.row(n, reactions::nu_fission);
+    Float weight = 0;
+    for (Int g = 0; g < stride; ++g) {
+      weight += nu_fission[g];
+    }
+    weight *= density;
+    fission_weight += weight;
+    Float * RESTRICT const chi = xs.row(m, reactions::chi);
+    Float const * RESTRICT const micro = nuclides.row(n, reactions::chi);
+    for (Int g = 0; g < stride; ++g) {
+      chi[g] += weight * micro[g];
+    }
+  }
+  if (fission_weight > 0) {
+    Float * RESTRICT const chi = xs.row(m, reactions::chi);
+    Float const inv_weight = 1 / fission_weight;
+    for (Int g = 0; g < stride; ++g) {
+      chi[g] *= inv_weight;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// The hash of everything the mixed cross sections of a material depend on
+auto
+compositionHash(uint64_t const nuclides_hash, Material const & material) -> uint64_t
+{
+  uint64_t h = hashCombine(nuclides_hash, material.nuclides.size());
+  h = hashCombine(h, hashBytes(material.nuclides.data(),
+                               material.nuclides.size() * sizeof(Int)));
+  return hashCombine(h, hashBytes(material.number_densities.data(),
+                                  material.number_densities.size() * sizeof(Float)));
+}
+
+auto
+nuclidesHash(CrossSections<HostMemSpace> const & nuclides) -> uint64_t
+{
+  uint64_t h = hashCombine(static_cast<uint64_t>(nuclides.numEntries()),
+                           static_cast<uint64_t>(nuclides.numGroups()));
+  auto const & vectors = nuclides.vectorValues();
+  auto const & scatter = nuclides.scatterValues();
+  h = hashCombine(h, hashBytes(vectors.data(), vectors.size() * sizeof(Float)));
+  return hashCombine(h, hashBytes(scatter.data(), scatter.size() * sizeof(Float)));
+}
+
+//----------------------------------------------------------------------------------------
+// The device copy of host cross sections. When the device is the host, this is the
+// host data itself, so there is nothing to copy or to keep in sync.
+template <class MemSpace>
+auto
+deviceCopy(CrossSections<HostMemSpace> const & host) -> CrossSections<MemSpace>
+{
+  if constexpr (std::is_same_v<MemSpace, HostMemSpace>) {
+    return host;
+  } else {
+    return host.template mirror<MemSpace>();
+  }
+}
+
+template <class MemSpace>
+void
+copyToDevice(CrossSections<HostMemSpace> const & host,
+             CrossSections<MemSpace> const & device)
+{
+  if constexpr (!std::is_same_v<MemSpace, HostMemSpace>) {
+    Kokkos::deep_copy(device.vectorValues(), host.vectorValues());
+    Kokkos::deep_copy(device.scatterValues(), host.scatterValues());
+  }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+mixMaterials(CrossSections<HostMemSpace> const & nuclides,
+             std::vector<Material> const & materials) -> CrossSections<HostMemSpace>
+{
+  PROFILE_SCOPE("juno::mixMaterials");
+  if (!checkMaterials(nuclides, materials)) {
+    return {};
+  }
+  auto const num_materials = static_cast<Int>(materials.size());
+  CrossSections<HostMemSpace> xs("materials", num_materials, nuclides.numGroups());
+  Kokkos::parallel_for(
+      "juno::mixMaterials", rangePolicy<HostExecSpace>(0, num_materials),
+      [&](Int const m) { mix(nuclides, materials[static_cast<size_t>(m)], xs, m); });
+  return xs;
+}
+
+//----------------------------------------------------------------------------------------
+MaterialCrossSections::MaterialCrossSections(
+    CrossSections<HostMemSpace> const & nuclides, std::vector<Material> const & materials)
+{
+  update(nuclides, materials);
+}
+
+//----------------------------------------------------------------------------------------
+auto
+MaterialCrossSections::update(CrossSections<HostMemSpace> const & nuclides,
+                              std::vector<Material> const & materials) -> Int
+{
+  PROFILE_SCOPE("juno::MaterialCrossSections::update");
+  if (!checkMaterials(nuclides, materials)) {
+    return 0;
+  }
+  uint64_t const nuclides_hash = nuclidesHash(nuclides);
+  std::vector<uint64_t> hashes(materials.size());
+  for (size_t m = 0; m < materials.size(); ++m) {
+    hashes[m] = compositionHash(nuclides_hash, materials[m]);
+  }
+
+  auto const num_materials = static_cast<Int>(materials.size());
+  if (num_materials != _host.numEntries() || nuclides.numGroups() != _host.numGroups()) {
+    _host = mixMaterials(nuclides, materials);
+    _device = deviceCopy<DeviceMemSpace>(_host);
+    _hashes = std::move(hashes);
+    return num_materials;
+  }
+
+  std::vector<Int> changed;
+  for (size_t m = 0; m < materials.size(); ++m) {
+    if (hashes[m] != _hashes[m]) {
+      changed.push_back(static_cast<Int>(m));
+    }
+  }
+  auto const num_changed = static_cast<Int>(changed.size());
+  if (num_changed == 0) {
+    return 0;
+  }
+  CrossSections<HostMemSpace> const & xs = _host;
+  Kokkos::parallel_for(
+      "juno::MaterialCrossSections::update", rangePolicy<HostExecSpace>(0, num_changed),
+      [&](Int const i) {
+        Int const m = changed[static_cast<size_t>(i)];
+        mix(nuclides, materials[static_cast<size_t>(m)], xs, m);
+      });
+  copyToDevice(_host, _device);
+  _hashes = std::move(hashes);
+  return num_changed;
+}
+
+} // namespace juno
@@ -0,0 +1,427 @@
+#include <juno/common/assert.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/mirrored_view.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/physics/moc.hpp>
+
+#include <cmath>   // std::sqrt
+#include <limits>  // std::numeric_limits
+#include <numbers> // std::numbers::pi
+
+namespace juno
+{
+
+namespace
+{
+
+Float constexpr four_pi = 4 * std::numbers::pi_v<Float>;
+
+// The rational exponential at about the precision of Float
+double constexpr rational_tolerance =
+    8 * static_cast<double>(std::numeric_limits<Float>::epsilon());
+using SweepRationalExp = RationalExp<rationalExpOrder(rational_tolerance)>;
+
+struct LibraryExp {
+  [[nodiscard]] HOSTDEV auto
+  operator()(Float const x) const noexcept -> Float
+  {
+    return Kokkos::exp(x);
+  }
+};
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------------------
+
+template <class MemSpace>
+MOCSweeper<MemSpace>::MOCSweeper(FaceGrid<MemSpace> const & grid,
+                                 TrackLayout const & layout, SweepOptions const & options)
+    : _grid(grid),
+      _options(options),
+      _num_tracks(layout.numTracks()),
+      _num_polar(layout.polar.num_angles)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  PROFILE_SCOPE("juno::MOCSweeper");
+  ASSERT_ASSUME(_options.tracks_per_batch > 0);
+  Int const num_azimuthal = layout.numAzimuthal();
+  Int const num_polar = _num_polar;
+
+  if (_options.exponential == sweep_exponentials::table) {
+    _exp_table = makeExpTable<MemSpace>(_options.exp_tolerance);
+    if (_exp_table.numIntervals() == 0) {
+      _options.exponential = sweep_exponentials::rational;
+    }
+  }
+  _tracks = toView<MemSpace>("juno::MOCSweeper::tracks", layout.tracks);
+  _azimuths = toView<MemSpace>("juno::MOCSweeper::azimuths", layout.azimuths);
+  _links = toView<MemSpace>("juno::MOCSweeper::links", layout.links);
+
+  // The weight of each azimuth and polar angle in the tallies, and the area that the
+  // tracks of each azimuth stand for, in the volumes
+  std::vector<Float> track_weights;
+  std::vector<Float> areas;
+  for (size_t a = 0; a < static_cast<size_t>(num_azimuthal); ++a) {
+    Float const w = layout.azimuthal_weights[a] * layout.spacing[a];
+    areas.push_back(2 * w);
+    for (Int p = 0; p < num_polar; ++p) {
+      track_weights.push_back(four_pi * w * layout.polar.weights[p] *
+                              layout.polar.sin_theta[p]);
+    }
+  }
+  for (Int p = 0; p < num_polar; ++p) {
+    _inv_sin_theta[p] = 1 / layout.polar.sin_theta[p];
+  }
+  _track_weights = toView<MemSpace>("juno::MOCSweeper::track_weights", track_weights);
+  auto const track_areas = toView<MemSpace>("juno::MOCSweeper::areas", areas);
+
+  // The unit of the quantized lengths: no segment is longer than the diagonal of the
+  // bounding box of its face
+  auto const mesh = _grid.mesh;
+  Float max_diagonal = 0;
+  Kokkos::parallel_reduce(
+      "juno::MOCSweeper::maxDiagonal", rangePolicy<ExecSpace>(0, mesh.numFaces()),
+      KOKKOS_LAMBDA(Int const f, Float & m) {
+        AABB2 const box = mesh.faceBoundingBox(f);
+        Float const d = box.width() * box.width() + box.height() * box.height();
+        m = d > m ? d : m;
+      },
+      Kokkos::Max<Float>(max_diagonal));
+  _length_scale = std::sqrt(max_diagonal) / static_cast<Float>(max_quantized_length);
+
+  // Trace the batches, tally the volumes, and keep the segments while they fit
+  auto const num_faces = static_cast<size_t>(mesh.numFaces());
+  AccumView const volumes("juno::MOCSweeper::volume_tally", num_faces);
+  auto const azimuths = _azimuths;
+  auto const scale = static_cast<FloatAccum>(_length_scale);
+  for (Int b = 0; b < numBatches(); ++b) {
+    auto const segments = segmentBatch(b);
+    if (segments.offsets.size() == 0) {
+      LOG_ERROR("MOCSweeper: the segments of a batch are too many for Int; reduce "
+                "SweepOptions::tracks_per_batch");
+      *this = MOCSweeper();
+      return;
+    }
+    Int const begin = b * _options.tracks_per_batch;
+    auto const offsets = segments.offsets;
+    auto const faces = segments.faces;
+    auto const lengths = segments.lengths;
+    Kokkos::parallel_for(
+        "juno::MOCSweeper::volumes",
+        rangePolicy<ExecSpace>(0, static_cast<Int>(offsets.size()) - 1),
+        KOKKOS_LAMBDA(Int const k) {
+          FloatAccum const area =
+              static_cast<FloatAccum>(track_areas(azimuths(begin + k))) * scale;
+          for (Int s = offsets(k); s < offsets(k + 1); ++s) {
+            Kokkos::atomic_add(&volumes(faces(s)),
+                               area * static_cast<FloatAccum>(lengths(s)));
+          }
+        });
+    _num_segments += static_cast<Size>(faces.size());
+    if (_cached) {
+      _batches.push_back(segments);
+      if (segmentBytes() > _options.memory_budget) {
+        _batches.clear();
+        _cached = false;
+      }
+    }
+  }
+  _volumes = FloatView(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                          std::string("juno::MOCSweeper::volumes")),
+                       num_faces);
+  auto const face_volumes = _volumes;
+  Kokkos::parallel_for(
+      "juno::MOCSweeper::volumes", rangePolicy<ExecSpace>(0, mesh.numFaces()),
+      KOKKOS_LAMBDA(Int const f) { face_volumes(f) = static_cast<Float>(volumes(f)); });
+  LOG_INFO("MOC: ", _num_tracks, " tracks, ", _num_segments, " segments, ",
+           segmentBytes() >> 20, " MiB of segments, ",
+           _cached ? "cached" : "traced in each sweep");
+}
+
+//----------------------------------------------------------------------------------------
+// Segments
+//----------------------------------------------------------------------------------------
+
+template <class MemSpace>
+auto
+MOCSweeper<MemSpace>::numBatches() const noexcept -> Int
+{
+  return (_num_tracks + _options.tracks_per_batch - 1) / _options.tracks_per_batch;
+}
+
+template <class MemSpace>
+auto
+MOCSweeper<MemSpace>::segmentBatch(Int const batch) const -> TrackSegments<MemSpace>
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  PROFILE_SCOPE("juno::MOCSweeper::segmentBatch");
+  Int const begin = batch * _options.tracks_per_batch;
+  Int const end =
+      begin + _options.tracks_per_batch < _num_tracks ? begin + _options.tracks_per_batch
+                                                      : _num_tracks;
+  Kokkos::View<Ray2 *, MemSpace> const rays =
+      Kokkos::subview(_tracks, std::make_pair(begin, end));
+  auto const raw = segmentRays(_grid, rays);
+
+  // Quantize the lengths, rounding to the nearest unit
+  TrackSegments<MemSpace> segments;
+  segments.offsets = raw.offsets;
+  segments.faces = raw.faces;
+  segments.lengths = Kokkos::View<uint16_t *, MemSpace>(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                         std::string("juno::TrackSegments::lengths")),
+      raw.lengths.size());
+  auto const lengths = segments.lengths;
+  auto const raw_lengths = raw.lengths;
+  Float const inv_scale = 1 / _length_scale;
+  Kokkos::parallel_for(
+      "juno::MOCSweeper::quantize",
+      rangePolicy<ExecSpace>(0, static_cast<Int>(lengths.size())),
+      KOKKOS_LAMBDA(Int const s) {
+        Float const units = raw_lengths(s) * inv_scale + static_cast<Float>(0.5);
+        auto constexpr max_units = static_cast<Float>(max_quantized_length);
+        lengths(s) = static_cast<uint16_t>(units < max_units ? units : max_units);
+      });
+  return segments;
+}
+
+//----------------------------------------------------------------------------------------
+// Sweeping
+//----------------------------------------------------------------------------------------
+
+template <class MemSpace>
+template <class Exp>
+void
+MOCSweeper<MemSpace>::sweepBatch(Int const batch,
+                                 TrackSegments<MemSpace> const & segments,
+                                 CrossSections<MemSpace> const & xs,
+                                 IntView const & face_materials, AccumView const & tally,
+                                 Exp const & exp, IntView const & fed,
+                                 Int const pass) const
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  Int constexpr chunk = xs_alignment / static_cast<Int>(sizeof(Float));
+  Int const begin = batch * _options.tracks_per_batch;
+  Int const num_polar = _num_polar;
+  Int const stride = _group_stride;
+  Int const angular_size = num_polar * stride;
+  Float const scale = _length_scale;
+  Float inv_sin_theta[max_polar_angles] = {};
+  for (Int p = 0; p < num_polar; ++p) {
+    inv_sin_theta[p] = _inv_sin_theta[p];
+  }
+  auto const azimuths = _azimuths;
+  auto const weights = _track_weights;
+  auto const psi_in = _psi_in;
+  auto const psi_out = _psi_out;
+  auto const reduced = _reduced_source;
+  auto const offsets = segments.offsets;
+  auto const faces = segments.faces;
+  auto const lengths = segments.lengths;
+  Kokkos::parallel_for(
+      "juno::MOCSweeper::sweep",
+      rangePolicy<ExecSpace>(0, 2 * (static_cast<Int>(offsets.size()) - 1)),
+      KOKKOS_LAMBDA(Int const i) {
+        Int const k = i / 2;
+        Int const direction = i % 2;
+        Int const track = begin + k;
+        // Only the directions of this pass, fed by a neighbor or not
+        if (pass >= 0 && fed(2 * track + direction) != pass) {
+          return;
+        }
+        Int const a = azimuths(track);
+        Int const first = offsets(k);
+        Int const last = offsets(k + 1);
+        Int const boundary = (2 * track + direction) * angular_size;
+        Float * const psi = psi_out.data() + boundary;
+        for (Int j = 0; j < angular_size; ++j) {
+          psi[j] = psi_in(boundary + j);
+        }
+        for (Int n = 0; n < last - first; ++n) {
+          Int const s = direction == 0 ? first + n : last - 1 - n;
+          Int const f = faces(s);
+          Float const length = scale * static_cast<Float>(lengths(s));
+          Float const * const sigma = xs.row(face_materials(f), reactions::total);
+          Float const * const q = reduced.data() + f * stride;
+          for (Int g0 = 0; g0 < stride; g0 += chunk) {
+            Float acc[chunk] = {};
+            for (Int p = 0; p < num_polar; ++p) {
+              Float const l = length * inv_sin_theta[p];
+              Float const w = weights(a * num_polar + p);
+              Float * const psi_p = psi + p * stride + g0;
+              for (Int g = 0; g < chunk; ++g) {
+                Float const delta =
+                    (psi_p[g] - q[g0 + g]) * (1 - exp(-sigma[g0 + g] * l));
+                psi_p[g] -= delta;
+                acc[g] += w * delta;
+              }
+            }
+            for (Int g = 0; g < chunk; ++g) {
+              Kokkos::atomic_add(&tally(f * stride + g0 + g),
+                                 static_cast<FloatAccum>(acc[g]));
+            }
+          }
+        }
+      });
+}
+
+template <class MemSpace>
+void
+MOCSweeper<MemSpace>::sweep(CrossSections<MemSpace> const & xs,
+                            IntView const & face_materials, FloatView const & source,
+                            FloatView const & scalar_flux)
+{
+  sweepImpl(xs, face_materials, source, scalar_flux, nullptr);
+}
+
+template <class MemSpace>
+void
+MOCSweeper<MemSpace>::sweep(CrossSections<MemSpace> const & xs,
+                            IntView const & face_materials, FloatView const & source,
+                            FloatView const & scalar_flux,
+                            BoundaryExchange<MemSpace> & exchange)
+{
+  ASSERT(static_cast<Int>(exchange.fed().size()) == 2 * _num_tracks);
+  sweepImpl(xs, face_materials, source, scalar_flux, &exchange);
+}
+
+template <class MemSpace>
+void
+MOCSweeper<MemSpace>::sweepImpl(CrossSections<MemSpace> const & xs,
+                                IntView const & face_materials,
+                                FloatView const & source, FloatView const & scalar_flux,
+                                BoundaryExchange<MemSpace> * const exchange)
+{
+  using ExecSpace = typename MemSpace::execution_space;
+  PROFILE_SCOPE("juno::MOCSweeper::sweep");
+  Int const num_faces = _grid.mesh.numFaces();
+  Int const stride = xs.groupStride();
+  auto const size = static_cast<size_t>(num_faces) * static_cast<size_t>(stride);
+  ASSERT_ASSUME(static_cast<Int>(face_materials.size()) == num_faces);
+  ASSERT_ASSUME(source.size() == size);
+  ASSERT_ASSUME(scalar_flux.size() == size);
+
+  // The boundary fluxes start at zero, and again when the number of groups changes
+  if (stride != _group_stride) {
+    if (exchange != nullptr) {
+      exchange->finish(_psi_in);
+    }
+    _group_stride = stride;
+    auto const boundary_size = static_cast<size_t>(2 * _num_tracks * _num_polar) *
+                               static_cast<size_t>(stride);
+    _psi_in = FloatView("juno::MOCSweeper::psi_in", boundary_size);
+    _psi_out = FloatView("juno::MOCSweeper::psi_out", boundary_size);
+    _reduced_source = FloatView(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                                   std::string("juno::MOCSweeper::q")),
+                                size);
+    _tally = AccumView(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                          std::string("juno::MOCSweeper::tally")),
+                       size);
+  }
+
+  // q / sigma_t, and zero tallies
+  auto const reduced = _reduced_source;
+  auto const tally = _tally;
+  Kokkos::parallel_for(
+      "juno::MOCSweeper::reduceSource",
+      rangePolicy<ExecSpace>(0, static_cast<Int>(size)), KOKKOS_LAMBDA(Int const i) {
+        Int const f = i / stride;
+        Float const sigma = xs.row(face_materials(f), reactions::total)[i % stride];
+        reduced(i) = sigma > 0 ? source(i) / sigma : 0;
+        tally(i) = 0;
+      });
+
+  auto const sweepAll = [&](auto const & exp) {
+    auto const sweepBatches = [&](IntView const & fed, Int const pass) {
+      for (Int b = 0; b < numBatches(); ++b) {
+        if (_cached) {
+          sweepBatch(b, _batches[static_cast<size_t>(b)], xs, face_materials, tally, exp,
+                     fed, pass);
+        } else {
+          sweepBatch(b, segmentBatch(b), xs, face_materials, tally, exp, fed, pass);
+        }
+        if (exchange != nullptr) {
+          exchange->progress();
+        }
+      }
+    };
+    if (exchange == nullptr || !exchange->inFlight()) {
+      sweepBatches({}, -1);
+    } else if (_cached) {
+      // The directions with local incoming fluxes while the messages are in flight,
+      // then those fed by the neighbors
+      sweepBatches(exchange->fed(), 0);
+      exchange->finish(_psi_in);
+      sweepBatches(exchange->fed(), 1);
+    } else {
+      // Tracing the batches twice would cost more than the overlap saves
+      exchange->finish(_psi_in);
+      sweepBatches({}, -1);
+    }
+  };
+  switch (_options.exponential) {
+  case sweep_exponentials::library:
+    sweepAll(LibraryExp{});
+    break;
+  case sweep_exponentials::table:
+    sweepAll(_exp_table);
+    break;
+  default:
+    sweepAll(SweepRationalExp{});
+    break;
+  }
+
+  // The outgoing fluxes come back in through the reflective boundaries
+  if (_options.boundary == moc_boundaries::reflective) {
+    Int const angular_size = _num_polar * stride;
+    auto const links = _links;
+    auto const psi_in = _psi_in;
+    auto const psi_out = _psi_out;
+    Kokkos::parallel_for(
+        "juno::MOCSweeper::reflect", rangePolicy<ExecSpace>(0, 2 * _num_tracks),
+        KOKKOS_LAMBDA(Int const i) {
+          Int const from = i * angular_size;
+          Int const to = links(i) * angular_size;
+          for (Int j = 0; j < angular_size; ++j) {
+            psi_in(to + j) = psi_out(from + j);
+          }
+        });
+  }
+
+  // The outgoing fluxes through the sides with a neighbor go to it, for the next sweep
+  if (exchange != nullptr) {
+    exchange->begin(_psi_out, _num_polar * stride);
+  }
+
+  // The scalar flux, from the tallies
+  auto const volumes = _volumes;
+  Kokkos::parallel_for(
+      "juno::MOCSweeper::scalarFlux", rangePolicy<ExecSpace>(0, static_cast<Int>(size)),
+      KOKKOS_LAMBDA(Int const i) {
+        Int const f = i / stride;
+        Float const sigma = xs.row(face_materials(f), reactions::total)[i % stride];
+        auto const sigma_volume =
+            static_cast<FloatAccum>(sigma) * static_cast<FloatAccum>(volumes(f));
+        FloatAccum const streaming = sigma_volume > 0 ? tally(i) / sigma_volume : 0;
+        scalar_flux(i) = four_pi * reduced(i) + static_cast<Float>(streaming);
+      });
+}
+
+template <class MemSpace>
+void
+MOCSweeper<MemSpace>::resetBoundaryFluxes()
+{
+  if (_psi_in.size() > 0) {
+    Kokkos::deep_copy(_psi_in, 0);
+  }
+}
+
+template class MOCSweeper<HostMemSpace>;
+
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+template class MOCSweeper<DeviceMemSpace>;
+#endif
+
+} // namespace juno
@@ -0,0 +1,81 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/physics/nuclide.hpp>
+
+namespace juno
+{
+
+//----------------------------------------------------------------------------------------
+auto
+validate(Nuclide const & nuclide) -> bool
+{
+  auto const num_groups = static_cast<size_t>(nuclide.num_groups);
+  if (nuclide.num_groups <= 0) {
+    LOG_ERROR("Nuclide ", nuclide.name.c_str(), ": no energy groups");
+    return false;
+  }
+  if (nuclide.total.size() != num_groups || nuclide.absorption.size() != num_groups ||
+      nuclide.nu_fission.size() != num_groups || nuclide.chi.size() != num_groups) {
+    LOG_ERROR("Nuclide ", nuclide.name.c_str(), ": expected ", nuclide.num_groups,
+              " groups for each reaction");
+    return false;
+  }
+  if (nuclide.scatter.size() != num_groups * num_groups) {
+    LOG_ERROR("Nuclide ", nuclide.name.c_str(), ": expected a ", nuclide.num_groups,
+              " by ", nuclide.num_groups, " scattering matrix");
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+void
+packNuclide(Nuclide const & nuclide, CrossSections<HostMemSpace> const & xs, Int const e)
+{
+  Int const num_groups = xs.numGroups();
+  ASSUME(nuclide.num_groups == num_groups);
+  std::vector<Float> const * const vectors[reactions::count] = {
+      &nuclide.total, &nuclide.absorption, &nuclide.nu_fission, &nuclide.chi};
+  for (Int r = 0; r < reactions::count; ++r) {
+    Float * const row = xs.row(e, r);
+    for (Int g = 0; g < num_groups; ++g) {
+      row[g] = (*vectors[r])[static_cast<size_t>(g)];
+    }
+  }
+  for (Int from = 0; from < num_groups; ++from) {
+    Float * const row = xs.scatterRow(e, from);
+    for (Int to = 0; to < num_groups; ++to) {
+      row[to] = nuclide.scatter[static_cast<size_t>(from * num_groups + to)];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+auto
+makeCrossSections(std::vector<Nuclide> const & nuclides) -> CrossSections<HostMemSpace>
+{
+  PROFILE_SCOPE("juno::makeCrossSections");
+  if (nuclides.empty()) {
+    return {};
+  }
+  Int const num_groups = nuclides[0].num_groups;
+  for (auto const & nuclide : nuclides) {
+    if (!validate(nuclide)) {
+      return {};
+    }
+    if (nuclide.num_groups != num_groups) {
+      LOG_ERROR("Nuclide ", nuclide.name.c_str(), " has ", nuclide.num_groups,
+                " groups, but ", nuclides[0].name.c_str(), " has ", num_groups);
+      return {};
+    }
+  }
+
+  auto const num_nuclides = static_cast<Int>(nuclides.size());
+  CrossSections<HostMemSpace> xs("nuclides", num_nuclides, num_groups);
+  Kokkos::parallel_for(
+      "juno::makeCrossSections", rangePolicy<HostExecSpace>(0, num_nuclides),
+      [&](Int const n) { packNuclide(nuclides[static_cast<size_t>(n)], xs, n); });
+  return xs;
+}
+
+} // namespace juno
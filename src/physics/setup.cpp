@@ -0,0 +1,105 @@
+#include <juno/common/hash.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/common/stage_cache.hpp>
+#include <juno/mesh/reorder.hpp>
+#include <juno/physics/setup.hpp>
+
+#include <utility> // std::move
+
+namespace juno
+{
+
+namespace
+{
+
+// The hash of the composition of the materials, by nuclide entry
+auto
+hashMaterials(std::vector<Material> const & materials) -> uint64_t
+{
+  uint64_t h = hashValue(materials.size());
+  for (auto const & material : materials) {
+    h = hashCombine(h, hashString(material.name));
+    for (size_t i = 0; i < material.nuclides.size(); ++i) {
+      h = hashCombine(h, hashValue(material.nuclides[i]));
+      h = hashCombine(h, hashValue(material.number_densities[i]));
+    }
+  }
+  return h;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+reorderCurve(SetupInput const & setup) -> int32_t
+{
+  return setup.reorder == "morton" ? curves::morton : curves::hilbert;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+makeMaterials(std::vector<MaterialInput> const & inputs, std::vector<std::string> & names)
+    -> std::vector<Material>
+{
+  std::vector<Material> materials;
+  materials.reserve(inputs.size());
+  for (auto const & input : inputs) {
+    Material material{input.name, {}, input.number_densities};
+    for (auto const & nuclide : input.nuclides) {
+      Int index = 0;
+      while (index < static_cast<Int>(names.size()) &&
+             names[static_cast<size_t>(index)] != nuclide) {
+        ++index;
+      }
+      if (index == static_cast<Int>(names.size())) {
+        names.push_back(nuclide);
+      }
+      material.nuclides.push_back(index);
+    }
+    materials.push_back(std::move(material));
+  }
+  return materials;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+stageKeys(SetupInput const & setup, CrossSectionLibrary const & library) -> StageKeys
+{
+  uint64_t const mesh_hash = hashFile(setup.mesh);
+  if (mesh_hash == 0 || !library.isOpen()) {
+    return {};
+  }
+
+  // The nuclides used, from the index of the library
+  std::vector<std::string> names;
+  auto const materials = makeMaterials(setup.materials, names);
+  uint64_t nuclides_hash = library.indexHash();
+  for (auto const & name : names) {
+    Int const i = library.find(name);
+    if (i < 0) {
+      LOG_ERROR("Nuclide ", name.c_str(), " is not in the cross section library");
+      return {};
+    }
+    nuclides_hash = hashCombine(nuclides_hash, library.dataHash(i));
+  }
+
+  StageKeys keys;
+  keys.import = stageKey("import", {mesh_hash});
+  keys.reorder = setup.reorder == "none"
+                     ? keys.import
+                     : stageKey("reorder", {keys.import, hashValue(reorderCurve(setup))});
+  keys.index = stageKey("index", {keys.reorder, hashValue(setup.faces_per_cell)});
+  keys.mix = stageKey("mix", {nuclides_hash, hashMaterials(materials)});
+  return keys;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+tracksKey(AABB2 const & box, TrackParameters const & parameters) -> uint64_t
+{
+  return stageKey("tracks", {hashValue(box), hashValue(parameters.num_azimuthal),
+                             hashValue(parameters.spacing),
+                             hashValue(parameters.num_polar)});
+}
+
+} // namespace juno
@@ -0,0 +1,301 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/profiler.hpp>
+#include <juno/physics/tracks.hpp>
+
+#include <algorithm> // std::sort, std::lower_bound, std::min
+#include <cmath>     // std::atan, std::cos, std::floor, std::sin, std::abs
+#include <limits>    // std::numeric_limits
+#include <numbers>   // std::numbers::pi
+
+namespace juno
+{
+
+namespace
+{
+
+double constexpr pi = std::numbers::pi;
+
+// The side of the box nearest to a point of its boundary
+auto
+nearestSide(AABB2 const & box, Vec2 const p) -> int32_t
+{
+  // The distances to the sides, in the order of box_sides
+  double const distances[box_sides::count] = {
+      std::abs(p.y - box.min.y), std::abs(box.max.x - p.x), std::abs(box.max.y - p.y),
+      std::abs(p.x - box.min.x)};
+  int32_t nearest = box_sides::bottom;
+  for (int32_t side = 1; side < box_sides::count; ++side) {
+    if (distances[side] < distances[nearest]) {
+      nearest = side;
+    }
+  }
+  return nearest;
+}
+
+// A point of the boundary of the box, as its distance counterclockwise along the
+// boundary from the bottom left corner
+auto
+perimeterCoordinate(AABB2 const & box, Vec2 const p) -> double
+{
+  double const w = box.width();
+  double const h = box.height();
+  double const x = p.x - box.min.x;
+  double const y = p.y - box.min.y;
+  switch (nearestSide(box, p)) {
+  case box_sides::bottom:
+    return x;
+  case box_sides::right:
+    return w + y;
+  case box_sides::top:
+    return w + h + (w - x);
+  default:
+    return 2 * w + h + (h - y);
+  }
+}
+
+// The point of the opposite side that p, on the boundary, is translated to
+auto
+translatedPoint(AABB2 const & box, Vec2 const p) -> Vec2
+{
+  switch (nearestSide(box, p)) {
+  case box_sides::bottom:
+    return {p.x, box.max.y};
+  case box_sides::right:
+    return {box.min.x, p.y};
+  case box_sides::top:
+    return {p.x, box.min.y};
+  default:
+    return {box.max.x, p.y};
+  }
+}
+
+// An entry point of a direction into the box
+struct Entry {
+  double s;
+  Int direction; // 2 t + d
+};
+
+// The direction of the entry nearest to s, which must be sorted, or -1 if none is
+// within the tolerance
+auto
+nearestEntry(std::vector<Entry> const & entries, double const s, double const tolerance)
+    -> Int
+{
+  auto const it =
+      std::lower_bound(entries.begin(), entries.end(), s,
+                       [](Entry const & e, double const v) { return e.s < v; });
+  // The nearest entry, on either side
+  auto best = entries.end();
+  if (it != entries.end()) {
+    best = it;
+  }
+  if (it != entries.begin() && (best == entries.end() || s - (it - 1)->s < best->s - s)) {
+    best = it - 1;
+  }
+  if (best != entries.end() && std::abs(best->s - s) <= tolerance) {
+    return best->direction;
+  }
+  return -1;
+}
+
+// The ray from p along phi, clipped to the box
+auto
+clippedRay(AABB2 const & box, Vec2 const p, double const phi) -> Ray2
+{
+  double const dx = std::cos(phi);
+  double const dy = std::sin(phi);
+  double const x = p.x;
+  double const y = p.y;
+  double const x_end = dx > 0 ? box.max.x : box.min.x;
+  double const y_end = box.max.y;
+  double const tx = (x_end - x) / dx;
+  double const ty = (y_end - y) / dy;
+  Ray2 ray;
+  ray.origin = p;
+  ray.direction = {static_cast<Float>(dx), static_cast<Float>(dy)};
+  ray.length = static_cast<Float>(std::min(tx, ty));
+  return ray;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+auto
+tabuchiYamamoto(Int const num_angles) -> PolarQuadrature
+{
+  PolarQuadrature q;
+  switch (num_angles) {
+  case 1:
+    q.sin_theta[0] = static_cast<Float>(0.798184);
+    q.weights[0] = 1;
+    break;
+  case 2:
+    q.sin_theta[0] = static_cast<Float>(0.363900);
+    q.sin_theta[1] = static_cast<Float>(0.899900);
+    q.weights[0] = static_cast<Float>(0.212854);
+    q.weights[1] = static_cast<Float>(0.787146);
+    break;
+  case 3:
+    q.sin_theta[0] = static_cast<Float>(0.166648);
+    q.sin_theta[1] = static_cast<Float>(0.537707);
+    q.sin_theta[2] = static_cast<Float>(0.932954);
+    q.weights[0] = static_cast<Float>(0.046233);
+    q.weights[1] = static_cast<Float>(0.283619);
+    q.weights[2] = static_cast<Float>(0.670148);
+    break;
+  default:
+    LOG_ERROR("Tabuchi-Yamamoto quadrature: expected 1 to ", max_polar_angles,
+              " polar angles, got ", num_angles);
+    return q;
+  }
+  q.num_angles = num_angles;
+  return q;
+}
+
+//----------------------------------------------------------------------------------------
+auto
+makeTrackLayout(AABB2 const & box, TrackParameters const & parameters) -> TrackLayout
+{
+  PROFILE_SCOPE("juno::makeTrackLayout");
+  Int const num_azimuthal = parameters.num_azimuthal;
+  if (box.isEmpty() || box.width() <= 0 || box.height() <= 0) {
+    LOG_ERROR("makeTrackLayout: the box is empty");
+    return {};
+  }
+  if (num_azimuthal <= 0 || num_azimuthal % 2 != 0) {
+    LOG_ERROR("makeTrackLayout: the number of azimuthal angles must be even and "
+              "positive, got ",
+              num_azimuthal);
+    return {};
+  }
+  if (!(parameters.spacing > 0)) {
+    LOG_ERROR("makeTrackLayout: the track spacing must be positive");
+    return {};
+  }
+  TrackLayout layout;
+  layout.polar = tabuchiYamamoto(parameters.num_polar);
+  if (layout.polar.num_angles == 0) {
+    return {};
+  }
+  layout.box = box;
+  double const w = box.width();
+  double const h = box.height();
+  double const spacing_limit = parameters.spacing;
+  auto const num_a = static_cast<size_t>(num_azimuthal);
+
+  // The cyclic angles and spacings. Angle a and its complement num_azimuthal - 1 - a
+  // have the same numbers of tracks.
+  std::vector<double> phi(num_a);
+  std::vector<double> spacing(num_a);
+  std::vector<Int> nx(num_a);
+  std::vector<Int> ny(num_a);
+  for (size_t a = 0; a < num_a / 2; ++a) {
+    double const desired =
+        pi * (static_cast<double>(a) + 0.5) / static_cast<double>(num_azimuthal);
+    nx[a] = static_cast<Int>(std::floor(w * std::sin(desired) / spacing_limit)) + 1;
+    ny[a] = static_cast<Int>(std::floor(h * std::cos(desired) / spacing_limit)) + 1;
+    auto const fx = static_cast<double>(nx[a]);
+    auto const fy = static_cast<double>(ny[a]);
+    phi[a] = std::atan(h * fx / (w * fy));
+    spacing[a] = w / fx * std::sin(phi[a]);
+    size_t const c = num_a - 1 - a;
+    phi[c] = pi - phi[a];
+    spacing[c] = spacing[a];
+    nx[c] = nx[a];
+    ny[c] = ny[a];
+  }
+
+  // The weight of each angle is the arc between the midpoints to its neighbors, with
+  // the neighbors beyond (0, pi) reflected
+  for (size_t a = 0; a < num_a; ++a) {
+    double const prev = a == 0 ? -phi[0] : phi[a - 1];
+    double const next = a + 1 == num_a ? 2 * pi - phi[a] : phi[a + 1];
+    layout.phi.push_back(static_cast<Float>(phi[a]));
+    layout.spacing.push_back(static_cast<Float>(spacing[a]));
+    layout.azimuthal_weights.push_back(static_cast<Float>((next - prev) / (4 * pi)));
+  }
+
+  // The tracks of each angle: nx start on the bottom side, and ny on the left side for
+  // angles below pi/2, or on the right side above
+  layout.azimuth_offsets.push_back(0);
+  for (size_t a = 0; a < num_a; ++a) {
+    double const dx = w / static_cast<double>(nx[a]);
+    double const dy = h / static_cast<double>(ny[a]);
+    double const x0 = box.min.x;
+    double const y0 = box.min.y;
+    for (Int i = 0; i < nx[a]; ++i) {
+      Vec2 const p = {static_cast<Float>(x0 + dx * (static_cast<double>(i) + 0.5)),
+                      box.min.y};
+      layout.tracks.push_back(clippedRay(box, p, phi[a]));
+    }
+    for (Int j = 0; j < ny[a]; ++j) {
+      Float const x = phi[a] < pi / 2 ? box.min.x : box.max.x;
+      Vec2 const p = {x, static_cast<Float>(y0 + dy * (static_cast<double>(j) + 0.5))};
+      layout.tracks.push_back(clippedRay(box, p, phi[a]));
+    }
+    layout.azimuths.insert(layout.azimuths.end(), static_cast<size_t>(nx[a] + ny[a]),
+                           static_cast<Int>(a));
+    layout.azimuth_offsets.push_back(layout.numTracks());
+  }
+
+  // Reflective links: the exit point of a direction of a track is the entry point of a
+  // direction of a track of the complementary angle. The entry points of the forward
+  // directions are the origins, and of the backward directions the ends of the tracks.
+  // Translated links: the exit point, translated to the opposite side, is the entry
+  // point of the same direction of a track of the same angle.
+  Int const num_tracks = layout.numTracks();
+  layout.links.assign(static_cast<size_t>(2 * num_tracks), -1);
+  layout.translated_links.assign(static_cast<size_t>(2 * num_tracks), -1);
+  layout.exit_sides.assign(static_cast<size_t>(2 * num_tracks), -1);
+  // The entry points on a side are at least the spacing apart, so take the nearest
+  double tolerance = std::numeric_limits<double>::max();
+  for (size_t a = 0; a < num_a; ++a) {
+    tolerance = std::min({tolerance, w / static_cast<double>(nx[a]) / 4,
+                          h / static_cast<double>(ny[a]) / 4});
+  }
+  auto const entriesOf = [&](size_t const a, Int const direction) {
+    std::vector<Entry> entries;
+    for (Int t = layout.azimuth_offsets[a]; t < layout.azimuth_offsets[a + 1]; ++t) {
+      Ray2 const & ray = layout.tracks[static_cast<size_t>(t)];
+      if (direction != 1) {
+        entries.push_back({perimeterCoordinate(box, ray.origin), 2 * t});
+      }
+      if (direction != 0) {
+        entries.push_back({perimeterCoordinate(box, ray(ray.length)), 2 * t + 1});
+      }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](Entry const & x, Entry const & y) { return x.s < y.s; });
+    return entries;
+  };
+  Int num_unmatched = 0;
+  for (size_t a = 0; a < num_a; ++a) {
+    auto const reflected = entriesOf(num_a - 1 - a, -1);
+    std::vector<Entry> const translated[2] = {entriesOf(a, 0), entriesOf(a, 1)};
+    for (Int t = layout.azimuth_offsets[a]; t < layout.azimuth_offsets[a + 1]; ++t) {
+      Ray2 const & ray = layout.tracks[static_cast<size_t>(t)];
+      Vec2 const exits[2] = {ray(ray.length), ray.origin};
+      for (Int d = 0; d < 2; ++d) {
+        auto const i = static_cast<size_t>(2 * t + d);
+        layout.links[i] =
+            nearestEntry(reflected, perimeterCoordinate(box, exits[d]), tolerance);
+        layout.translated_links[i] = nearestEntry(
+            translated[d], perimeterCoordinate(box, translatedPoint(box, exits[d])),
+            tolerance);
+        layout.exit_sides[i] = nearestSide(box, exits[d]);
+        num_unmatched += layout.links[i] < 0 ? 1 : 0;
+        num_unmatched += layout.translated_links[i] < 0 ? 1 : 0;
+      }
+    }
+  }
+  if (num_unmatched > 0) {
+    LOG_ERROR("makeTrackLayout: ", num_unmatched,
+              " track ends have no reflection or translation");
+    return {};
+  }
+  LOG_DEBUG("makeTrackLayout: ", num_tracks, " tracks, ", num_azimuthal,
+            " azimuthal angles, ", layout.polar.num_angles, " polar angles");
+  return layout;
+}
+
+} // namespace juno
@@ -0,0 +1,181 @@
+#include <juno/common/arena.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/math/krylov.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint> // uintptr_t
+#include <utility> // std::move
+
+#include "../test_macros.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+using Arena = juno::Arena<juno::HostMemSpace>;
+using Matrix = juno::CSRMatrix<juno::HostMemSpace>;
+using Vector = Kokkos::View<Float *, juno::HostMemSpace>;
+
+namespace
+{
+
+auto
+isAligned(void const * p) -> bool
+{
+  return reinterpret_cast<uintptr_t>(p) % Arena::alignment == 0;
+}
+
+// The tridiagonal matrix of -u'' + u on n points
+auto
+makeOperator(Int const n) -> Matrix
+{
+  Matrix a;
+  a.num_rows = n;
+  a.num_cols = n;
+  a.row_offsets = Matrix::IntView("row_offsets", static_cast<size_t>(n + 1));
+  a.columns = Matrix::IntView("columns", static_cast<size_t>(3 * n));
+  a.values = Matrix::FloatView("values", static_cast<size_t>(3 * n));
+  Int k = 0;
+  for (Int i = 0; i < n; ++i) {
+    for (Int j = i - 1; j <= i + 1; ++j) {
+      if (0 <= j && j < n) {
+        a.columns(k) = j;
+        a.values(k) = j == i ? 3 : -1;
+        ++k;
+      }
+    }
+    a.row_offsets(i + 1) = k;
+  }
+  return a;
+}
+
+} // namespace
+
+TEST_CASE(allocate)
+{
+  STATIC_ASSERT(Arena::bytes<Float>(0) == 0);
+  STATIC_ASSERT(Arena::bytes<Float>(1) == Arena::alignment);
+  STATIC_ASSERT(Arena::bytes<double>(32) == Arena::alignment);
+  STATIC_ASSERT(Arena::bytes<double>(33) == 2 * Arena::alignment);
+
+  Arena arena("arena", 4096);
+  ASSERT(arena.capacity() == 4096);
+  ASSERT(arena.used() == 0);
+
+  // Aligned, disjoint, and in the buffer
+  auto const a = arena.allocate<Float>(3);
+  auto const b = arena.allocate<Int>(100);
+  auto const c = arena.allocate<double>(0);
+  ASSERT(a.size() == 3);
+  ASSERT(b.size() == 100);
+  ASSERT(c.size() == 0);
+  ASSERT(isAligned(a.data()));
+  ASSERT(isAligned(b.data()));
+  auto const * const a_end = reinterpret_cast<char const *>(a.data() + a.size());
+  ASSERT(a_end <= reinterpret_cast<char const *>(b.data()));
+  ASSERT(arena.used() == Arena::bytes<Float>(3) + Arena::bytes<Int>(100));
+  ASSERT(arena.numOverflows() == 0);
+  for (Int i = 0; i < 100; ++i) {
+    b(i) = i;
+  }
+  a(2) = 1;
+  ASSERT(b(99) == 99);
+  ASSERT_NEAR(a(2), 1, eps);
+
+  // A reset frees the buffer, and the same memory is carved again
+  size_t const used = arena.used();
+  arena.reset();
+  ASSERT(arena.used() == 0);
+  ASSERT(arena.highWater() == used);
+  auto const d = arena.allocate<Float>(3);
+  ASSERT(d.data() == a.data());
+  ASSERT(arena.capacity() == 4096);
+}
+
+TEST_CASE(growth)
+{
+  // An empty arena overflows in the first iteration, and then fits
+  Arena arena("arena");
+  ASSERT(arena.capacity() == 0);
+  for (Int iteration = 0; iteration < 3; ++iteration) {
+    auto const a = arena.allocate<Float>(1000);
+    auto const b = arena.allocate<Float>(5000);
+    ASSERT(isAligned(a.data()));
+    ASSERT(isAligned(b.data()));
+    for (Int i = 0; i < 5000; ++i) {
+      b(i) = 1;
+    }
+    a(999) = 2;
+    ASSERT_NEAR(b(4999), 1, eps);
+    ASSERT(arena.numOverflows() == 2);
+    arena.reset();
+  }
+  size_t const high_water = Arena::bytes<Float>(1000) + Arena::bytes<Float>(5000);
+  ASSERT(arena.highWater() == high_water);
+  ASSERT(arena.capacity() == high_water);
+
+  // The high-water mark is reported through the logger
+  juno::logger::reset();
+  juno::logger::level = juno::logger::levels::info;
+  arena.logUsage();
+  ASSERT(juno::logger::errorCount() == 0);
+
+  // A move leaves the source empty
+  Arena moved(std::move(arena));
+  ASSERT(moved.capacity() == high_water);
+  ASSERT(arena.capacity() == 0); // NOLINT(bugprone-use-after-move)
+  ASSERT(moved.allocate<Float>(1000).size() == 1000);
+}
+
+TEST_CASE(krylov)
+{
+  // Solves with the workspace from an arena match those with their own, and allocate
+  // nothing once the arena has grown
+  Int constexpr n = 200;
+  auto const a = makeOperator(n);
+  auto const m = juno::makeJacobiPreconditioner(a);
+  Vector const b("b", n);
+  Kokkos::deep_copy(b, 1);
+  juno::KrylovOptions options;
+  options.tolerance = static_cast<Float>(1e-5);
+  options.restart = 10;
+
+  Arena arena("krylov");
+  for (Int solver = 0; solver < 2; ++solver) {
+    Vector const x("x", n);
+    Vector const y("y", n);
+    auto const own = solver == 0 ? juno::gmres(a, m, b, x, options)
+                                 : juno::bicgstab(a, m, b, x, options);
+    Int overflows = 0;
+    for (Int iteration = 0; iteration < 3; ++iteration) {
+      Kokkos::deep_copy(y, 0);
+      auto const result = solver == 0 ? juno::gmres(a, m, b, y, arena, options)
+                                      : juno::bicgstab(a, m, b, y, arena, options);
+      ASSERT(result.converged);
+      ASSERT(result.iterations == own.iterations);
+      for (Int i = 0; i < n; ++i) {
+        ASSERT_NEAR(y(i), x(i), 0); // the same operations, so the same bits
+      }
+      if (iteration == 0) {
+        overflows = arena.numOverflows();
+      }
+      arena.reset();
+    }
+    ASSERT(arena.numOverflows() == overflows);
+  }
+  ASSERT(arena.highWater() >= juno::impl::gmresBytes<juno::HostMemSpace>(n, 10));
+}
+
+TEST_SUITE(arena)
+{
+  TEST(allocate);
+  TEST(growth);
+  TEST(krylov);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(arena);
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include <juno/common/assert.hpp>
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <string>
+
+#include "../test_macros.hpp"
+
+#if JUNO_ENABLE_DEFERRED_ASSERTS
+
+// The juno ASSERT is replaced by the test one, so fail through failedAssert directly
+TEST_CASE(deferred)
+{
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  ASSERT(juno::checkAsserts("nothing") == 0);
+  ASSERT(juno::logger::errorCount() == 0);
+
+  Int constexpr n = 1000;
+  Int constexpr every = 100;
+  juno::DeviceExecSpace const space;
+  Kokkos::parallel_for(
+      "fail_some", juno::rangePolicy(0, n, space), KOKKOS_LAMBDA(Int const i) {
+        if (i % every == 0) {
+          juno::failedAssert(__FILE__, __LINE__, "i % every != 0");
+        }
+        if (i == 1) {
+          juno::failedAssertNear(__FILE__, __LINE__, "a", "b", "eps");
+        }
+      });
+  ASSERT(juno::checkAsserts("fail_some") == n / every + 1);
+  ASSERT(juno::logger::errorCount() == 1);
+
+  // The records were reset
+  ASSERT(juno::checkAsserts("fail_none") == 0);
+  ASSERT(juno::logger::errorCount() == 1);
+
+  // More failures than records are still counted
+  Kokkos::parallel_for(
+      "fail_all", juno::rangePolicy(0, n, space),
+      KOKKOS_LAMBDA(Int) { juno::failedAssert(__FILE__, __LINE__, "false"); });
+  ASSERT(juno::checkAsserts("fail_all") == n);
+  ASSERT(juno::logger::errorCount() == 2);
+
+  // Host code records too
+  std::string const path(200, 'a');
+  juno::failedAssertNear((path + "/record.cpp").c_str(), 1, "x", "y", "1e-3");
+  auto const & record = juno::host_failed_asserts.records[0];
+  ASSERT(juno::host_failed_asserts.count == 1);
+  ASSERT(record.line == 1);
+  std::string const file(record.file);
+  ASSERT(file.size() == juno::failed_asserts::file_size - 1);
+  ASSERT(file.ends_with("/record.cpp"));
+  ASSERT(std::string(record.message) == "x == y +/- 1e-3");
+  ASSERT(juno::checkAsserts("host") == 1);
+  juno::logger::reset();
+}
+
+#else
+
+TEST_CASE(immediate)
+{
+  // Failures abort, so there is never anything to report
+  ASSERT(juno::checkAsserts("nothing") == 0);
+}
+
+#endif
+
+TEST_SUITE(assertions)
+{
+#if JUNO_ENABLE_DEFERRED_ASSERTS
+  TEST(deferred);
+#else
+  TEST(immediate);
+#endif
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(assertions);
+  return 0;
+}
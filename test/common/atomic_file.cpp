@@ -0,0 +1,121 @@
+#include <juno/common/atomic_file.hpp>
+#include <juno/common/logger.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <atomic>
+#include <filesystem> // std::filesystem::temp_directory_path, std::filesystem::remove_all
+#include <fstream>    // std::ifstream, std::ofstream
+#include <iterator>   // std::istreambuf_iterator, std::distance
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../test_macros.hpp"
+
+namespace
+{
+
+auto
+tempDirectory(std::string const & name) -> std::string
+{
+  auto const path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  return path.string();
+}
+
+auto
+readFile(std::string const & filename) -> std::string
+{
+  std::ifstream file(filename, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+auto
+numFiles(std::string const & directory) -> Int
+{
+  std::filesystem::directory_iterator const begin(directory);
+  return static_cast<Int>(std::distance(begin, std::filesystem::directory_iterator()));
+}
+
+} // namespace
+
+TEST_CASE(write)
+{
+  auto const directory = tempDirectory("juno_test_atomic_file");
+  auto const filename = directory + "/file";
+  auto const contents = [](std::string const & text) {
+    return [text](std::ofstream & file) { file << text; };
+  };
+  ASSERT(juno::writeFileAtomically(filename, "test file", contents("first")));
+  ASSERT(readFile(filename) == "first");
+  ASSERT(juno::writeFileAtomically(filename, "test file", contents("second")));
+  ASSERT(readFile(filename) == "second");
+  // No temporary is left behind
+  ASSERT(numFiles(directory) == 1);
+  auto const temporary = juno::impl::temporaryFilename(filename);
+  ASSERT(temporary != juno::impl::temporaryFilename(filename));
+
+  // A failed write leaves the file as it was
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  ASSERT(!juno::writeFileAtomically(filename, "test file", [](std::ofstream & file) {
+    file << "partial";
+    file.setstate(std::ios::badbit);
+  }));
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(readFile(filename) == "second");
+  ASSERT(numFiles(directory) == 1);
+  ASSERT(!juno::writeFileAtomically(directory + "/none/file", "test file", contents("")));
+  ASSERT(juno::logger::errorCount() == 2);
+  juno::logger::reset();
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(concurrent)
+{
+  // Writers of the same file never see each other's data: the file is always one of
+  // the writes, whole
+  auto const directory = tempDirectory("juno_test_atomic_file_concurrent");
+  auto const filename = directory + "/file";
+  Int constexpr num_threads = 8;
+  Int constexpr num_writes = 20;
+  Int constexpr size = 1 << 16;
+  std::atomic<Int> num_failed = 0;
+  std::vector<std::thread> threads;
+  for (Int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::string const text(static_cast<size_t>(size), static_cast<char>('a' + t));
+      for (Int i = 0; i < num_writes; ++i) {
+        if (!juno::writeFileAtomically(filename, "test file",
+                                       [&](std::ofstream & file) { file << text; })) {
+          ++num_failed;
+        }
+      }
+    });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  ASSERT(num_failed == 0);
+  auto const text = readFile(filename);
+  ASSERT(text.size() == static_cast<size_t>(size));
+  ASSERT(text.find_first_not_of(text[0]) == std::string::npos);
+  ASSERT(numFiles(directory) == 1);
+  std::filesystem::remove_all(directory);
+}
+
+TEST_SUITE(atomic_file)
+{
+  TEST(write);
+  TEST(concurrent);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(atomic_file);
+  return 0;
+}
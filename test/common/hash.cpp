@@ -0,0 +1,56 @@
+#include <juno/common/hash.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <omp.h>
+
+#include "../test_macros.hpp"
+
+TEST_CASE(hashBytes)
+{
+  // Several chunks, with a partial word at the end
+  size_t constexpr size = (size_t{3} << 20) + 5;
+  std::vector<unsigned char> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<unsigned char>(i * 31 + 7);
+  }
+  uint64_t const h = juno::hashBytes(bytes.data(), size);
+  ASSERT(h == juno::hashBytes(bytes.data(), size));
+
+  // The same with any number of threads
+  int const num_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  ASSERT(h == juno::hashBytes(bytes.data(), size));
+  omp_set_num_threads(num_threads);
+
+  // Any change of the data or its size changes the hash
+  ASSERT(h != juno::hashBytes(bytes.data(), size - 1));
+  bytes[size / 2] ^= 1;
+  ASSERT(h != juno::hashBytes(bytes.data(), size));
+  bytes[size / 2] ^= 1;
+  bytes[size - 1] ^= 1;
+  ASSERT(h != juno::hashBytes(bytes.data(), size));
+
+  // Empty data
+  ASSERT(juno::hashBytes(nullptr, 0) == juno::hashBytes(bytes.data(), 0));
+}
+
+TEST_CASE(hashCombine)
+{
+  STATIC_ASSERT(juno::hashCombine(1, 2) != juno::hashCombine(2, 1));
+  STATIC_ASSERT(juno::hashCombine(0, 1) != juno::hashCombine(0, 2));
+}
+
+TEST_SUITE(hash)
+{
+  TEST(hashBytes);
+  TEST_CONCURRENT(hashCombine);
+}
+
+auto
+main() -> int
+{
+  RUN_SUITE(hash);
+  return 0;
+}
@@ -1,9 +1,33 @@
 #include <juno/common/logger.hpp>
 
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <string_view>
+#include <thread>
+
+#include <omp.h>
+#include <unistd.h> // dup, dup2, pipe, read, close
 
 #include "../test_macros.hpp"
 
+// A user type. It is trivially copyable, so deferred logging only needs toBuffer.
+struct Point {
+  float x;
+  float y;
+};
+
+template <>
+auto
+juno::logger::impl::toBuffer(char * buffer_pos, Point const & value) noexcept -> char *
+{
+  buffer_pos = toBuffer(buffer_pos, '(');
+  buffer_pos = toBuffer(buffer_pos, value.x);
+  buffer_pos = toBuffer(buffer_pos, ", ");
+  buffer_pos = toBuffer(buffer_pos, value.y);
+  return toBuffer(buffer_pos, ')');
+}
+
 TEST_CASE(loggerTest)
 {
   juno::logger::reset();
@@ -36,7 +60,228 @@ TEST_CASE(loggerTest)
   juno::logger::info(s, " with multiple", " arguments");
 }
 
-TEST_SUITE(logger) { TEST(loggerTest); }
+TEST_CASE(threadedTest)
+{
+  juno::logger::reset();
+
+  // Each thread formats into its own buffer, so the last message seen by a thread is
+  // always the one it logged.
+  int32_t constexpr num_messages = 1000;
+#pragma omp parallel for
+  for (int32_t i = 0; i < num_messages; ++i) {
+    juno::logger::info("thread ", omp_get_thread_num(), " message ", i);
+    std::string const expected = "message " + std::to_string(i);
+    std::string_view const last_message = juno::logger::getLastMessage();
+    ASSERT(last_message.find(expected) != std::string_view::npos);
+  }
+  juno::logger::flush();
+}
+
+TEST_CASE(asynchronousTest)
+{
+  juno::logger::reset();
+  ASSERT(!juno::logger::asynchronous);
+  ASSERT(juno::logger::droppedMessages() == 0);
+
+  juno::logger::asynchronous = true;
+  int32_t constexpr num_messages = 1000;
+#pragma omp parallel for
+  for (int32_t i = 0; i < num_messages; ++i) {
+    juno::logger::info("async message ", i);
+  }
+  juno::logger::reset();
+  ASSERT(juno::logger::droppedMessages() == 0);
+
+  // Stall the flusher: write stdout to a pipe that is not read, so the flusher blocks
+  // in its write once the pipe is full, and the queue overflows. The empty queue takes
+  // at least a full queue of lines.
+  juno::logger::asynchronous = true;
+  fflush(stdout);
+  int const saved_stdout = dup(STDOUT_FILENO);
+  int fds[2];
+  ASSERT(pipe(fds) == 0);
+  dup2(fds[1], STDOUT_FILENO);
+  close(fds[1]);
+  int32_t constexpr num_stalled = 10000;
+  for (int32_t i = 0; i < num_stalled; ++i) {
+    juno::logger::info("stalled message ", i);
+  }
+  ASSERT(juno::logger::droppedMessages() > 0);
+  ASSERT(juno::logger::droppedMessages() <=
+         num_stalled - juno::logger::queue_capacity);
+
+  // Read the pipe, so the flusher can finish. reset() drains the queue and returns to
+  // synchronous mode.
+  std::thread reader([&]() {
+    char data[4096];
+    while (read(fds[0], data, sizeof(data)) > 0) {
+    }
+  });
+  juno::logger::reset();
+  ASSERT(!juno::logger::asynchronous);
+  ASSERT(juno::logger::droppedMessages() == 0);
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdout);
+  reader.join();
+  close(fds[0]);
+}
+
+TEST_CASE(deferredTest)
+{
+  juno::logger::reset();
+  juno::logger::level = juno::logger::levels::debug;
+  juno::logger::float_precision = 1;
+
+  // In synchronous mode, the message is not formatted until flush()
+  juno::logger::info("immediate");
+  std::string const s = "std::string";
+  juno::logger::deferredInfo("deferred ", 42, " ", 1.5, " ", s, " ", Point{1, 2});
+  ASSERT(juno::logger::getLastMessage().find("immediate") != std::string_view::npos);
+  juno::logger::flush();
+  std::string_view const last_message = juno::logger::getLastMessage();
+  ASSERT(last_message.find("INFO - deferred 42 1.5 std::string (1.0, 2.0)") !=
+         std::string_view::npos);
+
+  // Filtered by level at the call site
+  juno::logger::level = juno::logger::levels::info;
+  juno::logger::deferredDebug("filtered");
+  juno::logger::flush();
+  ASSERT(juno::logger::getLastMessage().find("filtered") == std::string_view::npos);
+
+  // A string longer than a record is truncated
+  std::string const long_string(1000, 'x');
+  juno::logger::deferredInfo("long ", long_string, " end");
+  juno::logger::flush();
+  std::string_view const long_message = juno::logger::getLastMessage();
+  ASSERT(long_message.find("INFO - long xxxx") != std::string_view::npos);
+  ASSERT(long_message.find("x end") != std::string_view::npos);
+  ASSERT(long_message.size() < static_cast<size_t>(juno::logger::buffer_size));
+
+  // Many threads, many more records than fit in a ring
+  juno::logger::level = juno::logger::levels::debug;
+  int32_t constexpr num_messages = 10000;
+#pragma omp parallel for
+  for (int32_t i = 0; i < num_messages; ++i) {
+    juno::logger::deferredDebug("deferred thread ", omp_get_thread_num(), " message ",
+                                i);
+  }
+  juno::logger::flush();
+
+  juno::logger::reset();
+}
+
+TEST_CASE(rankTest)
+{
+  juno::logger::reset();
+  ASSERT(juno::logger::rank_filter == juno::logger::rank_filters::all);
+  ASSERT(juno::logger::rank() >= 0);
+
+  // Without a launcher, this process is the root rank
+  if (juno::logger::rank() == 0) {
+    juno::logger::rank_filter = juno::logger::rank_filters::root;
+    juno::logger::info("root only");
+    ASSERT(juno::logger::getLastMessage().find("root only") != std::string_view::npos);
+    juno::logger::rank_filter = juno::logger::rank_filters::strided;
+    juno::logger::rank_stride = 4;
+    juno::logger::info("every 4th rank");
+    ASSERT(juno::logger::getLastMessage().find("every 4th") != std::string_view::npos);
+  }
+
+  // Identical messages are written once, with their counts
+  juno::logger::reset();
+  juno::logger::aggregated = true;
+  for (int32_t i = 0; i < 3; ++i) {
+    juno::logger::info("repeated");
+  }
+  juno::logger::warn("once");
+  juno::logger::aggregate();
+  if (juno::logger::rank() == 0) {
+    ASSERT(juno::logger::getLastMessage().find("WARN - once [count: 1, ranks: 1]") !=
+           std::string_view::npos);
+  }
+
+  // reset() writes the messages that have not been aggregated
+  juno::logger::aggregated = true;
+  juno::logger::info("pending");
+  juno::logger::info("pending");
+  juno::logger::reset();
+  ASSERT(juno::logger::getLastMessage().find("INFO - pending [count: 2, ranks: 1]") !=
+         std::string_view::npos);
+
+  // A text that fills the buffer is truncated to make room for the counts
+  std::string const long_text(240, 'y');
+  juno::logger::aggregated = true;
+  juno::logger::info(long_text);
+  juno::logger::reset();
+  std::string_view const long_message = juno::logger::getLastMessage();
+  ASSERT(long_message.find("INFO - yyyy") != std::string_view::npos);
+  ASSERT(long_message.find("y [count: 1, ranks: 1]") != std::string_view::npos);
+  ASSERT(long_message.size() < static_cast<size_t>(juno::logger::buffer_size));
+}
+
+namespace
+{
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+int32_t callback_count = 0;
+
+void
+countErrors(std::string_view const message)
+{
+  ASSERT(message.starts_with("batch item "));
+  ++callback_count;
+}
+
+} // namespace
+
+TEST_CASE(errorPolicyTest)
+{
+  juno::logger::reset();
+  ASSERT(juno::logger::error_policy == juno::logger::error_policies::fatal);
+  ASSERT(juno::logger::errorCount() == 0);
+  ASSERT(juno::logger::getErrors().empty());
+
+  // Throw
+  juno::logger::error_policy = juno::logger::error_policies::exception;
+  bool caught = false;
+  try {
+    juno::logger::error("bad input ", 3);
+  } catch (juno::logger::Error const & e) {
+    caught = true;
+    ASSERT(std::string_view(e.what()) == "bad input 3");
+  }
+  ASSERT(caught);
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(std::string_view(juno::logger::getErrors()[0].message) == "bad input 3");
+
+  // Callback. The record only keeps the most recent errors.
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  juno::logger::error_callback = countErrors;
+  int32_t constexpr num_errors = 20;
+  for (int32_t i = 0; i < num_errors; ++i) {
+    juno::logger::error("batch item ", i, " failed");
+  }
+  ASSERT(callback_count == num_errors);
+  ASSERT(juno::logger::errorCount() == num_errors + 1);
+  auto const errors = juno::logger::getErrors();
+  ASSERT(errors.size() == juno::logger::error_record_capacity);
+  ASSERT(std::string_view(errors.back().message) == "batch item 19 failed");
+
+  juno::logger::clearErrors();
+  ASSERT(juno::logger::errorCount() == 0);
+  juno::logger::reset();
+  ASSERT(juno::logger::error_callback == nullptr);
+}
+
+TEST_SUITE(logger)
+{
+  TEST(loggerTest);
+  TEST(threadedTest);
+  TEST(asynchronousTest);
+  TEST(deferredTest);
+  TEST(rankTest);
+  TEST(errorPolicyTest);
+}
 
 auto
 main() -> int
@@ -0,0 +1,111 @@
+#include <juno/common/logger.hpp>
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+#include "../test_macros.hpp"
+
+// Check that the std::to_chars based toBuffer specializations produce the same text as
+// the snprintf based path they replaced.
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------
+// The previous implementation: snprintf once for the length, then again to write.
+// buffer_pos must point to the start of a buffer of buffer_size chars.
+template <class T>
+auto
+snprintfToBuffer(char * buffer_pos, char const * format, T const value) -> char *
+{
+  int32_t const len = snprintf(nullptr, 0, format, value);
+  snprintf(buffer_pos, juno::logger::buffer_size, format, value);
+  return buffer_pos + len;
+}
+
+//----------------------------------------------------------------------------------------
+template <class T>
+auto
+toChars(T const value) -> std::string_view
+{
+  char * const first = juno::logger::buffer;
+  char * const last = juno::logger::impl::toBuffer(first, value);
+  return {first, static_cast<size_t>(last - first)};
+}
+
+//----------------------------------------------------------------------------------------
+template <class T>
+auto
+toSnprintf(char * first, char const * format, T const value) -> std::string_view
+{
+  char * const last = snprintfToBuffer(first, format, value);
+  return {first, static_cast<size_t>(last - first)};
+}
+
+} // namespace
+
+TEST_CASE(integers)
+{
+  char expected[juno::logger::buffer_size];
+  int32_t const i32s[] = {0, 1, -1, 42, -12345, INT32_MAX, INT32_MIN};
+  for (auto const v : i32s) {
+    ASSERT(toChars(v) == toSnprintf(expected, "%d", v));
+  }
+  uint32_t const u32s[] = {0U, 1U, 4000000000U, UINT32_MAX};
+  for (auto const v : u32s) {
+    ASSERT(toChars(v) == toSnprintf(expected, "%u", v));
+  }
+  int64_t const i64s[] = {0, -1, INT64_MAX, INT64_MIN};
+  for (auto const v : i64s) {
+    ASSERT(toChars(v) == toSnprintf(expected, "%ld", v));
+  }
+  uint64_t const u64s[] = {0, 1, UINT64_MAX};
+  for (auto const v : u64s) {
+    ASSERT(toChars(v) == toSnprintf(expected, "%lu", v));
+  }
+}
+
+TEST_CASE(floats)
+{
+  juno::logger::reset();
+  char expected[juno::logger::buffer_size];
+
+  // Default: fixed with 6 digits, the same as "%f"
+  double const doubles[] = {0.0, 1.0, -1.5, 3.14159265358979, 1e-7, 123456.789};
+  for (auto const v : doubles) {
+    ASSERT(toChars(v) == toSnprintf(expected, "%f", v));
+  }
+  ASSERT(toChars(0.25F) == "0.250000");
+
+  // Fixed with a different precision
+  juno::logger::float_precision = 2;
+  ASSERT(toChars(3.14159) == "3.14");
+  ASSERT(toChars(2.5F) == "2.50");
+
+  // Shortest round-trip
+  juno::logger::float_precision = -1;
+  ASSERT(toChars(0.1) == "0.1");
+  ASSERT(toChars(0.1F) == "0.1");
+  for (auto const v : doubles) {
+    std::string_view const sv = toChars(v);
+    double parsed = 0.0;
+    std::from_chars(sv.data(), sv.data() + sv.size(), parsed);
+    ASSERT_NEAR(parsed, v, 0.0); // the shortest form round-trips exactly
+  }
+  juno::logger::reset();
+}
+
+TEST_SUITE(logger_format)
+{
+  TEST(integers);
+  TEST(floats);
+}
+
+auto
+main() -> int
+{
+  RUN_SUITE(logger_format);
+  return 0;
+}
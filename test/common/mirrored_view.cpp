@@ -0,0 +1,95 @@
+#include <juno/common/mirrored_view.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "../test_macros.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+using FloatView = juno::MirroredView<Float>;
+using DoubleBuffer = juno::DoubleBufferedView<Float>;
+
+TEST_CASE(roundTrip)
+{
+  Int constexpr n = 1000;
+  FloatView const x("x", n);
+  ASSERT(x.size() == n);
+  ASSERT(x.host().size() == static_cast<size_t>(n));
+  ASSERT(x.device().size() == static_cast<size_t>(n));
+  for (Int i = 0; i < n; ++i) {
+    x.host()(i) = static_cast<Float>(i);
+  }
+
+  juno::DeviceExecSpace const space;
+  x.toDevice(space);
+  auto const d_x = x.device();
+  Kokkos::parallel_for(
+      "double", juno::rangePolicy(0, n, space),
+      KOKKOS_LAMBDA(Int const i) { d_x(i) *= 2; });
+  x.toHost(space);
+  space.fence();
+  for (Int i = 0; i < n; ++i) {
+    ASSERT_NEAR(x.host()(i), static_cast<Float>(2 * i), eps);
+  }
+}
+
+TEST_CASE(fromVector)
+{
+  std::vector<Int> const v = {3, 1, 4, 1, 5};
+  auto const d_v = juno::toView<juno::DeviceMemSpace>("v", v);
+  ASSERT(d_v.size() == v.size());
+  auto const h_v = Kokkos::create_mirror_view_and_copy(juno::HostMemSpace(), d_v);
+  for (size_t i = 0; i < v.size(); ++i) {
+    ASSERT(h_v(i) == v[i]);
+  }
+  ASSERT(juno::toView<juno::HostMemSpace>("empty", std::vector<Float>{}).size() == 0);
+}
+
+TEST_CASE(doubleBuffered)
+{
+  Int constexpr n = 1000;
+  Int constexpr num_batches = 5;
+  DoubleBuffer buf("x", n);
+  auto const fill = [](auto const & host, Int const batch) {
+    for (Int i = 0; i < n; ++i) {
+      host(i) = static_cast<Float>(batch + 1);
+    }
+  };
+
+  fill(buf.acquireBack(), 0);
+  buf.beginUpload();
+  buf.swap();
+  for (Int b = 0; b < num_batches; ++b) {
+    Float sum = 0;
+    auto const d_x = buf.front().device();
+    Kokkos::parallel_reduce(
+        "sum", juno::rangePolicy(0, n, buf.computeSpace()),
+        KOKKOS_LAMBDA(Int const i, Float & update) { update += d_x(i); }, sum);
+    if (b + 1 < num_batches) {
+      fill(buf.acquireBack(), b + 1);
+      buf.beginUpload();
+    }
+    // Reducing into a host scalar waits for the kernel
+    ASSERT_NEAR(sum, static_cast<Float>(n * (b + 1)), eps);
+    buf.swap();
+  }
+  buf.fence();
+}
+
+TEST_SUITE(mirrored_view)
+{
+  TEST(roundTrip);
+  TEST(fromVector);
+  TEST(doubleBuffered);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(mirrored_view);
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include <juno/common/profiler.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "../test_macros.hpp"
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------
+auto
+findNode(std::vector<juno::profiler::ProfileNode> const & profile,
+         std::string const & name) -> juno::profiler::ProfileNode const *
+{
+  for (auto const & node : profile) {
+    if (node.name == name) {
+      return &node;
+    }
+  }
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------------------
+// Volatile, so the work is not removed
+auto
+work(int32_t const n) -> double
+{
+  double volatile sum = 0.0;
+  for (int32_t i = 0; i < n; ++i) {
+    sum = sum + static_cast<double>(i);
+  }
+  return sum;
+}
+
+} // namespace
+
+TEST_CASE(nestingTest)
+{
+  juno::profiler::reset();
+  juno::profiler::enabled = true;
+  {
+    PROFILE_SCOPE("outer");
+    for (int32_t i = 0; i < 3; ++i) {
+      PROFILE_SCOPE("inner");
+      work(1000);
+    }
+    {
+      // A name with the same contents, but different storage, is the same node
+      std::string const name = "inner";
+      PROFILE_SCOPE(name.c_str());
+      work(1000);
+    }
+  }
+  auto const profile = juno::profiler::getProfile();
+  ASSERT(profile.size() == 2);
+  ASSERT(profile[0].name == "outer");
+  ASSERT(profile[0].parent == -1);
+  ASSERT(profile[0].depth == 0);
+  ASSERT(profile[0].calls == 1);
+  ASSERT(profile[0].threads == 1);
+  ASSERT(profile[1].name == "inner");
+  ASSERT(profile[1].parent == 0);
+  ASSERT(profile[1].depth == 1);
+  ASSERT(profile[1].calls == 4);
+  ASSERT(profile[1].time <= profile[0].time);
+  juno::profiler::report();
+  juno::profiler::reset();
+}
+
+TEST_CASE(disabledTest)
+{
+  juno::profiler::reset();
+  ASSERT(!juno::profiler::enabled);
+  {
+    PROFILE_SCOPE("disabled");
+    work(1000);
+  }
+  ASSERT(juno::profiler::getProfile().empty());
+
+  // A timer started while disabled must not stop a timer started after enabling
+  juno::profiler::enabled = true;
+  juno::profiler::start("enabled");
+  juno::profiler::enabled = false;
+  {
+    PROFILE_SCOPE("disabled");
+  }
+  juno::profiler::stop();
+  auto const profile = juno::profiler::getProfile();
+  ASSERT(profile.size() == 1);
+  ASSERT(profile[0].name == "enabled");
+  ASSERT(profile[0].calls == 1);
+  juno::profiler::reset();
+}
+
+TEST_CASE(threadedTest)
+{
+  juno::profiler::reset();
+  juno::profiler::enabled = true;
+  int32_t const nthreads = omp_get_max_threads();
+  {
+    PROFILE_SCOPE("serial");
+#pragma omp parallel default(none)
+    {
+      PROFILE_SCOPE("parallel");
+      for (int32_t i = 0; i < 10; ++i) {
+        PROFILE_SCOPE("task");
+        work(100);
+      }
+    }
+  }
+  // Worker threads have no enclosing timer, so their "parallel" is top-level, while the
+  // master's is nested under "serial".
+  auto const profile = juno::profiler::getProfile();
+  auto const * const serial = findNode(profile, "serial");
+  ASSERT(serial != nullptr);
+  ASSERT(serial->calls == 1);
+  uint64_t parallel_calls = 0;
+  uint64_t task_calls = 0;
+  int32_t parallel_threads = 0;
+  for (auto const & node : profile) {
+    if (node.name == "parallel") {
+      parallel_calls += node.calls;
+      parallel_threads += node.threads;
+    } else if (node.name == "task") {
+      task_calls += node.calls;
+    }
+  }
+  ASSERT(parallel_calls == static_cast<uint64_t>(nthreads));
+  ASSERT(parallel_threads == nthreads);
+  ASSERT(task_calls == 10 * static_cast<uint64_t>(nthreads));
+  juno::profiler::report();
+  juno::profiler::reset();
+}
+
+TEST_SUITE(profiler)
+{
+  TEST(nestingTest);
+  TEST(disabledTest);
+  TEST(threadedTest);
+}
+
+auto
+main() -> int
+{
+  RUN_SUITE(profiler);
+  return 0;
+}
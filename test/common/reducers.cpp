@@ -0,0 +1,106 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/reducers.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath>       // std::abs
+#include <limits>      // std::numeric_limits
+#include <type_traits> // std::is_same_v
+#include <utility>     // std::make_pair
+
+#include "../test_macros.hpp"
+
+namespace
+{
+
+// Many small terms after a large one, which a naive float sum loses entirely
+Int constexpr num_terms = 1 << 22;
+
+auto
+term(Int const i) -> float
+{
+  return i == 0 ? 1e5F : 1e-4F * static_cast<float>(1 + i % 7);
+}
+
+// The sum, to about the precision of double
+auto
+exactSum() -> double
+{
+  juno::CompensatedSum<double> sum;
+  for (Int i = 0; i < num_terms; ++i) {
+    sum += static_cast<double>(term(i));
+  }
+  return sum.value();
+}
+
+} // namespace
+
+TEST_CASE(types)
+{
+  STATIC_ASSERT((std::is_same_v<FloatStorage, Float>));
+  STATIC_ASSERT(sizeof(FloatAccum) >= sizeof(Float));
+#if JUNO_ENABLE_MIXED_PRECISION
+  STATIC_ASSERT((std::is_same_v<FloatAccum, double>));
+#endif
+}
+
+TEST_CASE(compensated)
+{
+  double const exact = exactSum();
+  float naive = 0;
+  juno::CompensatedSum<float> sum;
+  for (Int i = 0; i < num_terms; ++i) {
+    naive += term(i);
+    sum += term(i);
+  }
+  ASSERT(std::abs(static_cast<double>(naive) - exact) > 1e-2 * exact);
+  ASSERT(std::abs(static_cast<double>(sum.value()) - exact) <= 2e-7 * exact);
+
+  // In parallel, with the partial sums joined
+  juno::CompensatedSum<float> parallel;
+  Kokkos::parallel_reduce(
+      "sum", juno::rangePolicy<juno::HostExecSpace>(0, num_terms),
+      KOKKOS_LAMBDA(Int const i, juno::CompensatedSum<float> & s) { s += term(i); },
+      juno::KahanSum<float, Kokkos::HostSpace>(parallel));
+  ASSERT(std::abs(static_cast<double>(parallel.value()) - exact) <= 2e-7 * exact);
+}
+
+TEST_CASE(pairwise)
+{
+  double const exact = exactSum();
+  Kokkos::View<Float *, juno::HostMemSpace> const x("x", num_terms);
+  for (Int i = 0; i < num_terms; ++i) {
+    x(i) = static_cast<Float>(term(i));
+  }
+  double const sum = static_cast<double>(juno::pairwiseSum("sum", x));
+  auto const eps = static_cast<double>(std::numeric_limits<Float>::epsilon());
+  ASSERT(std::abs(sum - exact) <= 4 * eps * exact);
+
+  // Partial blocks, and nothing
+  Kokkos::View<Float *, juno::HostMemSpace> const head =
+      Kokkos::subview(x, std::make_pair(1, 100));
+  double head_exact = 0;
+  for (Int i = 1; i < 100; ++i) {
+    head_exact += static_cast<double>(x(i));
+  }
+  ASSERT_NEAR(static_cast<double>(juno::pairwiseSum("sum", head)), head_exact,
+              1e-6 * head_exact);
+  Kokkos::View<Float *, juno::HostMemSpace> const none =
+      Kokkos::subview(x, std::make_pair(0, 0));
+  ASSERT_NEAR(juno::pairwiseSum("sum", none), 0, 0); // an empty sum is exactly 0
+}
+
+TEST_SUITE(reducers)
+{
+  TEST_CONCURRENT(types);
+  TEST(compensated);
+  TEST(pairwise);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(reducers);
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/scan.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "../test_macros.hpp"
+
+using IntView = Kokkos::View<Int *, juno::HostMemSpace>;
+
+TEST_CASE(exclusiveScan)
+{
+  Int constexpr n = 1000;
+  IntView const counts("counts", n);
+  IntView const offsets("offsets", n + 1);
+  for (Int i = 0; i < n; ++i) {
+    counts(i) = i % 3;
+  }
+  Size const total = juno::impl::exclusiveScan(counts, offsets);
+  ASSERT(offsets(0) == 0);
+  for (Int i = 0; i < n; ++i) {
+    ASSERT(offsets(i + 1) == offsets(i) + counts(i));
+  }
+  ASSERT(total == offsets(n));
+
+  // Nothing to scan
+  IntView const none("none", 0);
+  IntView const one("one", 1);
+  ASSERT(juno::impl::exclusiveScan(none, one) == 0);
+}
+
+TEST_CASE(overflow)
+{
+  // The total is exact even when the offsets cannot hold it
+  bool constexpr narrow = sizeof(Int) < sizeof(Size);
+  Int const count = narrow ? intMax() / 2 : static_cast<Int>(Size{1} << 40);
+  IntView const counts("counts", 3);
+  IntView const offsets("offsets", 4);
+  for (Int i = 0; i < 3; ++i) {
+    counts(i) = count;
+  }
+  Size const total = juno::impl::exclusiveScan(counts, offsets);
+  ASSERT(total == 3 * static_cast<Size>(count));
+  ASSERT((total > intMax()) == narrow);
+}
+
+TEST_CASE(sizeIndices)
+{
+  // A range larger than Int, with Size indices: only the last few are visited
+  using ExecSpace = juno::HostExecSpace;
+  Size constexpr end = Size{1} << 33;
+  Size sum = 0;
+  Kokkos::parallel_reduce(
+      "sum", juno::rangePolicy<ExecSpace, Size>(end - 4, end),
+      KOKKOS_LAMBDA(Size const i, Size & s) { s += i - (end - 4); }, sum);
+  ASSERT(sum == 6);
+}
+
+TEST_SUITE(scan)
+{
+  TEST(exclusiveScan);
+  TEST(overflow);
+  TEST(sizeIndices);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(scan);
+  return 0;
+}
@@ -0,0 +1,144 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/stage_cache.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <filesystem> // std::filesystem::temp_directory_path, std::filesystem::remove_all
+#include <fstream>    // std::fstream
+#include <string>
+#include <vector>
+
+#include "../test_macros.hpp"
+
+namespace
+{
+
+auto
+tempDirectory(std::string const & name) -> std::string
+{
+  auto const path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(path);
+  return path.string();
+}
+
+} // namespace
+
+TEST_CASE(keys)
+{
+  uint64_t const a = juno::stageKey("mix", {1, 2});
+  ASSERT(a == juno::stageKey("mix", {1, 2}));
+  ASSERT(a != juno::stageKey("mix", {2, 1}));
+  ASSERT(a != juno::stageKey("tracks", {1, 2}));
+  ASSERT(a != juno::stageKey("mix", {1, 2, 3}));
+  ASSERT(juno::hashString("ab") != juno::hashString("ba"));
+  ASSERT(juno::hashValue(Float{1}) != juno::hashValue(Float{2}));
+}
+
+TEST_CASE(reader)
+{
+  juno::StageWriter writer;
+  writer.write(Int{7});
+  writer.writeVector(std::vector<Float>{1, 2, 3});
+  writer.writeString("fuel");
+  Kokkos::View<Int *, juno::HostMemSpace> const view("view", 2);
+  view(0) = 4;
+  view(1) = 5;
+  writer.writeView(view);
+
+  juno::StageReader reader(writer.bytes());
+  ASSERT(reader.read<Int>() == 7);
+  auto const values = reader.readVector<Float>();
+  ASSERT(values.size() == 3);
+  ASSERT_NEAR(values[2], 3, static_cast<Float>(1e-6));
+  ASSERT(reader.readString() == "fuel");
+  auto const read_view = reader.readView<Int>("read_view");
+  ASSERT(read_view.size() == 2);
+  ASSERT(read_view(1) == 5);
+  ASSERT(reader.ok());
+  ASSERT(reader.atEnd());
+
+  // Past the end
+  ASSERT(reader.read<Int>() == 0);
+  ASSERT(!reader.ok());
+
+  // An array of the wrong size
+  juno::StageReader sized(writer.bytes());
+  sized.read<Int>();
+  Kokkos::View<Float *, juno::HostMemSpace> const two("two", 2);
+  sized.readInto(two);
+  ASSERT(!sized.ok());
+
+  // A reader of nothing is not ok
+  ASSERT(!juno::StageReader().ok());
+}
+
+TEST_CASE(round_trip)
+{
+  auto const directory = tempDirectory("juno_test_stage_cache");
+  juno::StageCache const cache(directory);
+  ASSERT(cache.enabled());
+  ASSERT(std::filesystem::is_directory(directory));
+
+  uint64_t const key = juno::stageKey("mix", {42});
+  ASSERT(!cache.read("mix", key).ok());
+  juno::StageWriter writer;
+  writer.writeVector(std::vector<int32_t>{1, 2, 3});
+  ASSERT(cache.write("mix", key, writer));
+  auto reader = cache.read("mix", key);
+  ASSERT(reader.ok());
+  ASSERT(reader.readVector<int32_t>().size() == 3);
+  ASSERT(reader.atEnd());
+
+  // Another key or stage misses
+  ASSERT(!cache.read("mix", key + 1).ok());
+  ASSERT(!cache.read("tracks", key).ok());
+
+  // A damaged file misses
+  {
+    std::fstream file(cache.filename("mix", key),
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-1, std::ios::end);
+    file.put('x');
+  }
+  ASSERT(!cache.read("mix", key).ok());
+  ASSERT(cache.write("mix", key, writer));
+  ASSERT(cache.read("mix", key).ok());
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(disabled)
+{
+  juno::StageCache const cache;
+  ASSERT(!cache.enabled());
+  juno::StageWriter writer;
+  writer.write(Int{1});
+  ASSERT(!cache.write("mix", 1, writer));
+  ASSERT(!cache.read("mix", 1).ok());
+
+  // A directory that cannot be created
+  auto const directory = tempDirectory("juno_test_stage_cache_file");
+  std::ofstream(directory) << "a file";
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  juno::StageCache const bad(directory + "/cache");
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(!bad.enabled());
+  juno::logger::reset();
+  std::filesystem::remove_all(directory);
+}
+
+TEST_SUITE(stage_cache)
+{
+  TEST(keys);
+  TEST(reader);
+  TEST(round_trip);
+  TEST(disabled);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(stage_cache);
+  return 0;
+}
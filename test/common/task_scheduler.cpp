@@ -0,0 +1,130 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/task_scheduler.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include <omp.h>
+
+#include "../test_macros.hpp"
+
+TEST_CASE(partition)
+{
+  // Uniform costs split by count
+  std::vector<double> const uniform(100, 1);
+  auto offsets = juno::partitionByCost(uniform, 4);
+  ASSERT(offsets == (std::vector<Int>{0, 25, 50, 75, 100}));
+
+  // The expensive elements get parts of their own
+  std::vector<double> skewed(100, 1);
+  skewed[0] = 100;
+  skewed[1] = 100;
+  offsets = juno::partitionByCost(skewed, 3);
+  ASSERT(offsets.size() == 4);
+  ASSERT(offsets[1] == 1);
+  ASSERT(offsets[2] == 2);
+  ASSERT(offsets[3] == 100);
+
+  // More parts than elements, and no costs
+  offsets = juno::partitionByCost({1, 1}, 4);
+  ASSERT(offsets.front() == 0 && offsets.back() == 2);
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    ASSERT(offsets[i - 1] <= offsets[i]);
+  }
+  offsets = juno::partitionByCost(std::vector<double>(10, 0), 2);
+  ASSERT(offsets == (std::vector<Int>{0, 5, 10}));
+  offsets = juno::partitionByCost({}, 3);
+  ASSERT(offsets == (std::vector<Int>{0, 0, 0, 0}));
+}
+
+TEST_CASE(tasks)
+{
+  // Every task runs exactly once, however wrong the costs are
+  Int constexpr num_tasks = 1000;
+  std::vector<double> costs(num_tasks, 1);
+  costs[0] = 1e6;
+  std::vector<std::atomic<Int>> runs(num_tasks);
+  auto const balance = juno::runTasks("tasks", costs, [&](Int const t) {
+    runs[static_cast<size_t>(t)].fetch_add(1, std::memory_order_relaxed);
+  });
+  for (auto const & n : runs) {
+    ASSERT(n == 1);
+  }
+  Int total = 0;
+  for (Int const n : balance.num_tasks) {
+    total += n;
+  }
+  ASSERT(total == num_tasks);
+  ASSERT(balance.busy_seconds.size() == balance.num_tasks.size());
+  ASSERT(balance.imbalance() >= 1);
+  ASSERT(balance.imbalance() <= static_cast<double>(balance.busy_seconds.size()) + 1e-9);
+
+  // A nested call gets a team of one thread, however many runTasks asked for
+  if (omp_get_max_active_levels() == 1) {
+    juno::LoadBalance nested;
+#pragma omp parallel num_threads(2)
+    {
+#pragma omp single
+      nested = juno::runTasks("nested", costs, [](Int) {});
+    }
+    ASSERT(nested.busy_seconds.size() == 1);
+    ASSERT(nested.num_tasks.size() == 1);
+    ASSERT(nested.num_tasks[0] == num_tasks);
+    ASSERT_NEAR(nested.imbalance(), 1.0, 1e-12);
+  }
+
+  // No tasks
+  auto const none = juno::runTasks("none", {}, [](Int) {});
+  ASSERT_NEAR(none.imbalance(), 1.0, 1e-12);
+}
+
+TEST_CASE(weighted)
+{
+  // Elements whose cost grows along the array, as when a mesh mixes coarse and fine
+  // pin cells
+  Int constexpr n = 10000;
+  std::vector<double> costs(n);
+  for (Int i = 0; i < n; ++i) {
+    costs[static_cast<size_t>(i)] = static_cast<double>(1 + i / 100);
+  }
+  std::vector<Int> visits(n, 0);
+  std::atomic<Int> num_wrong = 0;
+  juno::parallelForWeighted(
+      "weighted", costs,
+      [&](Int const i) {
+        if (visits[static_cast<size_t>(i)]++ != 0) {
+          ++num_wrong;
+        }
+      },
+      4);
+  ASSERT(num_wrong == 0);
+  for (Int const v : visits) {
+    ASSERT(v == 1);
+  }
+
+  // A dynamic policy visits every iteration once too
+  Kokkos::View<Int *, juno::HostMemSpace> const counts("counts", n);
+  Kokkos::parallel_for(
+      "dynamic", juno::dynamicRangePolicy<juno::HostExecSpace>(0, n, 16),
+      [&](Int const i) { counts(i) += 1; });
+  for (Int i = 0; i < n; ++i) {
+    ASSERT(counts(i) == 1);
+  }
+}
+
+TEST_SUITE(task_scheduler)
+{
+  TEST_CONCURRENT(partition);
+  TEST(tasks);
+  TEST(weighted);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(task_scheduler);
+  return 0;
+}
@@ -0,0 +1,228 @@
+#include <juno/common/logger.hpp>
+#include <juno/gmsh/io.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdio>     // std::remove
+#include <filesystem> // std::filesystem::temp_directory_path
+#include <fstream>    // std::ofstream
+#include <string>
+
+#include "../test_macros.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+namespace
+{
+
+// Two unit squares side by side, as in the mesh tests: a quad on surface 1 and two
+// triangles on surface 2, with the lines of the bottom edge on curve 1. The node tags
+// are not contiguous, and the nodes are split into two blocks.
+//  3---4---5
+//  |   | / |
+//  0---1---2
+char const * const two_squares = R"($MeshFormat
+4.1 0 8
+$EndMeshFormat
+$PhysicalNames
+2
+2 1 "Fuel"
+2 2 "Moderator"
+$EndPhysicalNames
+$Entities
+0 1 2 0
+1 0 0 0 2 0 0 0 0
+1 0 0 0 1 1 0 1 1 0
+2 1 0 0 2 1 0 2 1 2 0
+$EndEntities
+$Nodes
+2 6 1 12
+2 1 0 3
+1
+3
+5
+0 0 0
+1 0 0
+2 0 0
+2 2 0 3
+7
+9
+12
+0 1 0
+1 1 0
+2 1 0
+$EndNodes
+$Elements
+3 5 1 5
+1 1 1 2
+1 1 3
+2 3 5
+2 1 3 1
+3 1 3 9 7
+2 2 2 2
+4 3 12 5
+5 3 12 9
+$EndElements
+)";
+
+auto
+writeFile(std::string const & name, std::string const & contents) -> std::string
+{
+  std::string const path = (std::filesystem::temp_directory_path() / name).string();
+  std::ofstream file(path);
+  file << contents;
+  return path;
+}
+
+// An n by n mesh of triangles over the unit square, in blocks of one row each
+auto
+makeTriangleMeshFile(Int const n) -> std::string
+{
+  std::string text = "$MeshFormat\n4.1 0 8\n$EndMeshFormat\n";
+  Int const num_nodes = (n + 1) * (n + 1);
+  text += "$Nodes\n1 " + std::to_string(num_nodes) + " 1 " + std::to_string(num_nodes) +
+          "\n2 1 0 " + std::to_string(num_nodes) + "\n";
+  for (Int i = 1; i <= num_nodes; ++i) {
+    text += std::to_string(i) + "\n";
+  }
+  for (Int j = 0; j <= n; ++j) {
+    for (Int i = 0; i <= n; ++i) {
+      text += std::to_string(static_cast<double>(i) / static_cast<double>(n)) + " " +
+              std::to_string(static_cast<double>(j) / static_cast<double>(n)) + " 0\n";
+    }
+  }
+  text += "$EndNodes\n$Elements\n" + std::to_string(n) + " " +
+          std::to_string(2 * n * n) + " 1 " + std::to_string(2 * n * n) + "\n";
+  Int tag = 1;
+  for (Int j = 0; j < n; ++j) {
+    text += "2 1 2 " + std::to_string(2 * n) + "\n";
+    for (Int i = 0; i < n; ++i) {
+      Int const v = j * (n + 1) + i + 1;
+      text += std::to_string(tag++) + " " + std::to_string(v) + " " +
+              std::to_string(v + 1) + " " + std::to_string(v + n + 2) + "\n";
+      text += std::to_string(tag++) + " " + std::to_string(v) + " " +
+              std::to_string(v + n + 2) + " " + std::to_string(v + n + 1) + "\n";
+    }
+  }
+  text += "$EndElements\n";
+  return writeFile("juno_test_triangles.msh", text);
+}
+
+} // namespace
+
+TEST_CASE(twoSquares)
+{
+  std::string const path = writeFile("juno_test_two_squares.msh", two_squares);
+  auto const soup = juno::readGmshFile(path);
+  std::remove(path.c_str());
+  ASSERT(juno::validate(soup));
+  ASSERT(soup.numVertices() == 6);
+  Float const xs[] = {0, 1, 2, 0, 1, 2};
+  Float const ys[] = {0, 0, 0, 1, 1, 1};
+  for (Int i = 0; i < 6; ++i) {
+    ASSERT_NEAR(soup.x()(i), xs[i], eps);
+    ASSERT_NEAR(soup.y()(i), ys[i], eps);
+    ASSERT_NEAR(soup.z()(i), 0, eps);
+  }
+
+  // The lines are skipped
+  ASSERT(soup.numElements() == 3);
+  ASSERT(soup.elementTypes()(0) == juno::vtk_types::quad);
+  ASSERT(soup.elementTypes()(1) == juno::vtk_types::triangle);
+  ASSERT(soup.elementTypes()(2) == juno::vtk_types::triangle);
+  Int const offsets[] = {0, 4, 7, 10};
+  Int const vertices[] = {0, 1, 4, 3, 1, 5, 2, 1, 5, 4};
+  for (Int i = 0; i < 4; ++i) {
+    ASSERT(soup.elementOffsets()(i) == offsets[i]);
+  }
+  for (Int i = 0; i < 10; ++i) {
+    ASSERT(soup.elementVertices()(i) == vertices[i]);
+  }
+
+  // Fuel is on both surfaces, Moderator on the second
+  ASSERT(soup.numElementSets() == 2);
+  ASSERT(soup.elementSetNames()[0] == "Fuel");
+  ASSERT(soup.elementSetNames()[1] == "Moderator");
+  ASSERT(soup.elementSetOffsets()(1) == 3);
+  ASSERT(soup.elementSetOffsets()(2) == 5);
+  Int const set_elements[] = {0, 1, 2, 1, 2};
+  for (Int i = 0; i < 5; ++i) {
+    ASSERT(soup.elementSetElements()(i) == set_elements[i]);
+  }
+}
+
+TEST_CASE(manyChunks)
+{
+  // Large enough to be split into many chunks
+  Int constexpr n = 100;
+  std::string const path = makeTriangleMeshFile(n);
+  auto const soup = juno::readGmshFile(path);
+  std::remove(path.c_str());
+  ASSERT(juno::validate(soup));
+  ASSERT(soup.numVertices() == (n + 1) * (n + 1));
+  ASSERT(soup.numElements() == 2 * n * n);
+  for (Int j = 0; j <= n; ++j) {
+    for (Int i = 0; i <= n; ++i) {
+      Int const v = j * (n + 1) + i;
+      ASSERT_NEAR(soup.x()(v), static_cast<Float>(i) / n, eps);
+      ASSERT_NEAR(soup.y()(v), static_cast<Float>(j) / n, eps);
+    }
+  }
+  for (Int e = 0; e < 2 * n * n; ++e) {
+    Int const cell = e / 2;
+    Int const v = (cell / n) * (n + 1) + cell % n;
+    ASSERT(soup.elementOffsets()(e + 1) == 3 * (e + 1));
+    ASSERT(soup.elementVertices()(3 * e) == v);
+    ASSERT(soup.elementVertices()(3 * e + 1) == (e % 2 == 0 ? v + 1 : v + n + 2));
+  }
+  ASSERT(soup.numElementSets() == 0);
+}
+
+TEST_CASE(errors)
+{
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  auto const expectError = [](std::string const & name, std::string const & contents) {
+    std::string const path = writeFile(name, contents);
+    auto const num_errors = juno::logger::errorCount();
+    auto const soup = juno::readGmshFile(path);
+    std::remove(path.c_str());
+    ASSERT(juno::logger::errorCount() == num_errors + 1);
+    ASSERT(soup.numVertices() == 0);
+    ASSERT(soup.numElements() == 0);
+  };
+
+  std::string const text = two_squares;
+  auto const replace = [&text](std::string const & from, std::string const & to) {
+    std::string result = text;
+    result.replace(result.find(from), from.size(), to);
+    return result;
+  };
+  expectError("juno_test_version.msh", replace("4.1 0 8", "2.2 0 8"));
+  expectError("juno_test_binary.msh", replace("4.1 0 8", "4.1 1 8"));
+  expectError("juno_test_coordinate.msh", replace("2 0 0\n", "2 zero 0\n"));
+  expectError("juno_test_node_tag.msh", replace("5 3 12 9", "5 3 12 8"));
+  expectError("juno_test_element_type.msh", replace("2 2 2 2", "2 2 99 2"));
+  expectError("juno_test_count.msh", replace("2 6 1 12", "2 7 1 12"));
+
+  auto const num_errors = juno::logger::errorCount();
+  auto const soup = juno::readGmshFile("juno_test_does_not_exist.msh");
+  ASSERT(juno::logger::errorCount() == num_errors + 1);
+  ASSERT(soup.numVertices() == 0);
+  juno::logger::reset();
+}
+
+TEST_SUITE(gmsh_io)
+{
+  TEST(twoSquares);
+  TEST(manyChunks);
+  TEST(errors);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(gmsh_io);
+  return 0;
+}
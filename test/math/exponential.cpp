@@ -0,0 +1,139 @@
+#include <juno/common/execution_policy.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/math/exponential.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath>  // std::exp, std::abs
+#include <limits> // std::numeric_limits
+
+#include "../test_macros.hpp"
+
+namespace
+{
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+// The largest relative error of f against std::exp in double, on [lo, hi]
+template <class F>
+auto
+maxRelativeError(F const & f, double const lo, double const hi) -> double
+{
+  Int constexpr num_points = 100000;
+  double max_error = 0;
+  for (Int i = 0; i <= num_points; ++i) {
+    double const t = static_cast<double>(i) / num_points;
+    auto const x = static_cast<Float>(lo + (hi - lo) * t);
+    double const exact = std::exp(static_cast<double>(x));
+    double const error = std::abs(static_cast<double>(f(x)) - exact) / exact;
+    max_error = error > max_error ? error : max_error;
+  }
+  return max_error;
+}
+
+template <Int Order>
+void
+testRationalOrder()
+{
+  juno::RationalExp<Order> const f;
+  // The range of normal results
+  double const lo = 0.99 * (std::numeric_limits<Float>::min_exponent - 1) * 0.6931;
+  double const hi = 0.99 * (std::numeric_limits<Float>::max_exponent - 1) * 0.6931;
+  ASSERT(maxRelativeError(f, lo, hi) <= juno::rationalExpError(Order));
+  ASSERT(maxRelativeError(f, -1, 1) <= juno::rationalExpError(Order));
+  ASSERT_NEAR(f(0), 1, eps);
+  ASSERT_NEAR(f(static_cast<Float>(-1e4)), 0, eps);
+  ASSERT(f(static_cast<Float>(1e4)) > std::numeric_limits<Float>::max() / 2);
+}
+
+} // namespace
+
+TEST_CASE(rational)
+{
+  STATIC_ASSERT_NEAR(juno::impl::padeExpCoefficient(2, 2), 1.0 / 12, 1e-15);
+  STATIC_ASSERT_NEAR(juno::impl::padeExpCoefficient(3, 3), 1.0 / 120, 1e-15);
+  STATIC_ASSERT_NEAR(juno::impl::padeExpCoefficient(5, 1), 0.5, 1e-15);
+  testRationalOrder<2>();
+  testRationalOrder<3>();
+  testRationalOrder<4>();
+  testRationalOrder<5>();
+
+  // The error bounds decrease with the order, which is chosen by the tolerance
+  for (Int order = juno::min_rational_exp_order; order < juno::max_rational_exp_order;
+       ++order) {
+    ASSERT(juno::rationalExpError(order + 1) <= juno::rationalExpError(order));
+  }
+  STATIC_ASSERT(juno::rationalExpOrder(1) == juno::min_rational_exp_order);
+  STATIC_ASSERT(juno::rationalExpOrder(1e-5) == 2);
+  STATIC_ASSERT(juno::rationalExpOrder(1e-6) == 3);
+  STATIC_ASSERT(juno::rationalExpOrder(0) == juno::max_rational_exp_order);
+  ASSERT(juno::rationalExpError(juno::rationalExpOrder(1e-6)) <= 1e-6);
+}
+
+TEST_CASE(table)
+{
+  for (double const tolerance : {1e-2, 1e-4, 1e-6}) {
+    auto const table = juno::makeExpTable<juno::HostMemSpace>(tolerance);
+    ASSERT(table.numIntervals() > 0);
+    ASSERT_NEAR(static_cast<double>(table.tolerance()), tolerance, 1e-3 * tolerance);
+    Int constexpr num_points = 100000;
+    double max_error = 0;
+    for (Int i = 0; i <= num_points; ++i) {
+      auto const x = static_cast<Float>(-40.0 * static_cast<double>(i) / num_points);
+      double const exact = std::exp(static_cast<double>(x));
+      double const error = std::abs(static_cast<double>(table(x)) - exact);
+      max_error = error > max_error ? error : max_error;
+    }
+    ASSERT(max_error <= tolerance);
+    ASSERT_NEAR(table(0), 1, eps);
+    ASSERT_NEAR(table(static_cast<Float>(-1e30)), 0, eps);
+    // A positive x extrapolates the first interval instead of reading before the table
+    ASSERT_NEAR(static_cast<double>(table(static_cast<Float>(1e-3))), 1.0,
+                tolerance + 1e-3);
+  }
+
+  // Too tight or too loose
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  ASSERT(juno::makeExpTable<juno::HostMemSpace>(1e-20).numIntervals() == 0);
+  ASSERT(juno::makeExpTable<juno::HostMemSpace>(1).numIntervals() == 0);
+  ASSERT(juno::logger::errorCount() == 2);
+  juno::logger::reset();
+}
+
+TEST_CASE(kernel)
+{
+  // Both in a kernel, for the attenuation 1 - exp(-tau)
+  using ExecSpace = juno::HostExecSpace;
+  Int constexpr n = 4096;
+  auto const table = juno::makeExpTable<juno::HostMemSpace>(1e-5);
+  juno::RationalExp<juno::rationalExpOrder(1e-5)> const rational;
+  Float max_error = 0;
+  Kokkos::parallel_reduce(
+      "attenuation", juno::rangePolicy<ExecSpace>(0, n),
+      KOKKOS_LAMBDA(Int const i, Float & e) {
+        Float const tau = static_cast<Float>(i) / 256;
+        Float const exact = 1 - Kokkos::exp(-tau);
+        Float const a = Kokkos::abs(1 - table(-tau) - exact);
+        Float const b = Kokkos::abs(1 - rational(-tau) - exact);
+        Float const worst = a > b ? a : b;
+        e = worst > e ? worst : e;
+      },
+      Kokkos::Max<Float>(max_error));
+  ASSERT(max_error <= static_cast<Float>(1e-5));
+}
+
+TEST_SUITE(exponential)
+{
+  TEST_CONCURRENT(rational);
+  TEST(table);
+  TEST(kernel);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(exponential);
+  return 0;
+}
@@ -0,0 +1,159 @@
+#include <juno/math/krylov.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath>
+
+#include "../test_macros.hpp"
+
+using Matrix = juno::CSRMatrix<juno::HostMemSpace>;
+using Vector = Kokkos::View<Float *, juno::HostMemSpace>;
+
+namespace
+{
+
+// The 5-point convection-diffusion operator on an n by n grid, with Dirichlet
+// boundaries: -laplacian(u) + c du/dx. Nonsymmetric for c != 0.
+auto
+makeOperator(Int const n, Float const c) -> Matrix
+{
+  Int const num_rows = n * n;
+  Matrix a;
+  a.num_rows = num_rows;
+  a.num_cols = num_rows;
+  a.row_offsets = Matrix::IntView("row_offsets", static_cast<size_t>(num_rows + 1));
+  a.columns = Matrix::IntView("columns", static_cast<size_t>(5 * num_rows));
+  a.values = Matrix::FloatView("values", static_cast<size_t>(5 * num_rows));
+  Int k = 0;
+  for (Int j = 0; j < n; ++j) {
+    for (Int i = 0; i < n; ++i) {
+      // In order of column
+      auto const add = [&](Int const col, Float const value) {
+        a.columns(k) = col;
+        a.values(k) = value;
+        ++k;
+      };
+      Int const row = j * n + i;
+      if (j > 0) {
+        add(row - n, -1);
+      }
+      if (i > 0) {
+        add(row - 1, -1 - c / 2);
+      }
+      add(row, 4);
+      if (i + 1 < n) {
+        add(row + 1, -1 + c / 2);
+      }
+      if (j + 1 < n) {
+        add(row + n, -1);
+      }
+      a.row_offsets(row + 1) = k;
+    }
+  }
+  return a;
+}
+
+template <class A, class M>
+void
+testSolvers(A const & a, M const & m, Int const max_iterations)
+{
+  Int const n = a.num_rows;
+  Vector const exact("exact", static_cast<size_t>(n));
+  for (Int i = 0; i < n; ++i) {
+    exact(i) = std::sin(static_cast<Float>(i) / 7);
+  }
+  Vector const b("b", static_cast<size_t>(n));
+  juno::spmv(a, exact, b);
+  Float const tolerance = static_cast<Float>(1e-5);
+
+  for (Int solver = 0; solver < 2; ++solver) {
+    Vector const x("x", static_cast<size_t>(n));
+    juno::KrylovOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    auto const result = solver == 0 ? juno::gmres(a, m, b, x, options)
+                                    : juno::bicgstab(a, m, b, x, options);
+    ASSERT(result.converged);
+    ASSERT(result.iterations <= max_iterations);
+    ASSERT(result.residual <= tolerance);
+
+    // The residual is the true one
+    Vector const r("r", static_cast<size_t>(n));
+    juno::spmv(a, x, r);
+    Float r_norm = 0;
+    Float b_norm = 0;
+    for (Int i = 0; i < n; ++i) {
+      r_norm += (b(i) - r(i)) * (b(i) - r(i));
+      b_norm += b(i) * b(i);
+    }
+    ASSERT(std::sqrt(r_norm / b_norm) <= 2 * tolerance);
+  }
+}
+
+} // namespace
+
+TEST_CASE(solve)
+{
+  auto const a = makeOperator(24, static_cast<Float>(0.8));
+  auto const ell = juno::makeSlicedELLMatrix(a);
+  juno::IdentityPreconditioner<juno::HostMemSpace> const identity;
+  auto const jacobi = juno::makeJacobiPreconditioner(a);
+  auto const ilu = juno::makeILU0Preconditioner(a);
+  testSolvers(a, identity, 400);
+  testSolvers(ell, identity, 400);
+  testSolvers(a, jacobi, 400);
+  testSolvers(ell, jacobi, 400);
+  // ILU(0) converges in far fewer iterations
+  testSolvers(a, ilu, 60);
+  testSolvers(ell, ilu, 60);
+}
+
+TEST_CASE(options)
+{
+  auto const a = makeOperator(16, 0);
+  auto const m = juno::makeILU0Preconditioner(a);
+  Vector const b("b", static_cast<size_t>(a.num_rows));
+  Vector const x("x", static_cast<size_t>(a.num_rows));
+
+  // A zero right-hand side has the solution 0
+  x(3) = 1;
+  auto result = juno::gmres(a, m, b, x);
+  ASSERT(result.converged);
+  ASSERT(result.iterations == 0);
+  ASSERT_NEAR(x(3), 0, static_cast<Float>(1e-6));
+
+  // The iteration limit is respected, with a short restart and infrequent checks
+  Kokkos::deep_copy(b, 1);
+  juno::KrylovOptions options;
+  options.tolerance = static_cast<Float>(1e-5);
+  options.max_iterations = 3;
+  options.restart = 2;
+  options.check_interval = 10;
+  result = juno::gmres(a, m, b, x, options);
+  ASSERT(!result.converged);
+  ASSERT(result.iterations == 3);
+  result = juno::bicgstab(a, m, b, x, options);
+  ASSERT(result.iterations == 3);
+
+  // An exact initial guess takes no iterations
+  options.max_iterations = 100;
+  result = juno::gmres(a, m, b, x, options);
+  ASSERT(result.converged);
+  result = juno::bicgstab(a, m, b, x, options);
+  ASSERT(result.converged);
+  ASSERT(result.iterations == 0);
+}
+
+TEST_SUITE(krylov)
+{
+  TEST(solve);
+  TEST(options);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(krylov);
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include <juno/math/matrix.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+#include "../test_macros.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-3);
+
+namespace
+{
+
+// Deterministic values in [-1, 1)
+auto
+nextValue(uint32_t & state) -> Float
+{
+  state = state * 1664525U + 1013904223U;
+  return static_cast<Float>(state >> 8) / static_cast<Float>(1U << 23) - 1;
+}
+
+// A batch of random, well-conditioned matrices, with a zero on the diagonal so that
+// pivoting is required
+template <Int N>
+auto
+makeMatrices(Int const size, Int const layout) -> juno::MatrixBatch<N>
+{
+  auto const a = juno::makeBatch<Float, N, N>("a", size, layout);
+  uint32_t state = 12345;
+  for (Int b = 0; b < size; ++b) {
+    for (Int i = 0; i < N; ++i) {
+      for (Int j = 0; j < N; ++j) {
+        a(b, i, j) = nextValue(state);
+      }
+      // Dominant entries, off the diagonal so that every row must be swapped
+      a(b, i, (i + 1) % N) += static_cast<Float>(2 * N);
+    }
+  }
+  return a;
+}
+
+template <Int N>
+void
+testSolve(Int const layout)
+{
+  // Two full tiles and a partial one
+  Int constexpr size = 2 * juno::batch_layouts::interleaved + 5;
+  auto const a = makeMatrices<N>(size, layout);
+  auto const x = juno::makeBatch<Float, N, 1>("x", size, layout);
+  auto const rhs = juno::makeBatch<Float, N, 1>("rhs", size, layout);
+  uint32_t state = 678;
+  for (Int b = 0; b < size; ++b) {
+    for (Int i = 0; i < N; ++i) {
+      x(b, i) = nextValue(state);
+    }
+  }
+
+  // matvec, against the definition
+  juno::matvec(a, x, rhs);
+  for (Int b = 0; b < size; ++b) {
+    for (Int i = 0; i < N; ++i) {
+      Float yi = 0;
+      for (Int j = 0; j < N; ++j) {
+        yi += a(b, i, j) * x(b, j);
+      }
+      ASSERT_NEAR(rhs(b, i), yi, eps);
+    }
+  }
+
+  // Factor once, solve for two right-hand sides
+  auto const lu = makeMatrices<N>(size, layout);
+  auto const pivots = juno::makeBatch<Int, N, 1>("pivots", size, layout);
+  ASSERT(juno::luFactor(lu, pivots) == 0);
+  for (Int b = 0; b < size; ++b) {
+    for (Int k = 0; k < N; ++k) {
+      ASSERT(k <= pivots(b, k) && pivots(b, k) < N);
+    }
+  }
+  juno::luSolve(lu, pivots, rhs);
+  for (Int b = 0; b < size; ++b) {
+    for (Int i = 0; i < N; ++i) {
+      ASSERT_NEAR(rhs(b, i), x(b, i), eps);
+    }
+  }
+
+  // solve, with a singular matrix
+  for (Int j = 0; j < N; ++j) {
+    a(3, 0, j) = 0;
+  }
+  juno::matvec(a, x, rhs);
+  ASSERT(juno::solve(a, rhs) == 1);
+  for (Int b = 0; b < size; ++b) {
+    if (b != 3) {
+      for (Int i = 0; i < N; ++i) {
+        ASSERT_NEAR(rhs(b, i), x(b, i), eps);
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE(layout)
+{
+  auto const interleaved =
+      juno::makeBatch<Float, 3, 2>("m", 13, juno::batch_layouts::interleaved);
+  auto const contiguous =
+      juno::makeBatch<Float, 3, 2>("m", 13, juno::batch_layouts::contiguous);
+  // The last tile is padded
+  ASSERT(interleaved.values.size() == 2 * 8 * 6);
+  ASSERT(contiguous.values.size() == 13 * 6);
+  // Column-major, with the matrices of a tile interleaved, or one after the other
+  ASSERT(&interleaved(1, 2, 1) == interleaved.values.data() + 5 * 8 + 1);
+  ASSERT(&interleaved(10, 2, 1) == interleaved.values.data() + 48 + 5 * 8 + 2);
+  ASSERT(&contiguous(10, 2, 1) == contiguous.values.data() + 10 * 6 + 5);
+}
+
+TEST_CASE(solve)
+{
+  for (auto const layout : {juno::batch_layouts::interleaved,
+                            juno::batch_layouts::contiguous}) {
+    testSolve<1>(layout);
+    testSolve<2>(layout);
+    testSolve<3>(layout);
+    testSolve<4>(layout);
+    testSolve<7>(layout);
+    testSolve<16>(layout);
+  }
+}
+
+TEST_CASE(single)
+{
+  // The kernels on one matrix of a batch, as called from other kernels
+  auto const a = juno::makeBatch<Float, 2, 2>("a", 3);
+  auto const pivots = juno::makeBatch<Int, 2, 1>("pivots", 3);
+  auto const x = juno::makeBatch<Float, 2, 1>("x", 3);
+  a(1, 0, 0) = 0;
+  a(1, 0, 1) = 2;
+  a(1, 1, 0) = 4;
+  a(1, 1, 1) = 1;
+  x(1, 0) = 2;
+  x(1, 1) = 5;
+  ASSERT(juno::luFactor(a, pivots, 1));
+  ASSERT(pivots(1, 0) == 1);
+  juno::luSolve(a, pivots, x, 1);
+  ASSERT_NEAR(x(1, 0), 1, eps);
+  ASSERT_NEAR(x(1, 1), 1, eps);
+  // Matrix 0 is zero
+  ASSERT(!juno::luFactor(a, pivots, 0));
+}
+
+TEST_SUITE(matrix)
+{
+  TEST(layout);
+  TEST(solve);
+  TEST(single);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(matrix);
+  return 0;
+}
@@ -0,0 +1,177 @@
+#include <juno/common/logger.hpp>
+#include <juno/math/compare.hpp>
+#include <juno/math/preconditioners.hpp>
+#include <juno/math/sparse_matrix.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <vector>
+
+#include "../test_macros.hpp"
+
+using Matrix = juno::CSRMatrix<juno::HostMemSpace>;
+using Vector = Kokkos::View<Float *, juno::HostMemSpace>;
+
+Float constexpr eps = static_cast<Float>(1e-4);
+
+namespace
+{
+
+// A CSR matrix from a dense, row-major one, without its zeros
+auto
+fromDense(Int const n, std::vector<Float> const & dense) -> Matrix
+{
+  Matrix a;
+  a.num_rows = n;
+  a.num_cols = n;
+  a.row_offsets = Matrix::IntView("row_offsets", static_cast<size_t>(n + 1));
+  std::vector<Int> columns;
+  std::vector<Float> values;
+  for (Int i = 0; i < n; ++i) {
+    for (Int j = 0; j < n; ++j) {
+      Float const aij = dense[static_cast<size_t>(i * n + j)];
+      if (!juno::isZero(aij)) {
+        columns.push_back(j);
+        values.push_back(aij);
+      }
+    }
+    a.row_offsets(i + 1) = static_cast<Int>(columns.size());
+  }
+  a.columns = Matrix::IntView("columns", columns.size());
+  a.values = Matrix::FloatView("values", values.size());
+  for (size_t k = 0; k < columns.size(); ++k) {
+    a.columns(k) = columns[k];
+    a.values(k) = values[k];
+  }
+  return a;
+}
+
+// A nonsymmetric band matrix, with rows of different lengths
+auto
+makeDense(Int const n) -> std::vector<Float>
+{
+  std::vector<Float> dense(static_cast<size_t>(n * n), 0);
+  for (Int i = 0; i < n; ++i) {
+    dense[static_cast<size_t>(i * n + i)] = 4;
+    if (i > 0) {
+      dense[static_cast<size_t>(i * n + i - 1)] = -1;
+    }
+    if (i + 1 < n) {
+      dense[static_cast<size_t>(i * n + i + 1)] = static_cast<Float>(-0.5);
+    }
+    if (i % 3 == 0 && i + 7 < n) {
+      dense[static_cast<size_t>(i * n + i + 7)] = static_cast<Float>(0.25);
+    }
+  }
+  return dense;
+}
+
+auto
+makeVector(Int const n) -> Vector
+{
+  Vector x("x", static_cast<size_t>(n));
+  for (Int i = 0; i < n; ++i) {
+    x(i) = static_cast<Float>(i % 5) - 2;
+  }
+  return x;
+}
+
+} // namespace
+
+TEST_CASE(spmv)
+{
+  // More rows than a slice, and a partial slice
+  Int constexpr n = juno::ell_slice_height + 5;
+  auto const dense = makeDense(n);
+  auto const csr = fromDense(n, dense);
+  auto const ell = juno::makeSlicedELLMatrix(csr);
+  ASSERT(ell.slice_offsets.size() == 3);
+  // The first slice has a row of 4 entries, the last one only rows of 3 or fewer
+  ASSERT(ell.slice_offsets(1) == 4 * juno::ell_slice_height);
+  ASSERT(ell.slice_offsets(2) == 7 * juno::ell_slice_height);
+
+  auto const x = makeVector(n);
+  Vector const y_csr("y_csr", static_cast<size_t>(n));
+  Vector const y_ell("y_ell", static_cast<size_t>(n));
+  juno::spmv(csr, x, y_csr);
+  juno::spmv(ell, x, y_ell);
+  for (Int i = 0; i < n; ++i) {
+    Float yi = 0;
+    for (Int j = 0; j < n; ++j) {
+      yi += dense[static_cast<size_t>(i * n + j)] * x(j);
+    }
+    ASSERT_NEAR(y_csr(i), yi, eps);
+    ASSERT_NEAR(y_ell(i), yi, eps);
+  }
+
+  auto const diagonal = juno::diagonalIndices(csr);
+  for (Int i = 0; i < n; ++i) {
+    ASSERT(csr.columns(diagonal(i)) == i);
+  }
+}
+
+TEST_CASE(preconditioners)
+{
+  Int constexpr n = 40;
+  auto const dense = makeDense(n);
+  auto const a = fromDense(n, dense);
+  auto const r = makeVector(n);
+  Vector const z("z", static_cast<size_t>(n));
+  Vector const az("az", static_cast<size_t>(n));
+
+  auto const jacobi = juno::makeJacobiPreconditioner(a);
+  jacobi.apply(r, z);
+  for (Int i = 0; i < n; ++i) {
+    ASSERT_NEAR(z(i), r(i) / 4, eps);
+  }
+
+  // The band below the diagonal has one entry per row, so L has no fill-in, and the
+  // forward solve has a level per row
+  auto const ilu = juno::makeILU0Preconditioner(a);
+  ASSERT(ilu.lower_levels.size() == n + 1);
+  ilu.apply(r, z);
+  juno::spmv(a, z, az);
+  // Not exact, since U drops the fill-in under the 7th diagonal, but close
+  Float error = 0;
+  for (Int i = 0; i < n; ++i) {
+    error += (az(i) - r(i)) * (az(i) - r(i));
+  }
+  ASSERT(error < static_cast<Float>(0.1));
+
+  // ILU(0) of a tridiagonal matrix is its LU factorization
+  auto tridiagonal = dense;
+  for (Int i = 0; i + 7 < n; ++i) {
+    tridiagonal[static_cast<size_t>(i * n + i + 7)] = 0;
+  }
+  auto const t = fromDense(n, tridiagonal);
+  auto const lu = juno::makeILU0Preconditioner(t);
+  lu.apply(r, z);
+  juno::spmv(t, z, az);
+  for (Int i = 0; i < n; ++i) {
+    ASSERT_NEAR(az(i), r(i), eps);
+  }
+
+  // No diagonal entry in row 1
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  auto singular = tridiagonal;
+  singular[static_cast<size_t>(n + 1)] = 0;
+  auto const empty = juno::makeILU0Preconditioner(fromDense(n, singular));
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(empty.lower_levels.empty());
+  juno::logger::reset();
+}
+
+TEST_SUITE(sparse_matrix)
+{
+  TEST(spmv);
+  TEST(preconditioners);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(sparse_matrix);
+  return 0;
+}
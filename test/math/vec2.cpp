@@ -0,0 +1,88 @@
+#include <juno/math/aabb2.hpp>
+#include <juno/math/ray2.hpp>
+#include <juno/math/vec2.hpp>
+
+#include "../test_macros.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+HOSTDEV
+TEST_CASE(vec2)
+{
+  juno::Vec2 const a = {1, 2};
+  juno::Vec2 const b = {3, -1};
+  ASSERT_NEAR((a + b).x, 4, eps);
+  ASSERT_NEAR((a + b).y, 1, eps);
+  ASSERT_NEAR((a - b).x, -2, eps);
+  ASSERT_NEAR((a - b).y, 3, eps);
+  ASSERT_NEAR((2 * a).x, 2, eps);
+  ASSERT_NEAR((2 * a).y, 4, eps);
+  ASSERT_NEAR((a * 2).x, 2, eps);
+  ASSERT_NEAR((a * 2).y, 4, eps);
+  ASSERT_NEAR((a / 2).x, static_cast<Float>(0.5), eps);
+  ASSERT_NEAR((a / 2).y, 1, eps);
+  ASSERT_NEAR(juno::dot(a, b), 1, eps);
+  ASSERT_NEAR(juno::cross(a, b), -7, eps);
+  ASSERT_NEAR(juno::cross(b, a), 7, eps);
+  ASSERT_NEAR(juno::squaredNorm(a), 5, eps);
+  ASSERT_NEAR(juno::norm(juno::Vec2{3, 4}), 5, eps);
+  ASSERT_NEAR(juno::distance(a, b), juno::norm(a - b), eps);
+}
+
+HOSTDEV
+TEST_CASE(aabb2)
+{
+  juno::AABB2 box;
+  ASSERT(box.isEmpty());
+  box.grow(juno::AABB2{});
+  ASSERT(box.isEmpty());
+  box.grow(juno::Vec2{1, 2});
+  ASSERT(!box.isEmpty());
+  ASSERT_NEAR(box.min.x, box.max.x, eps);
+  ASSERT_NEAR(box.min.y, box.max.y, eps);
+  box.grow(juno::Vec2{-1, 3});
+  ASSERT_NEAR(box.width(), 2, eps);
+  ASSERT_NEAR(box.height(), 1, eps);
+  ASSERT_NEAR(box.centroid().x, 0, eps);
+  ASSERT_NEAR(box.centroid().y, static_cast<Float>(2.5), eps);
+  ASSERT(box.contains({0, 2}));
+  ASSERT(!box.contains({0, 4}));
+  juno::AABB2 other;
+  other.grow(juno::Vec2{5, 5});
+  box.grow(other);
+  ASSERT_NEAR(box.max.x, 5, eps);
+  ASSERT_NEAR(box.max.y, 5, eps);
+}
+
+HOSTDEV
+TEST_CASE(ray2)
+{
+  juno::Ray2 const ray = {{0, 0}, {1, 0}, 2};
+  ASSERT_NEAR(ray(1).x, 1, eps);
+  ASSERT_NEAR(ray(1).y, 0, eps);
+  ASSERT_NEAR(juno::intersect(ray, {1, -1}, {1, 1}), 1, eps);
+  ASSERT_NEAR(juno::intersect(ray, {1, 1}, {1, -1}), 1, eps);
+  // Beyond the end of the ray, behind it, beside the segment, and parallel
+  ASSERT(juno::intersect(ray, {3, -1}, {3, 1}) < 0);
+  ASSERT(juno::intersect(ray, {-1, -1}, {-1, 1}) < 0);
+  ASSERT(juno::intersect(ray, {1, 1}, {1, 2}) < 0);
+  ASSERT(juno::intersect(ray, {0, 1}, {1, 1}) < 0);
+}
+
+MAKE_GPU_KERNEL(vec2);
+MAKE_GPU_KERNEL(aabb2);
+MAKE_GPU_KERNEL(ray2);
+
+TEST_SUITE(vec2_suite)
+{
+  TEST_HOSTDEV(vec2);
+  TEST_HOSTDEV(aabb2);
+  TEST_HOSTDEV(ray2);
+}
+
+auto
+main() -> int
+{
+  RUN_SUITE(vec2_suite);
+  return 0;
+}
@@ -0,0 +1,144 @@
+#include <juno/mesh/face_grid.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "../test_macros.hpp"
+#include "quad_mesh.hpp"
+
+using HostMesh = juno::FaceVertexMesh<juno::HostMemSpace>;
+
+Float constexpr eps = static_cast<Float>(1e-5);
+
+namespace
+{
+
+// The face containing p, by testing every face
+auto
+locateLinear(HostMesh const & mesh, juno::Vec2 const p) -> Int
+{
+  for (Int f = 0; f < mesh.numFaces(); ++f) {
+    if (mesh.faceContains(f, p)) {
+      return f;
+    }
+  }
+  return -1;
+}
+
+} // namespace
+
+TEST_CASE(build)
+{
+  Int constexpr n = 10;
+  auto const grid = juno::buildFaceGrid(juno::test::makeQuadMesh(n));
+  ASSERT(grid.nx > 0);
+  ASSERT(grid.ny > 0);
+  ASSERT_NEAR(grid.box.width(), 1, eps);
+  ASSERT_NEAR(grid.box.height(), 1, eps);
+  ASSERT(grid.cell_offsets.size() == static_cast<size_t>(grid.numCells()) + 1);
+  ASSERT(grid.cell_offsets(0) == 0);
+  auto const num_entries = static_cast<size_t>(grid.cell_offsets(grid.numCells()));
+  ASSERT(grid.cell_faces.size() == num_entries);
+
+  // Each face is in the cell of its centroid, and the faces of each cell are sorted
+  for (Int f = 0; f < n * n; ++f) {
+    juno::Vec2 const c = grid.mesh.faceCentroid(f);
+    Int const cell = grid.cellIndex(grid.cellX(c.x), grid.cellY(c.y));
+    bool found = false;
+    for (Int k = grid.cell_offsets(cell); k < grid.cell_offsets(cell + 1); ++k) {
+      found = found || grid.cell_faces(k) == f;
+    }
+    ASSERT(found);
+  }
+  for (Int c = 0; c < grid.numCells(); ++c) {
+    for (Int k = grid.cell_offsets(c) + 1; k < grid.cell_offsets(c + 1); ++k) {
+      ASSERT(grid.cell_faces(k - 1) < grid.cell_faces(k));
+    }
+  }
+}
+
+TEST_CASE(locate)
+{
+  auto const mesh = juno::test::makeQuadMesh(10);
+  auto const grid = juno::buildFaceGrid(mesh);
+
+  // A lattice of points, some on edges and some outside the mesh
+  Int constexpr m = 23;
+  Kokkos::View<juno::Vec2 *, juno::HostMemSpace> const points("points", m * m);
+  for (Int j = 0; j < m; ++j) {
+    for (Int i = 0; i < m; ++i) {
+      Float const x = static_cast<Float>(i - 1) / static_cast<Float>(m - 3);
+      Float const y = static_cast<Float>(j - 1) / static_cast<Float>(m - 3);
+      points(j * m + i) = {x * static_cast<Float>(1.1), y};
+    }
+  }
+  Kokkos::View<Int *, juno::HostMemSpace> const faces("faces", m * m);
+  juno::locatePoints(grid, points, faces);
+  for (Int i = 0; i < m * m; ++i) {
+    ASSERT(faces(i) == locateLinear(mesh, points(i)));
+  }
+  ASSERT(grid.locate({static_cast<Float>(0.05), static_cast<Float>(0.05)}) == 0);
+  ASSERT(grid.locate({2, 2}) == -1);
+}
+
+TEST_CASE(segmentRays)
+{
+  Int constexpr n = 10;
+  auto const grid = juno::buildFaceGrid(juno::test::makeQuadMesh(n));
+  Float const h = static_cast<Float>(0.5);
+  Float const inv_sqrt2 = static_cast<Float>(0.70710678118654752);
+  Kokkos::View<juno::Ray2 *, juno::HostMemSpace> const rays("rays", 4);
+  // Horizontal, through the middle of a row of faces
+  rays(0) = {{0, static_cast<Float>(0.05)}, {1, 0}, 1};
+  // Diagonal, through the corners of the faces
+  rays(1) = {{0, 0}, {inv_sqrt2, inv_sqrt2}, 2 * inv_sqrt2};
+  // Starting and ending outside the mesh, along an edge
+  rays(2) = {{-1, h}, {1, 0}, 3};
+  // Missing the mesh
+  rays(3) = {{-1, -1}, {0, 1}, 3};
+
+  auto const segments = juno::segmentRays(grid, rays);
+  auto const length = [&](Int const r) {
+    Float sum = 0;
+    for (Int s = segments.offsets(r); s < segments.offsets(r + 1); ++s) {
+      sum += segments.lengths(s);
+    }
+    return sum;
+  };
+
+  // The first ray crosses the faces of the first row in order
+  ASSERT(segments.offsets(1) - segments.offsets(0) == n);
+  for (Int s = 0; s < n; ++s) {
+    ASSERT(segments.faces(s) == s);
+    ASSERT_NEAR(segments.lengths(s), static_cast<Float>(0.1), eps);
+  }
+  ASSERT_NEAR(length(0), 1, eps);
+
+  // The diagonal crosses the faces on the diagonal
+  Int const first = segments.offsets(1);
+  ASSERT(segments.offsets(2) - first == n);
+  for (Int s = 0; s < n; ++s) {
+    ASSERT(segments.faces(first + s) == s * n + s);
+  }
+  ASSERT_NEAR(length(1), 2 * inv_sqrt2, eps);
+
+  // Only the part in the mesh is kept
+  ASSERT(segments.offsets(3) - segments.offsets(2) == n);
+  ASSERT_NEAR(length(2), 1, eps);
+
+  ASSERT(segments.offsets(4) == segments.offsets(3));
+}
+
+TEST_SUITE(face_grid)
+{
+  TEST(build);
+  TEST(locate);
+  TEST(segmentRays);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(face_grid);
+  return 0;
+}
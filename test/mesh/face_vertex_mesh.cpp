@@ -0,0 +1,139 @@
+#include <juno/mesh/face_vertex_mesh.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "../test_macros.hpp"
+
+using HostSoup = juno::PolytopeSoup<juno::HostMemSpace>;
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+namespace
+{
+
+// Two unit squares side by side. The left is a quad, the right is split into two
+// triangles, the first of which is clockwise.
+//  3---4---5
+//  |   | / |
+//  0---1---2
+auto
+makeSoup() -> HostSoup
+{
+  HostSoup soup(6, 3, 10);
+  Float const xs[] = {0, 1, 2, 0, 1, 2};
+  Float const ys[] = {0, 0, 0, 1, 1, 1};
+  for (Int i = 0; i < 6; ++i) {
+    soup.x()(i) = xs[i];
+    soup.y()(i) = ys[i];
+    soup.z()(i) = 0;
+  }
+  int8_t const types[] = {juno::vtk_types::quad, juno::vtk_types::triangle,
+                          juno::vtk_types::triangle};
+  Int const offsets[] = {0, 4, 7, 10};
+  Int const vertices[] = {0, 1, 4, 3, 1, 5, 2, 1, 5, 4};
+  for (Int i = 0; i < 3; ++i) {
+    soup.elementTypes()(i) = types[i];
+  }
+  for (Int i = 0; i < 4; ++i) {
+    soup.elementOffsets()(i) = offsets[i];
+  }
+  for (Int i = 0; i < 10; ++i) {
+    soup.elementVertices()(i) = vertices[i];
+  }
+  return soup;
+}
+
+} // namespace
+
+TEST_CASE(construct)
+{
+  auto const mesh = juno::makeFaceVertexMesh(makeSoup());
+  ASSERT(mesh.numVertices() == 6);
+  ASSERT(mesh.numFaces() == 3);
+  ASSERT(mesh.faceSize(0) == 4);
+  ASSERT(mesh.faceSize(1) == 3);
+
+  // The clockwise triangle is reversed
+  ASSERT(mesh.faceVertex(1, 0) == 2);
+  ASSERT(mesh.faceVertex(1, 1) == 5);
+  ASSERT(mesh.faceVertex(1, 2) == 1);
+
+  // Vertex 1 is in every face, vertex 0 only in the quad
+  auto const & offsets = mesh.vertexFaceOffsets();
+  auto const & faces = mesh.vertexFaces();
+  ASSERT(offsets(0) == 0);
+  ASSERT(offsets(1) == 1);
+  ASSERT(offsets(2) == 4);
+  ASSERT(faces(1) == 0);
+  ASSERT(faces(2) == 1);
+  ASSERT(faces(3) == 2);
+  ASSERT(offsets(6) == 10);
+}
+
+TEST_CASE(geometry)
+{
+  auto const mesh = juno::makeFaceVertexMesh(makeSoup());
+  ASSERT_NEAR(mesh.faceArea(0), 1, eps);
+  ASSERT_NEAR(mesh.faceArea(1), static_cast<Float>(0.5), eps);
+  ASSERT_NEAR(mesh.faceArea(2), static_cast<Float>(0.5), eps);
+
+  juno::Vec2 const c0 = mesh.faceCentroid(0);
+  ASSERT_NEAR(c0.x, static_cast<Float>(0.5), eps);
+  ASSERT_NEAR(c0.y, static_cast<Float>(0.5), eps);
+  juno::Vec2 const c1 = mesh.faceCentroid(1);
+  ASSERT_NEAR(c1.x, static_cast<Float>(5.0 / 3.0), eps);
+  ASSERT_NEAR(c1.y, static_cast<Float>(1.0 / 3.0), eps);
+
+  juno::AABB2 const box = mesh.faceBoundingBox(2);
+  ASSERT_NEAR(box.min.x, 1, eps);
+  ASSERT_NEAR(box.min.y, 0, eps);
+  ASSERT_NEAR(box.max.x, 2, eps);
+  ASSERT_NEAR(box.max.y, 1, eps);
+
+  ASSERT(mesh.faceContains(0, {0.5, 0.5}));
+  ASSERT(!mesh.faceContains(0, {1.5, 0.5}));
+  ASSERT(mesh.faceContains(1, {1.75, 0.25}));
+  ASSERT(!mesh.faceContains(1, {1.25, 0.75}));
+  ASSERT(mesh.faceContains(2, {1.25, 0.75}));
+
+  // A point on the shared edge is in exactly one face
+  juno::Vec2 const on_edge = {1, 0.5};
+  Int count = 0;
+  for (Int f = 0; f < mesh.numFaces(); ++f) {
+    count += mesh.faceContains(f, on_edge) ? 1 : 0;
+  }
+  ASSERT(count == 1);
+
+  // The faces across each edge
+  ASSERT(mesh.edgeNeighbor(0, 0) == -1);
+  ASSERT(mesh.edgeNeighbor(0, 1) == 2);
+  ASSERT(mesh.edgeNeighbor(1, 1) == 2);
+  ASSERT(mesh.edgeNeighbor(2, 0) == 1);
+  ASSERT(mesh.edgeNeighbor(2, 1) == -1);
+  ASSERT(mesh.edgeNeighbor(2, 2) == 0);
+}
+
+TEST_CASE(deviceQueries)
+{
+  auto const mesh = juno::makeFaceVertexMesh(makeSoup()).mirror<juno::DeviceMemSpace>();
+  Float area = 0;
+  Kokkos::parallel_reduce(
+      "area", juno::rangePolicy(0, mesh.numFaces()),
+      KOKKOS_LAMBDA(Int const f, Float & update) { update += mesh.faceArea(f); }, area);
+  ASSERT_NEAR(area, 2, eps);
+}
+
+TEST_SUITE(face_vertex_mesh)
+{
+  TEST(construct);
+  TEST(geometry);
+  TEST(deviceQueries);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(face_vertex_mesh);
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <juno/common/logger.hpp>
+#include <juno/mesh/field_writer.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if JUNO_USE_HDF5
+#  include <hdf5.h>
+#endif
+
+#include "../test_macros.hpp"
+#include "quad_mesh.hpp"
+
+using FloatView = Kokkos::View<Float *, juno::HostMemSpace>;
+
+namespace
+{
+
+#if JUNO_USE_HDF5
+// The datasets are read back as doubles
+double constexpr eps = 1e-6;
+
+// A dataset of the file, as doubles
+auto
+readDataset(std::string const & filename, std::string const & name) -> std::vector<double>
+{
+  hid_t const file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  ASSERT(file >= 0);
+  hid_t const dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+  ASSERT(dataset >= 0);
+  hid_t const space = H5Dget_space(dataset);
+  std::vector<double> values(static_cast<size_t>(H5Sget_simple_extent_npoints(space)));
+  ASSERT(H5Dread(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                 values.data()) >= 0);
+  H5Sclose(space);
+  H5Dclose(dataset);
+  H5Fclose(file);
+  return values;
+}
+
+auto
+readText(std::string const & filename) -> std::string
+{
+  std::ifstream in(filename);
+  std::stringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+#endif
+
+} // namespace
+
+#if JUNO_USE_HDF5
+
+TEST_CASE(write_steps)
+{
+  Int constexpr n = 4;
+  Int constexpr num_faces = n * n;
+  Int constexpr stride = 3;
+  std::string const prefix = "field_writer_output";
+  FloatView const flux("flux", num_faces * stride);
+  FloatView const power("power", num_faces);
+  {
+    juno::FieldWriterOptions options;
+    options.chunk_size = 5;
+    options.compression = 4;
+    options.max_pending = 1;
+    juno::FieldWriter writer(prefix, juno::test::makeQuadMesh(n), {}, options);
+    ASSERT(writer.isOpen());
+    for (Int step = 0; step < 3; ++step) {
+      for (Int f = 0; f < num_faces; ++f) {
+        flux(f * stride) = static_cast<Float>(step * 100 + f);
+        flux(f * stride + 1) = -static_cast<Float>(f);
+        flux(f * stride + 2) = 12345; // padding, not written
+        power(f) = static_cast<Float>(2 * f + step);
+      }
+      // The fields may be overwritten once write returns
+      writer.write(0.5 * step, std::vector<juno::Field<juno::HostMemSpace>>{
+                                   {"flux", flux, 2, stride}, {"power", power}});
+    }
+    ASSERT(writer.numSteps() == 3);
+    // The steps are added to the XDMF file by flush()
+    ASSERT(readText(prefix + ".xmf").find("/steps/0/") == std::string::npos);
+    writer.flush();
+
+    // A field of the wrong size
+    juno::logger::reset();
+    juno::logger::error_policy = juno::logger::error_policies::callback;
+    writer.write(3, std::vector<juno::Field<juno::HostMemSpace>>{{"power", flux}});
+    ASSERT(juno::logger::errorCount() == 1);
+    ASSERT(writer.numSteps() == 3);
+    juno::logger::reset();
+  }
+
+  auto const file = prefix + "_r0.h5";
+  auto const vertices = readDataset(file, "/mesh/vertices");
+  ASSERT(vertices.size() == 2 * (n + 1) * (n + 1));
+  ASSERT_NEAR(vertices[2 * 6], 0.25, eps);
+  ASSERT_NEAR(vertices[2 * 6 + 1], 0.25, eps);
+  auto const topology = readDataset(file, "/mesh/topology");
+  ASSERT(topology.size() == 5 * num_faces);
+  ASSERT_NEAR(topology[0], 5, eps); // quadrilateral
+  ASSERT_NEAR(topology[1], 0, eps);
+  ASSERT_NEAR(topology[3], 6, eps);
+  for (Int step = 0; step < 3; ++step) {
+    auto const name = "/steps/" + std::to_string(step);
+    auto const written_flux = readDataset(file, name + "/flux");
+    auto const written_power = readDataset(file, name + "/power");
+    ASSERT(written_flux.size() == 2 * num_faces);
+    ASSERT(written_power.size() == num_faces);
+    for (Int f = 0; f < num_faces; ++f) {
+      ASSERT_NEAR(written_flux[static_cast<size_t>(2 * f)], step * 100 + f, eps);
+      ASSERT_NEAR(written_flux[static_cast<size_t>(2 * f + 1)], -f, eps);
+      ASSERT_NEAR(written_power[static_cast<size_t>(f)], 2 * f + step, eps);
+    }
+  }
+
+  auto const text = readText(prefix + ".xmf");
+  ASSERT(text.find("CollectionType=\"Temporal\"") != std::string::npos);
+  ASSERT(text.find("<Time Value=\"1\"/>") != std::string::npos);
+  ASSERT(text.find("TopologyType=\"Mixed\" NumberOfElements=\"16\"") !=
+         std::string::npos);
+  ASSERT(text.find("field_writer_output_r0.h5:/steps/2/flux") != std::string::npos);
+  ASSERT(text.find("Dimensions=\"16 2\"") != std::string::npos);
+  ASSERT(text.find("/steps/3/") == std::string::npos);
+
+  std::filesystem::remove(file);
+  std::filesystem::remove(prefix + ".xmf");
+}
+
+TEST_CASE(cannot_create)
+{
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  juno::FieldWriter writer("no_such_directory/output", juno::test::makeQuadMesh(2));
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(!writer.isOpen());
+  juno::logger::reset();
+}
+
+#else
+
+TEST_CASE(without_hdf5)
+{
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  juno::FieldWriter writer("field_writer_output", juno::test::makeQuadMesh(2));
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(!writer.isOpen());
+  FloatView const power("power", 4);
+  writer.write(0, std::vector<juno::Field<juno::HostMemSpace>>{{"power", power}});
+  writer.flush();
+  ASSERT(writer.numSteps() == 0);
+  ASSERT(!std::filesystem::exists("field_writer_output.xmf"));
+  juno::logger::reset();
+}
+
+#endif
+
+TEST_SUITE(field_writer)
+{
+#if JUNO_USE_HDF5
+  TEST(write_steps);
+  TEST(cannot_create);
+#else
+  TEST(without_hdf5);
+#endif
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(field_writer);
+  return 0;
+}
@@ -0,0 +1,156 @@
+#include <juno/common/logger.hpp>
+#include <juno/mesh/mesh_cache.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdio>     // std::remove
+#include <cstring>    // std::memcmp
+#include <filesystem> // std::filesystem::temp_directory_path
+#include <fstream>    // std::fstream
+#include <string>
+
+#include "../test_macros.hpp"
+#include "quad_mesh.hpp"
+
+using HostSoup = juno::PolytopeSoup<juno::HostMemSpace>;
+using IntView = HostSoup::IntView;
+
+namespace
+{
+
+uint64_t constexpr source_hash = 12345;
+
+// The quad soup of makeQuadSoup, with the left half of the faces in set "left" and
+// every face in set "all"
+auto
+makeSoup(Int const n) -> HostSoup
+{
+  HostSoup soup = juno::test::makeQuadSoup(n);
+  Int const num_left = n * n / 2;
+  IntView const offsets("offsets", 3);
+  IntView const elements("elements", static_cast<size_t>(n * n + num_left));
+  offsets(1) = n * n;
+  offsets(2) = n * n + num_left;
+  Int k = 0;
+  for (Int f = 0; f < n * n; ++f) {
+    elements(k++) = f;
+  }
+  for (Int f = 0; f < n * n; ++f) {
+    if (f % n < n / 2) {
+      elements(k++) = f;
+    }
+  }
+  soup.setElementSets({"all", "left"}, offsets, elements);
+  return soup;
+}
+
+auto
+tempPath(std::string const & name) -> std::string
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Whether two host Views hold the same bytes, since the cache must round-trip exactly
+template <class View>
+auto
+equal(View const & a, View const & b) -> bool
+{
+  return a.size() == b.size() &&
+         (a.size() == 0 ||
+          std::memcmp(a.data(), b.data(), a.size() * sizeof(*a.data())) == 0);
+}
+
+} // namespace
+
+TEST_CASE(roundTrip)
+{
+  std::string const path = tempPath("juno_test_round_trip.cache");
+  auto const written = juno::makeMeshCache(makeSoup(8));
+  ASSERT(!written.empty());
+  ASSERT(juno::writeMeshCache(path, written, source_hash));
+
+  auto const read = juno::readMeshCache(path, source_hash);
+  std::remove(path.c_str());
+  ASSERT(!read.empty());
+  ASSERT(read.file != nullptr);
+
+  // The mesh
+  auto const & a = written.grid.mesh;
+  auto const & b = read.grid.mesh;
+  ASSERT(equal(a.x(), b.x()));
+  ASSERT(equal(a.y(), b.y()));
+  ASSERT(equal(a.faceOffsets(), b.faceOffsets()));
+  ASSERT(equal(a.faceVertices(), b.faceVertices()));
+  ASSERT(equal(a.vertexFaceOffsets(), b.vertexFaceOffsets()));
+  ASSERT(equal(a.vertexFaces(), b.vertexFaces()));
+
+  // The spatial index
+  ASSERT(written.grid.nx == read.grid.nx);
+  ASSERT(written.grid.ny == read.grid.ny);
+  ASSERT_NEAR(written.grid.dx, read.grid.dx, 0);
+  ASSERT_NEAR(written.grid.box.max.x, read.grid.box.max.x, 0);
+  ASSERT_NEAR(written.grid.box.max.y, read.grid.box.max.y, 0);
+  ASSERT(equal(written.grid.cell_offsets, read.grid.cell_offsets));
+  ASSERT(equal(written.grid.cell_faces, read.grid.cell_faces));
+  for (Int f = 0; f < b.numFaces(); ++f) {
+    ASSERT(read.grid.locate(b.faceCentroid(f)) == f);
+  }
+
+  // The element sets
+  ASSERT(read.element_set_names.size() == 2);
+  ASSERT(read.element_set_names[0] == "all");
+  ASSERT(read.element_set_names[1] == "left");
+  ASSERT(equal(written.element_set_offsets, read.element_set_offsets));
+  ASSERT(equal(written.element_set_elements, read.element_set_elements));
+
+  // The mapped arrays are aligned
+  auto const address = reinterpret_cast<uintptr_t>(b.x().data());
+  ASSERT(address % juno::mesh_cache::alignment == 0);
+}
+
+TEST_CASE(rejected)
+{
+  juno::logger::reset();
+  std::string const path = tempPath("juno_test_rejected.cache");
+
+  // Missing
+  ASSERT(juno::readMeshCache(path, source_hash).empty());
+
+  // Stale
+  ASSERT(juno::writeMeshCache(path, juno::makeMeshCache(makeSoup(4)), source_hash));
+  ASSERT(juno::readMeshCache(path, source_hash + 1).empty());
+  ASSERT(!juno::readMeshCache(path, source_hash).empty());
+
+  // Damaged: change the last byte of the element set names
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-1, std::ios::end);
+    file.put('x');
+  }
+  ASSERT(juno::readMeshCache(path, source_hash).empty());
+
+  // Not a cache
+  {
+    std::ofstream file(path, std::ios::trunc);
+    file << "not a mesh cache";
+  }
+  ASSERT(juno::readMeshCache(path, source_hash).empty());
+  std::remove(path.c_str());
+
+  // None of these are errors
+  ASSERT(juno::logger::errorCount() == 0);
+}
+
+TEST_SUITE(mesh_cache)
+{
+  TEST(roundTrip);
+  TEST(rejected);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(mesh_cache);
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include <juno/common/logger.hpp>
+#include <juno/mesh/partition.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "../test_macros.hpp"
+#include "quad_mesh.hpp"
+
+using juno::test::makeBox;
+
+TEST_CASE(decomposition)
+{
+  auto const square = juno::makeBlockDecomposition(makeBox(1, 1), 4);
+  ASSERT(square.num_x == 2);
+  ASSERT(square.num_y == 2);
+  ASSERT(square.numBlocks() == 4);
+
+  // The blocks of a wide box are as square as possible
+  auto const wide = juno::makeBlockDecomposition(makeBox(4, 1), 4);
+  ASSERT(wide.num_x == 4);
+  ASSERT(wide.num_y == 1);
+  ASSERT_NEAR(wide.blockWidth(), 1, static_cast<Float>(1e-6));
+
+  // Slabs
+  auto const slabs = juno::makeBlockDecomposition(makeBox(1, 1), 1, 3);
+  ASSERT(slabs.num_x == 1);
+  ASSERT(slabs.num_y == 3);
+  auto const top = slabs.blockBox(2);
+  ASSERT_NEAR(top.max.y, 1, static_cast<Float>(1e-6));
+  ASSERT_NEAR(top.min.y, static_cast<Float>(2) / 3, static_cast<Float>(1e-6));
+  // Neighbouring blocks share their side exactly, so that they tile the box
+  ASSERT_NEAR(top.min.y, slabs.blockBox(1).max.y, 0);
+  ASSERT(slabs.blockOf({static_cast<Float>(0.5), static_cast<Float>(0.9)}) == 2);
+  ASSERT(slabs.blockOf({static_cast<Float>(0.5), static_cast<Float>(0.1)}) == 0);
+  // Points outside go to the nearest block
+  ASSERT(slabs.blockOf({static_cast<Float>(0.5), 2}) == 2);
+
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  auto const empty = juno::makeBlockDecomposition(makeBox(1, 1), 0);
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(empty.numBlocks() == 0);
+  juno::logger::reset();
+}
+
+TEST_CASE(neighbors)
+{
+  auto blocks = juno::makeBlockDecomposition(makeBox(1, 1), 2, 2);
+  // 2 3
+  // 0 1
+  ASSERT(blocks.neighbor(0, juno::box_sides::right) == 1);
+  ASSERT(blocks.neighbor(0, juno::box_sides::top) == 2);
+  ASSERT(blocks.neighbor(0, juno::box_sides::left) == -1);
+  ASSERT(blocks.neighbor(0, juno::box_sides::bottom) == -1);
+  ASSERT(blocks.neighbor(3, juno::box_sides::left) == 2);
+  ASSERT(blocks.neighbor(3, juno::box_sides::bottom) == 1);
+  ASSERT(blocks.neighbor(3, juno::box_sides::right) == -1);
+
+  blocks.periodic_x = true;
+  ASSERT(blocks.neighbor(0, juno::box_sides::left) == 1);
+  ASSERT(blocks.neighbor(3, juno::box_sides::right) == 2);
+  ASSERT(blocks.neighbor(0, juno::box_sides::bottom) == -1);
+
+  // A single block is its own neighbor in a periodic direction
+  auto single = juno::makeBlockDecomposition(makeBox(1, 1), 1);
+  single.periodic_y = true;
+  ASSERT(single.neighbor(0, juno::box_sides::top) == 0);
+  ASSERT(single.neighbor(0, juno::box_sides::bottom) == 0);
+  ASSERT(single.neighbor(0, juno::box_sides::right) == -1);
+}
+
+TEST_CASE(partition_faces)
+{
+  Int constexpr n = 4;
+  auto const mesh = juno::test::makeQuadMesh(n);
+  auto const blocks = juno::makeBlockDecomposition(makeBox(1, 1), 4);
+  auto const face_blocks = juno::partitionFaces(mesh, blocks);
+  ASSERT(static_cast<Int>(face_blocks.size()) == n * n);
+  for (Int j = 0; j < n; ++j) {
+    for (Int i = 0; i < n; ++i) {
+      Int const b = (j / 2) * 2 + (i / 2);
+      ASSERT(face_blocks[static_cast<size_t>(j * n + i)] == b);
+    }
+  }
+
+  auto const submesh = juno::extractSubmesh(mesh, face_blocks, 3);
+  ASSERT(submesh.mesh.numFaces() == 4);
+  ASSERT(submesh.mesh.numVertices() == 9);
+  Int const expected[4] = {10, 11, 14, 15};
+  for (Int f = 0; f < 4; ++f) {
+    ASSERT(submesh.faces[static_cast<size_t>(f)] == expected[f]);
+    // The same face, with vertices of its own
+    auto const c = submesh.mesh.faceCentroid(f);
+    auto const d = mesh.faceCentroid(expected[f]);
+    ASSERT_NEAR(c.x, d.x, static_cast<Float>(1e-6));
+    ASSERT_NEAR(c.y, d.y, static_cast<Float>(1e-6));
+  }
+}
+
+TEST_CASE(nonconforming)
+{
+  // The faces of a 3 by 3 mesh cross the sides of 2 by 2 blocks
+  auto const mesh = juno::test::makeQuadMesh(3);
+  auto const blocks = juno::makeBlockDecomposition(makeBox(1, 1), 2, 2);
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  auto const face_blocks = juno::partitionFaces(mesh, blocks);
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(face_blocks.empty());
+  juno::logger::reset();
+}
+
+TEST_SUITE(partition)
+{
+  TEST(decomposition);
+  TEST(neighbors);
+  TEST(partition_faces);
+  TEST(nonconforming);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(partition);
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include <juno/mesh/polytope_soup.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <string>
+#include <vector>
+
+#include "../test_macros.hpp"
+
+using HostSoup = juno::PolytopeSoup<juno::HostMemSpace>;
+
+namespace
+{
+
+// Two unit squares side by side. The left is a quad, the right is split into two
+// triangles, the first of which is clockwise.
+//  3---4---5
+//  |   | / |
+//  0---1---2
+auto
+makeSoup() -> HostSoup
+{
+  HostSoup soup(6, 3, 10);
+  Float const xs[] = {0, 1, 2, 0, 1, 2};
+  Float const ys[] = {0, 0, 0, 1, 1, 1};
+  for (Int i = 0; i < 6; ++i) {
+    soup.x()(i) = xs[i];
+    soup.y()(i) = ys[i];
+    soup.z()(i) = 0;
+  }
+  int8_t const types[] = {juno::vtk_types::quad, juno::vtk_types::triangle,
+                          juno::vtk_types::triangle};
+  Int const offsets[] = {0, 4, 7, 10};
+  Int const vertices[] = {0, 1, 4, 3, 1, 5, 2, 1, 5, 4};
+  for (Int i = 0; i < 3; ++i) {
+    soup.elementTypes()(i) = types[i];
+  }
+  for (Int i = 0; i < 4; ++i) {
+    soup.elementOffsets()(i) = offsets[i];
+  }
+  for (Int i = 0; i < 10; ++i) {
+    soup.elementVertices()(i) = vertices[i];
+  }
+  HostSoup::IntView const set_offsets("set_offsets", 3);
+  HostSoup::IntView const set_elements("set_elements", 3);
+  set_offsets(1) = 1;
+  set_offsets(2) = 3;
+  set_elements(0) = 0;
+  set_elements(1) = 1;
+  set_elements(2) = 2;
+  soup.setElementSets({"Material_A", "Material_B"}, set_offsets, set_elements);
+  return soup;
+}
+
+} // namespace
+
+TEST_CASE(verticesPerElement)
+{
+  STATIC_ASSERT(juno::verticesPerElement(juno::vtk_types::triangle) == 3);
+  STATIC_ASSERT(juno::verticesPerElement(juno::vtk_types::quad) == 4);
+  STATIC_ASSERT(juno::verticesPerElement(juno::vtk_types::polygon) == 0);
+  STATIC_ASSERT(juno::verticesPerElement(juno::vtk_types::quadratic_quad) == 8);
+  STATIC_ASSERT(juno::verticesPerElement(0) == -1);
+}
+
+TEST_CASE(construct)
+{
+  HostSoup const soup = makeSoup();
+  ASSERT(soup.numVertices() == 6);
+  ASSERT(soup.numElements() == 3);
+  ASSERT(soup.numElementSets() == 2);
+  ASSERT(soup.getElementSetIndex("Material_B") == 1);
+  ASSERT(soup.getElementSetIndex("Material_C") == -1);
+  ASSERT(juno::validate(soup));
+}
+
+TEST_CASE(mirror)
+{
+  HostSoup const soup = makeSoup();
+  auto const device_soup = soup.mirror<juno::DeviceMemSpace>();
+  ASSERT(device_soup.numVertices() == 6);
+  ASSERT(device_soup.numElements() == 3);
+  ASSERT(device_soup.elementSetNames() == soup.elementSetNames());
+
+  // Sum the vertex IDs on the device
+  auto const vertices = device_soup.elementVertices();
+  Int sum = 0;
+  Kokkos::parallel_reduce(
+      "sum", juno::rangePolicy(0, static_cast<Int>(vertices.size())),
+      KOKKOS_LAMBDA(Int const i, Int & update) { update += vertices(i); }, sum);
+  ASSERT(sum == 26);
+
+  // And back
+  auto const host_soup = device_soup.mirror<juno::HostMemSpace>();
+  ASSERT(juno::validate(host_soup));
+  ASSERT_NEAR(host_soup.x()(2), 2, 0); // copied, so exact
+  ASSERT(host_soup.elementVertices()(6) == 2);
+}
+
+TEST_SUITE(polytope_soup)
+{
+  TEST_CONCURRENT(verticesPerElement);
+  TEST(construct);
+  TEST(mirror);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(polytope_soup);
+  return 0;
+}
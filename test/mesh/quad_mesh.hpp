@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/math/aabb2.hpp>
+#include <juno/mesh/face_vertex_mesh.hpp>
+#include <juno/mesh/polytope_soup.hpp>
+
+// Meshes shared by the tests of the mesh and of the physics
+
+namespace juno::test
+{
+
+// The box from the origin to (width, height)
+inline auto
+makeBox(Float const width, Float const height) -> AABB2
+{
+  AABB2 box;
+  box.min = {0, 0};
+  box.max = {width, height};
+  return box;
+}
+
+// An n by n soup of quads over the unit square. Face f is cell (f * stride) % (n * n)
+// of the grid, in row order, so a stride coprime with n * n scatters the faces.
+inline auto
+makeQuadSoup(Int const n, Int const stride = 1) -> PolytopeSoup<HostMemSpace>
+{
+  PolytopeSoup<HostMemSpace> soup((n + 1) * (n + 1), n * n, 4 * n * n);
+  for (Int j = 0; j <= n; ++j) {
+    for (Int i = 0; i <= n; ++i) {
+      Int const v = j * (n + 1) + i;
+      soup.x()(v) = static_cast<Float>(i) / static_cast<Float>(n);
+      soup.y()(v) = static_cast<Float>(j) / static_cast<Float>(n);
+      soup.z()(v) = 0;
+    }
+  }
+  soup.elementOffsets()(0) = 0;
+  for (Int f = 0; f < n * n; ++f) {
+    Int const cell = (f * stride) % (n * n);
+    Int const v = (cell / n) * (n + 1) + cell % n;
+    soup.elementTypes()(f) = vtk_types::quad;
+    soup.elementOffsets()(f + 1) = 4 * (f + 1);
+    soup.elementVertices()(4 * f + 0) = v;
+    soup.elementVertices()(4 * f + 1) = v + 1;
+    soup.elementVertices()(4 * f + 2) = v + n + 2;
+    soup.elementVertices()(4 * f + 3) = v + n + 1;
+  }
+  return soup;
+}
+
+// An n by n mesh of quads over the unit square
+inline auto
+makeQuadMesh(Int const n) -> FaceVertexMesh<HostMemSpace>
+{
+  return makeFaceVertexMesh(makeQuadSoup(n));
+}
+
+} // namespace juno::test
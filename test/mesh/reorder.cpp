@@ -0,0 +1,150 @@
+#include <juno/mesh/reorder.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+#include "../test_macros.hpp"
+#include "quad_mesh.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+using HostSoup = juno::PolytopeSoup<juno::HostMemSpace>;
+using IntView = HostSoup::IntView;
+
+namespace
+{
+
+// The quad soup of makeQuadSoup, with vertex v at z = v, so the renumbered vertices can
+// be traced. Set "even" holds the faces with even IDs.
+auto
+makeScatteredSoup(Int const n, Int const stride) -> HostSoup
+{
+  HostSoup soup = juno::test::makeQuadSoup(n, stride);
+  for (Int v = 0; v < soup.numVertices(); ++v) {
+    soup.z()(v) = static_cast<Float>(v);
+  }
+  Int const num_even = (n * n + 1) / 2;
+  IntView const offsets("offsets", 2);
+  IntView const elements("elements", static_cast<size_t>(num_even));
+  offsets(1) = num_even;
+  for (Int k = 0; k < num_even; ++k) {
+    elements(k) = 2 * k;
+  }
+  soup.setElementSets({"even"}, offsets, elements);
+  return soup;
+}
+
+} // namespace
+
+HOSTDEV
+TEST_CASE(keys)
+{
+  STATIC_ASSERT(juno::mortonKey(0, 0) == 0);
+  STATIC_ASSERT(juno::mortonKey(1, 0) == 1);
+  STATIC_ASSERT(juno::mortonKey(0, 1) == 2);
+  STATIC_ASSERT(juno::mortonKey(3, 3) == 15);
+  STATIC_ASSERT(juno::mortonKey(0xffff, 0xffff) == 0xffffffffU);
+
+  // The Hilbert curve starts at the origin, and each step moves to an adjacent cell.
+  // Check the first 4 by 4 block, which the curve fills before leaving it.
+  ASSERT(juno::hilbertKey(0, 0) == 0);
+  uint32_t px = 0;
+  uint32_t py = 0;
+  for (uint32_t d = 1; d < 16; ++d) {
+    bool found = false;
+    for (uint32_t x = 0; x < 4; ++x) {
+      for (uint32_t y = 0; y < 4; ++y) {
+        if (juno::hilbertKey(x, y) == d) {
+          ASSERT((x > px ? x - px : px - x) + (y > py ? y - py : py - y) == 1);
+          px = x;
+          py = y;
+          found = true;
+        }
+      }
+    }
+    ASSERT(found);
+  }
+}
+
+TEST_CASE(applyReordering)
+{
+  Int constexpr n = 32;
+  auto const soup = makeScatteredSoup(n, 37);
+  for (auto const curve : {juno::curves::morton, juno::curves::hilbert}) {
+    auto const ordering = juno::computeReordering(soup, curve);
+    auto const result = juno::applyReordering(soup, ordering);
+    ASSERT(juno::validate(result));
+    ASSERT(result.numVertices() == soup.numVertices());
+    ASSERT(result.numElements() == soup.numElements());
+
+    // The vertices and elements are the same, renumbered
+    for (Int i = 0; i < result.numVertices(); ++i) {
+      Int const old = ordering.vertex_order(i);
+      ASSERT_NEAR(result.x()(i), soup.x()(old), eps);
+      ASSERT_NEAR(result.z()(i), soup.z()(old), eps);
+    }
+    for (Int e = 0; e < result.numElements(); ++e) {
+      Int const old = ordering.element_order(e);
+      for (Int k = 0; k < 4; ++k) {
+        Int const v = result.elementVertices()(4 * e + k);
+        Int const old_v = soup.elementVertices()(4 * old + k);
+        ASSERT_NEAR(soup.z()(old_v), result.z()(v), eps);
+      }
+    }
+
+    // The element set holds the same elements, sorted
+    auto const & set = result.elementSetElements();
+    ASSERT(set.size() == soup.elementSetElements().size());
+    for (size_t k = 0; k < set.size(); ++k) {
+      ASSERT(ordering.element_order(set(k)) % 2 == 0);
+      ASSERT(k == 0 || set(k - 1) < set(k));
+    }
+
+    // Much better locality than the scattered order
+    auto const before = juno::faceAdjacencyBandwidth(juno::makeFaceVertexMesh(soup));
+    auto const after = juno::faceAdjacencyBandwidth(juno::makeFaceVertexMesh(result));
+    ASSERT(after.mean * 4 < before.mean);
+
+    // permute applies the same order to other arrays
+    auto const z = juno::permute(soup.z(), ordering.vertex_order);
+    for (Int i = 0; i < result.numVertices(); ++i) {
+      ASSERT_NEAR(z(i), result.z()(i), eps);
+    }
+  }
+
+  // reorderSoup is the same as computing and applying the ordering
+  auto const a = juno::reorderSoup(soup, juno::curves::hilbert);
+  auto const b = juno::applyReordering(soup, juno::computeReordering(soup));
+  for (Int i = 0; i < 4 * n * n; ++i) {
+    ASSERT(a.elementVertices()(i) == b.elementVertices()(i));
+  }
+}
+
+TEST_CASE(faceAdjacencyBandwidth)
+{
+  // In row order, the neighbors of a face are 1 or n faces away
+  Int constexpr n = 8;
+  auto const mesh = juno::makeFaceVertexMesh(makeScatteredSoup(n, 1));
+  auto const bandwidth = juno::faceAdjacencyBandwidth(mesh);
+  ASSERT(bandwidth.max == n);
+  // 2 n (n - 1) edges of each length, counted from both sides
+  ASSERT_NEAR(bandwidth.mean, static_cast<Float>(1 + n) / 2, static_cast<Float>(1e-5));
+}
+
+MAKE_GPU_KERNEL(keys);
+
+TEST_SUITE(reorder)
+{
+  TEST_HOSTDEV(keys);
+  TEST(applyReordering);
+  TEST(faceAdjacencyBandwidth);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(reorder);
+  return 0;
+}
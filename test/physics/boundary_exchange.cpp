@@ -0,0 +1,239 @@
+#include <juno/common/communicator.hpp>
+#include <juno/common/logger.hpp>
+#include <juno/mesh/partition.hpp>
+#include <juno/physics/boundary_exchange.hpp>
+#include <juno/physics/moc.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <vector>
+
+#include "../test_macros.hpp"
+#include "sweep_problem.hpp"
+
+// Run on any number of ranks: the decomposed sweeps have one block per rank, and match
+// the sweep of the whole domain on each rank.
+
+using HostMesh = juno::FaceVertexMesh<juno::HostMemSpace>;
+using Sweeper = juno::MOCSweeper<juno::HostMemSpace>;
+using Exchange = juno::BoundaryExchange<juno::HostMemSpace>;
+using FloatView = Kokkos::View<Float *, juno::HostMemSpace>;
+using IntView = Kokkos::View<Int *, juno::HostMemSpace>;
+
+using juno::test::four_pi;
+using juno::test::makeBox;
+using juno::test::makeCrossSections;
+using juno::test::makeSource;
+using juno::test::makeTrackParameters;
+
+namespace
+{
+
+// A communicator of this rank alone
+auto
+selfCommunicator() -> juno::Communicator
+{
+#if JUNO_USE_MPI
+  return juno::Communicator(MPI_COMM_SELF);
+#else
+  return {};
+#endif
+}
+
+// The scalar flux of the whole mesh, swept on one rank
+auto
+sweepWhole(HostMesh const & mesh, int32_t const boundary, Int const num_sweeps)
+    -> FloatView
+{
+  auto const grid = juno::buildFaceGrid(mesh);
+  juno::SweepOptions options;
+  options.boundary = boundary;
+  Sweeper sweeper(grid, juno::makeTrackLayout(grid.box, makeTrackParameters()), options);
+  auto const xs = makeCrossSections();
+  Int const stride = xs.groupStride();
+  Int const num_faces = mesh.numFaces();
+  IntView const materials("materials", static_cast<size_t>(num_faces));
+  auto const source = makeSource(num_faces, stride, 1);
+  FloatView const flux("flux", static_cast<size_t>(num_faces * stride));
+  for (Int iteration = 0; iteration < num_sweeps; ++iteration) {
+    sweeper.sweep(xs, materials, source, flux);
+  }
+  return flux;
+}
+
+// The faces of this rank's block of the mesh, in the whole mesh, and their scalar flux
+struct BlockFlux {
+  std::vector<Int> faces;
+  FloatView flux;
+};
+
+// Sweep this rank's block of the mesh with the exchange
+auto
+sweepBlock(HostMesh const & mesh, int32_t const boundary, Int const num_sweeps,
+           juno::SweepOptions options = {}) -> BlockFlux
+{
+  juno::Communicator const comm;
+  auto const blocks = juno::makeBlockDecomposition(makeBox(1, 1), comm.size());
+  auto const face_blocks = juno::partitionFaces(mesh, blocks);
+  ASSERT(!face_blocks.empty());
+  auto const submesh = juno::extractSubmesh(mesh, face_blocks, comm.rank());
+  auto const layout =
+      juno::makeBlockTrackLayout(blocks, comm.rank(), makeTrackParameters());
+  Exchange exchange(layout, blocks, comm.rank(), comm);
+  ASSERT(exchange.fed().size() == 2 * layout.tracks.size());
+
+  options.boundary = boundary;
+  Sweeper sweeper(juno::buildFaceGrid(submesh.mesh), layout, options);
+  auto const xs = makeCrossSections();
+  Int const stride = xs.groupStride();
+  Int const num_faces = submesh.mesh.numFaces();
+  IntView const materials("materials", static_cast<size_t>(num_faces));
+  auto const source = makeSource(num_faces, stride, 1);
+  FloatView const flux("flux", static_cast<size_t>(num_faces * stride));
+  for (Int iteration = 0; iteration < num_sweeps; ++iteration) {
+    sweeper.sweep(xs, materials, source, flux, exchange);
+  }
+  return {submesh.faces, flux};
+}
+
+} // namespace
+
+TEST_CASE(self_exchange)
+{
+  // A block that is its own neighbor on every side, with vacuum boundaries, is an
+  // infinite medium: every direction is fed by the direction that leaves the opposite
+  // side
+  Int constexpr n = 4;
+  auto const mesh = juno::test::makeQuadMesh(n);
+  auto blocks = juno::makeBlockDecomposition(makeBox(1, 1), 1);
+  blocks.periodic_x = true;
+  blocks.periodic_y = true;
+  auto const layout = juno::makeBlockTrackLayout(blocks, 0, makeTrackParameters());
+  Exchange exchange(layout, blocks, 0, selfCommunicator());
+  Int const num_directions = 2 * layout.numTracks();
+  ASSERT(exchange.numSent() == num_directions);
+  ASSERT(exchange.numReceived() == num_directions);
+  for (Int i = 0; i < num_directions; ++i) {
+    ASSERT(exchange.fed()(i) == 1);
+  }
+
+  juno::SweepOptions options;
+  options.boundary = juno::moc_boundaries::vacuum;
+  Sweeper sweeper(juno::buildFaceGrid(mesh), layout, options);
+  auto const xs = makeCrossSections();
+  Int const stride = xs.groupStride();
+  IntView const materials("materials", n * n);
+  auto const source = makeSource(n * n, stride, 1);
+  FloatView const flux("flux", static_cast<size_t>(n * n * stride));
+  for (Int iteration = 0; iteration < 40; ++iteration) {
+    sweeper.sweep(xs, materials, source, flux, exchange);
+    ASSERT(exchange.inFlight());
+  }
+  for (Int f = 0; f < n * n; ++f) {
+    ASSERT_NEAR(flux(f * stride), four_pi, static_cast<Float>(1e-3) * four_pi);
+    ASSERT_NEAR(flux(f * stride + 1), four_pi / 4, static_cast<Float>(1e-3) * four_pi);
+  }
+}
+
+TEST_CASE(no_neighbors)
+{
+  // Without neighbors, nothing is exchanged, and the sweep is that of the block alone
+  auto const blocks = juno::makeBlockDecomposition(makeBox(1, 1), 1);
+  auto const layout = juno::makeBlockTrackLayout(blocks, 0, makeTrackParameters());
+  Exchange const exchange(layout, blocks, 0, selfCommunicator());
+  ASSERT(exchange.numSent() == 0);
+  ASSERT(exchange.numReceived() == 0);
+  for (int32_t s = 0; s < juno::box_sides::count; ++s) {
+    ASSERT(exchange.neighbor(s) == -1);
+  }
+
+  // More blocks than ranks
+  auto const two = juno::makeBlockDecomposition(makeBox(1, 1), 2);
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  Exchange const bad(juno::makeBlockTrackLayout(two, 0, makeTrackParameters()), two, 0,
+                     selfCommunicator());
+  ASSERT(juno::logger::errorCount() == 1);
+  ASSERT(bad.fed().size() == 0);
+  juno::logger::reset();
+}
+
+TEST_CASE(block_layout)
+{
+  // The tracks of each block are those of the first, translated
+  auto const blocks = juno::makeBlockDecomposition(makeBox(1, 1), 2, 2);
+  auto const first = juno::makeBlockTrackLayout(blocks, 0, makeTrackParameters());
+  auto const last = juno::makeBlockTrackLayout(blocks, 3, makeTrackParameters());
+  ASSERT(first.numTracks() > 0);
+  ASSERT(last.numTracks() == first.numTracks());
+  ASSERT_NEAR(last.box.min.x, blocks.blockBox(3).min.x, 0); // the box of the block
+  ASSERT_NEAR(last.box.max.y, 1, static_cast<Float>(1e-6));
+  for (size_t t = 0; t < first.tracks.size(); ++t) {
+    auto const half = static_cast<Float>(0.5);
+    ASSERT_NEAR(last.tracks[t].origin.x, first.tracks[t].origin.x + half,
+                static_cast<Float>(1e-6));
+    ASSERT_NEAR(last.tracks[t].origin.y, first.tracks[t].origin.y + half,
+                static_cast<Float>(1e-6));
+    ASSERT(last.links[2 * t] == first.links[2 * t]);
+  }
+}
+
+TEST_CASE(decomposed_infinite_medium)
+{
+  // Reflective boundaries on the sides of the domain, and exchanges between the blocks
+  Int constexpr n = 8;
+  auto const block =
+      sweepBlock(juno::test::makeQuadMesh(n), juno::moc_boundaries::reflective, 40);
+  auto const stride = static_cast<size_t>(makeCrossSections().groupStride());
+  ASSERT(block.flux.size() == block.faces.size() * stride);
+  for (size_t f = 0; f < block.faces.size(); ++f) {
+    ASSERT_NEAR(block.flux(f * stride), four_pi, static_cast<Float>(1e-3) * four_pi);
+  }
+}
+
+TEST_CASE(decomposed_vacuum)
+{
+  // The flux of the decomposed domain is that of the whole domain, up to the different
+  // tracks
+  Int constexpr n = 8;
+  auto const mesh = juno::test::makeQuadMesh(n);
+  Int constexpr num_sweeps = 30;
+  auto const whole = sweepWhole(mesh, juno::moc_boundaries::vacuum, num_sweeps);
+  auto const stride = static_cast<size_t>(makeCrossSections().groupStride());
+  auto const check = [&](BlockFlux const & block) {
+    for (size_t f = 0; f < block.faces.size(); ++f) {
+      auto const global = static_cast<size_t>(block.faces[f]);
+      for (size_t g = 0; g < 2; ++g) {
+        Float const expected = whole(global * stride + g);
+        ASSERT_NEAR(block.flux(f * stride + g), expected,
+                    static_cast<Float>(2e-2) * expected);
+      }
+    }
+  };
+  check(sweepBlock(mesh, juno::moc_boundaries::vacuum, num_sweeps));
+
+  // Without cached segments, the exchange does not overlap the sweep, and gives the
+  // same flux
+  juno::SweepOptions options;
+  options.memory_budget = 0;
+  options.tracks_per_batch = 100;
+  check(sweepBlock(mesh, juno::moc_boundaries::vacuum, num_sweeps, options));
+}
+
+TEST_SUITE(boundary_exchange)
+{
+  TEST(self_exchange);
+  TEST(no_neighbors);
+  TEST(block_layout);
+  TEST(decomposed_infinite_medium);
+  TEST(decomposed_vacuum);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  juno::MPIGuard const mpi(argc, argv);
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(boundary_exchange);
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include <juno/math/krylov.hpp>
+#include <juno/physics/cmfd.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "../test_macros.hpp"
+#include "../mesh/quad_mesh.hpp"
+
+using Vector = Kokkos::View<Float *, juno::HostMemSpace>;
+
+Float constexpr eps = static_cast<Float>(1e-4);
+
+namespace
+{
+
+auto
+makeConstant(Int const n, Float const value) -> Vector
+{
+  Vector v("v", static_cast<size_t>(n));
+  Kokkos::deep_copy(v, value);
+  return v;
+}
+
+} // namespace
+
+TEST_CASE(assemble)
+{
+  Int constexpr n = 6;
+  auto const mesh = juno::test::makeQuadMesh(n);
+  Float const d = 2;
+  Float const sigma = static_cast<Float>(0.5);
+  auto const diffusion = makeConstant(n * n, d);
+  auto const removal = makeConstant(n * n, sigma);
+  auto const a = juno::assembleDiffusionOperator(mesh, diffusion, removal,
+                                                 juno::cmfd_boundaries::reflective);
+  ASSERT(a.num_rows == n * n);
+  // 4 interior neighbors, 3 on an edge, 2 in a corner, and the diagonal
+  ASSERT(a.numNonzeros() == n * n + 4 * n * (n - 1));
+
+  Float const area = static_cast<Float>(1) / (n * n);
+  for (Int f = 0; f < n * n; ++f) {
+    Float row_sum = 0;
+    for (Int k = a.row_offsets(f); k < a.row_offsets(f + 1); ++k) {
+      ASSERT(k == a.row_offsets(f) || a.columns(k - 1) < a.columns(k));
+      row_sum += a.values(k);
+      // On a uniform grid, the coupling of neighbors is D
+      if (a.columns(k) != f) {
+        ASSERT_NEAR(a.values(k), -d, eps);
+      }
+    }
+    // With reflective boundaries, the currents cancel
+    ASSERT_NEAR(row_sum, sigma * area, eps);
+  }
+
+  // With vacuum boundaries, a corner leaks across two edges:
+  // D L / (h + 2 D) with L = 1 / n, h = 1 / (2 n)
+  auto const v = juno::assembleDiffusionOperator(mesh, diffusion, removal,
+                                                 juno::cmfd_boundaries::vacuum);
+  Float const leak = d / n / (static_cast<Float>(0.5) / n + 2 * d);
+  Float const corner = v.values(v.row_offsets(0));
+  ASSERT_NEAR(corner, sigma * area + 2 * d + 2 * leak, eps);
+}
+
+TEST_CASE(solve)
+{
+  Int constexpr n = 16;
+  auto const mesh = juno::test::makeQuadMesh(n).mirror<juno::DeviceMemSpace>();
+  using DeviceVector = Kokkos::View<Float *, juno::DeviceMemSpace>;
+  // Cells of a few diffusion lengths, as for CMFD, so the system is well conditioned
+  // even in single precision
+  Float const d = static_cast<Float>(0.01);
+  Float const sigma = 1;
+  Float const area = static_cast<Float>(1) / (n * n);
+  DeviceVector const diffusion("diffusion", n * n);
+  DeviceVector const removal("removal", n * n);
+  DeviceVector const source("source", n * n);
+  Kokkos::deep_copy(diffusion, d);
+  Kokkos::deep_copy(removal, sigma);
+  Kokkos::deep_copy(source, area);
+
+  // In an infinite medium, phi = S / removal
+  auto const a = juno::assembleDiffusionOperator(mesh, diffusion, removal,
+                                                 juno::cmfd_boundaries::reflective);
+  auto const m = juno::makeILU0Preconditioner(a);
+  DeviceVector const phi("phi", n * n);
+  juno::KrylovOptions options;
+  options.tolerance = static_cast<Float>(1e-5);
+  auto const result = juno::gmres(a, m, source, phi, options);
+  ASSERT(result.converged);
+  auto const h_phi = Kokkos::create_mirror_view_and_copy(juno::HostMemSpace(), phi);
+  for (Int f = 0; f < n * n; ++f) {
+    ASSERT_NEAR(h_phi(f), 1 / sigma, eps);
+  }
+
+  // With vacuum boundaries, the flux is symmetric and peaks in the center
+  auto const v = juno::makeSlicedELLMatrix(juno::assembleDiffusionOperator(
+      mesh, diffusion, removal, juno::cmfd_boundaries::vacuum));
+  auto const jacobi = juno::makeJacobiPreconditioner(juno::assembleDiffusionOperator(
+      mesh, diffusion, removal, juno::cmfd_boundaries::vacuum));
+  Kokkos::deep_copy(phi, 0);
+  ASSERT(juno::bicgstab(v, jacobi, source, phi, options).converged);
+  auto const h_v = Kokkos::create_mirror_view_and_copy(juno::HostMemSpace(), phi);
+  for (Int j = 0; j < n; ++j) {
+    for (Int i = 0; i < n; ++i) {
+      Float const value = h_v(j * n + i);
+      ASSERT(value > 0);
+      ASSERT_NEAR(value, h_v(i * n + j), eps);
+      ASSERT_NEAR(value, h_v(j * n + n - 1 - i), eps);
+    }
+  }
+  ASSERT(h_v(0) < h_v((n / 2) * n + n / 2));
+}
+
+TEST_SUITE(cmfd)
+{
+  TEST(assemble);
+  TEST(solve);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(cmfd);
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <juno/common/logger.hpp>
+#include <juno/physics/nuclide.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+
+#include "../test_macros.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+using juno::reactions::absorption;
+using juno::reactions::chi;
+using juno::reactions::nu_fission;
+using juno::reactions::total;
+
+namespace
+{
+
+// A fissile nuclide with 3 groups and downscattering only
+auto
+makeNuclide() -> juno::Nuclide
+{
+  juno::Nuclide nuclide;
+  nuclide.name = "U235";
+  nuclide.zaid = 92235;
+  nuclide.num_groups = 3;
+  nuclide.total = {1, 2, 3};
+  nuclide.absorption = {static_cast<Float>(0.5), 1, 2};
+  nuclide.nu_fission = {static_cast<Float>(0.25), static_cast<Float>(0.5), 1};
+  nuclide.chi = {static_cast<Float>(0.75), static_cast<Float>(0.25), 0};
+  nuclide.scatter = {static_cast<Float>(0.5), static_cast<Float>(0.25), 0, //
+                     0, 1, static_cast<Float>(0.5),                         //
+                     0, 0, 1};
+  return nuclide;
+}
+
+} // namespace
+
+TEST_CASE(padding)
+{
+  Int constexpr per_row = juno::xs_alignment / static_cast<Int>(sizeof(Float));
+  STATIC_ASSERT(juno::paddedGroups(1) == per_row);
+  STATIC_ASSERT(juno::paddedGroups(per_row) == per_row);
+  STATIC_ASSERT(juno::paddedGroups(per_row + 1) == 2 * per_row);
+
+  // Every row starts on a cache line
+  juno::CrossSections<juno::HostMemSpace> const xs("xs", 5, 7);
+  ASSERT(xs.numEntries() == 5);
+  ASSERT(xs.groupStride() == juno::paddedGroups(7));
+  for (Int e = 0; e < xs.numEntries(); ++e) {
+    for (Int r = 0; r < juno::reactions::count; ++r) {
+      ASSERT(reinterpret_cast<uintptr_t>(xs.row(e, r)) % juno::xs_alignment == 0);
+    }
+    for (Int g = 0; g < xs.numGroups(); ++g) {
+      ASSERT(reinterpret_cast<uintptr_t>(xs.scatterRow(e, g)) % juno::xs_alignment == 0);
+    }
+  }
+}
+
+TEST_CASE(pack)
+{
+  auto const nuclide = makeNuclide();
+  auto const xs = juno::makeCrossSections({nuclide, nuclide});
+  ASSERT(xs.numEntries() == 2);
+  ASSERT(xs.numGroups() == 3);
+  ASSERT(juno::validate(xs));
+  for (Int e = 0; e < 2; ++e) {
+    for (Int g = 0; g < 3; ++g) {
+      auto const i = static_cast<size_t>(g);
+      ASSERT_NEAR(xs(e, total, g), nuclide.total[i], eps);
+      ASSERT_NEAR(xs(e, absorption, g), nuclide.absorption[i], eps);
+      ASSERT_NEAR(xs(e, nu_fission, g), nuclide.nu_fission[i], eps);
+      ASSERT_NEAR(xs(e, chi, g), nuclide.chi[i], eps);
+      for (Int to = 0; to < 3; ++to) {
+        ASSERT_NEAR(xs.scatter(e, g, to),
+                    nuclide.scatter[static_cast<size_t>(g * 3 + to)], eps);
+      }
+    }
+    // The padding is zero
+    for (Int g = 3; g < xs.groupStride(); ++g) {
+      ASSERT_NEAR(xs(e, total, g), 0, eps);
+    }
+  }
+
+  // The scattering row of a group is the row of the matrix
+  ASSERT_NEAR(xs.scatterRow(0, 1)[0], nuclide.scatter[3], eps);
+  ASSERT_NEAR(xs.scatterRow(0, 1)[1], nuclide.scatter[4], eps);
+  ASSERT_NEAR(xs.scatterRow(0, 1)[2], nuclide.scatter[5], eps);
+
+  // Copies are deep and keep the layout
+  auto const copy = xs.mirror<juno::HostMemSpace>();
+  ASSERT(copy.vectorValues().data() != xs.vectorValues().data());
+  ASSERT(reinterpret_cast<uintptr_t>(copy.row(1, chi)) % juno::xs_alignment == 0);
+  ASSERT_NEAR(copy(1, chi, 0), xs(1, chi, 0), eps);
+  ASSERT_NEAR(copy.scatter(1, 1, 2), xs.scatter(1, 1, 2), eps);
+}
+
+TEST_CASE(invalid)
+{
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+
+  auto nuclide = makeNuclide();
+  nuclide.chi.pop_back();
+  ASSERT(!juno::validate(nuclide));
+  ASSERT(juno::makeCrossSections({nuclide}).numEntries() == 0);
+
+  auto const other = makeNuclide();
+  auto xs = juno::makeCrossSections({other});
+  ASSERT(juno::validate(xs));
+  xs(0, absorption, 1) = 10;
+  ASSERT(!juno::validate(xs));
+  xs(0, absorption, 1) = 1;
+  xs(0, chi, 2) = 1;
+  ASSERT(!juno::validate(xs));
+  xs(0, chi, 2) = 0;
+  xs.scatter(0, 2, 0) = -1;
+  ASSERT(!juno::validate(xs));
+  ASSERT(juno::logger::errorCount() > 0);
+
+  juno::logger::reset();
+}
+
+TEST_SUITE(cross_section)
+{
+  TEST(padding);
+  TEST(pack);
+  TEST(invalid);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(cross_section);
+  return 0;
+}
@@ -0,0 +1,172 @@
+#include <juno/common/logger.hpp>
+#include <juno/physics/cross_section_library.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <atomic>
+#include <cmath>      // std::abs
+#include <cstdio>     // std::remove
+#include <filesystem> // std::filesystem::temp_directory_path
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../test_macros.hpp"
+
+Float constexpr eps = static_cast<Float>(1e-6);
+
+Int constexpr num_nuclides = 100;
+Int constexpr num_groups = 4;
+
+namespace
+{
+
+// Nuclide i has total cross sections i + g, and so on
+auto
+makeNuclide(Int const i) -> juno::Nuclide
+{
+  juno::Nuclide nuclide;
+  nuclide.name = "N" + std::to_string(i);
+  nuclide.zaid = static_cast<int32_t>(1000 + i);
+  nuclide.num_groups = num_groups;
+  for (Int g = 0; g < num_groups; ++g) {
+    nuclide.total.push_back(static_cast<Float>(i + g + 1));
+    nuclide.absorption.push_back(static_cast<Float>(g));
+    nuclide.nu_fission.push_back(static_cast<Float>(i));
+    nuclide.chi.push_back(static_cast<Float>(0.25));
+    for (Int to = 0; to < num_groups; ++to) {
+      nuclide.scatter.push_back(static_cast<Float>(g * num_groups + to));
+    }
+  }
+  return nuclide;
+}
+
+auto
+libraryPath() -> std::string
+{
+  return (std::filesystem::temp_directory_path() / "juno_test_library.xs").string();
+}
+
+void
+writeLibrary()
+{
+  std::vector<juno::Nuclide> nuclides;
+  for (Int i = 0; i < num_nuclides; ++i) {
+    nuclides.push_back(makeNuclide(i));
+  }
+  ASSERT(juno::writeCrossSectionLibrary(libraryPath(), nuclides));
+}
+
+} // namespace
+
+TEST_CASE(lazy)
+{
+  writeLibrary();
+  juno::CrossSectionLibrary const library(libraryPath());
+  ASSERT(library.isOpen());
+  ASSERT(library.numNuclides() == num_nuclides);
+  ASSERT(library.numGroups() == num_groups);
+  ASSERT(library.numLoaded() == 0);
+  ASSERT(library.find("N42") == 42);
+  ASSERT(library.find("N100") == -1);
+  ASSERT(library.name(7) == "N7");
+  ASSERT(library.zaid(7) == 1007);
+  ASSERT(library.indexHash() != 0);
+  ASSERT(library.dataHash(7) != library.dataHash(8));
+  ASSERT(library.numLoaded() == 0);
+
+  // Only the nuclides asked for are read, once
+  auto const & n42 = library.nuclide(42);
+  ASSERT(library.numLoaded() == 1);
+  ASSERT(&library.nuclide(42) == &n42);
+  ASSERT(library.numLoaded() == 1);
+  ASSERT(n42.name == "N42");
+  ASSERT(n42.num_groups == num_groups);
+  ASSERT_NEAR(n42.total[3], 46, eps);
+  ASSERT_NEAR(n42.scatter[6], 6, eps);
+
+  auto const xs = library.load({"N3", "N42", "N99", "N3"});
+  ASSERT(library.numLoaded() == 3);
+  ASSERT(xs.numEntries() == 4);
+  ASSERT(xs.numGroups() == num_groups);
+  ASSERT_NEAR(xs(0, juno::reactions::total, 0), 4, eps);
+  ASSERT_NEAR(xs(2, juno::reactions::nu_fission, 1), 99, eps);
+  ASSERT_NEAR(xs(3, juno::reactions::total, 2), 6, eps);
+  ASSERT_NEAR(xs.scatter(1, 2, 1), 9, eps);
+  ASSERT(juno::validate(xs));
+}
+
+TEST_CASE(parallel)
+{
+  juno::CrossSectionLibrary const library(libraryPath());
+  // Every thread asks for every nuclide, from a different start: each is read once
+  Int constexpr num_threads = 8;
+  std::vector<std::thread> threads;
+  std::atomic<Int> num_wrong = 0;
+  for (Int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&library, &num_wrong, t]() {
+      for (Int i = 0; i < num_nuclides; ++i) {
+        Int const n = (i + t * 13) % num_nuclides;
+        if (std::abs(library.nuclide(n).total[0] - static_cast<Float>(n + 1)) > eps) {
+          ++num_wrong;
+        }
+      }
+    });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  ASSERT(num_wrong == 0);
+  ASSERT(library.numLoaded() == num_nuclides);
+}
+
+TEST_CASE(invalid)
+{
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+
+  juno::CrossSectionLibrary const library(libraryPath());
+  ASSERT(library.load({"N1", "U235"}).numEntries() == 0);
+  ASSERT(juno::logger::errorCount() == 1);
+
+  // Damage the data of the last nuclide; the others can still be read
+  {
+    std::fstream file(libraryPath(), std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-8, std::ios::end);
+    file.put('x');
+  }
+  juno::CrossSectionLibrary const damaged(libraryPath());
+  ASSERT(damaged.isOpen());
+  ASSERT(damaged.nuclide(0).num_groups == num_groups);
+  ASSERT(damaged.nuclide(num_nuclides - 1).num_groups == 0);
+  ASSERT(damaged.load({"N0", "N99"}).numEntries() == 0);
+  ASSERT(juno::logger::errorCount() == 2);
+
+  // Damage the index
+  {
+    std::fstream file(libraryPath(), std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(40);
+    file.put('x');
+  }
+  ASSERT(!juno::CrossSectionLibrary(libraryPath()).isOpen());
+  ASSERT(juno::logger::errorCount() == 3);
+  std::remove(libraryPath().c_str());
+
+  juno::logger::reset();
+}
+
+TEST_SUITE(cross_section_library)
+{
+  TEST(lazy);
+  TEST(parallel);
+  TEST(invalid);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(cross_section_library);
+  return 0;
+}
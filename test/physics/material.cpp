@@ -0,0 +1,129 @@
+#include <juno/common/logger.hpp>
+#include <juno/physics/material.hpp>
+#include <juno/physics/nuclide.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "../test_macros.hpp"
+
+using juno::reactions::absorption;
+using juno::reactions::chi;
+using juno::reactions::nu_fission;
+using juno::reactions::total;
+
+Float constexpr eps = static_cast<Float>(1e-5);
+
+namespace
+{
+
+// Two 2-group nuclides: a fissile one, and a fissile one with a harder spectrum
+auto
+makeNuclides() -> juno::CrossSections<juno::HostMemSpace>
+{
+  juno::Nuclide a;
+  a.name = "a";
+  a.num_groups = 2;
+  a.total = {1, 2};
+  a.absorption = {static_cast<Float>(0.5), 1};
+  a.nu_fission = {1, 1};
+  a.chi = {static_cast<Float>(0.5), static_cast<Float>(0.5)};
+  a.scatter = {static_cast<Float>(0.25), static_cast<Float>(0.25), 0, 1};
+
+  juno::Nuclide b = a;
+  b.name = "b";
+  b.total = {4, 8};
+  b.nu_fission = {3, 3};
+  b.chi = {1, 0};
+  return juno::makeCrossSections({a, b});
+}
+
+} // namespace
+
+TEST_CASE(mix)
+{
+  auto const nuclides = makeNuclides();
+  std::vector<juno::Material> const materials = {
+      {"a", {0}, {2}},
+      {"ab", {0, 1}, {1, 1}},
+      {"empty", {}, {}},
+  };
+  auto const xs = juno::mixMaterials(nuclides, materials);
+  ASSERT(xs.numEntries() == 3);
+  ASSERT(juno::validate(xs));
+
+  ASSERT_NEAR(xs(0, total, 0), 2, eps);
+  ASSERT_NEAR(xs(0, total, 1), 4, eps);
+  ASSERT_NEAR(xs(0, nu_fission, 1), 2, eps);
+  ASSERT_NEAR(xs.scatter(0, 0, 1), static_cast<Float>(0.5), eps);
+  ASSERT_NEAR(xs(0, chi, 0), static_cast<Float>(0.5), eps);
+
+  ASSERT_NEAR(xs(1, total, 0), 5, eps);
+  ASSERT_NEAR(xs(1, absorption, 1), 2, eps);
+  ASSERT_NEAR(xs(1, nu_fission, 0), 4, eps);
+  ASSERT_NEAR(xs.scatter(1, 1, 1), 2, eps);
+  // b produces 3 times the fission neutrons of a
+  ASSERT_NEAR(xs(1, chi, 0), static_cast<Float>(0.875), eps);
+  ASSERT_NEAR(xs(1, chi, 1), static_cast<Float>(0.125), eps);
+
+  for (Int g = 0; g < 2; ++g) {
+    ASSERT_NEAR(xs(2, total, g), 0, eps);
+    ASSERT_NEAR(xs(2, chi, g), 0, eps);
+  }
+
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  std::vector<juno::Material> const bad = {{"bad", {2}, {1}}};
+  ASSERT(juno::mixMaterials(nuclides, bad).numEntries() == 0);
+  ASSERT(juno::logger::errorCount() == 1);
+  juno::logger::reset();
+}
+
+TEST_CASE(update)
+{
+  auto const nuclides = makeNuclides();
+  std::vector<juno::Material> materials = {
+      {"a", {0}, {1}},
+      {"b", {1}, {1}},
+      {"ab", {0, 1}, {1, 1}},
+  };
+  juno::MaterialCrossSections xs(nuclides, materials);
+  ASSERT(xs.numMaterials() == 3);
+  auto const device = Kokkos::create_mirror_view_and_copy(juno::HostMemSpace(),
+                                                          xs.device().vectorValues());
+  ASSERT(device.size() == xs.host().vectorValues().size());
+  ASSERT_NEAR(device(0), xs.host().vectorValues()(0), eps);
+
+  // Nothing changed
+  ASSERT(xs.update(nuclides, materials) == 0);
+
+  // Only the depleted material is mixed again
+  materials[2].number_densities[1] = 2;
+  ASSERT(xs.update(nuclides, materials) == 1);
+  ASSERT_NEAR(xs.host()(2, total, 0), 9, eps);
+  ASSERT_NEAR(xs.host()(0, total, 0), 1, eps);
+  ASSERT_NEAR(xs.host()(2, chi, 0), static_cast<Float>(13) / 14, eps);
+  auto const updated = Kokkos::create_mirror_view_and_copy(juno::HostMemSpace(),
+                                                           xs.device().vectorValues());
+  Int const stride = xs.host().groupStride();
+  ASSERT_NEAR(updated(2 * juno::reactions::count * stride), 9, eps);
+
+  // A new material means mixing them all
+  materials.push_back({"a2", {0}, {2}});
+  ASSERT(xs.update(nuclides, materials) == 4);
+  ASSERT(xs.numMaterials() == 4);
+  ASSERT_NEAR(xs.host()(3, total, 1), 4, eps);
+}
+
+TEST_SUITE(material)
+{
+  TEST(mix);
+  TEST(update);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(material);
+  return 0;
+}
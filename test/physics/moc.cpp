@@ -0,0 +1,186 @@
+#include <juno/physics/moc.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath> // std::abs
+
+#include "../test_macros.hpp"
+#include "sweep_problem.hpp"
+
+using Sweeper = juno::MOCSweeper<juno::HostMemSpace>;
+using FloatView = Kokkos::View<Float *, juno::HostMemSpace>;
+using IntView = Kokkos::View<Int *, juno::HostMemSpace>;
+
+using juno::test::four_pi;
+using juno::test::makeCrossSections;
+using juno::test::makeSource;
+
+namespace
+{
+
+auto
+makeLayout(juno::AABB2 const & box) -> juno::TrackLayout
+{
+  return juno::makeTrackLayout(box, juno::test::makeTrackParameters());
+}
+
+} // namespace
+
+TEST_CASE(volumes)
+{
+  Int constexpr n = 4;
+  auto const grid = juno::buildFaceGrid(juno::test::makeQuadMesh(n));
+  Sweeper const sweeper(grid, makeLayout(grid.box));
+  ASSERT(sweeper.numTracks() > 0);
+  ASSERT(sweeper.numSegments() > sweeper.numTracks());
+  ASSERT(sweeper.isCached());
+  ASSERT(sweeper.lengthScale() > 0);
+
+  // Each azimuth covers the whole box, so the total is the area up to the rounding of
+  // the lengths, and each face is about right
+  Float total = 0;
+  for (Int f = 0; f < n * n; ++f) {
+    Float const v = sweeper.volumes()(f);
+    ASSERT_NEAR(v, static_cast<Float>(1) / (n * n), static_cast<Float>(2e-3));
+    total += v;
+  }
+  ASSERT_NEAR(total, 1, static_cast<Float>(1e-3));
+}
+
+TEST_CASE(infinite_medium)
+{
+  // With reflective boundaries and a uniform source, the flux is that of an infinite
+  // medium
+  Int constexpr n = 4;
+  auto const grid = juno::buildFaceGrid(juno::test::makeQuadMesh(n));
+  Sweeper sweeper(grid, makeLayout(grid.box));
+  auto const xs = makeCrossSections();
+  Int const stride = xs.groupStride();
+  IntView const materials("materials", n * n);
+  auto const source = makeSource(n * n, stride, 1);
+  FloatView const flux("flux", static_cast<size_t>(n * n * stride));
+  for (Int iteration = 0; iteration < 40; ++iteration) {
+    sweeper.sweep(xs, materials, source, flux);
+  }
+  for (Int f = 0; f < n * n; ++f) {
+    ASSERT_NEAR(flux(f * stride), four_pi, static_cast<Float>(1e-3) * four_pi);
+    ASSERT_NEAR(flux(f * stride + 1), four_pi / 4, static_cast<Float>(1e-3) * four_pi);
+    for (Int g = 2; g < stride; ++g) {
+      ASSERT_NEAR(flux(f * stride + g), 0, static_cast<Float>(1e-6)); // padding
+    }
+  }
+
+  // Without the boundary fluxes, the first sweep is that of a vacuum boundary
+  sweeper.resetBoundaryFluxes();
+  sweeper.sweep(xs, materials, source, flux);
+  ASSERT(flux(0) < static_cast<Float>(0.9) * four_pi);
+}
+
+TEST_CASE(vacuum)
+{
+  Int constexpr n = 6;
+  auto const grid = juno::buildFaceGrid(juno::test::makeQuadMesh(n));
+  juno::SweepOptions options;
+  options.boundary = juno::moc_boundaries::vacuum;
+  Sweeper sweeper(grid, makeLayout(grid.box), options);
+  auto const xs = makeCrossSections();
+  Int const stride = xs.groupStride();
+  IntView const materials("materials", n * n);
+  auto const source = makeSource(n * n, stride, 1);
+  FloatView const flux("flux", static_cast<size_t>(n * n * stride));
+  sweeper.sweep(xs, materials, source, flux);
+  sweeper.sweep(xs, materials, source, flux);
+
+  // The flux is below that of the infinite medium, highest in the center, and has the
+  // symmetries of the square
+  for (Int j = 0; j < n; ++j) {
+    for (Int i = 0; i < n; ++i) {
+      Float const phi = flux((j * n + i) * stride);
+      ASSERT(0 < phi && phi < four_pi);
+      Float const mirror = flux((j * n + (n - 1 - i)) * stride);
+      Float const transpose = flux((i * n + j) * stride);
+      ASSERT_NEAR(phi, mirror, static_cast<Float>(1e-2) * phi);
+      ASSERT_NEAR(phi, transpose, static_cast<Float>(1e-2) * phi);
+    }
+  }
+  ASSERT(flux(0) < flux((n / 2 * n + n / 2) * stride));
+}
+
+TEST_CASE(on_the_fly)
+{
+  // Without the memory for the segments, they are traced in each sweep, in batches, and
+  // give the same flux
+  Int constexpr n = 4;
+  auto const grid = juno::buildFaceGrid(juno::test::makeQuadMesh(n));
+  auto const layout = makeLayout(grid.box);
+  Sweeper cached(grid, layout);
+  juno::SweepOptions options;
+  options.memory_budget = 0;
+  options.tracks_per_batch = 100;
+  Sweeper traced(grid, layout, options);
+  ASSERT(cached.isCached());
+  ASSERT(!traced.isCached());
+  ASSERT(traced.numSegments() == cached.numSegments());
+  ASSERT(traced.segmentBytes() > cached.segmentBytes());
+
+  auto const xs = makeCrossSections();
+  Int const stride = xs.groupStride();
+  IntView const materials("materials", n * n);
+  auto const source = makeSource(n * n, stride, 1);
+  FloatView const a("a", static_cast<size_t>(n * n * stride));
+  FloatView const b("b", static_cast<size_t>(n * n * stride));
+  for (Int iteration = 0; iteration < 3; ++iteration) {
+    cached.sweep(xs, materials, source, a);
+    traced.sweep(xs, materials, source, b);
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    ASSERT_NEAR(a(i), b(i), static_cast<Float>(1e-5) * four_pi);
+  }
+}
+
+TEST_CASE(exponentials)
+{
+  // The fast exponentials give the flux of the library exp, within their tolerance
+  Int constexpr n = 4;
+  auto const grid = juno::buildFaceGrid(juno::test::makeQuadMesh(n));
+  auto const layout = makeLayout(grid.box);
+  auto const xs = makeCrossSections();
+  Int const stride = xs.groupStride();
+  IntView const materials("materials", n * n);
+  auto const source = makeSource(n * n, stride, 1);
+  auto const sweepWith = [&](int32_t const exponential) {
+    juno::SweepOptions options;
+    options.exponential = exponential;
+    options.exp_tolerance = 1e-5;
+    Sweeper sweeper(grid, layout, options);
+    FloatView const flux("flux", static_cast<size_t>(n * n * stride));
+    for (Int iteration = 0; iteration < 3; ++iteration) {
+      sweeper.sweep(xs, materials, source, flux);
+    }
+    return flux;
+  };
+  auto const library = sweepWith(juno::sweep_exponentials::library);
+  auto const rational = sweepWith(juno::sweep_exponentials::rational);
+  auto const table = sweepWith(juno::sweep_exponentials::table);
+  for (size_t i = 0; i < library.size(); ++i) {
+    ASSERT_NEAR(rational(i), library(i), static_cast<Float>(1e-5) * four_pi);
+    ASSERT_NEAR(table(i), library(i), static_cast<Float>(1e-3) * four_pi);
+  }
+}
+
+TEST_SUITE(moc)
+{
+  TEST(volumes);
+  TEST(infinite_medium);
+  TEST(vacuum);
+  TEST(on_the_fly);
+  TEST(exponentials);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(moc);
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <juno/common/logger.hpp>
+#include <juno/common/stage_cache.hpp>
+#include <juno/physics/setup.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <filesystem> // std::filesystem::temp_directory_path, std::filesystem::remove_all
+#include <fstream>    // std::ofstream
+#include <string>
+#include <utility> // std::pair
+#include <vector>
+
+#include "../test_macros.hpp"
+
+namespace
+{
+
+auto
+tempPath(std::string const & name) -> std::string
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// A library of five nuclides with one group, and different absorption cross sections.
+// The total cross section of the first is "total".
+void
+writeLibrary(std::string const & filename, Float const total)
+{
+  std::vector<juno::Nuclide> nuclides;
+  for (char const * name : {"U235", "U238", "O16", "H1", "B10"}) {
+    juno::Nuclide nuclide;
+    nuclide.name = name;
+    nuclide.num_groups = 1;
+    nuclide.total = {nuclides.empty() ? total : 1};
+    nuclide.absorption = {static_cast<Float>(nuclides.size())};
+    nuclide.nu_fission = {0};
+    nuclide.chi = {0};
+    nuclide.scatter = {0};
+    nuclides.push_back(nuclide);
+  }
+  ASSERT(juno::writeCrossSectionLibrary(filename, nuclides));
+}
+
+auto
+makeSetup() -> juno::SetupInput
+{
+  juno::SetupInput setup;
+  setup.mesh = tempPath("juno_test_setup.msh");
+  setup.library = tempPath("juno_test_setup.xs");
+  std::ofstream(setup.mesh) << "$MeshFormat\n4.1 0 8\n$EndMeshFormat\n";
+  writeLibrary(setup.library, 2);
+  auto const n = [](double const x) { return static_cast<Float>(x); };
+  setup.materials = {
+      {"fuel", {"U235", "U238", "O16"}, {n(7e-4), n(2e-2), n(4e-2)}},
+      {"water", {"H1", "O16"}, {n(6e-2), n(3e-2)}}};
+  return setup;
+}
+
+// The stages that a run of the setup runs, as junoc does: those whose results are not
+// cached, which are then cached. The box of the mesh is fixed.
+auto
+runStages(juno::SetupInput const & setup, juno::StageCache const & cache)
+    -> std::vector<std::string>
+{
+  juno::CrossSectionLibrary const library(setup.library);
+  auto const keys = juno::stageKeys(setup, library);
+  ASSERT(keys.import != 0);
+  juno::AABB2 const box = {juno::Vec2{0, 0}, juno::Vec2{1, 1}};
+  std::vector<std::pair<std::string, uint64_t>> const stages = {
+      {"import", keys.import},
+      {"reorder", keys.reorder},
+      {"index", keys.index},
+      {"mix", keys.mix},
+      {"tracks", juno::tracksKey(box, setup.tracks)}};
+  std::vector<std::string> ran;
+  for (auto const & [stage, key] : stages) {
+    if (!cache.read(stage, key).ok()) {
+      ran.push_back(stage);
+      juno::StageWriter writer;
+      writer.write(key);
+      ASSERT(cache.write(stage, key, writer));
+    }
+  }
+  return ran;
+}
+
+} // namespace
+
+TEST_CASE(materials)
+{
+  std::vector<std::string> names = {"H1"};
+  auto const setup = makeSetup();
+  auto const materials = juno::makeMaterials(setup.materials, names);
+  ASSERT(materials.size() == 2);
+  ASSERT((names == std::vector<std::string>{"H1", "U235", "U238", "O16"}));
+  ASSERT(materials[0].name == "fuel");
+  ASSERT((materials[0].nuclides == std::vector<Int>{1, 2, 3}));
+  ASSERT((materials[1].nuclides == std::vector<Int>{0, 3}));
+  // Copied, so exactly equal
+  auto const & densities = setup.materials[1].number_densities;
+  ASSERT_NEAR(materials[1].number_densities[0], densities[0], 0);
+}
+
+TEST_CASE(reruns)
+{
+  auto const directory = tempPath("juno_test_setup_cache");
+  std::filesystem::remove_all(directory);
+  juno::StageCache const cache(directory);
+  auto setup = makeSetup();
+  using Stages = std::vector<std::string>;
+  Stages const all = {"import", "reorder", "index", "mix", "tracks"};
+  ASSERT(runStages(setup, cache) == all);
+
+  // The settings of the solver, such as the tolerance, are not in the setup: the same
+  // setup runs no stage
+  ASSERT(runStages(setup, cache).empty());
+
+  // A material only mixes again
+  setup.materials[0].number_densities[0] = static_cast<Float>(8e-4);
+  ASSERT((runStages(setup, cache) == Stages{"mix"}));
+  setup.materials[1].nuclides[0] = "B10";
+  ASSERT((runStages(setup, cache) == Stages{"mix"}));
+
+  // The index, from the reordered soup
+  setup.faces_per_cell = 4;
+  ASSERT((runStages(setup, cache) == Stages{"index"}));
+  setup.reorder = "morton";
+  ASSERT((runStages(setup, cache) == Stages{"reorder", "index"}));
+  setup.tracks.spacing = static_cast<Float>(0.1);
+  ASSERT((runStages(setup, cache) == Stages{"tracks"}));
+
+  // The same library, written again, is the same; other data is not
+  writeLibrary(setup.library, 2);
+  ASSERT(runStages(setup, cache).empty());
+  writeLibrary(setup.library, 3);
+  ASSERT((runStages(setup, cache) == Stages{"mix"}));
+
+  // The mesh file
+  std::ofstream(setup.mesh, std::ios::app) << "\n";
+  ASSERT((runStages(setup, cache) == Stages{"import", "reorder", "index"}));
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(keys)
+{
+  auto setup = makeSetup();
+  juno::CrossSectionLibrary const library(setup.library);
+  auto const keys = juno::stageKeys(setup, library);
+  ASSERT(keys.reorder != keys.import);
+  setup.reorder = "none";
+  auto const unordered = juno::stageKeys(setup, library);
+  ASSERT(unordered.reorder == unordered.import);
+  ASSERT(unordered.import == keys.import);
+  ASSERT(unordered.mix == keys.mix);
+
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  setup.materials[1].nuclides[0] = "U234";
+  ASSERT(juno::stageKeys(setup, library).mix == 0);
+  ASSERT(juno::logger::errorCount() == 1);
+  setup.mesh = tempPath("juno_test_setup_missing.msh");
+  ASSERT(juno::stageKeys(setup, library).import == 0);
+  ASSERT(juno::logger::errorCount() == 2);
+  juno::logger::reset();
+}
+
+TEST_SUITE(setup)
+{
+  TEST(materials);
+  TEST(reruns);
+  TEST(keys);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(setup);
+  std::filesystem::remove(tempPath("juno_test_setup.msh"));
+  std::filesystem::remove(tempPath("juno_test_setup.xs"));
+  return 0;
+}
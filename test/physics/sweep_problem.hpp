@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juno/config.hpp>
+#include <juno/physics/cross_section.hpp>
+#include <juno/physics/tracks.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "../mesh/quad_mesh.hpp"
+
+// The problem swept by the tests of the sweeps: two groups, a uniform source, and a
+// fine track layout. Its infinite-medium scalar flux is four_pi in group 0 and
+// four_pi / 4 in group 1.
+
+namespace juno::test
+{
+
+inline constexpr Float four_pi = static_cast<Float>(4 * 3.14159265358979);
+
+inline auto
+makeTrackParameters() -> TrackParameters
+{
+  TrackParameters parameters;
+  parameters.num_azimuthal = 16;
+  parameters.spacing = static_cast<Float>(0.02);
+  parameters.num_polar = 3;
+  return parameters;
+}
+
+// One material with two groups, sigma_t = {1, 2}
+inline auto
+makeCrossSections() -> CrossSections<HostMemSpace>
+{
+  CrossSections<HostMemSpace> xs("xs", 1, 2);
+  xs(0, reactions::total, 0) = 1;
+  xs(0, reactions::total, 1) = 2;
+  return xs;
+}
+
+// A uniform source of q in group 0 and q / 2 in group 1
+inline auto
+makeSource(Int const num_faces, Int const stride, Float const q)
+    -> Kokkos::View<Float *, HostMemSpace>
+{
+  Kokkos::View<Float *, HostMemSpace> source("source",
+                                             static_cast<size_t>(num_faces * stride));
+  for (Int f = 0; f < num_faces; ++f) {
+    source(f * stride) = q;
+    source(f * stride + 1) = q / 2;
+  }
+  return source;
+}
+
+} // namespace juno::test
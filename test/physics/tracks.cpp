@@ -0,0 +1,204 @@
+#include <juno/common/logger.hpp>
+#include <juno/physics/tracks.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cmath> // std::abs
+
+#include "../test_macros.hpp"
+#include "../mesh/quad_mesh.hpp"
+
+using juno::test::makeBox;
+
+Float constexpr eps = static_cast<Float>(1e-4);
+
+namespace
+{
+
+auto
+onBoundary(juno::AABB2 const & box, juno::Vec2 const p) -> bool
+{
+  return std::abs(p.x - box.min.x) < eps || std::abs(p.x - box.max.x) < eps ||
+         std::abs(p.y - box.min.y) < eps || std::abs(p.y - box.max.y) < eps;
+}
+
+} // namespace
+
+TEST_CASE(polar)
+{
+  for (Int n = 1; n <= juno::max_polar_angles; ++n) {
+    auto const q = juno::tabuchiYamamoto(n);
+    ASSERT(q.num_angles == n);
+    Float sum = 0;
+    for (Int p = 0; p < n; ++p) {
+      ASSERT(q.sin_theta[p] > 0 && q.sin_theta[p] <= 1);
+      sum += q.weights[p];
+    }
+    ASSERT_NEAR(sum, 1, eps);
+  }
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  ASSERT(juno::tabuchiYamamoto(4).num_angles == 0);
+  ASSERT(juno::logger::errorCount() == 1);
+  juno::logger::reset();
+}
+
+TEST_CASE(layout)
+{
+  auto const box = makeBox(1, 2);
+  juno::TrackParameters parameters;
+  parameters.num_azimuthal = 8;
+  parameters.spacing = static_cast<Float>(0.1);
+  parameters.num_polar = 2;
+  auto const layout = juno::makeTrackLayout(box, parameters);
+  ASSERT(layout.numAzimuthal() == 8);
+  ASSERT(layout.polar.num_angles == 2);
+  ASSERT(layout.azimuth_offsets.back() == layout.numTracks());
+
+  // The angles are increasing, complementary, and their weights sum to 1/2
+  Float sum = 0;
+  for (Int a = 0; a < 8; ++a) {
+    auto const i = static_cast<size_t>(a);
+    ASSERT(layout.phi[i] > 0);
+    ASSERT(i == 0 || layout.phi[i - 1] < layout.phi[i]);
+    ASSERT_NEAR(layout.phi[i] + layout.phi[7 - i], static_cast<Float>(3.14159265), eps);
+    ASSERT(layout.spacing[i] <= parameters.spacing);
+    sum += layout.azimuthal_weights[i];
+  }
+  ASSERT_NEAR(sum, static_cast<Float>(0.5), eps);
+
+  // The tracks cross the box, from boundary to boundary
+  for (Int t = 0; t < layout.numTracks(); ++t) {
+    auto const & ray = layout.tracks[static_cast<size_t>(t)];
+    ASSERT(ray.length > 0);
+    ASSERT(onBoundary(box, ray.origin));
+    ASSERT(onBoundary(box, ray(ray.length)));
+    Int const a = layout.azimuths[static_cast<size_t>(t)];
+    ASSERT(layout.azimuth_offsets[static_cast<size_t>(a)] <= t);
+    ASSERT(t < layout.azimuth_offsets[static_cast<size_t>(a) + 1]);
+  }
+}
+
+TEST_CASE(links)
+{
+  auto const box = makeBox(2, 1);
+  juno::TrackParameters parameters;
+  parameters.num_azimuthal = 16;
+  parameters.spacing = static_cast<Float>(0.05);
+  auto const layout = juno::makeTrackLayout(box, parameters);
+  Int const num_directions = 2 * layout.numTracks();
+  ASSERT(static_cast<Int>(layout.links.size()) == num_directions);
+
+  // Each direction is continued by exactly one, of the complementary angle, at its exit
+  std::vector<Int> counts(static_cast<size_t>(num_directions), 0);
+  for (Int i = 0; i < num_directions; ++i) {
+    Int const j = layout.links[static_cast<size_t>(i)];
+    ASSERT(0 <= j && j < num_directions);
+    ++counts[static_cast<size_t>(j)];
+    Int const a = layout.azimuths[static_cast<size_t>(i / 2)];
+    Int const b = layout.azimuths[static_cast<size_t>(j / 2)];
+    ASSERT(a + b == layout.numAzimuthal() - 1);
+    auto const & from = layout.tracks[static_cast<size_t>(i / 2)];
+    auto const & to = layout.tracks[static_cast<size_t>(j / 2)];
+    juno::Vec2 const exit = i % 2 == 0 ? from(from.length) : from.origin;
+    juno::Vec2 const entry = j % 2 == 0 ? to.origin : to(to.length);
+    ASSERT(juno::distance(exit, entry) < 10 * eps);
+  }
+  for (Int const n : counts) {
+    ASSERT(n == 1);
+  }
+
+  // Following the links returns to the first track
+  Int i = layout.links[0];
+  Int steps = 1;
+  for (; i != 0 && steps <= num_directions; ++steps) {
+    i = layout.links[static_cast<size_t>(i)];
+  }
+  ASSERT(i == 0);
+}
+
+TEST_CASE(translated_links)
+{
+  auto const box = makeBox(2, 1);
+  juno::TrackParameters parameters;
+  parameters.num_azimuthal = 16;
+  parameters.spacing = static_cast<Float>(0.05);
+  auto const layout = juno::makeTrackLayout(box, parameters);
+  Int const num_directions = 2 * layout.numTracks();
+  ASSERT(static_cast<Int>(layout.translated_links.size()) == num_directions);
+  ASSERT(static_cast<Int>(layout.exit_sides.size()) == num_directions);
+
+  // Each direction continues into the same angle and direction, at the exit point
+  // translated across the box, and exactly one direction enters at each point
+  std::vector<Int> counts(static_cast<size_t>(num_directions), 0);
+  for (Int i = 0; i < num_directions; ++i) {
+    Int const j = layout.translated_links[static_cast<size_t>(i)];
+    ASSERT(0 <= j && j < num_directions);
+    ASSERT(i % 2 == j % 2);
+    ++counts[static_cast<size_t>(j)];
+    ASSERT(layout.azimuths[static_cast<size_t>(i / 2)] ==
+           layout.azimuths[static_cast<size_t>(j / 2)]);
+    auto const & from = layout.tracks[static_cast<size_t>(i / 2)];
+    auto const & to = layout.tracks[static_cast<size_t>(j / 2)];
+    juno::Vec2 exit = i % 2 == 0 ? from(from.length) : from.origin;
+    juno::Vec2 const entry = j % 2 == 0 ? to.origin : to(to.length);
+    switch (layout.exit_sides[static_cast<size_t>(i)]) {
+    case juno::box_sides::bottom:
+      ASSERT(std::abs(exit.y - box.min.y) < eps);
+      exit.y += box.height();
+      break;
+    case juno::box_sides::right:
+      ASSERT(std::abs(exit.x - box.max.x) < eps);
+      exit.x -= box.width();
+      break;
+    case juno::box_sides::top:
+      ASSERT(std::abs(exit.y - box.max.y) < eps);
+      exit.y -= box.height();
+      break;
+    default:
+      ASSERT(layout.exit_sides[static_cast<size_t>(i)] == juno::box_sides::left);
+      ASSERT(std::abs(exit.x - box.min.x) < eps);
+      exit.x += box.width();
+      break;
+    }
+    ASSERT(juno::distance(exit, entry) < 10 * eps);
+  }
+  for (Int const n : counts) {
+    ASSERT(n == 1);
+  }
+  STATIC_ASSERT(juno::oppositeSide(juno::box_sides::left) == juno::box_sides::right);
+  STATIC_ASSERT(juno::oppositeSide(juno::box_sides::bottom) == juno::box_sides::top);
+}
+
+TEST_CASE(errors)
+{
+  juno::logger::reset();
+  juno::logger::error_policy = juno::logger::error_policies::callback;
+  juno::TrackParameters parameters;
+  parameters.num_azimuthal = 7;
+  ASSERT(juno::makeTrackLayout(makeBox(1, 1), parameters).numTracks() == 0);
+  parameters.num_azimuthal = 8;
+  parameters.spacing = 0;
+  ASSERT(juno::makeTrackLayout(makeBox(1, 1), parameters).numTracks() == 0);
+  parameters.spacing = 1;
+  ASSERT(juno::makeTrackLayout(juno::AABB2{}, parameters).numTracks() == 0);
+  ASSERT(juno::logger::errorCount() == 3);
+  juno::logger::reset();
+}
+
+TEST_SUITE(tracks)
+{
+  TEST(polar);
+  TEST(layout);
+  TEST(links);
+  TEST(translated_links);
+  TEST(errors);
+}
+
+auto
+main(int argc, char ** argv) -> int
+{
+  Kokkos::ScopeGuard const guard(argc, argv);
+  RUN_SUITE(tracks);
+  return 0;
+}
@@ -25,11 +25,28 @@
 //        TEST_GPU_KERNEL(host_test).
 //      - it is assumed that MAKE_GPU_KERNEL(host_test) was called before
 //        TEST_GPU_KERNEL(host_test).
-// 4. RUN_TESTS(suite)
+// 4. RUN_SUITE(suite)
 //      - to run a test suite in the main function.
 //
 // Additional notes:
-// - TEST_HOSTDEV(name) is a shortcut for "TEST(name); TEST_GPU_KERNEL(name)".
+// - TEST_HOSTDEV(name) is a shortcut for "TEST_CONCURRENT(name); TEST_GPU_KERNEL(name)".
+// - TEST_CONCURRENT(name) is TEST(name) for a test that may run at the same time as
+//   the other concurrent tests. Use it for the host tests that do not touch global
+//   state, such as the logger, Kokkos (including views) or files.
+//
+// Running:
+// A suite only registers its tests. RUN_SUITE then runs them, and prints the time of
+// each, so that slow tests stand out:
+//  1. The GPU kernels are launched round-robin on JUNO_TEST_STREAMS streams (default 4),
+//     without synchronizing between them.
+//  2. The TEST_CONCURRENT tests, such as the host halves of the TEST_HOSTDEV tests, run
+//     on JUNO_TEST_THREADS threads (default: all hardware threads), while the kernels
+//     run. A HOSTDEV test is also device code, so it does not touch global state, such
+//     as the logger, Kokkos or files.
+//  3. The device is synchronized once, and each kernel is timed with events.
+//  4. The TEST tests run one at a time, in order, since they may share global state.
+// JUNO_TEST_THREADS=1 and JUNO_TEST_STREAMS=1 run everything in order, e.g. to attribute
+// a GPU error to one kernel.
 
 #ifndef JUNO_USE_GPU
 #  error("test_macros.hpp must be included after any JUNO files since it undefs NDEBUG")
@@ -37,8 +54,13 @@
 
 #undef NDEBUG
 #include <cassert> // assert
+#include <algorithm> // std::min, std::max
+#include <atomic>
+#include <chrono>
 #include <cstdio>  // printf
-#include <cstdlib> // abort
+#include <cstdlib> // abort, getenv, atoi
+#include <thread>
+#include <vector>
 
 #undef ASSERT
 #undef ASSERT_NEAR
@@ -71,12 +93,232 @@
 #define TEST_SUITE(name) static void name()
 // NOLINTEND(misc-use-anonymous-namespace)
 
-#define TEST(name) name()
+// NOLINTBEGIN(bugprone-macro-parentheses) OK, using the name of the test
+#define TEST(name) juno::test::registry().add(#name, [] { name(); })
 
-#define RUN_SUITE(suite)                                                                 \
-  printf("Running test suite '%s'\n", #suite);                                           \
-  suite();                                                                               \
-  printf("Test suite '%s' passed\n", #suite);
+#define TEST_CONCURRENT(name) juno::test::registry().addConcurrent(#name, [] { name(); })
+// NOLINTEND(bugprone-macro-parentheses)
+
+#define RUN_SUITE(suite) juno::test::runSuite(#suite, suite)
+
+//========================================================================================
+// Runner
+//========================================================================================
+
+namespace juno::test
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Test {
+  char const * name;
+  void (*run)();
+  bool concurrent;
+  double ms = 0;
+};
+
+#if JUNO_USE_GPU
+struct DeviceTest {
+  char const * name;
+  void (*launch)(gpuStream_t);
+  gpuEvent_t start = {};
+  gpuEvent_t stop = {};
+  double ms = 0;
+};
+#endif
+
+// The tests of the suite being run, in the order they were registered
+struct Registry {
+  std::vector<Test> tests;
+#if JUNO_USE_GPU
+  std::vector<DeviceTest> device;
+#endif
+
+  void
+  add(char const * name, void (*run)())
+  {
+    tests.push_back({name, run, false});
+  }
+
+  void
+  addConcurrent(char const * name, void (*run)())
+  {
+    tests.push_back({name, run, true});
+  }
+
+#if JUNO_USE_GPU
+  void
+  addDevice(char const * name, void (*launch)(gpuStream_t))
+  {
+    device.push_back({name, launch});
+  }
+#endif
+};
+
+inline auto
+registry() -> Registry &
+{
+  static Registry r;
+  return r;
+}
+
+// A positive integer from the environment, or the default
+inline auto
+envCount(char const * name, int const fallback) -> int
+{
+  char const * const value = std::getenv(name);
+  int const n = value == nullptr ? 0 : std::atoi(value);
+  return n > 0 ? n : fallback;
+}
+
+inline auto
+millisecondsSince(Clock::time_point const start) -> double
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+inline void
+timed(Test & test)
+{
+  auto const start = Clock::now();
+  test.run();
+  test.ms = millisecondsSince(start);
+}
+
+#if JUNO_USE_GPU
+inline void
+checkGPU(char const * what, gpuError_t const error)
+{
+  if (error != gpuSuccess) {
+    printf("GPU error %s: %s\n", what, gpuGetErrorString(error));
+    abort();
+  }
+}
+
+// Launch every kernel, without waiting for any of them
+inline void
+launchDeviceTests(std::vector<DeviceTest> & tests, std::vector<gpuStream_t> & streams)
+{
+  if (tests.empty()) {
+    return;
+  }
+  streams.resize(static_cast<size_t>(envCount("JUNO_TEST_STREAMS", 4)));
+  for (auto & stream : streams) {
+    checkGPU("creating a stream", gpuStreamCreate(&stream));
+  }
+  for (size_t i = 0; i < tests.size(); ++i) {
+    auto & test = tests[i];
+    gpuStream_t const stream = streams[i % streams.size()];
+    checkGPU("creating an event", gpuEventCreate(&test.start));
+    checkGPU("creating an event", gpuEventCreate(&test.stop));
+    gpuEventRecord(test.start, stream);
+    test.launch(stream);
+    gpuEventRecord(test.stop, stream);
+    // With one stream, every kernel is checked before the next, as if run alone
+    if (streams.size() == 1) {
+      checkGPU(test.name, gpuDeviceSynchronize());
+    }
+  }
+}
+
+inline void
+finishDeviceTests(std::vector<DeviceTest> & tests, std::vector<gpuStream_t> & streams)
+{
+  if (tests.empty()) {
+    return;
+  }
+  checkGPU("running the device tests", gpuDeviceSynchronize());
+  checkGPU("running the device tests", gpuGetLastError());
+  for (auto & test : tests) {
+    float ms = 0;
+    gpuEventElapsedTime(&ms, test.start, test.stop);
+    test.ms = static_cast<double>(ms);
+    gpuEventDestroy(test.start);
+    gpuEventDestroy(test.stop);
+  }
+  for (auto & stream : streams) {
+    gpuStreamDestroy(stream);
+  }
+}
+#endif
+
+// Run the tests that may run at the same time, on a pool of threads that each take the
+// next test
+inline void
+runConcurrentTests(std::vector<Test> & tests)
+{
+  std::vector<Test *> concurrent;
+  for (auto & test : tests) {
+    if (test.concurrent) {
+      concurrent.push_back(&test);
+    }
+  }
+  auto const hardware_threads =
+      static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+  auto const requested = envCount("JUNO_TEST_THREADS", hardware_threads);
+  auto const num_threads = std::min(concurrent.size(), static_cast<size_t>(requested));
+  if (num_threads <= 1) {
+    for (auto * const test : concurrent) {
+      timed(*test);
+    }
+    return;
+  }
+  std::atomic<size_t> next = 0;
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = next++; i < concurrent.size(); i = next++) {
+        timed(*concurrent[i]);
+      }
+    });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+}
+
+inline void
+printTime(char const * name, char const * where, double const ms)
+{
+  printf("  %-40s %-6s %10.3f ms\n", name, where, ms);
+}
+
+inline void
+runSuite(char const * name, void (*suite)())
+{
+  printf("Running test suite '%s'\n", name);
+  auto & r = registry();
+  r = {};
+  suite();
+  auto const start = Clock::now();
+
+#if JUNO_USE_GPU
+  std::vector<gpuStream_t> streams;
+  launchDeviceTests(r.device, streams);
+#endif
+  runConcurrentTests(r.tests);
+#if JUNO_USE_GPU
+  finishDeviceTests(r.device, streams);
+#endif
+  for (auto & test : r.tests) {
+    if (!test.concurrent) {
+      timed(test);
+    }
+  }
+
+  for (auto const & test : r.tests) {
+    printTime(test.name, "host", test.ms);
+  }
+#if JUNO_USE_GPU
+  for (auto const & test : r.device) {
+    printTime(test.name, "device", test.ms);
+  }
+#endif
+  printf("Test suite '%s' passed in %.3f ms\n", name, millisecondsSince(start));
+}
+
+} // namespace juno::test
 
 //========================================================================================
 // Macros for GPU
@@ -104,41 +346,25 @@
                               MAKE_GPU_KERNEL_1_ARGS)                                    \
     (__VA_ARGS__)
 
-#  define GPU_KERNEL_POST_TEST                                                           \
-    gpuError_t const sync_error = gpuDeviceSynchronize();                                \
-    if (sync_error != gpuSuccess) {                                                      \
-      printf("GPU error: %s\n", gpuGetErrorString(sync_error));                          \
-      abort();                                                                           \
-    }                                                                                    \
-    gpuError_t const error = gpuGetLastError();                                          \
-    if (error != gpuSuccess) {                                                           \
-      printf("GPU error: %s\n", gpuGetErrorString(error));                               \
-      abort();                                                                           \
-    }
-
 #  define TEST_GPU_KERNEL_1_ARGS(host_test)                                              \
-    {                                                                                    \
-      host_test##_gpu_kernel<<<1, 1>>>();                                                \
-      GPU_KERNEL_POST_TEST                                                               \
-    }
+    juno::test::registry().addDevice(#host_test, [](gpuStream_t const stream) {          \
+      host_test##_gpu_kernel<<<1, 1, 0, stream>>>();                                     \
+    })
 
 #  define TEST_GPU_KERNEL_2_ARGS(host_test, T)                                           \
-    {                                                                                    \
-      host_test##_gpu_kernel<T><<<1, 1>>>();                                             \
-      GPU_KERNEL_POST_TEST                                                               \
-    }
+    juno::test::registry().addDevice(#host_test, [](gpuStream_t const stream) {          \
+      host_test##_gpu_kernel<T><<<1, 1, 0, stream>>>();                                  \
+    })
 
 #  define TEST_GPU_KERNEL_3_ARGS(host_test, T, U)                                        \
-    {                                                                                    \
-      host_test##_gpu_kernel<T, U><<<1, 1>>>();                                          \
-      GPU_KERNEL_POST_TEST                                                               \
-    }
+    juno::test::registry().addDevice(#host_test, [](gpuStream_t const stream) {          \
+      host_test##_gpu_kernel<T, U><<<1, 1, 0, stream>>>();                               \
+    })
 
 #  define TEST_GPU_KERNEL_4_ARGS(host_test, T, U, V)                                     \
-    {                                                                                    \
-      host_test##_gpu_kernel<T, U, V><<<1, 1>>>();                                       \
-      GPU_KERNEL_POST_TEST                                                               \
-    }
+    juno::test::registry().addDevice(#host_test, [](gpuStream_t const stream) {          \
+      host_test##_gpu_kernel<T, U, V><<<1, 1, 0, stream>>>();                            \
+    })
 
 #  define TEST_GPU_KERNEL_GET_MACRO(_1, _2, _3, _4, NAME, ...) NAME
 #  define TEST_GPU_KERNEL(...)                                                           \
@@ -153,19 +379,19 @@
 #endif // JUNO_USE_GPU
 
 #define TEST_HOSTDEV_1_ARGS(host_test)                                                   \
-  TEST(host_test);                                                                       \
+  TEST_CONCURRENT(host_test);                                                            \
   TEST_GPU_KERNEL(host_test);
 
 #define TEST_HOSTDEV_2_ARGS(host_test, T)                                                \
-  TEST((host_test<T>));                                                                  \
+  TEST_CONCURRENT((host_test<T>));                                                       \
   TEST_GPU_KERNEL(host_test, T);
 
 #define TEST_HOSTDEV_3_ARGS(host_test, T, U)                                             \
-  TEST((host_test<T, U>));                                                               \
+  TEST_CONCURRENT((host_test<T, U>));                                                    \
   TEST_GPU_KERNEL(host_test, T, U);
 
 #define TEST_HOSTDEV_4_ARGS(host_test, T, U, V)                                          \
-  TEST((host_test<T, U, V>));                                                            \
+  TEST_CONCURRENT((host_test<T, U, V>));                                                 \
   TEST_GPU_KERNEL(host_test, T, U, V);
 // NOLINTEND(bugprone-macro-parentheses)
 